@@ -53,8 +53,10 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -72,6 +74,59 @@
 #include "backend_get.h"
 #include "backend_client.h"
 
+/*
+ * Constants
+ */
+/*! Max bytes read from a client socket per event, see from_client */
+#define FROM_CLIENT_BUFSIZ 65536
+
+/*
+ * Types
+ */
+/*! Worker process executing a read-only RPC of a client, see rpc_worker_start
+ */
+struct rpc_worker{
+    qelem_t              rw_qelem; /* List header */
+    pid_t                rw_pid;  /* Worker process id */
+    int                  rw_fd;   /* Read end of reply pipe */
+    struct client_entry *rw_ce;   /* Client, or NULL if client removed */
+    cbuf                *rw_cb;   /* Reply received so far */
+};
+
+/*! Scheduling class of clients with a relative weight, see CLICON_BACKEND_SCHED_CLASS
+ */
+struct sched_class{
+    qelem_t              sc_qelem;    /* List header */
+    char                *sc_name;     /* Username or transport, or "default" */
+    uint32_t             sc_weight;   /* RPCs per quantum and scheduling round */
+    uint32_t             sc_depth;    /* Pending RPCs of clients in class */
+    uint64_t             sc_rpcs;     /* Scheduled RPCs */
+    uint64_t             sc_denied;   /* RPCs denied by admission control */
+    uint64_t             sc_wait;     /* Sum of wait time of scheduled RPCs in us */
+    uint32_t             sc_wait_max; /* Max wait time of scheduled RPCs in us */
+};
+
+/*
+ * Variables
+ */
+/* Number of running RPC worker processes, bounded by CLICON_BACKEND_RPC_WORKERS */
+static int _rpc_workers_nr = 0;
+
+/* Running RPC worker processes */
+static struct rpc_worker *_rpc_workers = NULL;
+
+/* Scheduling classes, first is default class, see sched_class_get */
+static struct sched_class *_sched_classes = NULL;
+
+/* Max weight of scheduling classes */
+static uint32_t _sched_weight_max = 1;
+
+/* Number of pending RPCs of all clients */
+static int _sched_depth = 0;
+
+/* Scheduling round registered as deferred event callback */
+static int _sched_reg = 0;
+
 /*! Find client by session-id 
  *
  * @param[in] ce_list   List of clients
@@ -126,6 +181,236 @@ ce_client_descr(struct client_entry *ce,
     return retval;
 }
 
+/* Forward */
+static int ce_output_cb(int s, void *arg);
+static int rpc_worker_cb(int s, void *arg);
+static int sched_client_rm(struct client_entry *ce);
+static int sched_kick(clixon_handle h);
+static int from_client_input(clixon_handle h, struct client_entry *ce, unsigned char *p, size_t plen, int eof);
+
+/*! Resume input from a client unless it is suspended for another reason
+ *
+ * Input is suspended while the client waits for a RPC worker (if not scheduled), while
+ * its RPC queue is full, and while its output is above the high-water mark.
+ * Input received but not dispatched while suspended is dispatched here.
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     1   OK, client removed
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+ce_input_resume(clixon_handle        h,
+                struct client_entry *ce)
+{
+    int   retval = -1;
+    cbuf *cbpend;
+
+    if (ce->ce_outsusp || ce->ce_suspended)
+        return 0;
+    if (ce->ce_worker != NULL && clicon_option_int(h, "CLICON_BACKEND_SCHED_QUANTUM") <= 0)
+        return 0;
+    if (clixon_event_reg_fd_prio(ce->ce_s, from_client, (void*)ce, "local netconf client socket",
+                                 clicon_option_bool(h, "CLICON_SOCK_PRIO")) < 0)
+        goto done;
+    retval = 0;
+    if ((cbpend = ce->ce_rcvpend) != NULL){
+        ce->ce_rcvpend = NULL;
+        retval = from_client_input(h, ce, (unsigned char *)cbuf_get(cbpend), cbuf_len(cbpend), 0);
+        cbuf_free(cbpend);
+    }
+ done:
+    return retval;
+}
+
+/*! Write queued output of a client without blocking
+ *
+ * Writes as much as the socket accepts. If output remains, a write event is
+ * registered and the rest is written by ce_output_cb when the socket is writable.
+ * If the client has closed its socket, queued output is dropped, the client is
+ * removed when its socket is read.
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+ce_output_write(clixon_handle        h,
+                struct client_entry *ce)
+{
+    int               retval = -1;
+    struct ce_output *co;
+    struct iovec      iov[3];
+    struct msghdr     msg = {0,};
+    size_t            pos;
+    size_t            total;
+    ssize_t           n;
+    int               i;
+
+    while ((co = ce->ce_outq) != NULL){
+        iov[0].iov_base = co->co_hdr;
+        iov[0].iov_len = co->co_hdrlen;
+        iov[1].iov_base = cbuf_get(co->co_cb);
+        iov[1].iov_len = cbuf_len(co->co_cb);
+        iov[2].iov_base = "\n##\n";
+        iov[2].iov_len = strlen("\n##\n");
+        total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+        /* Skip what is already written */
+        pos = co->co_pos;
+        for (i=0; i<3 && pos >= iov[i].iov_len; i++)
+            pos -= iov[i].iov_len;
+        iov[i].iov_base = (char*)iov[i].iov_base + pos;
+        iov[i].iov_len -= pos;
+        msg.msg_iov = &iov[i];
+        msg.msg_iovlen = 3 - i;
+        if ((n = sendmsg(ce->ce_s, &msg, MSG_DONTWAIT)) < 0){
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EPIPE || errno == ECONNRESET){
+                clixon_log(h, LOG_WARNING, "client %d reset", ce->ce_nr);
+                while ((co = ce->ce_outq) != NULL){
+                    DELQ(co, ce->ce_outq, struct ce_output *);
+                    cbuf_free(co->co_cb);
+                    free(co);
+                }
+                ce->ce_outlen = 0;
+                break;
+            }
+            clixon_err(OE_UNIX, errno, "sendmsg");
+            goto done;
+        }
+        co->co_pos += n;
+        ce->ce_outlen -= n;
+        if (co->co_pos < total)
+            continue;
+        DELQ(co, ce->ce_outq, struct ce_output *);
+        cbuf_free(co->co_cb);
+        free(co);
+    }
+    if (ce->ce_outq == NULL){
+        ce->ce_outdrop = 0;
+        if (ce->ce_outreg && !ce->ce_outsusp){ /* If suspended, resumed by ce_output_cb */
+            clixon_event_unreg_fd(ce->ce_s, ce_output_cb);
+            ce->ce_outreg = 0;
+        }
+    }
+    else if (ce->ce_outreg == 0){
+        if (clixon_event_reg_fd_write(ce->ce_s, ce_output_cb, ce, "client output") < 0)
+            goto done;
+        ce->ce_outreg = 1;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Client socket is writable: write queued output
+ *
+ * If input from the client is suspended since its output is above the high-water mark,
+ * input is resumed when all output is written.
+ * @param[in]  s    Socket to client
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see ce_output_write
+ */
+static int
+ce_output_cb(int   s,
+             void *arg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    clixon_handle        h = ce->ce_handle;
+
+    if (ce_output_write(h, ce) < 0)
+        goto done;
+    if (ce->ce_outsusp && ce->ce_outq == NULL){
+        clixon_event_unreg_fd(ce->ce_s, ce_output_cb);
+        ce->ce_outreg = 0;
+        ce->ce_outsusp = 0;
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d output written, resume input", ce->ce_nr);
+        if (ce_input_resume(h, ce) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Queue a message to a client and write what is possible without blocking
+ *
+ * The message buffer is handed over to the output queue, and NETCONF 1.1 chunked
+ * framing is added when writing, ie the message is not copied.
+ * Notifications are dropped if the output queue of the client is above the
+ * high-water mark CLICON_BACKEND_OUTPUT_HIGHWATER, so that a slow subscriber does not
+ * consume unlimited memory. Replies are never dropped.
+ * If CLICON_BACKEND_OUTPUT_SUSPEND is set, input from the client is also suspended while
+ * its output queue is above the high-water mark, see ce_output_cb.
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  cb      Message, freed by this function, also on error
+ * @param[in]  notify  Message is a notification
+ * @retval     1       Message queued or written
+ * @retval     0       Notification dropped
+ * @retval    -1       Error
+ */
+static int
+ce_output_send(clixon_handle        h,
+               struct client_entry *ce,
+               cbuf                *cb,
+               int                  notify)
+{
+    int               retval = -1;
+    struct ce_output *co = NULL;
+    uint32_t          highwater;
+    cbuf             *cbce = NULL;
+
+    if (notify && ce->ce_outq != NULL &&
+        (highwater = clicon_option_int(h, "CLICON_BACKEND_OUTPUT_HIGHWATER")) > 0 &&
+        ce->ce_outlen >= highwater){
+        if (ce->ce_outdrop++ == 0)
+            clixon_log(h, LOG_WARNING, "client %d output above high-water mark %u, dropping notifications",
+                       ce->ce_nr, highwater);
+        retval = 0;
+        goto done;
+    }
+    if (ce_client_descr(ce, &cbce) < 0)
+        goto done;
+    if (clixon_debug_detail())
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send [%s] %s", cbuf_get(cbce), cbuf_get(cb));
+    else
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%s] %s", cbuf_get(cbce), cbuf_get(cb));
+    if ((co = malloc(sizeof(*co))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(co, 0, sizeof(*co));
+    co->co_hdrlen = snprintf(co->co_hdr, sizeof(co->co_hdr), "\n#%zu\n", cbuf_len(cb));
+    co->co_cb = cb;
+    cb = NULL;
+    ADDQ(co, ce->ce_outq);
+    ce->ce_outlen += co->co_hdrlen + cbuf_len(co->co_cb) + strlen("\n##\n");
+    if (ce_output_write(h, ce) < 0)
+        goto done;
+    if (ce->ce_outq != NULL && !ce->ce_outsusp &&
+        (highwater = clicon_option_int(h, "CLICON_BACKEND_OUTPUT_HIGHWATER")) > 0 &&
+        ce->ce_outlen >= highwater &&
+        clicon_option_bool(h, "CLICON_BACKEND_OUTPUT_SUSPEND")){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d output above high-water mark, suspend input", ce->ce_nr);
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        ce->ce_outsusp = 1;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbce)
+        cbuf_free(cbce);
+    return retval;
+}
+
 /*! Stream callback for netconf stream notification (RFC 5277)
  *
  * @param[in]  h     Clixon handle
@@ -144,7 +429,8 @@ ce_event_cb(clixon_handle h,
 {
     int                  retval = -1;
     struct client_entry *ce = (struct client_entry *)arg;
-    cbuf                *cbce = NULL;
+    cbuf                *cb = NULL;
+    int                  ret;
 
     clixon_debug(CLIXON_DBG_BACKEND, "op:%d", op);
     switch (op){
@@ -154,22 +440,26 @@ ce_event_cb(clixon_handle h,
             backend_client_rm(h, ce);
         break;
     default:
-        if (ce_client_descr(ce, &cbce) < 0)
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
-        if (send_msg_notify_xml(h, ce->ce_s, cbuf_get(cbce), event) < 0){
-            if (errno == ECONNRESET || errno == EPIPE){
-                clixon_log(h, LOG_WARNING, "client %d reset", ce->ce_nr);
-            }
-            break;
         }
+        if (clixon_xml2cbuf(cb, event, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        ret = ce_output_send(h, ce, cb, 1);
+        cb = NULL;
+        if (ret < 0)
+            goto done;
+        if (ret == 0) /* dropped */
+            break;
         /* note there may be other notifications than RFC5277 streams */
         ce->ce_out_notifications++;
         netconf_monitoring_counter_inc(h, "out-notifications");
     }
     retval = 0;
  done:
-    if (cbce)
-        cbuf_free(cbce);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -244,7 +534,10 @@ backend_monitoring_state_get(clixon_handle h,
     struct client_entry *ce;
     char                 timestr[28];
     int                  ret;
+    struct sched_class  *sc;
+    int                  sched;
 
+    sched = clicon_option_int(h, "CLICON_BACKEND_SCHED_QUANTUM") > 0;
     if ((cb = cbuf_new()) ==NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -281,9 +574,34 @@ backend_monitoring_state_get(clixon_handle h,
         cprintf(cb, "<in-bad-rpcs>%u</in-bad-rpcs>", ce->ce_in_bad_rpcs);
         cprintf(cb, "<out-rpc-errors>%u</out-rpc-errors>", ce->ce_out_rpc_errors);
         cprintf(cb, "<out-notifications>%u</out-notifications>", ce->ce_out_notifications);
+        if (sched){
+            if (ce->ce_class)
+                cprintf(cb, "<sched-class xmlns=\"%s\">%s</sched-class>",
+                        CLIXON_LIB_NS, ce->ce_class->sc_name);
+            cprintf(cb, "<rpc-queue-depth xmlns=\"%s\">%d</rpc-queue-depth>",
+                    CLIXON_LIB_NS, ce->ce_rpcq_nr);
+        }
         cprintf(cb, "</session>");
     }
     cprintf(cb, "</sessions>");
+    if (sched && _sched_classes){
+        cprintf(cb, "<scheduler xmlns=\"%s\">", CLIXON_LIB_NS);
+        sc = _sched_classes;
+        do {
+            cprintf(cb, "<class>");
+            cprintf(cb, "<name>%s</name>", sc->sc_name);
+            cprintf(cb, "<weight>%u</weight>", sc->sc_weight);
+            cprintf(cb, "<queue-depth>%u</queue-depth>", sc->sc_depth);
+            cprintf(cb, "<rpcs>%" PRIu64 "</rpcs>", sc->sc_rpcs);
+            cprintf(cb, "<denied>%" PRIu64 "</denied>", sc->sc_denied);
+            cprintf(cb, "<wait-time-avg>%" PRIu64 "</wait-time-avg>",
+                    sc->sc_rpcs ? sc->sc_wait/sc->sc_rpcs : 0);
+            cprintf(cb, "<wait-time-max>%u</wait-time-max>", sc->sc_wait_max);
+            cprintf(cb, "</class>");
+            sc = NEXTQ(struct sched_class *, sc);
+        } while (sc != _sched_classes);
+        cprintf(cb, "</scheduler>");
+    }
     cprintf(cb, "</netconf-state>");
     if ((ret = clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, xerr)) < 0)
         goto done;
@@ -347,8 +665,22 @@ backend_client_rm(clixon_handle        h,
     ce_prev = &c0; /* this points to stack and is not real backpointer */
     for (c = *ce_prev; c; c = c->ce_next){
         if (c == ce){
+            sched_client_rm(ce);
+            if (ce->ce_worker){ /* Reply of worker is discarded */
+                ce->ce_worker->rw_ce = NULL;
+                ce->ce_worker = NULL;
+            }
             if (ce->ce_s){
                 clixon_event_unreg_fd(ce->ce_s, from_client);
+                /* Write what the socket accepts of queued output, the rest is discarded
+                 * when the client entry is deleted. Errors are ignored since the client
+                 * is removed anyway */
+                if (ce->ce_outq != NULL)
+                    ce_output_write(h, ce);
+                if (ce->ce_outreg){
+                    clixon_event_unreg_fd(ce->ce_s, ce_output_cb);
+                    ce->ce_outreg = 0;
+                }
                 close(ce->ce_s);
                 ce->ce_s = 0;
                 if (release_all_dbs(h, ce->ce_id) < 0)
@@ -512,114 +844,28 @@ do_lock(clixon_handle h,
     goto done;
 }
 
-/*! Loads all or part of a specified configuration to target configuration
- * 
- * @param[in]  h       Clixon handle 
- * @param[in]  xn      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
- * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
- * @retval     0       OK
+/*! Check and bind the config payload of an edit before it is applied to a datastore
+ *
+ * Only limited validation is made, see note in from_client_edit_config
+ * @param[in]  h       Clixon handle
+ * @param[in]  xc      Config payload: <config>...</config>
+ * @param[in]  yspec   Yang spec
+ * @param[out] cbret   Return xml tree, eg <rpc-error.. if retval is 0
+ * @retval     1       OK
+ * @retval     0       Invalid, cbret set
  * @retval    -1       Error
- * @note  According to RFC 7950 8.3: constraints MUST be enforced:
- * o  during parsing of RPC payloads
- * o  during processing of the <edit-config> operation
- * But Clixon is flexible in allowing invalid XML payload here, only some specialized
- * validations are made.
- * However, what really should be done is to apply the change to the datastore and then
- * validate, if error, discard to previous state. 
- * But this could discard other previous changes to candidate.
  */
 static int
-from_client_edit_config(clixon_handle h,
-                        cxobj        *xn,
-                        cbuf         *cbret,
-                        void         *arg,
-                        void         *regarg)
+edit_config_check(clixon_handle h,
+                  cxobj        *xc,
+                  yang_stmt    *yspec,
+                  cbuf         *cbret)
 {
-    int                 retval = -1;
-    struct client_entry *ce = (struct client_entry *)arg;
-    uint32_t            myid = ce->ce_id;
-    uint32_t            iddb;
-    char               *target;
-    cxobj              *xc;
-    cxobj              *x;
-    enum operation_type operation = OP_MERGE;
-    int                 non_config = 0;
-    yang_stmt          *yspec;
-    cbuf               *cbx = NULL; /* Assist cbuf */
-    int                 ret;
-    char               *username;
-    cxobj              *xret = NULL;
-    char               *attr;
-    int                 autocommit = 0;
-    char               *val = NULL;
-    cvec               *nsc = NULL;
-    char               *prefix = NULL;
+    int    retval = -1;
+    cxobj *xret = NULL;
+    int    non_config = 0;
+    int    ret;
 
-    username = clicon_username_get(h);
-    if ((yspec =  clicon_dbspec_yang(h)) == NULL){
-        clixon_err(OE_YANG, ENOENT, "No yang spec9");
-        goto done;
-    }
-    if ((target = netconf_db_find(xn, "target")) == NULL){
-        if (netconf_missing_element(cbret, "protocol", "target", NULL) < 0)
-            goto done;
-        goto ok;
-    }
-    if ((cbx = cbuf_new()) == NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
-    /* Check if target locked by other client */
-    iddb = xmldb_islocked(h, target);
-    if (iddb && myid != iddb){
-        cprintf(cbx, "<session-id>%u</session-id>", iddb);
-        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
-            goto done;
-        goto ok;
-    }
-    if (clicon_option_bool(h, "CLICON_AUTOLOCK")){
-        if ((ret = do_lock(h, cbret, myid, target)) < 0)
-            goto done;
-        if (ret == 0)
-            goto ok;
-    }
-    if (strcmp(target, "candidate") == 0) {
-        /* Add system-only config to candidate cache */
-        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
-            if (system_only_data_add(h, "candidate") < 0)
-                goto done;
-        }
-    }
-    if (xml_nsctx_node(xn, &nsc) < 0)
-        goto done;
-    /* Get prefix of netconf base namespace in the incoming message */
-    if (xml_nsctx_get_prefix(nsc, NETCONF_BASE_NAMESPACE, &prefix) == 0){
-        cprintf(cbx, "No appropriate prefix exists for: %s", NETCONF_BASE_NAMESPACE);
-        if (netconf_unknown_namespace(cbret, "protocol", xml_name(xn), cbuf_get(cbx)) < 0)
-            goto done;
-        goto ok;
-    }
-    /* Get default-operation element */
-    if ((x = xpath_first(xn, nsc, "%s%sdefault-operation", prefix?prefix:"", prefix?":":"")) != NULL){
-        if (xml_operation(xml_body(x), &operation) < 0){
-            if (netconf_invalid_value(cbret, "protocol", "Wrong operation")< 0)
-                goto done;
-            goto ok;
-        }
-    }
-    /* Get config element */
-    if ((xc = xpath_first(xn, nsc, "%s%s%s",
-                          prefix?prefix:"",
-                          prefix?":":"",
-                          NETCONF_INPUT_CONFIG)) == NULL){
-        cprintf(cbx, "Element not found, or mismatching prefix %s for namespace %s",
-                prefix?prefix:"null", NETCONF_BASE_NAMESPACE);
-        if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, cbuf_get(cbx)) < 0)
-            goto done;
-        goto ok;
-    }
     /* <config> yang spec may be set to anyxml by ingress yang check,...*/
     if (xml_spec(xc) != NULL)
         xml_spec_set(xc, NULL);
@@ -631,7 +877,7 @@ from_client_edit_config(clixon_handle h,
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        goto ok;
+        goto fail;
     }
     /* (Mark all nodes that are not configure data and) set return */
     if ((ret = xml_non_config_data(xc, &xret)) < 0)
@@ -639,21 +885,21 @@ from_client_edit_config(clixon_handle h,
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        goto ok;
+        goto fail;
     }
     if (non_config){
         if (netconf_invalid_value(cbret, "protocol", "State data not allowed")< 0)
             goto done;
-        goto ok;
+        goto fail;
     }
     /* Limited validation of incoming payload
      */
-    if ((ret = xml_yang_validate_minmax(xc, 1, &xret)) < 0)
+    if ((ret = xml_yang_validate_minmax(xc, 1, 0, &xret)) < 0)
         goto done;
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        goto ok;
+        goto fail;
     }
     /* Must do before duplicate check,
      * should probably be done before minmax check above */
@@ -671,7 +917,7 @@ from_client_edit_config(clixon_handle h,
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        goto ok;
+        goto fail;
     }
     /* xmldb_put (difflist handling) requires list keys */
     if ((ret = xml_yang_validate_list_key_only(xc, &xret)) < 0)
@@ -679,16 +925,45 @@ from_client_edit_config(clixon_handle h,
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        goto ok;
-    }
-    if ((ret = xmldb_put(h, target, operation, xc, username, cbret)) < 0){
-        if (netconf_operation_failed(cbret, "protocol", clixon_err_reason())< 0)
-            goto done;
-        goto ok;
+        goto fail;
     }
-    if (ret == 0)
-        goto ok;
-    xmldb_modified_set(h, target, 1); /* mark as dirty */
+    retval = 1;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Clixon extensions after a successful edit: autocommit and copy to startup
+ *
+ * Commit candidate if the autocommit attribute of the request is true or if
+ * CLICON_AUTOCOMMIT is set. Copy running to startup if the copystartup attribute is true.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xn      Request: <rpc><xn></rpc>
+ * @param[in]  yspec   Yang spec
+ * @param[in]  myid    Session id of client
+ * @param[out] cbret   Return xml tree, eg <rpc-error.., if retval is 0
+ * @retval     1       OK
+ * @retval     0       Failed, error in cbret
+ * @retval    -1       Error
+ * @see from_client_edit_config
+ * @see from_client_edit_batch
+ */
+static int
+edit_config_post(clixon_handle h,
+                 cxobj        *xn,
+                 yang_stmt    *yspec,
+                 uint32_t      myid,
+                 cbuf         *cbret)
+{
+    int   retval = -1;
+    char *attr;
+    int   autocommit = 0;
+    int   ret;
+
     /* Clixon extension: autocommit */
     if ((attr = xml_find_value(xn, "autocommit")) != NULL &&
         strcmp(attr,"true") == 0)
@@ -715,7 +990,7 @@ from_client_edit_config(clixon_handle h,
             case PERSISTENT:
                 if (netconf_in_use(cbret, "application", "Persistent commit is ongoing")< 0)
                     goto done;
-                goto ok;
+                goto fail;
                 break;
             case EPHEMERAL:
             case ROLLBACK:
@@ -727,15 +1002,15 @@ from_client_edit_config(clixon_handle h,
             if (clixon_plugin_report_err(h, cbret) < 0)
                 goto done;
             xmldb_copy(h, "running", "candidate");
-            goto ok;
+            goto fail;
         }
         if (ret == 0){ /* discard */
             if (xmldb_copy(h, "running", "candidate") < 0){
                 if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                     goto done;
-                goto ok;
+                goto fail;
             }
-            goto ok;
+            goto fail;
         }
     }
     /* Clixon extension: copy */
@@ -744,9 +1019,137 @@ from_client_edit_config(clixon_handle h,
         if (xmldb_copy(h, "running", "startup") < 0){
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                 goto done;
+            goto fail;
+        }
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Loads all or part of a specified configuration to target configuration
+ * 
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xn      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note  According to RFC 7950 8.3: constraints MUST be enforced:
+ * o  during parsing of RPC payloads
+ * o  during processing of the <edit-config> operation
+ * But Clixon is flexible in allowing invalid XML payload here, only some specialized
+ * validations are made.
+ * However, what really should be done is to apply the change to the datastore and then
+ * validate, if error, discard to previous state. 
+ * But this could discard other previous changes to candidate.
+ */
+static int
+from_client_edit_config(clixon_handle h,
+                        cxobj        *xn,
+                        cbuf         *cbret,
+                        void         *arg,
+                        void         *regarg)
+{
+    int                 retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t            myid = ce->ce_id;
+    uint32_t            iddb;
+    char               *target;
+    cxobj              *xc;
+    cxobj              *x;
+    enum operation_type operation = OP_MERGE;
+    yang_stmt          *yspec;
+    cbuf               *cbx = NULL; /* Assist cbuf */
+    int                 ret;
+    char               *username;
+    char               *val = NULL;
+    cvec               *nsc = NULL;
+    char               *prefix = NULL;
+
+    username = clicon_username_get(h);
+    if ((yspec =  clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec9");
+        goto done;
+    }
+    if ((target = netconf_db_find(xn, "target")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "target", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((cbx = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, target);
+    if (iddb && myid != iddb){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if (clicon_option_bool(h, "CLICON_AUTOLOCK")){
+        if ((ret = do_lock(h, cbret, myid, target)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if (strcmp(target, "candidate") == 0) {
+        /* Add system-only config to candidate cache */
+        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+            if (system_only_data_add(h, "candidate") < 0)
+                goto done;
+        }
+    }
+    if (xml_nsctx_node(xn, &nsc) < 0)
+        goto done;
+    /* Get prefix of netconf base namespace in the incoming message */
+    if (xml_nsctx_get_prefix(nsc, NETCONF_BASE_NAMESPACE, &prefix) == 0){
+        cprintf(cbx, "No appropriate prefix exists for: %s", NETCONF_BASE_NAMESPACE);
+        if (netconf_unknown_namespace(cbret, "protocol", xml_name(xn), cbuf_get(cbx)) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Get default-operation element */
+    if ((x = xpath_first(xn, nsc, "%s%sdefault-operation", prefix?prefix:"", prefix?":":"")) != NULL){
+        if (xml_operation(xml_body(x), &operation) < 0){
+            if (netconf_invalid_value(cbret, "protocol", "Wrong operation")< 0)
+                goto done;
             goto ok;
         }
     }
+    /* Get config element */
+    if ((xc = xpath_first(xn, nsc, "%s%s%s",
+                          prefix?prefix:"",
+                          prefix?":":"",
+                          NETCONF_INPUT_CONFIG)) == NULL){
+        cprintf(cbx, "Element not found, or mismatching prefix %s for namespace %s",
+                prefix?prefix:"null", NETCONF_BASE_NAMESPACE);
+        if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, cbuf_get(cbx)) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = edit_config_check(h, xc, yspec, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    if ((ret = xmldb_put(h, target, operation, xc, username, cbret)) < 0){
+        if (netconf_operation_failed(cbret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 0)
+        goto ok;
+    xmldb_modified_set(h, target, 1); /* mark as dirty */
+    if ((ret = edit_config_post(h, xn, yspec, myid, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
     if (cbuf_len(cbret) != 0){
         clixon_err(OE_NETCONF, EINVAL, "Internal error: cbret is not empty");
         goto done;
@@ -763,14 +1166,151 @@ from_client_edit_config(clixon_handle h,
  done:
     if (nsc)
         cvec_free(nsc);
-    if (xret)
-        xml_free(xret);
     if (cbx)
         cbuf_free(cbx);
     clixon_debug(CLIXON_DBG_BACKEND, "done cbret:%s", cbuf_get(cbret));
     return retval;
 } /* from_client_edit_config */
 
+/*! Apply an ordered batch of edits to the candidate datastore, all or nothing
+ *
+ * Clixon extension for bulk edits: one validation of payload per edit, but pruning,
+ * defaults and writing of the datastore are made once per batch.
+ * default-operation and the autocommit and copystartup attributes are as in edit-config.
+ * test-option is only supported with value set, since edits are validated at commit.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xe></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_edit_config
+ * @see xmldb_put_batch
+ */
+static int
+from_client_edit_batch(clixon_handle h,
+                       cxobj        *xe,
+                       cbuf         *cbret,
+                       void         *arg,
+                       void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t             myid = ce->ce_id;
+    uint32_t             iddb;
+    char                *target = "candidate";
+    yang_stmt           *yspec;
+    cbuf                *cbx = NULL;
+    cxobj               *xedit;
+    cxobj               *xc;
+    char                *opstr;
+    enum operation_type  defop = OP_MERGE;
+    enum operation_type *opvec = NULL;
+    cxobj              **xvec = NULL;
+    int                  n;
+    int                  failed = 0;
+    int                  ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cbx = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, target);
+    if (iddb && myid != iddb){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if (clicon_option_bool(h, "CLICON_AUTOLOCK")){
+        if ((ret = do_lock(h, cbret, myid, target)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    /* Edits are not validated until commit, as in edit-config */
+    if ((opstr = xml_find_body(xe, "test-option")) != NULL &&
+        strcmp(opstr, "set") != 0){
+        if (netconf_operation_not_supported(cbret, "protocol", "Only test-option set is supported") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((opstr = xml_find_body(xe, "default-operation")) != NULL &&
+        xml_operation(opstr, &defop) < 0){
+        if (netconf_invalid_value(cbret, "protocol", "Wrong operation")< 0)
+            goto done;
+        goto ok;
+    }
+    /* Add system-only config to candidate cache */
+    if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+        if (system_only_data_add(h, target) < 0)
+            goto done;
+    }
+    n = xml_child_nr_type(xe, CX_ELMNT);
+    if ((opvec = calloc(n+1, sizeof(*opvec))) == NULL ||
+        (xvec = calloc(n+1, sizeof(*xvec))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    n = 0;
+    xedit = NULL;
+    while ((xedit = xml_child_each(xe, xedit, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xedit), "edit") != 0)
+            continue;
+        opvec[n] = defop;
+        if ((opstr = xml_find_body(xedit, "operation")) != NULL &&
+            xml_operation(opstr, &opvec[n]) < 0){
+            if (netconf_invalid_value(cbret, "protocol", "Wrong operation")< 0)
+                goto done;
+            goto ok;
+        }
+        if ((xc = xml_find_type(xedit, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+            if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, NULL) < 0)
+                goto done;
+            goto ok;
+        }
+        if ((ret = edit_config_check(h, xc, yspec, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        xvec[n++] = xc;
+    }
+    if (n == 0)
+        goto reply;
+    if ((ret = xmldb_put_batch(h, target, opvec, xvec, n, clicon_username_get(h), cbret, &failed)) < 0){
+        if (netconf_operation_failed(cbret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 0){
+        clixon_debug(CLIXON_DBG_BACKEND, "edit %d of %d failed", failed, n);
+        goto ok;
+    }
+    xmldb_modified_set(h, target, 1); /* mark as dirty */
+    if ((ret = edit_config_post(h, xe, yspec, myid, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+ reply:
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    if (opvec)
+        free(opvec);
+    if (xvec)
+        free(xvec);
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
 /*! Create or replace an entire config with another complete config db
  *
  * @param[in]  h       Clixon handle
@@ -1458,6 +1998,10 @@ from_client_stats(clixon_handle h,
 {
     int        retval = -1;
     uint64_t   nr;
+    uint64_t   entries;
+    uint64_t   hits;
+    uint64_t   misses;
+    uint64_t   expired;
     char      *str;
     int        modules = 0;
     yang_stmt *yspec0;
@@ -1483,6 +2027,15 @@ from_client_stats(clixon_handle h,
     yang_stats_global(&nr);
     cprintf(cbret, "<yangnr>%" PRIu64 "</yangnr>", nr);
     cprintf(cbret, "</global>");
+    if (clicon_option_int(h, "CLICON_BACKEND_STATEDATA_CACHE_TTL") > 0){
+        clixon_plugin_statedata_cache_stats(h, &entries, &hits, &misses, &expired);
+        cprintf(cbret, "<statedata-cache xmlns=\"%s\">", CLIXON_LIB_NS);
+        cprintf(cbret, "<entries>%" PRIu64 "</entries>", entries);
+        cprintf(cbret, "<hits>%" PRIu64 "</hits>", hits);
+        cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+        cprintf(cbret, "<expired>%" PRIu64 "</expired>", expired);
+        cprintf(cbret, "</statedata-cache>");
+    }
     cprintf(cbret, "<datastores xmlns=\"%s\">", CLIXON_LIB_NS);
     if (clixon_stats_datastore_get(h, "running", cbret) < 0)
         goto done;
@@ -1507,6 +2060,8 @@ from_client_stats(clixon_handle h,
             cprintf(cbret, "<name>%s/%s</name>", domain, yang_argument_get(yspec));
             if (clixon_stats_yang_get(h, yspec, cbret) < 0)
                 goto done;
+            if (yang_flag_get(yspec, YANG_FLAG_SPEC_MOUNT))
+                cprintf(cbret, "<mounts>%d</mounts>", yang_schema_mount_refs(yspec));
             if (modules){
                 inext3 = 0;
                 while ((ymodule = yn_iter(yspec, &inext3)) != NULL) {
@@ -1662,11 +2217,176 @@ from_client_hello(clixon_handle  h,
     return retval;
 }
 
+/*! Check if an RPC may be executed by a worker process
+ *
+ * Only read-only RPCs whose result does not depend on backend plugins are executed by
+ * workers, since state changes made by a worker are lost when it exits.
+ * A get is eligible only if no backend plugin provides state data.
+ * @param[in]  h       Clixon handle
+ * @param[in]  module  YANG module name of RPC
+ * @param[in]  rpc     RPC name
+ * @retval     1       Eligible and a worker is available
+ * @retval     0       Not eligible, or all workers busy
+ * @see CLICON_BACKEND_RPC_WORKERS
+ */
+static int
+rpc_worker_eligible(clixon_handle h,
+                    char         *module,
+                    char         *rpc)
+{
+    clixon_plugin_t *cp = NULL;
+
+    if (_rpc_workers_nr >= clicon_option_int(h, "CLICON_BACKEND_RPC_WORKERS"))
+        return 0;
+    if (strcmp(module, "ietf-netconf") == 0){
+        if (strcmp(rpc, "get-config") == 0)
+            return 1;
+        if (strcmp(rpc, "get") == 0){
+            while ((cp = clixon_plugin_each(h, cp)) != NULL)
+                if (clixon_plugin_api_get(cp)->ca_statedata != NULL)
+                    return 0;
+            return 1;
+        }
+    }
+    else if (strcmp(module, "ietf-netconf-monitoring") == 0){
+        if (strcmp(rpc, "get-schema") == 0)
+            return 1;
+    }
+    else if (strcmp(module, "clixon-lib") == 0){
+        if (strcmp(rpc, "stats") == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/*! Fork a worker process to execute an RPC of a client
+ *
+ * The worker reads a copy-on-write snapshot of the backend, ie datastores and caches,
+ * as of the fork. Processes are used instead of threads since the backend is not
+ * thread-safe, eg error state, XML and datastore caches.
+ * The worker continues executing the RPC in from_client_msg and writes the reply to a
+ * pipe, see rpc_worker_exit. The backend reads the reply in rpc_worker_cb and sends it
+ * to the client. Input from the client is not dispatched until then, so that replies
+ * are sent in the order of the requests.
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * @param[out] wfd  Write end of reply pipe, set in worker process only
+ * @retval     1    Backend process: reply deferred to worker
+ * @retval     0    Worker process: execute RPC and reply to wfd
+ * @retval    -1    Error
+ */
+static int
+rpc_worker_start(clixon_handle        h,
+                 struct client_entry *ce,
+                 int                 *wfd)
+{
+    int                  retval = -1;
+    struct rpc_worker   *rw = NULL;
+    struct rpc_worker   *rw1;
+    struct client_entry *c;
+    int                  fd[2];
+    pid_t                pid;
+    int                  ss;
+
+    if ((rw = malloc(sizeof(*rw))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(rw, 0, sizeof(*rw));
+    rw->rw_fd = -1;
+    if ((rw->rw_cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (pipe(fd) < 0){
+        clixon_err(OE_UNIX, errno, "pipe");
+        goto done;
+    }
+    if ((pid = fork()) < 0){
+        clixon_err(OE_UNIX, errno, "fork");
+        close(fd[0]);
+        close(fd[1]);
+        goto done;
+    }
+    if (pid == 0){ /* Worker */
+        close(fd[0]);
+        /* Close inherited server and client sockets, and reply pipes of other workers,
+         * so that a client sees end-of-file when the backend closes its socket, also
+         * if the worker is still running */
+        if ((ss = clicon_socket_get(h)) != -1)
+            close(ss);
+        for (c = backend_client_list(h); c; c = c->ce_next)
+            if (c->ce_s)
+                close(c->ce_s);
+        if ((rw1 = _rpc_workers) != NULL)
+            do {
+                close(rw1->rw_fd);
+                rw1 = NEXTQ(struct rpc_worker *, rw1);
+            } while (rw1 != _rpc_workers);
+        *wfd = fd[1];
+        retval = 0;
+        goto done;
+    }
+    close(fd[1]);
+    rw->rw_pid = pid;
+    rw->rw_fd = fd[0];
+    rw->rw_ce = ce;
+    if (clixon_event_reg_fd(rw->rw_fd, rpc_worker_cb, rw, "backend rpc worker") < 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_BACKEND, "client %d rpc worker pid:%d", ce->ce_nr, pid);
+    ce->ce_worker = rw;
+    ADDQ(rw, _rpc_workers);
+    rw = NULL;
+    _rpc_workers_nr++;
+    retval = 1;
+ done:
+    if (rw){
+        if (rw->rw_fd != -1)
+            close(rw->rw_fd);
+        if (rw->rw_cb)
+            cbuf_free(rw->rw_cb);
+        free(rw);
+    }
+    return retval;
+}
+
+/*! Write reply of RPC to backend and terminate worker process
+ *
+ * @param[in]  fd   Write end of reply pipe
+ * @param[in]  cb   Reply, or NULL on error
+ * @note Does not return
+ * @see rpc_worker_start
+ */
+static void
+rpc_worker_exit(int   fd,
+                cbuf *cb)
+{
+    char   *p;
+    size_t  len;
+    ssize_t n;
+
+    if (cb == NULL)
+        _exit(1);
+    p = cbuf_get(cb);
+    len = cbuf_len(cb);
+    while (len > 0){
+        if ((n = write(fd, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        p += n;
+        len -= n;
+    }
+    _exit(0);
+}
+
 /*! An internal clixon NETCONF message has arrived from a local client. Receive and dispatch.
  *
  * @param[in]   h    Clixon handle
  * @param[in]   ce   Client entry (from)
  * @param[in]   msg  Incoming message
+ * @retval      1    OK, reply deferred to worker process, see rpc_worker_start
  * @retval      0    OK
  * @retval     -1    Error Terminates backend and is never called). Instead errors are
  *                   propagated back to client.
@@ -1695,7 +2415,7 @@ from_client_msg(clixon_handle        h,
     char                *rpcprefix;
     char                *namespace = NULL;
     int                  nr = 0;
-    cbuf                *cbce = NULL;
+    int                  wfd = -1; /* Set in worker process */
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     yspec = clicon_dbspec_yang(h);
@@ -1889,6 +2609,17 @@ from_client_msg(clixon_handle        h,
                 goto reply;
             }
         }
+        /* Execute read-only RPC in worker process, only single RPCs since a reply is
+         * made per message */
+        if (wfd == -1 && xml_child_nr_type(x, CX_ELMNT) == 1 &&
+            rpc_worker_eligible(h, module, rpc)){
+            if ((ret = rpc_worker_start(h, ce, &wfd)) < 0)
+                goto done;
+            if (ret == 1){
+                retval = 1;
+                goto done;
+            }
+        }
         clixon_err_reset();
         if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
@@ -1925,25 +2656,14 @@ from_client_msg(clixon_handle        h,
     // XXX    clixon_debug(CLIXON_DBG_MSG, "Reply:%s", cbuf_get(cbret));
     /* XXX problem here is that cbret has not been parsed so may contain 
        parse errors */
-    if (ce_client_descr(ce, &cbce) < 0)
+    if (wfd != -1)
+        rpc_worker_exit(wfd, cbret);
+    /* Hand over reply to output queue of client, a closed client socket, eg a cli,
+     * netconf or restconf client exiting, is not an error */
+    ret = ce_output_send(h, ce, cbret, 0);
+    cbret = NULL;
+    if (ret < 0)
         goto done;
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
-        switch (errno){
-        case EPIPE:
-            /* man (2) write: 
-             * EPIPE  fd is connected to a pipe or socket whose reading end is 
-             * closed.  When this happens the writing process will also receive 
-             * a SIGPIPE signal. 
-             * In Clixon this means a client, eg restconf, netconf or cli closes
-             * the (UNIX domain) socket.
-             */
-        case ECONNRESET:
-            clixon_log(h, LOG_WARNING, "client rpc reset");
-            break;
-        default:
-            goto done;
-        }
-    }
     // ok:
     retval = 0;
   done:
@@ -1957,21 +2677,563 @@ from_client_msg(clixon_handle        h,
         xml_free(xret);
     if (xt)
         xml_free(xt);
-    if (cbce)
-        cbuf_free(cbce);
     if (cbret)
         cbuf_free(cbret);
     /* Sanity: log if clixon_err() is not called ! */
     if (retval < 0 && clixon_err_category() < 0)
         clixon_log(h, LOG_NOTICE, "%s: Internal error: No clixon_err call on RPC error (message: %s)",
                    __func__, rpc?rpc:"");
+    if (wfd != -1) /* Error in worker process */
+        rpc_worker_exit(wfd, NULL);
     //    clixon_debug(CLIXON_DBG_BACKEND, "retval:%d", retval);
     return retval;// -1 here terminates backend
 }
 
+/*! Read scheduling classes from CLICON_BACKEND_SCHED_CLASS
+ *
+ * Each option value is "<name>:<weight>". A default class with weight 1 is first
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+sched_class_init(clixon_handle h)
+{
+    int                 retval = -1;
+    struct sched_class *sc;
+    cxobj              *x = NULL;
+    char               *str;
+    char               *p;
+    char               *reason = NULL;
+    uint32_t            weight;
+    int                 ret;
+
+    if ((sc = calloc(1, sizeof(*sc))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((sc->sc_name = strdup("default")) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        free(sc);
+        goto done;
+    }
+    sc->sc_weight = 1;
+    ADDQ(sc, _sched_classes);
+    _sched_weight_max = 1;
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "CLICON_BACKEND_SCHED_CLASS") != 0)
+            continue;
+        if ((str = xml_body(x)) == NULL ||
+            (p = strrchr(str, ':')) == NULL)
+            continue;
+        if ((ret = parse_uint32(p+1, &weight, &reason)) < 0){
+            clixon_err(OE_UNIX, errno, "parse_uint32");
+            goto done;
+        }
+        if (ret == 0 || weight == 0){
+            clixon_log(h, LOG_WARNING, "CLICON_BACKEND_SCHED_CLASS %s: invalid weight", str);
+            if (reason){
+                free(reason);
+                reason = NULL;
+            }
+            continue;
+        }
+        if ((sc = calloc(1, sizeof(*sc))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((sc->sc_name = strndup(str, p-str)) == NULL){
+            clixon_err(OE_UNIX, errno, "strndup");
+            free(sc);
+            goto done;
+        }
+        sc->sc_weight = weight;
+        ADDQ(sc, _sched_classes);
+        if (weight > _sched_weight_max)
+            _sched_weight_max = weight;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Get scheduling class of a client
+ *
+ * The class is the one named as the username of the client, otherwise as its
+ * transport (without prefix, eg "cli"), otherwise the default class
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     sc  Scheduling class
+ * @retval     NULL Error
+ */
+static struct sched_class *
+sched_class_get(clixon_handle        h,
+                struct client_entry *ce)
+{
+    struct sched_class *sc;
+    char               *transport = NULL;
+    char               *p;
+
+    if (_sched_classes == NULL &&
+        sched_class_init(h) < 0)
+        return NULL;
+    if (ce->ce_username){
+        sc = NEXTQ(struct sched_class *, _sched_classes);
+        while (sc != _sched_classes){
+            if (strcmp(sc->sc_name, ce->ce_username) == 0)
+                return sc;
+            sc = NEXTQ(struct sched_class *, sc);
+        }
+    }
+    if ((transport = ce->ce_transport) != NULL){
+        if ((p = strchr(transport, ':')) != NULL)
+            transport = p+1;
+        sc = NEXTQ(struct sched_class *, _sched_classes);
+        while (sc != _sched_classes){
+            if (strcmp(sc->sc_name, transport) == 0)
+                return sc;
+            sc = NEXTQ(struct sched_class *, sc);
+        }
+    }
+    return _sched_classes;
+}
+
+/*! Reply to a RPC denied by admission control
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see sched_enqueue
+ */
+static int
+sched_deny(clixon_handle        h,
+           struct client_entry *ce)
+{
+    cbuf *cb;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        return -1;
+    }
+    if (netconf_resource_denied(cb, "application", "Backend overloaded, RPC not admitted") < 0){
+        cbuf_free(cb);
+        return -1;
+    }
+    ce->ce_out_rpc_errors++;
+    netconf_monitoring_counter_inc(h, "out-rpc-errors");
+    return ce_output_send(h, ce, cb, 0);
+}
+
+/*! Queue a complete message of a client until it is scheduled
+ *
+ * The message buffer of the client is handed over to the queue.
+ * If the number of pending RPCs of all clients is above CLICON_BACKEND_SCHED_ADMIT_MAX,
+ * scaled by the weight of the class of the client, the RPC is denied and replied to
+ * with resource-denied at once. If replies to earlier RPCs of the client are pending,
+ * the denial is queued to be replied to in order, but it is not a pending RPC, ie it
+ * is not counted in the queue length of the client or in the scheduler depth.
+ * If the queue of the client is full, input from the client is suspended.
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see sched_run
+ */
+static int
+sched_enqueue(clixon_handle        h,
+              struct client_entry *ce)
+{
+    int                 retval = -1;
+    struct ce_rpc      *cr = NULL;
+    struct sched_class *sc;
+    int                 admit_max;
+    int                 limit;
+    int                 qmax;
+
+    /* Class may change, eg transport set by hello, but not of pending RPCs */
+    if (ce->ce_rpcq == NULL || ce->ce_class == NULL){
+        if ((ce->ce_class = sched_class_get(h, ce)) == NULL)
+            goto done;
+    }
+    sc = ce->ce_class;
+    if ((cr = calloc(1, sizeof(*cr))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    gettimeofday(&cr->cr_time, NULL);
+    if ((admit_max = clicon_option_int(h, "CLICON_BACKEND_SCHED_ADMIT_MAX")) > 0){
+        limit = (int)(((uint64_t)admit_max * sc->sc_weight) / _sched_weight_max);
+        if (limit < 1)
+            limit = 1;
+    }
+    else
+        limit = 0;
+    if (limit && _sched_depth >= limit){
+        sc->sc_denied++;
+        cbuf_reset(ce->ce_rcvbuf);
+        if (ce->ce_rpcq == NULL && ce->ce_worker == NULL){ /* No earlier reply pending */
+            free(cr);
+            if (sched_deny(h, ce) < 0)
+                goto done;
+        }
+        else
+            ADDQ(cr, ce->ce_rpcq);
+        goto ok;
+    }
+    cr->cr_cb = ce->ce_rcvbuf;
+    if ((ce->ce_rcvbuf = cbuf_new()) == NULL){
+        ce->ce_rcvbuf = cr->cr_cb;
+        free(cr);
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    ADDQ(cr, ce->ce_rpcq);
+    ce->ce_rpcq_nr++;
+    sc->sc_depth++;
+    _sched_depth++;
+    qmax = clicon_option_int(h, "CLICON_BACKEND_SCHED_QUEUE_MAX");
+    if (!ce->ce_suspended && qmax > 0 && ce->ce_rpcq_nr >= qmax){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d queue full, suspend input", ce->ce_nr);
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        ce->ce_suspended = 1;
+    }
+    if (sched_kick(h) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove pending RPCs of a client
+ *
+ * @param[in]  ce  Client entry
+ * @retval     0   OK
+ */
+static int
+sched_client_rm(struct client_entry *ce)
+{
+    struct ce_rpc *cr;
+
+    while ((cr = ce->ce_rpcq) != NULL){
+        DELQ(cr, ce->ce_rpcq, struct ce_rpc *);
+        if (cr->cr_cb){ /* Denied RPCs are not counted */
+            cbuf_free(cr->cr_cb);
+            if (ce->ce_class)
+                ce->ce_class->sc_depth--;
+            _sched_depth--;
+        }
+        free(cr);
+    }
+    ce->ce_rpcq_nr = 0;
+    return 0;
+}
+
+/*! Check if client is still in client list, it may be removed by an RPC
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     1   Client exists
+ * @retval     0   Client is removed
+ */
+static int
+sched_client_exists(clixon_handle        h,
+                    struct client_entry *ce)
+{
+    struct client_entry *c;
+
+    for (c = backend_client_list(h); c; c = c->ce_next)
+        if (c == ce)
+            return 1;
+    return 0;
+}
+
+/*! Schedule pending RPCs of one client in a scheduling round
+ *
+ * The client may run RPCs up to its deficit, which is increased with the weight of
+ * its class times CLICON_BACKEND_SCHED_QUANTUM every round
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+sched_client_run(clixon_handle        h,
+                 struct client_entry *ce)
+{
+    int                 retval = -1;
+    struct ce_rpc      *cr = NULL;
+    struct sched_class *sc = ce->ce_class;
+    struct timeval      now;
+    struct timeval      td;
+    uint64_t            wait;
+    int                 qmax;
+    int                 ret;
+
+    ce->ce_deficit += sc->sc_weight * clicon_option_int(h, "CLICON_BACKEND_SCHED_QUANTUM");
+    while ((cr = ce->ce_rpcq) != NULL && (cr->cr_cb == NULL || ce->ce_deficit > 0)){
+        DELQ(cr, ce->ce_rpcq, struct ce_rpc *);
+        if (cr->cr_cb == NULL){ /* Denied after earlier RPCs, reply in order */
+            free(cr);
+            cr = NULL;
+            if (sched_deny(h, ce) < 0)
+                goto done;
+            if (!sched_client_exists(h, ce))
+                goto ok;
+            continue;
+        }
+        ce->ce_rpcq_nr--;
+        sc->sc_depth--;
+        _sched_depth--;
+        ce->ce_deficit--;
+        gettimeofday(&now, NULL);
+        timersub(&now, &cr->cr_time, &td);
+        wait = td.tv_sec*1000000 + td.tv_usec;
+        sc->sc_rpcs++;
+        sc->sc_wait += wait;
+        if (wait > sc->sc_wait_max)
+            sc->sc_wait_max = wait;
+        if ((ret = from_client_msg(h, ce, cbuf_get(cr->cr_cb))) < 0)
+            goto done;
+        cbuf_free(cr->cr_cb);
+        free(cr);
+        cr = NULL;
+        /* Client may have been removed by the rpc, eg kill-session */
+        if (!sched_client_exists(h, ce))
+            goto ok;
+        if (ret == 1) /* Executed by worker, wait for reply */
+            break;
+    }
+    if (ce->ce_rpcq == NULL)
+        ce->ce_deficit = 0;
+    /* Resume input if queue not full */
+    qmax = clicon_option_int(h, "CLICON_BACKEND_SCHED_QUEUE_MAX");
+    if (ce->ce_suspended && (qmax <= 0 || ce->ce_rpcq_nr < qmax)){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d resume input", ce->ce_nr);
+        ce->ce_suspended = 0;
+        if (ce_input_resume(h, ce) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cr){
+        if (cr->cr_cb)
+            cbuf_free(cr->cr_cb);
+        free(cr);
+    }
+    return retval;
+}
+
+/*! Scheduling round: run pending RPCs of all clients by weighted fair queueing
+ *
+ * Called by the event loop after file events, ie after input from all clients has
+ * been read. Each client with pending RPCs, and not waiting for a RPC worker, runs
+ * RPCs up to its budget, see sched_client_run. Then, if RPCs are still pending, a new
+ * round is scheduled.
+ * @param[in]  fd   Not used
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+sched_run(int   fd,
+          void *arg)
+{
+    int                   retval = -1;
+    clixon_handle         h = (clixon_handle)arg;
+    struct client_entry  *ce;
+    struct client_entry **cevec = NULL;
+    int                   len = 0;
+    int                   i;
+
+    _sched_reg = 0;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        len++;
+    if ((cevec = calloc(len+1, sizeof(*cevec))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    len = 0;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        if (ce->ce_rpcq != NULL && ce->ce_worker == NULL)
+            cevec[len++] = ce;
+    for (i=0; i<len; i++){
+        ce = cevec[i];
+        /* Client may have been removed by a rpc of other client, eg kill-session */
+        if (!sched_client_exists(h, ce) || ce->ce_worker != NULL)
+            continue;
+        if (sched_client_run(h, ce) < 0)
+            goto done;
+    }
+    if (sched_kick(h) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cevec)
+        free(cevec);
+    return retval;
+}
+
+/*! Register a scheduling round if a client can run RPCs and not already registered
+ *
+ * A client waiting for a RPC worker can not run, a new round is registered when the
+ * worker is done, see rpc_worker_cb
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+sched_kick(clixon_handle h)
+{
+    struct client_entry *ce;
+
+    if (_sched_reg)
+        return 0;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        if (ce->ce_rpcq != NULL && ce->ce_worker == NULL)
+            break;
+    if (ce == NULL)
+        return 0;
+    if (clixon_event_reg_defer(sched_run, h, "backend rpc scheduler") < 0)
+        return -1;
+    _sched_reg = 1;
+    return 0;
+}
+
+/*! Free scheduling classes
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+backend_sched_exit(clixon_handle h)
+{
+    struct sched_class *sc;
+
+    if (_sched_reg){
+        clixon_event_unreg_defer(sched_run, h);
+        _sched_reg = 0;
+    }
+    while ((sc = _sched_classes) != NULL){
+        DELQ(sc, _sched_classes, struct sched_class *);
+        if (sc->sc_name)
+            free(sc->sc_name);
+        free(sc);
+    }
+    _sched_depth = 0;
+    return 0;
+}
+
+/*! Dispatch complete messages of input received from a client
+ *
+ * A partially received message and its framing state are kept in the client entry.
+ * If a message is executed by a worker process, the rest of the input is kept in the
+ * client entry and input from the client is suspended until the worker is done.
+ * @param[in]   h     Clixon handle
+ * @param[in]   ce    Client entry (from)
+ * @param[in]   p     Input
+ * @param[in]   plen  Length of input
+ * @param[in]   eof   Client socket closed
+ * @retval      1     OK, client removed
+ * @retval      0     OK
+ * @retval     -1     Error
+ * @see rpc_worker_cb  where suspended input is resumed
+ */
+static int
+from_client_input(clixon_handle        h,
+                  struct client_entry *ce,
+                  unsigned char       *p,
+                  size_t               plen,
+                  int                  eof)
+{
+    int                  retval = -1;
+    cbuf                *cbce = NULL;
+    int                  eom = 0;
+    int                  ret;
+    struct client_entry *c;
+    int                  sched;
+
+    if (ce_client_descr(ce, &cbce) < 0)
+        goto done;
+    sched = clicon_option_int(h, "CLICON_BACKEND_SCHED_QUANTUM") > 0;
+    while (!eof && plen > 0){
+        if (netconf_input_msg2(&p, &plen,
+                               ce->ce_rcvbuf,
+                               NETCONF_SSH_CHUNKED,
+                               &ce->ce_frame_state,
+                               &ce->ce_frame_size,
+                               &eom) < 0){
+            /* Errors from input are only framing errors, non-fatal, close client */
+            eof = 1;
+            break;
+        }
+        if (eom == 0) /* Wait for rest of message */
+            break;
+        if (clixon_debug_detail())
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Recv [%s]: %s",
+                         cbuf_get(cbce), cbuf_get(ce->ce_rcvbuf));
+        else
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Recv [%s]: %s",
+                         cbuf_get(cbce), cbuf_get(ce->ce_rcvbuf));
+        if (sched){ /* Queue until scheduled, see sched_run */
+            if (sched_enqueue(h, ce) < 0)
+                goto done;
+            continue;
+        }
+        if ((ret = from_client_msg(h, ce, cbuf_get(ce->ce_rcvbuf))) < 0)
+            goto done;
+        /* Client may have been removed by the rpc, eg kill-session */
+        for (c = backend_client_list(h); c; c = c->ce_next)
+            if (c == ce)
+                break;
+        if (c == NULL){
+            retval = 1;
+            goto done;
+        }
+        cbuf_reset(ce->ce_rcvbuf);
+        /* Executed by worker, suspend input until reply, or output above high-water mark */
+        if (ret == 1 || ce->ce_outsusp){
+            if (plen > 0){
+                if (ce->ce_rcvpend == NULL &&
+                    (ce->ce_rcvpend = cbuf_new()) == NULL){
+                    clixon_err(OE_UNIX, errno, "cbuf_new");
+                    goto done;
+                }
+                if (cbuf_append_buf(ce->ce_rcvpend, p, plen) < 0){
+                    clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                    goto done;
+                }
+            }
+            clixon_event_unreg_fd(ce->ce_s, from_client);
+            break;
+        }
+    }
+    if (eof){
+        clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: EOF", cbuf_get(cbce));
+        backend_client_rm(h, ce);
+        netconf_monitoring_counter_inc(h, "dropped-sessions");
+        retval = 1;
+        goto done;
+    }
+    retval = 0;
+  done:
+    if (cbce)
+        cbuf_free(cbce);
+    return retval;
+}
+
 /*! Internal clixon message has arrived from a client. Receive and dispatch.
  *
  * Internal clixon is NETCONF 1.1 chunked encoding
+ * Reads what is available on the socket once, and never waits for the rest of a
+ * message. A partially received message and its framing state are kept in the
+ * client entry until the next call, so that a slow client, or a client sending a
+ * large message, does not block other clients.
+ * Each complete message is dispatched with from_client_msg.
  * @param[in]   s    Socket where message arrived. read from this.
  * @param[in]   arg  Client entry (from).
  * @retval      0    OK
@@ -1986,34 +3248,113 @@ from_client(int   s,
     struct client_entry *ce = (struct client_entry *)arg;
     clixon_handle        h = ce->ce_handle;
     int                  eof = 0;
-    cbuf                *cbce = NULL;
-    cbuf                *cb = NULL;
+    unsigned char        buf[FROM_CLIENT_BUFSIZ];
+    ssize_t              len;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     if (s != ce->ce_s){
         clixon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
-    if (ce_client_descr(ce, &cbce) < 0)
-        goto done;
-    if (clixon_msg_rcv11(s, cbuf_get(cbce), 0, &cb, &eof) < 0) /* XXX why not descr here? */
+    if (ce->ce_rcvbuf == NULL &&
+        (ce->ce_rcvbuf = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    if (eof){
-        backend_client_rm(h, ce);
-        netconf_monitoring_counter_inc(h, "dropped-sessions");
     }
-    else if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
+    if ((len = netconf_input_read2(s, buf, sizeof(buf), &eof)) < 0)
+        goto done;
+    if (from_client_input(h, ce, buf, len, eof) < 0)
         goto done;
     retval = 0;
   done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
-    if (cb)
-        cbuf_free(cb);
-    if (cbce)
-        cbuf_free(cbce);
     return retval; /* -1 here terminates backend */
 }
 
+/*! Reply from RPC worker process
+ *
+ * Reads reply from worker process until end-of-file, then sends the reply to the
+ * client and resumes input from the client, first the input received while the
+ * worker was busy.
+ * If the worker failed, an operation-failed error is sent instead.
+ * @param[in]  s    Read end of reply pipe
+ * @param[in]  arg  RPC worker
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see rpc_worker_start
+ */
+static int
+rpc_worker_cb(int   s,
+              void *arg)
+{
+    int                  retval = -1;
+    struct rpc_worker   *rw = (struct rpc_worker *)arg;
+    struct client_entry *ce;
+    clixon_handle        h;
+    char                 buf[BUFSIZ];
+    ssize_t              len;
+    int                  status = 0;
+    int                  ret;
+
+    if ((len = read(s, buf, sizeof(buf))) < 0){
+        if (errno == EINTR)
+            return 0;
+        clixon_debug(CLIXON_DBG_BACKEND, "rpc worker pid:%d read: %s", rw->rw_pid, strerror(errno));
+        cbuf_reset(rw->rw_cb); /* Handle as failed worker */
+        len = 0;
+    }
+    else if (len > 0){
+        if (cbuf_append_buf(rw->rw_cb, buf, len) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        return 0;
+    }
+    /* End-of-file: worker is done */
+    clixon_event_unreg_fd(s, rpc_worker_cb);
+    close(s);
+    waitpid(rw->rw_pid, &status, 0);
+    DELQ(rw, _rpc_workers, struct rpc_worker *);
+    _rpc_workers_nr--;
+    if ((ce = rw->rw_ce) == NULL){ /* Client removed, discard reply */
+        retval = 0;
+        goto done;
+    }
+    h = ce->ce_handle;
+    ce->ce_worker = NULL;
+    clixon_debug(CLIXON_DBG_BACKEND, "client %d rpc worker pid:%d status:%d",
+                 ce->ce_nr, rw->rw_pid, status);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || cbuf_len(rw->rw_cb) == 0){
+        cbuf_reset(rw->rw_cb);
+        if (netconf_operation_failed(rw->rw_cb, "application", "Backend RPC worker failed") < 0)
+            goto done;
+    }
+    /* Counters of worker process are lost */
+    if (strstr(cbuf_get(rw->rw_cb), "<rpc-error") != NULL){
+        ce->ce_out_rpc_errors++;
+        netconf_monitoring_counter_inc(h, "out-rpc-errors");
+    }
+    ret = ce_output_send(h, ce, rw->rw_cb, 0);
+    rw->rw_cb = NULL;
+    if (ret < 0)
+        goto done;
+    if (clicon_option_int(h, "CLICON_BACKEND_SCHED_QUANTUM") > 0){
+        /* Input is not suspended by worker if scheduled, continue with pending RPCs */
+        if (sched_kick(h) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    if (ce_input_resume(h, ce) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (rw->rw_cb)
+        cbuf_free(rw->rw_cb);
+    free(rw);
+    return retval;
+}
+
 /*! Init backend rpc: Set up standard netconf rpc callbacks
  *
  * @param[in]  h     Clixon handle
@@ -2100,6 +3441,9 @@ backend_rpc_init(clixon_handle h)
     if (rpc_callback_register(h, from_client_process_control, NULL,
                               CLIXON_LIB_NS, "process-control") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_edit_batch, NULL,
+                              CLIXON_LIB_NS, "edit-batch") < 0)
+        goto done;
     retval =0;
  done:
     return retval;
@@ -44,5 +44,6 @@ int backend_monitoring_state_get(clixon_handle h, yang_stmt *yspec, char *xpath,
 int backend_client_rm(clixon_handle h, struct client_entry *ce);
 int from_client(int fd, void *arg);
 int backend_rpc_init(clixon_handle h);
+int backend_sched_exit(clixon_handle h);
 
 #endif  /* _BACKEND_CLIENT_H_ */
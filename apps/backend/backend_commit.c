@@ -84,6 +84,7 @@
  * @param[in]   h       Clixon handle
  * @param[in]   yspec   Yang spec
  * @param[in]   td      Transaction data
+ * @param[in]   srcgen  Datastore generation of source tree, 0 if not running
  * @param[out]  xret    Error XML tree. Free with xml_free after use
  * @retval      1       Validation OK       
  * @retval      0       Validation failed (with cbret set)
@@ -93,36 +94,36 @@ static int
 generic_validate(clixon_handle       h,
                  yang_stmt          *yspec,
                  transaction_data_t *td,
+                 uint64_t            srcgen,
                  cxobj             **xret)
 {
     int        retval = -1;
-    cxobj     *x2;
-    int        i;
     int        ret;
     cbuf      *cb = NULL;
 
-    /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0)
+    /* All entries, or only entries affected by changes */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL")){
+        if ((ret = xml_yang_validate_all_diff(h, td->td_target, srcgen,
+                                              td->td_dvec, td->td_dlen,
+                                              td->td_avec, td->td_alen,
+                                              td->td_scvec, td->td_tcvec, td->td_clen,
+                                              xret)) < 0)
+            goto done;
+    }
+    else if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* changed entries (target) */
+    if ((ret = xml_yang_validate_add_vec(h, td->td_tcvec, td->td_clen, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
-    /* changed entries */
-    for (i=0; i<td->td_clen; i++){
-        x2 = td->td_tcvec[i]; /* target changed */
-        /* Should this be recursive? */
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
     /* added entries */
-    for (i=0; i<td->td_alen; i++){
-        x2 = td->td_avec[i];
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
+    if ((ret = xml_yang_validate_add_vec(h, td->td_avec, td->td_alen, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
     // ok:
     retval = 1;
  done:
@@ -134,6 +135,60 @@ generic_validate(clixon_handle       h,
     goto done;
 }
 
+/*! Find the node in another tree corresponding to a given node
+ *
+ * @param[in]  x     XML node in one tree
+ * @param[in]  xtop  Top of the other tree
+ * @param[out] xp    Corresponding node in other tree, or NULL if not found
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_diff_counterpart(cxobj  *x,
+                     cxobj  *xtop,
+                     cxobj **xp)
+{
+    cxobj *xparent;
+    cxobj *x0p = NULL;
+
+    *xp = NULL;
+    if ((xparent = xml_parent(x)) == NULL){
+        *xp = xtop;
+        return 0;
+    }
+    if (xml_diff_counterpart(xparent, xtop, &x0p) < 0)
+        return -1;
+    if (x0p == NULL)
+        return 0;
+    return match_base_child(x0p, x, xml_spec(x), xp);
+}
+
+/*! Mark ancestors in target tree of a deleted node as changed
+ *
+ * Deleted nodes only exist in the source tree, but incremental validation walks the
+ * target tree and needs XML_FLAG_CHANGE set on the remaining ancestors.
+ * @param[in]  xn    Deleted node in source tree
+ * @param[in]  xtop  Top of target tree
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_diff_mark_target(cxobj *xn,
+                     cxobj *xtop)
+{
+    cxobj *xt = NULL;
+
+    if (xml_parent(xn) == NULL)
+        return 0;
+    if (xml_diff_counterpart(xml_parent(xn), xtop, &xt) < 0)
+        return -1;
+    if (xt != NULL){
+        xml_flag_set(xt, XML_FLAG_CHANGE);
+        xml_apply_ancestor(xt, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    return 0;
+}
+
 /*! Given a transaction src/target, compute diffs and set flags
  *
  * @param[in]  h       Clixon handle
@@ -171,6 +226,9 @@ compute_diffs(clixon_handle       h,
         xml_flag_set(xn, XML_FLAG_DEL);
         xml_apply(xn, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_DEL);
         xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+        if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+            xml_diff_mark_target(xn, td->td_target) < 0)
+            goto done;
     }
     for (i=0; i<td->td_alen; i++){ /* Also down */
         xn = td->td_avec[i];
@@ -366,7 +424,7 @@ startup_common(clixon_handle       h,
     /* 5. Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
     clixon_debug(CLIXON_DBG_BACKEND, "Validating startup %s", db);
-    if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
+    if ((ret = generic_validate(h, yspec, td, 0, &xret)) < 0)
         goto done;
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
@@ -524,6 +582,7 @@ startup_commit(clixon_handle h,
      * If diff is read by end callback, they may reference freed nodes.
      */
     plugin_transaction_end_all(h, td);
+    clixon_plugin_statedata_cache_flush(h);
     retval = 1;
  done:
 #ifdef STARTUP_COMMIT_REORDER
@@ -565,6 +624,7 @@ validate_common(clixon_handle       h,
     int         retval = -1;
     yang_stmt  *yspec;
     int         ret;
+    uint64_t    srcgen;
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clixon_err(OE_FATAL, 0, "No DB_SPEC");
@@ -590,6 +650,7 @@ validate_common(clixon_handle       h,
         goto done;
     if (ret == 0)
         goto fail;
+    srcgen = xmldb_generation_get(h, "running");
     if (compute_diffs(h, td) < 0)
         goto done;
     /* 4. Call plugin transaction start callbacks */
@@ -598,7 +659,7 @@ validate_common(clixon_handle       h,
 
     /* 5. Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, xret)) < 0)
+    if ((ret = generic_validate(h, yspec, td, srcgen, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -769,6 +830,12 @@ candidate_commit(clixon_handle  h,
 #endif
     }
     xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    /* Running is now the validated target */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+        xml_deps_leafref_commit(xmldb_generation_get(h, "running")) < 0)
+        goto done;
+    /* State data may depend on running */
+    clixon_plugin_statedata_cache_flush(h);
     /* Here pointers to old (source) tree are obsolete */
     if (td->td_dvec){
         td->td_dlen = 0;
@@ -1054,6 +1121,9 @@ from_client_restart_one(clixon_handle    h,
         xml_flag_set(xn, XML_FLAG_DEL);
         xml_apply(xn, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_DEL);
         xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+        if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+            xml_diff_mark_target(xn, td->td_target) < 0)
+            goto done;
     }
     for (i=0; i<td->td_alen; i++){ /* Also down */
         xn = td->td_avec[i];
@@ -1074,7 +1144,7 @@ from_client_restart_one(clixon_handle    h,
         goto fail;
     /* Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, &xerr)) < 0)
+    if ((ret = generic_validate(h, yspec, td, 0, &xerr)) < 0)
         goto done;
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
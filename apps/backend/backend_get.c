@@ -179,6 +179,7 @@ client_get_streams(clixon_handle h,
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
  * @param[in,out] xret    Existing XML tree, merge x into this, or rpc-error
+ * @param[out]    timeout Names of plugins whose state callbacks timed out, or NULL. Free after use
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
  * @retval       -1       Error (fatal)
@@ -197,7 +198,8 @@ static int
 get_state_data(clixon_handle h,
                char         *xpath,
                cvec         *nsc,
-               cxobj       **xret)
+               cxobj       **xret,
+               char        **timeout)
 {
     int        retval = -1;
     yang_stmt *yspec;
@@ -206,6 +208,7 @@ get_state_data(clixon_handle h,
     int        ret;
     cbuf      *cb = NULL;
     cxobj     *xerr = NULL;
+    char      *str;
 
     clixon_debug(CLIXON_DBG_BACKEND, "");
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -308,6 +311,13 @@ get_state_data(clixon_handle h,
     /* Use plugin state callbacks */
     if ((ret = clixon_plugin_statedata_all(h, yspec, nsc, xpath, xret)) < 0)
         goto done;
+    if (clicon_data_get(h, "statedata-timeout", &str) == 0){
+        if (ret == 1 && (*timeout = strdup(str)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        clicon_data_del(h, "statedata-timeout");
+    }
     if (ret == 0)
         goto fail;
     retval = 1; /* OK */
@@ -391,7 +401,10 @@ filter_xpath_again(clixon_handle h,
  * @param[in]  username User name for NACM access
  * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
  * @param[in]  wdef     With-defaults parameter
+ * @param[in]  timeout  Names of plugins whose state callbacks timed out, or NULL
  * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * The partial reply of timed out state callbacks has one rpc-error with severity warning
+ * per plugin before the data, see RFC 6241 Sec 4.3
  * @retval     0        OK
  * @retval    -1        Error
  */
@@ -405,10 +418,14 @@ get_nacm_and_reply(clixon_handle     h,
                    char             *username,
                    int32_t           depth,
                    withdefaults_type wdef,
+                   char             *timeout,
                    cbuf             *cbret)
 {
     int     retval = -1;
     cxobj  *xnacm = NULL;
+    char  **vec = NULL;
+    int     nvec = 0;
+    int     i;
 
     /* Pre-NACM access step */
     xnacm = clicon_nacm_cache(h);
@@ -418,6 +435,22 @@ get_nacm_and_reply(clixon_handle     h,
             goto done;
     }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);     /* OK */
+    if (timeout){
+        if ((vec = clicon_strsep(timeout, " ", &nvec)) == NULL)
+            goto done;
+        for (i=0; i<nvec; i++){
+            cprintf(cbret, "<rpc-error>"
+                    "<error-type>application</error-type>"
+                    "<error-tag>operation-failed</error-tag>"
+                    "<error-severity>warning</error-severity>"
+                    "<error-message>State data callback of plugin ");
+            if (xml_chardata_cbuf_append(cbret, 0, vec[i]) < 0)
+                goto done;
+            cprintf(cbret, " not done after %u ms, state data of plugin ignored</error-message>"
+                    "</rpc-error>",
+                    clicon_option_int(h, "CLICON_BACKEND_STATEDATA_DEADLINE"));
+        }
+    }
     if (xret==NULL)
         cprintf(cbret, "<data/>");
     else{
@@ -430,6 +463,8 @@ get_nacm_and_reply(clixon_handle     h,
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
+    if (vec)
+        free(vec);
     return retval;
 }
 
@@ -657,6 +692,7 @@ get_list_pagination(clixon_handle        h,
     int        ret;
     dispatcher_entry_t *htable = NULL;
     cvec      *wherens = NULL;
+    char      *timeout = NULL;
     //    int        extflag = 0;
 #ifdef LIST_PAGINATION_REMAINING
     cxobj     *xcache;
@@ -781,7 +817,7 @@ get_list_pagination(clixon_handle        h,
     }
     else {
         if (content != CONTENT_CONFIG){
-            if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret)) < 0)
+            if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret, &timeout)) < 0)
                 goto done;
             if (ret == 0){ /* Error from callback (error in xret) */
                 if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
@@ -905,11 +941,13 @@ get_list_pagination(clixon_handle        h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, timeout, cbret) < 0)
         goto done;
  ok:
     retval = 0;
  done:
+    if (timeout)
+        free(timeout);
     if (wherens)
         cvec_free(wherens);
     if (xvec)
@@ -968,6 +1006,7 @@ get_common(clixon_handle        h,
     cxobj            *xlpg2 = NULL;
     withdefaults_type wdef;
     char             *wdefstr;
+    char             *timeout = NULL;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     wdef = WITHDEFAULTS_EXPLICIT;
@@ -1104,7 +1143,7 @@ get_common(clixon_handle        h,
         break;
     case CONTENT_ALL:       /* both config and state */
     case CONTENT_NONCONFIG: /* state data only */
-        if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret)) < 0)
+        if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret, &timeout)) < 0)
             goto done;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
@@ -1158,12 +1197,14 @@ get_common(clixon_handle        h,
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, timeout, cbret) < 0)
         goto done;
  ok:
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (timeout)
+        free(timeout);
     if (xlpg2)
         xml_free(xlpg2);
     if (xvec)
@@ -129,6 +129,9 @@ backend_terminate(clixon_handle h)
 
     xpath_optimize_exit();
     clixon_pagination_free(h);
+    clixon_plugin_statedata_cache_flush(h);
+    clixon_plugin_statedata_ttl_free(h);
+    backend_sched_exit(h);
     if (pidfile)
         unlink(pidfile);   
     if (sockfamily==AF_UNIX && lstat(sockpath, &st) == 0)
@@ -675,6 +678,12 @@ main(int    argc,
         clixon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to libxml2, but HAVE_LIBXML2 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-libxml2))");
         goto done;
     }
+#endif
+#ifndef HAVE_LIBPCRE2_8
+    if (clicon_yang_regexp(h) ==  REGEXP_PCRE2){
+        clixon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-pcre2))");
+        goto done;
+    }
 #endif
     /* Check pid-file, if zap kil the old daemon, else return here */
     if ((pidfile = clicon_backend_pidfile(h)) == NULL){
@@ -756,6 +765,8 @@ main(int    argc,
     /* Create top-level data yangs */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
         goto done;
+    if (yang_spec_cache_init(h, __PROGRAM__) < 0)
+        goto done;
 
     /* Load backend plugins before yangs are loaded (eg extension callbacks) */
     if ((dir = clicon_backend_dir(h)) != NULL &&
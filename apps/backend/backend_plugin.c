@@ -49,9 +49,12 @@
 #include <errno.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/time.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -64,6 +67,43 @@
 #include "clixon_backend_plugin.h"
 #include "clixon_backend_commit.h"
 
+/*
+ * Constants
+ */
+/*! Max number of entries in state data cache, oldest are removed first */
+#define STATEDATA_CACHE_MAX 128
+
+/*
+ * Types
+ */
+/*! Cached state data of a plugin for an xpath, see CLICON_BACKEND_STATEDATA_CACHE_TTL
+ */
+struct statedata_cache{
+    qelem_t          sc_qelem;  /* List header, oldest first */
+    clixon_plugin_t *sc_cp;     /* Plugin */
+    char            *sc_xpath;  /* Canonical xpath of request */
+    cxobj           *sc_x;      /* State data tree of plugin, bound to YANG and sorted */
+    struct timeval   sc_expire; /* Entry is stale after this time */
+};
+
+/*! Time to live of cached state data of a subtree, see clixon_plugin_statedata_ttl
+ */
+struct statedata_ttl{
+    qelem_t          st_qelem;  /* List header */
+    char            *st_xpath;  /* Xpath of subtree using canonical prefixes */
+    uint32_t         st_ttl;    /* Time to live in milliseconds, 0: not cached */
+};
+
+/*
+ * Variables
+ */
+static struct statedata_cache *_sc_list = NULL;
+static struct statedata_ttl   *_st_list = NULL;
+static int                     _sc_nr = 0;
+static uint64_t                _sc_hits = 0;
+static uint64_t                _sc_misses = 0;
+static uint64_t                _sc_expired = 0;
+
 /*! Request plugins to reset system state
  *
  * The system 'state' should be the same as the contents of running_db
@@ -317,10 +357,564 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/*! Check if the state data selected by an xpath is within the subtree of another xpath
+ *
+ * Both xpaths use canonical prefixes. The xpath is within the subtree if the subtree
+ * xpath is a prefix of it followed by a step or a predicate, eg /ex:a/ex:b and
+ * /ex:a[ex:k='1'] are within /ex:a, and all xpaths are within "/". A leading "/" is
+ * ignored, since the xpath of a request is relative to the root.
+ * Only location paths are compared, others, eg with unions or parent steps, are only
+ * within themselves.
+ * @param[in]  xpath    Xpath of request
+ * @param[in]  subtree  Xpath of subtree
+ * @retval     1        Xpath is within subtree
+ * @retval     0        Xpath is not within subtree, or not known
+ */
+static int
+statedata_xpath_within(const char *xpath,
+                       const char *subtree)
+{
+    const char *rest;
+    size_t      len;
+
+    if (strcmp(xpath, subtree) == 0 || strcmp(subtree, "/") == 0)
+        return 1;
+    if (strncmp(xpath, "//", 2) == 0 || strncmp(subtree, "//", 2) == 0 ||
+        strchr(subtree, '|') != NULL)
+        return 0;
+    if (*xpath == '/')
+        xpath++;
+    if (*subtree == '/')
+        subtree++;
+    len = strlen(subtree);
+    if (len == 0 || strncmp(xpath, subtree, len) != 0)
+        return 0;
+    rest = xpath + len;
+    if (*rest == '\0')
+        return 1;
+    if (*rest != '/' && *rest != '[')
+        return 0;
+    if (strchr(rest, '|') != NULL || strstr(rest, "..") != NULL || strstr(rest, "::") != NULL)
+        return 0;
+    return 1;
+}
+
+/*! Get time to live of cached state data of a request
+ *
+ * The TTL of the most specific subtree registered with clixon_plugin_statedata_ttl that
+ * contains the xpath is used, or CLICON_BACKEND_STATEDATA_CACHE_TTL if there is none.
+ * If registered subtrees are within the xpath, the least of their TTLs is used.
+ * @param[in]  h      Clixon handle
+ * @param[in]  xpath  Canonical xpath of request
+ * @retval     ttl    Time to live in milliseconds, 0 if not cached
+ */
+static uint32_t
+statedata_ttl_get(clixon_handle h,
+                  char         *xpath)
+{
+    struct statedata_ttl *st;
+    struct statedata_ttl *stbest = NULL;
+    uint32_t              ttl;
+
+    if ((st = _st_list) != NULL)
+        do {
+            if (statedata_xpath_within(xpath, st->st_xpath) &&
+                (stbest == NULL || strlen(st->st_xpath) > strlen(stbest->st_xpath)))
+                stbest = st;
+            st = NEXTQ(struct statedata_ttl *, st);
+        } while (st != _st_list);
+    if (stbest)
+        ttl = stbest->st_ttl;
+    else
+        ttl = clicon_option_int(h, "CLICON_BACKEND_STATEDATA_CACHE_TTL");
+    if ((st = _st_list) != NULL)
+        do {
+            if (st->st_ttl < ttl && statedata_xpath_within(st->st_xpath, xpath))
+                ttl = st->st_ttl;
+            st = NEXTQ(struct statedata_ttl *, st);
+        } while (st != _st_list);
+    return ttl;
+}
+
+/*! Register time to live of cached state data of a subtree
+ *
+ * Overrides CLICON_BACKEND_STATEDATA_CACHE_TTL for requests within the subtree, eg for
+ * state that changes more or less often than other state. A TTL of 0 means that state
+ * of the subtree is not cached. A new registration of the same xpath replaces the TTL.
+ * May be called by a plugin in its init function.
+ * @param[in]  h      Clixon handle
+ * @param[in]  xpath  Xpath of subtree using canonical prefixes, eg /ex:state
+ * @param[in]  ttl    Time to live in milliseconds
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *    if (clixon_plugin_statedata_ttl(h, "/ex:counters", 1000) < 0)
+ *       goto done;
+ * @endcode
+ * @see clixon_plugin_statedata_ttl_free
+ */
+int
+clixon_plugin_statedata_ttl(clixon_handle h,
+                            char         *xpath,
+                            uint32_t      ttl)
+{
+    struct statedata_ttl *st;
+
+    if (xpath == NULL){
+        clixon_err(OE_PLUGIN, EINVAL, "xpath is NULL");
+        return -1;
+    }
+    if ((st = _st_list) != NULL)
+        do {
+            if (strcmp(st->st_xpath, xpath) == 0){
+                st->st_ttl = ttl;
+                return 0;
+            }
+            st = NEXTQ(struct statedata_ttl *, st);
+        } while (st != _st_list);
+    if ((st = malloc(sizeof(*st))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(st, 0, sizeof(*st));
+    if ((st->st_xpath = strdup(xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        free(st);
+        return -1;
+    }
+    st->st_ttl = ttl;
+    ADDQ(st, _st_list);
+    return 0;
+}
+
+/*! Free time to live registrations of state data subtrees
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @see clixon_plugin_statedata_ttl
+ */
+int
+clixon_plugin_statedata_ttl_free(clixon_handle h)
+{
+    struct statedata_ttl *st;
+
+    while ((st = _st_list) != NULL){
+        DELQ(st, _st_list, struct statedata_ttl *);
+        free(st->st_xpath);
+        free(st);
+    }
+    return 0;
+}
+
+/*! Remove entry from state data cache
+ *
+ * @param[in]  sc  Cache entry
+ */
+static void
+statedata_cache_rm(struct statedata_cache *sc)
+{
+    DELQ(sc, _sc_list, struct statedata_cache *);
+    _sc_nr--;
+    if (sc->sc_xpath)
+        free(sc->sc_xpath);
+    if (sc->sc_x)
+        xml_free(sc->sc_x);
+    free(sc);
+}
+
+/*! Get state data of plugin from cache
+ *
+ * An entry of an xpath whose subtree contains the xpath of the request is used, since the
+ * state is filtered by the request xpath thereafter. Stale entries are removed.
+ * @param[in]  cp     Plugin handle
+ * @param[in]  xpath  Canonical xpath of request
+ * @param[out] xp     Copy of cached state tree. Free with xml_free
+ * @retval     1      Found
+ * @retval     0      Not found
+ * @retval    -1      Error
+ * @see statedata_xpath_within
+ */
+static int
+statedata_cache_get(clixon_plugin_t *cp,
+                    char            *xpath,
+                    cxobj          **xp)
+{
+    struct statedata_cache *sc;
+    struct timeval          now;
+
+    gettimeofday(&now, NULL);
+    /* Entries are ordered by expiry */
+    while ((sc = _sc_list) != NULL && timercmp(&sc->sc_expire, &now, <=)){
+        if (sc->sc_cp == cp && statedata_xpath_within(xpath, sc->sc_xpath))
+            _sc_expired++;
+        statedata_cache_rm(sc);
+    }
+    if ((sc = _sc_list) != NULL)
+        do {
+            if (sc->sc_cp == cp && statedata_xpath_within(xpath, sc->sc_xpath)){
+                if ((*xp = xml_dup(sc->sc_x)) == NULL)
+                    return -1;
+                _sc_hits++;
+                return 1;
+            }
+            sc = NEXTQ(struct statedata_cache *, sc);
+        } while (sc != _sc_list);
+    _sc_misses++;
+    return 0;
+}
+
+/*! Add state data of plugin to cache
+ *
+ * Entries are ordered by expiry. If the cache is full, the entry that expires first is
+ * removed.
+ * @param[in]  cp     Plugin handle
+ * @param[in]  xpath  Canonical xpath of request
+ * @param[in]  x      State tree of plugin, copied
+ * @param[in]  ttl    Time to live in milliseconds
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_cache_add(clixon_plugin_t *cp,
+                    char            *xpath,
+                    cxobj           *x,
+                    uint32_t         ttl)
+{
+    int                     retval = -1;
+    struct statedata_cache *sc = NULL;
+    struct statedata_cache *sc1;
+    struct timeval          t;
+
+    if (_sc_nr >= STATEDATA_CACHE_MAX)
+        statedata_cache_rm(_sc_list);
+    if ((sc = malloc(sizeof(*sc))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sc, 0, sizeof(*sc));
+    sc->sc_cp = cp;
+    if ((sc->sc_xpath = strdup(xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((sc->sc_x = xml_dup(x)) == NULL)
+        goto done;
+    gettimeofday(&sc->sc_expire, NULL);
+    t.tv_sec = ttl/1000;
+    t.tv_usec = (ttl%1000)*1000;
+    timeradd(&sc->sc_expire, &t, &sc->sc_expire);
+    /* Insert before first entry that expires later, or last */
+    if ((sc1 = _sc_list) != NULL)
+        do {
+            if (timercmp(&sc->sc_expire, &sc1->sc_expire, <))
+                break;
+            sc1 = NEXTQ(struct statedata_cache *, sc1);
+        } while (sc1 != _sc_list);
+    if (sc1 == NULL || sc1 == _sc_list){
+        ADDQ(sc, _sc_list);
+        if (sc1 != NULL && timercmp(&sc->sc_expire, &sc1->sc_expire, <))
+            _sc_list = sc; /* First */
+    }
+    else
+        ADDQ(sc, sc1);
+    _sc_nr++;
+    sc = NULL;
+    retval = 0;
+ done:
+    if (sc){
+        if (sc->sc_xpath)
+            free(sc->sc_xpath);
+        if (sc->sc_x)
+            xml_free(sc->sc_x);
+        free(sc);
+    }
+    return retval;
+}
+
+/*! Remove all entries of state data cache
+ *
+ * Called when running changes, since state data may depend on configuration
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @see CLICON_BACKEND_STATEDATA_CACHE_TTL
+ */
+int
+clixon_plugin_statedata_cache_flush(clixon_handle h)
+{
+    while (_sc_list != NULL)
+        statedata_cache_rm(_sc_list);
+    return 0;
+}
+
+/*! Get state data cache statistics
+ *
+ * @param[in]  h        Clixon handle
+ * @param[out] entries  Number of entries
+ * @param[out] hits     Number of lookups found in cache
+ * @param[out] misses   Number of lookups not found in cache
+ * @param[out] expired  Number of entries found stale
+ * @retval     0        OK
+ */
+int
+clixon_plugin_statedata_cache_stats(clixon_handle h,
+                                    uint64_t     *entries,
+                                    uint64_t     *hits,
+                                    uint64_t     *misses,
+                                    uint64_t     *expired)
+{
+    *entries = _sc_nr;
+    *hits = _sc_hits;
+    *misses = _sc_misses;
+    *expired = _sc_expired;
+    return 0;
+}
+
+/*! Call backend statedata callbacks in parallel using worker processes
+ *
+ * Each callback is called in a forked worker process, which writes the result as XML, or
+ * the error reason, to a pipe. Processes are used instead of threads since callbacks are
+ * not expected to be thread-safe, and the backend is not, eg error state and caches.
+ * Callbacks can therefore not change the state of the backend, eg plugin caches.
+ * Workers not done by the deadline CLICON_BACKEND_STATEDATA_DEADLINE are killed, their
+ * result is NULL and a warning is logged. The names of their plugins are also set in
+ * the "statedata-timeout" handle data, separated by space, see get_nacm_and_reply.
+ * On error, all workers still running are killed.
+ * @param[in]  h      Clixon handle
+ * @param[in]  cpvec  Plugins with statedata callbacks
+ * @param[in]  len    Number of plugins
+ * @param[in]  nsc    Namespace context
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  xcvec  Cached state per plugin, or NULL. Callbacks of cached plugins are not called
+ * @param[out] cbvec  Result per plugin, or NULL on timeout. See statedata_parallel_result
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_parallel(clixon_handle     h,
+                   clixon_plugin_t **cpvec,
+                   int               len,
+                   cvec             *nsc,
+                   char             *xpath,
+                   cxobj           **xcvec,
+                   cbuf            **cbvec)
+{
+    int            retval = -1;
+    pid_t         *pids = NULL;
+    int           *fds = NULL;
+    struct pollfd *pfds = NULL;
+    int            fd[2];
+    int            i;
+    int            j;
+    int            n;
+    int            running = 0;
+    uint32_t       deadline;
+    int            timeout;
+    struct timeval t0;
+    struct timeval t;
+    char           buf[BUFSIZ];
+    ssize_t        rlen;
+    cxobj         *x = NULL;
+    cbuf          *cb;
+    cbuf          *cbtimeout = NULL;
+    int            ret;
+
+    deadline = clicon_option_int(h, "CLICON_BACKEND_STATEDATA_DEADLINE");
+    gettimeofday(&t0, NULL);
+    if ((cbtimeout = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((pids = calloc(len, sizeof(pid_t))) == NULL ||
+        (fds = calloc(len, sizeof(int))) == NULL ||
+        (pfds = calloc(len, sizeof(struct pollfd))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<len; i++)
+        fds[i] = -1;
+    for (i=0; i<len; i++){
+        if (xcvec && xcvec[i])
+            continue;
+        if ((cbvec[i] = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (pipe(fd) < 0){
+            clixon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[i] = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            close(fd[0]);
+            close(fd[1]);
+            goto done;
+        }
+        if (pids[i] == 0){ /* Worker */
+            close(fd[0]);
+            cb = cbvec[i];
+            cbuf_reset(cb);
+            if ((ret = clixon_plugin_statedata_one(cpvec[i], h, nsc, xpath, &x)) < 0)
+                _exit(1);
+            if (ret == 0)
+                cprintf(cb, "0%s", clixon_err_reason());
+            else{
+                cprintf(cb, "1");
+                if (x && clixon_xml2cbuf(cb, x, 0, 0, NULL, -1, 1) < 0)
+                    _exit(1);
+            }
+            for (j = 0; j < cbuf_len(cb); j += n)
+                if ((n = write(fd[1], cbuf_get(cb) + j, cbuf_len(cb) - j)) < 0)
+                    _exit(1);
+            _exit(0);
+        }
+        close(fd[1]);
+        fds[i] = fd[0];
+        running++;
+    }
+    while (running > 0){
+        timeout = -1;
+        if (deadline){
+            gettimeofday(&t, NULL);
+            timersub(&t, &t0, &t);
+            if ((timeout = deadline - (t.tv_sec*1000 + t.tv_usec/1000)) <= 0)
+                break;
+        }
+        for (i=0, n=0; i<len; i++)
+            if (fds[i] != -1){
+                pfds[n].fd = fds[i];
+                pfds[n].events = POLLIN;
+                pfds[n].revents = 0;
+                n++;
+            }
+        if ((ret = poll(pfds, n, timeout)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        if (ret == 0) /* Deadline */
+            break;
+        for (j=0; j<n; j++){
+            if (pfds[j].revents == 0)
+                continue;
+            for (i=0; i<len; i++)
+                if (fds[i] == pfds[j].fd)
+                    break;
+            if ((rlen = read(fds[i], buf, sizeof(buf))) < 0){
+                if (errno == EINTR)
+                    continue;
+                rlen = 0; /* Handle as failed worker */
+                cbuf_reset(cbvec[i]);
+            }
+            if (rlen == 0){
+                close(fds[i]);
+                fds[i] = -1;
+                running--;
+            }
+            else if (cbuf_append_buf(cbvec[i], buf, rlen) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        }
+    }
+    for (i=0; i<len; i++)
+        if (fds[i] != -1){ /* Deadline */
+            clixon_log(h, LOG_WARNING, "State data callback of plugin %s not done after %u ms, state data of plugin ignored",
+                       clixon_plugin_name_get(cpvec[i]), deadline);
+            if (cbuf_len(cbtimeout))
+                cprintf(cbtimeout, " ");
+            cprintf(cbtimeout, "%s", clixon_plugin_name_get(cpvec[i]));
+            cbuf_free(cbvec[i]);
+            cbvec[i] = NULL;
+        }
+    if (cbuf_len(cbtimeout) &&
+        clicon_data_set(h, "statedata-timeout", cbuf_get(cbtimeout)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (fds){
+        for (i=0; i<len; i++)
+            if (fds[i] != -1){ /* Deadline or error: kill worker before wait */
+                if (pids[i] > 0)
+                    kill(pids[i], SIGKILL);
+                close(fds[i]);
+            }
+        free(fds);
+    }
+    if (cbtimeout)
+        cbuf_free(cbtimeout);
+    if (pids){
+        for (i=0; i<len; i++)
+            if (pids[i] > 0)
+                waitpid(pids[i], NULL, 0);
+        free(pids);
+    }
+    if (pfds)
+        free(pfds);
+    return retval;
+}
+
+/*! Get state data tree from result of worker process of a plugin
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  cp   Plugin handle
+ * @param[in]  cb   Result of worker, "1" followed by XML, or "0" followed by error reason,
+ *                  or NULL if worker timed out
+ * @param[out] xp   If retval=1, state tree created and returned: <config>..., or NULL
+ * @retval     1    OK
+ * @retval     0    Statedata callback failed. no XML tree returned
+ * @retval    -1    Fatal error
+ * @see statedata_parallel
+ */
+static int
+statedata_parallel_result(clixon_handle    h,
+                          clixon_plugin_t *cp,
+                          cbuf            *cb,
+                          cxobj          **xp)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+    char  *str;
+
+    if (cb == NULL)
+        goto ok;
+    str = cbuf_get(cb);
+    if (*str == '0'){
+        clixon_err(OE_PLUGIN, 0, "%s", str+1);
+        goto fail;
+    }
+    else if (*str != '1'){
+        clixon_err(OE_PLUGIN, 0, "State callback worker process of plugin %s failed",
+                   clixon_plugin_name_get(cp));
+        goto fail;
+    }
+    if ((x = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (clixon_xml_parse_string(str+1, YB_NONE, NULL, &x, NULL) < 0)
+        goto done;
+    *xp = x;
+    x = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (x)
+        xml_free(x);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  *
  * This is internal system call, plugin is invoked (does not call) this function
  * Backend plugins can register 
+ * If CLICON_BACKEND_STATEDATA_PARALLEL is set, callbacks are called in parallel, and
+ * results are merged in plugin order as when called serially.
+ * If CLICON_BACKEND_STATEDATA_CACHE_TTL is set, state data of each plugin is cached per
+ * xpath, and callbacks are not called for cached state.
+ * Names of plugins whose callbacks did not finish by the deadline are set in the
+ * "statedata-timeout" handle data, which is otherwise cleared.
  * @param[in]     h       clicon handle
  * @param[in]     yspec   Yang spec
  * @param[in]     nsc     Namespace context
@@ -330,6 +924,8 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
  * @retval        0       Statedata callback failed (xret set with netconf-error)
  * @retval       -1       Error
  * @note xret can be replaced in this function
+ * @see statedata_parallel
+ * @see statedata_cache_get
  */
 int
 clixon_plugin_statedata_all(clixon_handle h,
@@ -338,54 +934,106 @@ clixon_plugin_statedata_all(clixon_handle h,
                             char         *xpath,
                             cxobj       **xret)
 {
-    int              retval = -1;
-    int              ret;
-    cxobj           *x = NULL;
-    clixon_plugin_t *cp = NULL;
-    cxobj           *xerr = NULL;
+    int               retval = -1;
+    int               ret;
+    cxobj            *x = NULL;
+    clixon_plugin_t  *cp = NULL;
+    cxobj            *xerr = NULL;
+    clixon_plugin_t **cpvec = NULL;
+    cbuf            **cbvec = NULL;
+    cxobj           **xcvec = NULL;
+    int               len = 0;
+    int               i;
+    uint32_t          ttl;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+    clicon_data_del(h, "statedata-timeout");
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        if (clixon_plugin_api_get(cp)->ca_statedata != NULL)
+            len++;
+    if (len == 0)
+        goto ok;
+    if ((cpvec = calloc(len, sizeof(*cpvec))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = 0;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        if (clixon_plugin_api_get(cp)->ca_statedata != NULL)
+            cpvec[i++] = cp;
+    if ((ttl = statedata_ttl_get(h, xpath?xpath:"/")) > 0){
+        if ((xcvec = calloc(len, sizeof(*xcvec))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
             goto done;
-        if (ret == 0){
-            /* error reason should be in clixon_err_reason */
-            if (clixon_plugin_report_err_xml(h, &xerr,
-                                             "Internal error, state callback in plugin %s returned invalid XML: %s",
-                                             clixon_plugin_name_get(cp), clixon_err_reason()) < 0)
+        }
+        for (i=0; i<len; i++)
+            if (statedata_cache_get(cpvec[i], xpath?xpath:"/", &xcvec[i]) < 0)
+                goto done;
+    }
+    if (clicon_option_bool(h, "CLICON_BACKEND_STATEDATA_PARALLEL")){
+        if ((cbvec = calloc(len, sizeof(*cbvec))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (statedata_parallel(h, cpvec, len, nsc, xpath, xcvec, cbvec) < 0)
+            goto done;
+    }
+    for (i=0; i<len; i++){
+        cp = cpvec[i];
+        if (xcvec && xcvec[i]){ /* Cached: bound and sorted */
+            x = xcvec[i];
+            xcvec[i] = NULL;
+        }
+        else {
+            if (cbvec)
+                ret = statedata_parallel_result(h, cp, cbvec[i], &x);
+            else
+                ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x);
+            if (ret < 0)
+                goto done;
+            if (ret == 0){
+                /* error reason should be in clixon_err_reason */
+                if (clixon_plugin_report_err_xml(h, &xerr,
+                                                 "Internal error, state callback in plugin %s returned invalid XML: %s",
+                                                 clixon_plugin_name_get(cp), clixon_err_reason()) < 0)
+                    goto done;
+                xml_free(*xret);
+                *xret = xerr;
+                xerr = NULL;
+                goto fail;
+            }
+            if (x == NULL)
+                continue;
+            clixon_debug_xml(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, x, "%s STATE:", clixon_plugin_name_get(cp));
+            /* XXX: ret == 0 invalid yang binding should be handled as internal error */
+            if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
+                goto done;
+            if (ret == 0){
+                if (clixon_netconf_internal_error(xerr,
+                                                  ". Internal error, state callback returned invalid XML from plugin: ",
+                                                  clixon_plugin_name_get(cp)) < 0)
+                    goto done;
+                xml_free(*xret);
+                *xret = xerr;
+                xerr = NULL;
+                goto fail;
+            }
+            if (xml_sort_recurse(x) < 0)
+                goto done;
+            /* Remove global defaults and empty non-presence containers */
+            /* XXX: only for state data and according to with-defaults setting */
+            if (xml_default_nopresence(x, 2, 0) < 0)
+                goto done;
+            /* Also empty state is cached */
+            if (ttl > 0 &&
+                statedata_cache_add(cp, xpath?xpath:"/", x, ttl) < 0)
                 goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
         }
-        if (x == NULL)
-            continue;
         if (xml_child_nr(x) == 0){
             xml_free(x);
             x = NULL;
             continue;
         }
-        clixon_debug_xml(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, x, "%s STATE:", clixon_plugin_name_get(cp));
-        /* XXX: ret == 0 invalid yang binding should be handled as internal error */
-        if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_netconf_internal_error(xerr,
-                                              ". Internal error, state callback returned invalid XML from plugin: ",
-                                              clixon_plugin_name_get(cp)) < 0)
-                goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
-        }
-        if (xml_sort_recurse(x) < 0)
-            goto done;
-        /* Remove global defaults and empty non-presence containers */
-        /* XXX: only for state data and according to with-defaults setting */
-        if (xml_default_nopresence(x, 2, 0) < 0)
-            goto done;
         if (xpath_first(x, nsc, "%s", xpath) != NULL){
             if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
                 goto done;
@@ -396,9 +1044,24 @@ clixon_plugin_statedata_all(clixon_handle h,
             xml_free(x);
             x = NULL;
         }
-    } /* while plugin */
+    } /* for plugin */
+ ok:
     retval = 1;
  done:
+    if (cbvec){
+        for (i=0; i<len; i++)
+            if (cbvec[i])
+                cbuf_free(cbvec[i]);
+        free(cbvec);
+    }
+    if (xcvec){
+        for (i=0; i<len; i++)
+            if (xcvec[i])
+                xml_free(xcvec[i]);
+        free(xcvec);
+    }
+    if (cpvec)
+        free(cpvec);
     if (xerr)
         xml_free(xerr);
     if (x)
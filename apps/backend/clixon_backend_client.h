@@ -45,6 +45,24 @@
 /*
  * Types
  */
+/* Queued output message to a client, see backend_client.c
+ */
+struct ce_output{
+    qelem_t               co_qelem;   /* List header */
+    cbuf                 *co_cb;      /* Message body, framed when written */
+    char                  co_hdr[32]; /* NETCONF 1.1 chunk header of body */
+    size_t                co_hdrlen;  /* Length of co_hdr */
+    size_t                co_pos;     /* Bytes written of header, body and end-of-chunks */
+};
+
+/* Pending RPC of a client, not yet scheduled, see backend_client.c
+ */
+struct ce_rpc{
+    qelem_t               cr_qelem;   /* List header */
+    cbuf                 *cr_cb;      /* Message, or NULL if denied by admission control */
+    struct timeval        cr_time;    /* Time of arrival */
+};
+
 /* Backend client entry.
  * Keep state about every connected client.
  * References from RFC 6022, ietf-netconf-monitoring.yang sessions container
@@ -73,6 +91,21 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    cbuf                 *ce_rcvbuf;  /* Partially received message, see from_client */
+    int                   ce_frame_state; /* Chunked framing state of ce_rcvbuf */
+    size_t                ce_frame_size;  /* Chunked framing size of ce_rcvbuf */
+    struct ce_output     *ce_outq;    /* Messages not yet written to client */
+    size_t                ce_outlen;  /* Bytes not yet written in ce_outq */
+    int                   ce_outreg;  /* Write event registered for ce_outq */
+    int                   ce_outdrop; /* Notifications dropped since ce_outq above high-water mark */
+    int                   ce_outsusp; /* Input suspended since ce_outq above high-water mark */
+    struct rpc_worker    *ce_worker;  /* Worker process executing RPC of client, see backend_client.c */
+    cbuf                 *ce_rcvpend; /* Input received while ce_worker is busy, not yet dispatched */
+    struct ce_rpc        *ce_rpcq;    /* Pending RPCs, see CLICON_BACKEND_SCHED_QUANTUM */
+    int                   ce_rpcq_nr; /* Number of pending RPCs in ce_rpcq */
+    int                   ce_deficit; /* Remaining RPCs of client in scheduling round */
+    struct sched_class   *ce_class;   /* Scheduling class, see backend_client.c */
+    int                   ce_suspended; /* Input suspended since ce_rpcq is full */
 };
 typedef struct client_entry client_entry;
 
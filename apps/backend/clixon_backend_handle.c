@@ -192,6 +192,8 @@ backend_client_delete(clixon_handle        h,
     struct client_entry   *c;
     struct client_entry  **ce_prev;
     struct backend_handle *bh = handle(h);
+    struct ce_output      *co;
+    struct ce_rpc         *cr;
 
     ce_prev = &bh->bh_ce_list;
     for (c = *ce_prev; c; c = c->ce_next){
@@ -203,6 +205,21 @@ backend_client_delete(clixon_handle        h,
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            if (ce->ce_rcvbuf)
+                cbuf_free(ce->ce_rcvbuf);
+            if (ce->ce_rcvpend)
+                cbuf_free(ce->ce_rcvpend);
+            while ((co = ce->ce_outq) != NULL){
+                DELQ(co, ce->ce_outq, struct ce_output *);
+                cbuf_free(co->co_cb);
+                free(co);
+            }
+            while ((cr = ce->ce_rpcq) != NULL){
+                DELQ(cr, ce->ce_rpcq, struct ce_rpc *);
+                if (cr->cr_cb)
+                    cbuf_free(cr->cr_cb);
+                free(cr);
+            }
             ce->ce_next = NULL;
             free(ce);
             break;
@@ -103,6 +103,10 @@ int clixon_plugin_reset_all(clixon_handle h, char *db);
 int clixon_plugin_pre_daemon_all(clixon_handle h);
 int clixon_plugin_daemon_all(clixon_handle h);
 
+int clixon_plugin_statedata_ttl(clixon_handle h, char *xpath, uint32_t ttl);
+int clixon_plugin_statedata_ttl_free(clixon_handle h);
+int clixon_plugin_statedata_cache_flush(clixon_handle h);
+int clixon_plugin_statedata_cache_stats(clixon_handle h, uint64_t *entries, uint64_t *hits, uint64_t *misses, uint64_t *expired);
 int clixon_plugin_statedata_all(clixon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath, cxobj **xtop);
 int clixon_plugin_lockdb_all(clixon_handle h, char *db, int lock, int id);
 
@@ -534,7 +534,7 @@ yang2cli_var_pattern(clixon_handle h,
         pattern = cv_string_get(cvp);
         invert = cv_flag(cvp, V_INVERT);
         cprintf(cb, " regexp:%s\"", invert?"!":"");
-        if (mode == REGEXP_POSIX){
+        if (mode == REGEXP_POSIX || mode == REGEXP_PCRE2){ /* CLIgen has no pcre2 */
             posix = NULL;
             if (regexp_xsd2posix(pattern, &posix) < 0)
                 goto done;
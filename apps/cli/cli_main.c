@@ -793,6 +793,12 @@ main(int    argc,
         goto done;
 #endif
     }
+#ifndef HAVE_LIBPCRE2_8
+    if (clicon_yang_regexp(h) == REGEXP_PCRE2){
+        clixon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-pcre2))");
+        goto done;
+    }
+#endif
 
     /* CLIgen help string setting for long and multi-line strings */
     nr = clicon_option_int(h, "CLICON_CLI_HELPSTRING_TRUNCATE");
@@ -852,6 +858,8 @@ main(int    argc,
     /* Create top-level and store as option */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
         goto done;
+    if (yang_spec_cache_init(h, __PROGRAM__) < 0)
+        goto done;
 
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
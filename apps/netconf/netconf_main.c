@@ -877,6 +877,8 @@ main(int    argc,
     /* Create top-level yang spec and store as option */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
         goto done;
+    if (yang_spec_cache_init(h, __PROGRAM__) < 0)
+        goto done;
 
     /* Load netconf plugins before yangs are loaded (eg extension callbacks) */
     if ((dir = clicon_netconf_dir(h)) != NULL &&
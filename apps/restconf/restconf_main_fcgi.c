@@ -503,6 +503,8 @@ main(int    argc,
     /* Create top-level yang spec and store as option */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
         goto done;
+    if (yang_spec_cache_init(h, __PROGRAM__) < 0)
+        goto done;
 
     /* Initialize plugin module by creating a handle holding plugin and callback lists */
     if (clixon_plugin_module_init(h) < 0)
@@ -984,6 +984,8 @@ restconf_clixon_init(clixon_handle h,
     /* Create top-level yang spec and store as option */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
         goto done;
+    if (yang_spec_cache_init(h, __PROGRAM__) < 0)
+        goto done;
 
     /* Load restconf plugins before yangs are loaded (eg extension callbacks) */
     if ((dir = clicon_restconf_dir(h)) != NULL)
@@ -36,6 +36,7 @@
   * The example have the following optional arguments that you can pass as
   * argc/argv after -- in clixon_backend:
   *  -a <..> Register callback for this yang action
+  *  -L <ms> Time to live of cached state data of /ex:state (requires -s)
   *  -m <yang> Mount this yang on mountpoint
   *  -M <namespace> Namespace of mountpoint, note both -m and -M must exist
   *  -n  Notification streams example
@@ -73,7 +74,7 @@
 #include <clixon/clixon_backend.h>
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:m:M:n:o:O:rsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:L:m:M:n:o:O:rsS:T:x:iuUtV:w:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -106,6 +107,29 @@ static char *_mount_namespace = NULL;
  */
 static int _notification_stream_s = 0;
 
+/*! Event timer test
+ *
+ * Register timers with deadlines in shuffled order and cancel every third by its id.
+ * Check that the others are called in deadline order and log the result.
+ * Start backend with -- -T <nr>
+ * where <nr> is number of timers
+ */
+static int _timer_nr = 0;
+
+/*! Timer of event timer test
+ */
+struct example_timer {
+    int            et_nr;        /* Timer number */
+    uint64_t       et_id;        /* Timer id for cancellation */
+    struct timeval et_time;      /* Deadline */
+    int            et_cancelled; /* Cancelled, should not be called */
+};
+static struct example_timer *_timers = NULL;
+static struct timeval _timer_last = {0,};  /* Deadline of last called timer */
+static int _timer_called = 0;
+static int _timer_cancelled = 0;
+static int _timer_errors = 0;
+
 /*! System-only config xpath
  *
  * Start backend with -o <xpath>
@@ -157,6 +181,20 @@ static char *_state_xpath = NULL;
  */
 static int _state_file_cached = 0;
 
+/*! Delay of state callback in milliseconds
+ *
+ * Primarily for testing slow state callbacks, eg CLICON_BACKEND_STATEDATA_DEADLINE
+ * Start backend with -- -s -w <ms>
+ */
+static int _state_delay = 0;
+
+/*! Time to live of cached state data of the state container in milliseconds
+ *
+ * Registered with clixon_plugin_statedata_ttl if 0 or larger
+ * Start backend with -- -s -L <ms>
+ */
+static int _state_ttl = -1;
+
 /*! Cache control of read state file pagination example,
  *
  * keep xml tree cache as long as db is locked
@@ -367,6 +405,88 @@ example_stream_timer_setup(clixon_handle h,
     return clixon_event_reg_timeout(t, example_stream_timer, h, "example stream timer");
 }
 
+/*! Event timer test callback, check that timers are called in deadline order
+ */
+static int
+example_timer_cb(int   fd,
+                 void *arg)
+{
+    struct example_timer *et = (struct example_timer *)arg;
+    struct timeval        now;
+
+    gettimeofday(&now, NULL);
+    if (et->et_cancelled){
+        clixon_log(NULL, LOG_WARNING, "example timer %d: cancelled but called", et->et_nr);
+        _timer_errors++;
+    }
+    if (timercmp(&et->et_time, &_timer_last, <)){
+        clixon_log(NULL, LOG_WARNING, "example timer %d: not called in deadline order", et->et_nr);
+        _timer_errors++;
+    }
+    if (timercmp(&now, &et->et_time, <)){
+        clixon_log(NULL, LOG_WARNING, "example timer %d: called before deadline", et->et_nr);
+        _timer_errors++;
+    }
+    /* The timer is removed before it is called, its id is not valid anymore */
+    if (clixon_event_unreg_timeout_id(et->et_id) == 0){
+        clixon_log(NULL, LOG_WARNING, "example timer %d: cancelled when called", et->et_nr);
+        _timer_errors++;
+    }
+    _timer_last = et->et_time;
+    if (++_timer_called == _timer_nr - _timer_cancelled)
+        clixon_log(NULL, LOG_NOTICE, "example timers: %d called, %d cancelled, %d errors",
+                   _timer_called, _timer_cancelled, _timer_errors);
+    return 0;
+}
+
+/*! Set up event timer test, see _timer_nr
+ *
+ * Deadlines are 5ms apart starting in one second, in shuffled order of registration
+ * @param[in]  h   Clixon handle
+ * @param[in]  nr  Number of timers
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+example_timer_setup(clixon_handle h,
+                    int           nr)
+{
+    int                   retval = -1;
+    struct example_timer *et;
+    struct timeval        t0;
+    struct timeval        t;
+    int                   i;
+
+    if ((_timers = calloc(nr, sizeof(*_timers))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    gettimeofday(&t0, NULL);
+    t0.tv_sec += 1;
+    for (i=0; i<nr; i++){
+        et = &_timers[i];
+        et->et_nr = i;
+        t.tv_sec = 0;
+        t.tv_usec = ((i*7) % nr) * 5000; /* Permutation if nr is not a multiple of 7 */
+        timeradd(&t0, &t, &et->et_time);
+        if (clixon_event_reg_timeout_id(et->et_time, example_timer_cb, et,
+                                        "example timer", &et->et_id) < 0)
+            goto done;
+    }
+    for (i=0; i<nr; i+=3){
+        et = &_timers[i];
+        if (clixon_event_unreg_timeout_id(et->et_id) < 0){
+            clixon_err(OE_EVENTS, 0, "example timer %d: not found", i);
+            goto done;
+        }
+        et->et_cancelled = 1;
+        _timer_cancelled++;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Smallest possible RPC declaration for test
  *
  * Yang/XML:
@@ -508,6 +628,8 @@ example_statedata(clixon_handle h,
 
     if (!_state)
         goto ok;
+    if (_state_delay)
+        usleep(_state_delay*1000);
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -1553,6 +1675,10 @@ example_exit(clixon_handle h)
         xml_free(_state_xml_cache);
         _state_xml_cache = NULL;
     }
+    if (_timers){
+        free(_timers);
+        _timers = NULL;
+    }
     return 0;
 }
 
@@ -1610,6 +1736,9 @@ clixon_plugin_init(clixon_handle h)
         case 'a':
             _action_instanceid = optarg;
             break;
+        case 'L': /* state cache time to live (requires -s) */
+            _state_ttl = atoi(optarg);
+            break;
         case 'm':
             _mount_yang = optarg;
             break;
@@ -1634,6 +1763,9 @@ clixon_plugin_init(clixon_handle h)
         case 'S': /* state file (requires -s) */
             _state_file = optarg;
             break;
+        case 'T': /* event timer test */
+            _timer_nr = atoi(optarg);
+            break;
         case 'x': /* state xpath (requires -sS) */
             _state_xpath = optarg;
             break;
@@ -1652,11 +1784,17 @@ clixon_plugin_init(clixon_handle h)
         case 'V': /* validate fail */
             _validate_fail_xpath = optarg;
             break;
+        case 'w': /* state callback delay (requires -s) */
+            _state_delay = atoi(optarg);
+            break;
         }
     if ((_mount_yang && !_mount_namespace) || (!_mount_yang && _mount_namespace)){
         clixon_err(OE_PLUGIN, EINVAL, "Both -m and -M must be given for mounts");
         goto done;
     }
+    if (_state_ttl >= 0 &&
+        clixon_plugin_statedata_ttl(h, "/ex:state", _state_ttl) < 0)
+        goto done;
     if (_state_file){
         api.ca_statedata = example_statefile; /* Switch state data callback */
         if (_state_xpath){
@@ -1688,6 +1826,9 @@ clixon_plugin_init(clixon_handle h)
         if (example_stream_timer_setup(h, _notification_stream_s) < 0)
             goto done;
     }
+    if (_timer_nr > 0 &&
+        example_timer_setup(h, _timer_nr) < 0)
+        goto done;
     /* Register callback for routing rpc calls
      */
     /* From example.yang (clicon) */
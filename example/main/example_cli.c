@@ -243,6 +243,76 @@ example_client_rpc(clixon_handle h,
     return retval;
 }
 
+/*! Example of pipelined "downcalls": send several RPCs to the backend without waiting for replies
+ *
+ * Send <nr> example RPCs with x set to <a>0, <a>1,.. without waiting for each reply, then
+ * print the replies, which are returned in request order.
+ * @see clicon_rpc_msg_pipeline
+ */
+int
+example_client_pipeline(clixon_handle h,
+                        cvec         *cvv,
+                        cvec         *argv)
+{
+    int                 retval = -1;
+    cg_var             *cva;
+    uint32_t            nr;
+    uint32_t            id;
+    struct clicon_msg **msgs = NULL;
+    cxobj             **xrets = NULL;
+    cxobj              *xerr;
+    int                 i;
+
+    cva = cvec_find(cvv, "a");
+    nr = cv_uint32_get(cvec_find(cvv, "nr"));
+    if (clicon_session_id_get(h, &id) < 0){
+        if (clicon_hello_req(h, NULL, NULL, &id) < 0)
+            goto done;
+        clicon_session_id_set(h, id);
+    }
+    if ((msgs = calloc(nr, sizeof(*msgs))) == NULL ||
+        (xrets = calloc(nr, sizeof(*xrets))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<nr; i++)
+        if ((msgs[i] = clicon_msg_encode(id,
+                                         "<rpc xmlns=\"%s\" username=\"%s\" message-id=\"%d\">"
+                                         "<example xmlns=\"urn:example:clixon\"><x>%s%d</x></example></rpc>",
+                                         NETCONF_BASE_NAMESPACE,
+                                         clicon_username_get(h),
+                                         i,
+                                         cv_string_get(cva), i)) == NULL)
+            goto done;
+    /* Send all without waiting for replies */
+    if (clicon_rpc_msg_pipeline(h, msgs, nr, xrets) < 0)
+        goto done;
+    for (i=0; i<nr; i++){
+        if ((xerr = xpath_first(xrets[i], NULL, "//rpc-error")) != NULL){
+            clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Pipelined rpc");
+            goto done;
+        }
+        if (clixon_xml2file(stdout, xml_child_i(xrets[i], 0), 0, 0, NULL, cligen_output, 0, 1) < 0)
+            goto done;
+        fprintf(stdout,"\n");
+    }
+    retval = 0;
+ done:
+    if (msgs){
+        for (i=0; i<nr; i++)
+            if (msgs[i])
+                free(msgs[i]);
+        free(msgs);
+    }
+    if (xrets){
+        for (i=0; i<nr; i++)
+            if (xrets[i])
+                xml_free(xrets[i]);
+        free(xrets);
+    }
+    return retval;
+}
+
 /*! Translate function from an original value to a new.
  *
  * In this case, assume string and increment characters, eg HAL->IBM
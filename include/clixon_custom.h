@@ -230,6 +230,14 @@
  */
 #undef OPTIMIZE_YSPEC_NAMESPACE
 
+/*! If set, minimum number of children of a yang statement to use a hash index for lookups
+ *
+ * The index is built lazily on first lookup and maps argument, keyword, and for yang-specs
+ * also module namespace and prefix, to children.
+ * see yang_find, yang_find_datanode, yang_find_schemanode, yang_find_module_by_name
+ */
+#define OPTIMIZE_YANG_FIND_INDEX 16
+
 /*! If set, make optimization of non-presence default container
  *
  * Save the default XML in YANG and reuse next time
@@ -56,6 +56,7 @@ struct db_elmnt {
                                  */
     int            de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
     int            de_volatile; /* Disable auto-sync of cache to disk on every update (ie xmldb_put) */
+    uint64_t       de_gen;      /* Generation, changed on every set and clear of the element */
 };
 typedef struct db_elmnt db_elmnt;
 
@@ -80,6 +81,7 @@ int xmldb_get_cache(clixon_handle h, const char *db, yang_bind yb,
                     cxobj **xtp, modstate_diff_t *msdiff, cxobj **xerr);
 /* in clixon_datastore_write.[ch]: */
 int xmldb_put(clixon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
+int xmldb_put_batch(clixon_handle h, const char *db, enum operation_type *opvec, cxobj **x1vec, int n, char *username, cbuf *cbret, int *failed);
 int xmldb_dump(clixon_handle h, FILE *f, cxobj *xt, enum format_enum format, int pretty, withdefaults_type wdef, int multi, const char *multidb);
 int xmldb_write_cache2file(clixon_handle h, const char *db);
 
@@ -97,6 +99,7 @@ int xmldb_create(clixon_handle h, const char *db);
 int xmldb_db_reset(clixon_handle h, const char *db);
 cxobj *xmldb_cache_get(clixon_handle h, const char *db);
 int xmldb_modified_get(clixon_handle h, const char *db);
+uint64_t xmldb_generation_get(clixon_handle h, const char *db);
 int xmldb_modified_set(clixon_handle h, const char *db, int value);
 int xmldb_empty_get(clixon_handle h, const char *db);
 int xmldb_empty_set(clixon_handle h, const char *db, int value);
@@ -52,10 +52,16 @@ int clicon_sig_ignore_set(int val);
 int clicon_sig_ignore_get(void);
 int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, char *str);
 int clixon_event_reg_fd_prio(int fd, int (*fn)(int, void*), void *arg, char *str, int prio);
+int clixon_event_reg_fd_write(int fd, int (*fn)(int, void*), void *arg, char *str);
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
 int clixon_event_reg_timeout(struct timeval t,  int (*fn)(int, void*),
                              void *arg, char *str);
+int clixon_event_reg_timeout_id(struct timeval t,  int (*fn)(int, void*),
+                                void *arg, char *str, uint64_t *id);
 int clixon_event_unreg_timeout(int (*fn)(int, void*), void *arg);
+int clixon_event_unreg_timeout_id(uint64_t id);
+int clixon_event_reg_defer(int (*fn)(int, void*), void *arg, char *str);
+int clixon_event_unreg_defer(int (*fn)(int, void*), void *arg);
 int clixon_event_poll(int fd);
 int clixon_event_loop(clixon_handle h);
 int clixon_event_exit(void);
@@ -95,5 +95,6 @@ void       *clixon_str2ptr(map_str2ptr *mptab, char *str, size_t len);
 int         clixon_str2ptr_print(FILE *f, map_str2ptr *mptab);
 void       *clixon_ptr2ptr(map_ptr2ptr *mptab, size_t len, void *ptr);
 int         clixon_ptr2ptr_add(map_ptr2ptr **mptab, size_t *len, void *ptr0, void *ptr1);
+void       *clixon_ptr2ptr_del(map_ptr2ptr *mptab, size_t *len, void *ptr0);
 
 #endif  /* _CLIXON_MAP_H_ */
@@ -38,12 +38,22 @@
 #ifndef _CLIXON_REGEX_H_
 #define _CLIXON_REGEX_H_
 
+/*
+ * Types
+ */
+typedef struct regex_memo regex_memo;
+
 /*
  * Prototypes
  */
 int regexp_xsd2posix(char *xsd, char **posix);
+int regexp_xsd2pcre(char *xsd, char **pcre);
+int regex_pcre2_free(void *recomp);
 int regex_compile(clixon_handle h, char *regexp, void **recomp);
 int regex_exec(clixon_handle h, void *recomp, char *string);
 int regex_free(clixon_handle h, void *recomp);
+regex_memo *regex_memo_new(void);
+int regex_memo_free(regex_memo *rm);
+int regex_exec_memo(clixon_handle h, void *recomp, regex_memo *rm, char *string);
 
 #endif  /* _CLIXON_REGEX_H_ */
@@ -46,9 +46,13 @@
 int xml_yang_validate_rpc(clixon_handle h, cxobj *xrpc, int expanddefault, cxobj **xret);
 int xml_yang_validate_rpc_reply(clixon_handle h, cxobj *xrpc, cxobj **xret);
 int xml_yang_validate_add(clixon_handle h, cxobj *xt, cxobj **xret);
+int xml_yang_validate_add_vec(clixon_handle h, cxobj **xvec, int xlen, cxobj **xret);
 int xml_yang_validate_list_key_only(cxobj *xt, cxobj **xret);
 int xml_yang_validate_all(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_all_top(clixon_handle h, cxobj *xt, cxobj **xret);
+int xml_yang_validate_all_diff(clixon_handle h, cxobj *xt, uint64_t srcgen, cxobj **dvec, int dlen,
+                               cxobj **avec, int alen, cxobj **scvec, cxobj **tcvec, int clen,
+                               cxobj **xret);
 int xml_yang_validate_exit(clixon_handle h);
 int rpc_reply_check(clixon_handle h, char *rpcname, cbuf *cbret);
 
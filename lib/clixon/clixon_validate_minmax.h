@@ -43,7 +43,7 @@
 /*
  * Prototypes
  */
-int xml_yang_validate_minmax(cxobj *xt, int presence, cxobj **xret);
+int xml_yang_validate_minmax(cxobj *xt, int presence, int diff, cxobj **xret);
 int xml_duplicate_detect(cxobj *xt, int rm, cxobj **xret);
 
 #endif  /* _CLIXON_VALIDATE_MINMAX_H_ */
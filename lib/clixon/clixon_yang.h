@@ -62,6 +62,8 @@
                                * list elements using this index with binary search */
 #endif
 #define YANG_FLAG_STATE_LOCAL  0x10  /* Local inverted value of Y_CONFIG child */
+#define YANG_FLAG_FIND_INDEX   0x20  /* Use external map to access hash index of children
+                                      * for yang_find and friends, see yang_index_get */
 #define YANG_FLAG_DISABLED     0x40  /* Disabled due to if-feature evaluate to false
                                       * Transformed to ANYDATA but some code may need to check
                                       * why it is an ANYDATA
@@ -100,6 +102,11 @@
                                       * may be different from orig, therefore do not use link to
                                       * original. May also be due to deviations of derived trees
                                       */
+#define YANG_FLAG_DEPS        0x4000 /* Use external map to access constraint dependency
+                                      * info, see clixon_validate_deps.c */
+#define YANG_FLAG_MAPPED      0x8000 /* Argument string is not owned by statement and is not
+                                      * freed: it is in an argument arena of the spec, see
+                                      * yang_spec_arena_add */
 /*! Names of top-level data YANGs
  */
 #define YANG_DOMAIN_TOP "top"
@@ -207,6 +214,14 @@ enum yang_class{
 };
 typedef enum yang_class yang_class;
 
+/* Key of module lookup in yang spec, see yang_find_module_index
+ */
+enum yang_module_index{
+    YANG_MODULE_INDEX_NAME,      /* Module or submodule name */
+    YANG_MODULE_INDEX_NAMESPACE, /* Module namespace */
+    YANG_MODULE_INDEX_PREFIX     /* Module own prefix */
+};
+
 struct xml;
 
 /* This is the external handle type exposed in the API.
@@ -288,6 +303,8 @@ int        yang_mymodule_set(yang_stmt *ys, yang_stmt *ym);
 /* Stats */
 int        yang_stats_global(uint64_t *nr);
 int        yang_stats(yang_stmt *y, enum rfc_6020 keyw, uint64_t *nrp, size_t *szp);
+int        yang_spec_freeze(yang_stmt *yspec);
+int        yang_spec_arena_add(yang_stmt *yspec, char *buf, size_t len, int mapped);
 
 /* Other functions */
 yang_stmt *yspec_new(clixon_handle h, char *name);
@@ -316,6 +333,7 @@ yang_stmt *ys_mounts(yang_stmt *ys);
 yang_stmt *yang_find(yang_stmt *yn, int keyword, const char *argument);
 yang_stmt *yang_find_datanode(yang_stmt *yn, char *argument);
 yang_stmt *yang_find_schemanode(yang_stmt *yn, char *argument);
+int        yang_find_module_index(yang_stmt *yspec, enum yang_module_index key, const char *str, yang_stmt **ymod);
 char      *yang_find_myprefix(yang_stmt *ys);
 char      *yang_find_mynamespace(yang_stmt *ys);
 int        yang_find_prefix_by_namespace(yang_stmt *ys, char *ns, char **prefix);
@@ -332,6 +350,7 @@ int        yang_deviation(yang_stmt *ys, void *arg);
 int        yang_spec_print(FILE *f, yang_stmt *yspec);
 int        yang_spec_dump(yang_stmt *yspec, int debuglevel);
 int        yang_mounts_print(FILE *f, yang_stmt *ymounts);
+int        yang_identity_derived(yang_stmt *ybaseid, const char *module, const char *id);
 int        if_feature(yang_stmt *yspec, char *module, char *feature);
 int        ys_populate(yang_stmt *ys, void *arg);
 int        ys_populate2(yang_stmt *ys, void *arg);
@@ -348,6 +367,10 @@ int        yang_type_cache_get2(yang_stmt *ytype, yang_stmt **resolved, int *opt
                                 cvec **cvv, cvec *patterns, cvec *regexps, uint8_t *fraction);
 int        yang_type_cache_set2(yang_stmt *ys, yang_stmt *resolved, int options, cvec *cvv,
                                 cvec *patterns, uint8_t fraction, int rxmode, cvec *regexps);
+void      *yang_type_cache_validator_get(yang_stmt *ytype);
+int        yang_type_cache_validator_set(yang_stmt *ytype, void *yv);
+void      *yang_type_cache_enummap_get(yang_stmt *ytype);
+int        yang_type_cache_enummap_set(yang_stmt *ytype, void *map);
 yang_stmt *yang_anydata_add(yang_stmt *yp, char *name);
 int        yang_extension_value(yang_stmt *ys, char *name, char *ns, int *exist, char **value);
 int        yang_sort_subelements(yang_stmt *ys);
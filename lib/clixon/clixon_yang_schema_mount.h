@@ -67,5 +67,7 @@ int yang_schema_yanglib_mount_parse(clixon_handle h, cxobj *xt, cxobj *xyanglib,
 int yang_schema_yanglib_get_mount_parse(clixon_handle h, cxobj *xt);
 int yang_schema_get_child(clixon_handle h, cxobj *x1, cxobj *x1c, yang_stmt **yc);
 int yang_schema_yspec_rm(clixon_handle h, cxobj *xmnt);
+int yang_schema_mount_refs(yang_stmt *yspec);
+int yang_schema_mount_gc(clixon_handle h, int *nfreed);
 
 #endif  /* _CLIXON_YANG_SCHEMA_MOUNT_H_ */
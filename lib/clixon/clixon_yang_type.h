@@ -56,11 +56,17 @@ typedef struct yang_type_cache yang_type_cache;
  * Prototypes
  */
 int        ys_resolve_type(yang_stmt *ys, void *arg);
+int        ys_resolve_type_restore(clixon_handle h, yang_stmt *ytype, yang_stmt *resolved,
+                                   int options, cvec *cvv, cvec *patterns, uint8_t fraction);
 int        yang2cv_type(char *ytype, enum cv_type *cv_type);
 char      *cv2yang_type(enum cv_type cv_type);
 yang_stmt *yang_find_identity(yang_stmt *ys, char *identity);
 yang_stmt *yang_find_identity_nsc(yang_stmt *yspec, char *identity, cvec *nsc);
 int        ys_cv_validate(clixon_handle h, cg_var *cv, yang_stmt *ys, yang_stmt **ysub, char **reason);
+int        yang_type_validator_free(void *arg);
+int        yang_enum_map_free(void *arg);
+int        yang_enum_name2val(yang_stmt *ytype, const char *name, yang_stmt **ys, int64_t *val);
+int        yang_enum_val2name(yang_stmt *ytype, int64_t val, yang_stmt **ys);
 int        clicon_type2cv(char *type, char *rtype, yang_stmt *ys, enum cv_type *cvtype);
 int        yang_type_get(yang_stmt *ys, char **otype, yang_stmt **restype,
                          int *options, cvec **cvv,
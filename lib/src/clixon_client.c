@@ -864,6 +864,86 @@ clixon_client_get_uint64(clixon_client_handle  ch,
     return retval;
 }
 
+/*! Client-api apply an ordered batch of edits to candidate, all or nothing
+ *
+ * Send all edits in one clixon-lib edit-batch rpc instead of one edit-config per edit.
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  n         Number of edits
+ * @param[in]  ops       Vector of n operations, eg "merge", "delete", or NULL for merge
+ * @param[in]  configs   Vector of n XML strings with config to edit, content of <config>
+ * @retval     0         OK
+ * @retval    -1         Error, no edit is applied
+ * @code
+ *   const char *ops[] = {NULL, "delete"};
+ *   const char *configs[] = {"<x xmlns=\"urn:example\"><y>1</y></x>",
+ *                            "<x xmlns=\"urn:example\"><z>2</z></x>"};
+ *   if (clixon_client_edit_batch(ch, 2, ops, configs) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clixon_client_edit_batch(clixon_client_handle ch,
+                         int                  n,
+                         const char         **ops,
+                         const char         **configs)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    cxobj                       *xret = NULL;
+    cxobj                       *xd;
+    cbuf                        *msg = NULL;
+    cbuf                        *msgret = NULL;
+    int                          eof = 0;
+    int                          i;
+
+    clixon_debug(CLIXON_DBG_DEFAULT, "n:%d", n);
+    if ((msg = cbuf_new()) == NULL){
+        clixon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    if ((msgret = cbuf_new()) == NULL){
+        clixon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(msg, "<rpc xmlns=\"%s\" %s>"
+            "<edit-batch xmlns=\"%s\">",
+            NETCONF_BASE_NAMESPACE,
+            NETCONF_MESSAGE_ID_ATTR,
+            CLIXON_LIB_NS);
+    for (i=0; i<n; i++){
+        cprintf(msg, "<edit><edit-id>%d</edit-id>", i);
+        if (ops && ops[i])
+            cprintf(msg, "<operation>%s</operation>", ops[i]);
+        cprintf(msg, "<config>%s</config></edit>", configs[i]);
+    }
+    cprintf(msg, "</edit-batch></rpc>");
+    if (clixon_rpc10(cch->cch_socket, cch->cch_descr, msg, msgret, &eof) < 0)
+        goto done;
+    if (eof){
+        close(cch->cch_socket);
+        cch->cch_socket = -1;
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if (clixon_xml_parse_string(cbuf_get(msgret), YB_NONE, NULL, &xret, NULL) < 0)
+        goto done;
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL){
+        xd = xml_parent(xd); /* point to rpc-reply */
+        clixon_err_netconf(cch->cch_h, OE_NETCONF, 0, xd, "Edit batch");
+        goto done;
+    }
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_DEFAULT, "retval:%d", retval);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        cbuf_free(msg);
+    if (msgret)
+        cbuf_free(msgret);
+    return retval;
+}
+
 /* Access functions */
 /*! Client-api get uint64
  *
@@ -86,6 +86,9 @@
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
 
+/* Last datastore generation, see xmldb_generation_get */
+static uint64_t _xmldb_generation = 0;
+
 /*! Get xml database element including id, xml cache, empty on startup and dirty bit
  *
  * @param[in]  h    Clixon handle
@@ -121,6 +124,7 @@ clicon_db_elmnt_set(clixon_handle h,
 {
     clicon_hash_t  *cdat = clicon_db_elmnt(h);
 
+    de->de_gen = ++_xmldb_generation;
     if (clicon_hash_add(cdat, db, de, sizeof(*de))==NULL)
         return -1;
     return 0;
@@ -271,6 +275,7 @@ xmldb_disconnect(clixon_handle h)
                 xml_free(de->de_xml);
                 de->de_xml = NULL;
             }
+            de->de_gen = ++_xmldb_generation;
         }
     retval = 0;
  done:
@@ -605,6 +610,7 @@ xmldb_clear(clixon_handle h,
             xml_free(xt);
             de->de_xml = NULL;
         }
+        de->de_gen = ++_xmldb_generation;
         de->de_modified = 0;
         de->de_id = 0;
         memset(&de->de_tv, 0, sizeof(struct timeval));
@@ -702,6 +708,7 @@ xmldb_create(clixon_handle h,
             xml_free(xt);
             de->de_xml = NULL;
         }
+        de->de_gen = ++_xmldb_generation;
     }
     if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
         if (check_create_multidir(h, db) < 0)
@@ -809,6 +816,27 @@ xmldb_modified_set(clixon_handle h,
     return 0;
 }
 
+/*! Get generation of datastore
+ *
+ * The generation is changed whenever the datastore element is set or its cache is
+ * cleared, ie when its content may have changed. It can be used to check that data
+ * derived from a datastore is still valid.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @retval     gen   Generation
+ * @retval     0     Datastore does not exist
+ */
+uint64_t
+xmldb_generation_get(clixon_handle h,
+                     const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    return de->de_gen;
+}
+
 /*! Get empty flag from datastore (the datastore was empty ON LOAD)
  *
  * @param[in]  h     Clixon handle
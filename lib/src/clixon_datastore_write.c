@@ -100,6 +100,28 @@ struct xmldb_multi_write_arg {
     enum format_enum  mw_format;
 };
 
+/* Undo entry of a batch modification: copy of base child as it was before modification
+ * The base nodes are located by the path of modification nodes since the base tree
+ * changes, and modification trees do not.
+ * @see xmldb_put_batch
+ */
+struct xmldb_undo {
+    cxobj *xu_x1t;  /* Top of modification tree */
+    cxobj *xu_x1p;  /* Modification node locating base parent */
+    cxobj *xu_x1c;  /* Modification child locating base node it may add, or NULL */
+    cxobj *xu_x0c;  /* Copy of base child, or of base parent if xu_all, or NULL */
+    int    xu_all;  /* All children of base parent are copied */
+};
+
+/* Undo log of a batch modification
+ * @see xmldb_put_batch
+ */
+struct xmldb_undo_log {
+    struct xmldb_undo *ul_vec;
+    int                ul_len;
+    int                ul_max;
+};
+
 /*! Given an attribute name and its expected namespace, find its value
  * 
  * An attribute may have a prefix(or NULL). The routine finds the associated
@@ -1359,6 +1381,141 @@ xml_mark_cache_dirty(cxobj *x,
     return 2;
 }
 
+/*! Get datastore cache of db for modification, read it from file if not cached
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  db        running or candidate
+ * @param[in]  yspec     Top-level yang spec
+ * @param[out] dep       Datastore element, or NULL if not in cache
+ * @param[out] x0p       Base xml tree
+ * @param[out] firsttime Set if x0 was read from file and is not yet in cache
+ * @param[out] xerr      Error xml tree if read fails
+ * @retval     1         OK
+ * @retval     0         Failed, xerr may be set
+ * @retval    -1         Error
+ */
+static int
+xmldb_put_cache(clixon_handle h,
+                const char   *db,
+                yang_stmt    *yspec,
+                db_elmnt    **dep,
+                cxobj       **x0p,
+                int          *firsttime,
+                cxobj       **xerr)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    cxobj    *x0 = NULL;
+    int       ret;
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
+        x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
+    }
+    /* If there is no xml x0 tree (in cache), then read it from file */
+    if (x0 == NULL){
+        (*firsttime)++; /* to avoid leakage on error, see fail from text_modify */
+        /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0, de, NULL, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        /* Add default global values (see also xmldb_populate) */
+        if (xml_global_defaults(h, x0, NULL, "/", yspec, 0) < 0)
+            goto done;
+        /* Add default recursive values */
+        if (xml_default_recurse(x0, 0, 0) < 0)
+            goto done;
+    }
+    if (strcmp(xml_name(x0), DATASTORE_TOP_SYMBOL) !=0 ||
+        xml_flag(x0, XML_FLAG_TOP) == 0){
+        clixon_err(OE_XML, 0, "Top-level symbol is %s, expected \"%s\"",
+                   xml_name(x0), DATASTORE_TOP_SYMBOL);
+        goto done;
+    }
+    *dep = de;
+    *x0p = x0;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Post-process a modified datastore cache and write it back to cache and file
+ *
+ * Prune, mark, add defaults, write back to cache and to file unless volatile
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     running or candidate
+ * @param[in]  de     Datastore element, or NULL if not in cache
+ * @param[in]  x0     Modified base xml tree
+ * @param[in]  yspec  Top-level yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xmldb_put_commit(clixon_handle h,
+                 const char   *db,
+                 db_elmnt     *de,
+                 cxobj        *x0,
+                 yang_stmt    *yspec)
+{
+    int      retval = -1;
+    db_elmnt de0 = {0,};
+
+    /* Remove NONE nodes if all subs recursively are also NONE */
+    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
+        goto done;
+    /* Mark ancestor if any changes to children. */
+    if (xml_apply(x0, CX_ELMNT, xml_mark_added_ancestors, (void*)(XML_FLAG_ADD|XML_FLAG_DEL)) < 0)
+        goto done;
+    /* Mark changed xml as cache dirty */
+    if (xml_apply(x0, CX_ELMNT, xml_mark_cache_dirty, NULL) < 0)
+        goto done;
+    /* Remove empty non-presence containers recursively.
+     */
+    if (xml_default_nopresence(x0, 3, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+        goto done;
+    /* Complete defaults
+     */
+    if (xml_global_defaults(h, x0, NULL, "/", yspec, 0) < 0)
+        goto done;
+    /* Add default recursive values */
+    if (xml_default_recurse(x0, 0, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+        goto done;
+#ifdef XML_DEFAULT_WHEN_TWICE
+    /* Defaults a second time for when statements that depend on defaults that have not yet been evaluated
+     */
+    if (xml_default_recurse(x0, 0, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+        goto done;
+#endif
+    /* Write back to datastore cache if first time */
+    if (de != NULL)
+        de0 = *de;
+    if (de0.de_xml == NULL)
+        de0.de_xml = x0;
+    de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
+    clicon_db_elmnt_set(h, db, &de0);
+    /* Write cache to file unless volatile (ie stop syncing to store) */
+    if (xmldb_volatile_get(h, db) == 0){
+        if (xmldb_write_cache2file(h, db) < 0)
+            goto done;
+        /* Clear flags from previous steps + dirty */
+        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                      (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE|XML_FLAG_CACHE_DIRTY)) < 0)
+            goto done;
+    }
+    else {
+        /* Clear flags from previous steps */
+        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                      (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE)) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Modify database given an xml tree and an operation
  *
  * @param[in]  h      CLICON handle
@@ -1383,6 +1540,7 @@ xml_mark_cache_dirty(cxobj *x,
  * @endcode
  * @note if xret is non-null, it may contain error message
  * @note x1 may change as a side-effect (eg operation attributes are stripped)
+ * @see xmldb_put_batch  for several modifications
  */
 int
 xmldb_put(clixon_handle       h,
@@ -1396,11 +1554,9 @@ xmldb_put(clixon_handle       h,
     yang_stmt  *yspec;
     cxobj      *x0 = NULL;
     db_elmnt   *de = NULL;
-    db_elmnt    de0 = {0,};
     int         ret;
     cxobj      *xnacm = NULL;
     int         permit = 0; /* nacm permit all */
-    cvec       *nsc = NULL; /* nacm namespace context */
     int         firsttime = 0;
     cxobj      *xerr = NULL;
 
@@ -1418,30 +1574,10 @@ xmldb_put(clixon_handle       h,
                    xml_name(x1), NETCONF_INPUT_CONFIG);
         goto done;
     }
-    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
-        x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
-    }
-    /* If there is no xml x0 tree (in cache), then read it from file */
-    if (x0 == NULL){
-        firsttime++; /* to avoid leakage on error, see fail from text_modify */
-        /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0, de, NULL, &xerr)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-        /* Add default global values (see also xmldb_populate) */
-        if (xml_global_defaults(h, x0, nsc, "/", yspec, 0) < 0)
-            goto done;
-        /* Add default recursive values */
-        if (xml_default_recurse(x0, 0, 0) < 0)
-            goto done;
-    }
-    if (strcmp(xml_name(x0), DATASTORE_TOP_SYMBOL) !=0 ||
-        xml_flag(x0, XML_FLAG_TOP) == 0){
-        clixon_err(OE_XML, 0, "Top-level symbol is %s, expected \"%s\"",
-                   xml_name(x0), DATASTORE_TOP_SYMBOL);
+    if ((ret = xmldb_put_cache(h, db, yspec, &de, &x0, &firsttime, &xerr)) < 0)
         goto done;
-    }
+    if (ret == 0)
+        goto fail;
     /* Here x0 looks like: <config>...</config> */
     xnacm = clicon_nacm_cache(h);
     permit = (xnacm==NULL);
@@ -1462,61 +1598,471 @@ xmldb_put(clixon_handle       h,
         }
         goto fail;
     }
-    /* Remove NONE nodes if all subs recursively are also NONE */
-    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
-        goto done;
-    /* Mark ancestor if any changes to children. */
-    if (xml_apply(x0, CX_ELMNT, xml_mark_added_ancestors, (void*)(XML_FLAG_ADD|XML_FLAG_DEL)) < 0)
+    if (xmldb_put_commit(h, db, de, x0, yspec) < 0)
         goto done;
-    /* Mark changed xml as cache dirty */
-    if (xml_apply(x0, CX_ELMNT, xml_mark_cache_dirty, NULL) < 0)
+    retval = 1;
+ done:
+    clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Add entry to undo log of a batch modification
+ *
+ * @param[in]  ul   Undo log
+ * @param[in]  x1t  Top of modification tree
+ * @param[in]  x1p  Modification node locating base parent
+ * @param[in]  x1c  Modification child locating base node it may add, or NULL
+ * @param[in]  x0   Base node to copy, or NULL
+ * @param[in]  all  If set, x0 is base parent and all its children are restored
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_undo_add(struct xmldb_undo_log *ul,
+               cxobj                 *x1t,
+               cxobj                 *x1p,
+               cxobj                 *x1c,
+               cxobj                 *x0,
+               int                    all)
+{
+    int                retval = -1;
+    struct xmldb_undo *vec;
+    struct xmldb_undo *xu;
+    cxobj             *xd = NULL;
+    int                max;
+
+    if (x0 && (xd = xml_dup(x0)) == NULL)
         goto done;
-    /* Remove empty non-presence containers recursively.
-     */
-    if (xml_default_nopresence(x0, 3, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+    if (ul->ul_len == ul->ul_max){
+        max = ul->ul_max ? 2*ul->ul_max : 16;
+        if ((vec = realloc(ul->ul_vec, max*sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        ul->ul_vec = vec;
+        ul->ul_max = max;
+    }
+    xu = &ul->ul_vec[ul->ul_len++];
+    xu->xu_x1t = x1t;
+    xu->xu_x1p = x1p;
+    xu->xu_x1c = x1c;
+    xu->xu_x0c = xd;
+    xu->xu_all = all;
+    xd = NULL;
+    retval = 0;
+ done:
+    if (xd)
+        xml_free(xd);
+    return retval;
+}
+
+/*! Free undo log of a batch modification
+ *
+ * @param[in]  ul   Undo log
+ */
+static void
+xmldb_undo_free(struct xmldb_undo_log *ul)
+{
+    int i;
+
+    for (i=0; i<ul->ul_len; i++)
+        if (ul->ul_vec[i].xu_x0c)
+            xml_free(ul->ul_vec[i].xu_x0c);
+    if (ul->ul_vec)
+        free(ul->ul_vec);
+    memset(ul, 0, sizeof(*ul));
+}
+
+/*! Check if modification node has no attributes other than namespace declarations
+ *
+ * Ie no operation or insert attributes that replace or move the base node
+ * @param[in]  x1   Modification node
+ * @retval     1    Yes, only namespace declarations
+ * @retval     0    No
+ */
+static int
+xmldb_undo_plain(cxobj *x1)
+{
+    cxobj *xa = NULL;
+
+    while ((xa = xml_child_each_attr(x1, xa)) != NULL)
+        if (!isxmlns(xa) && strcmp(xml_name(xa), "objectcreate") != 0)
+            return 0;
+    return 1;
+}
+
+/*! Check if base node matching a modification node can be found after modification
+ *
+ * Not so for nodes without yang, leaf-lists without value, lists without keys, and
+ * ordered-by user, where position is not given by the node itself.
+ * @param[in]  x1   Modification node
+ * @retval     1    Yes, base node can be found with match_base_child
+ * @retval     0    No
+ */
+static int
+xmldb_undo_locatable(cxobj *x1)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    cvec         *cvk;
+    cg_var       *cvi;
+
+    if ((y = xml_spec(x1)) == NULL)
+        return 0;
+    keyword = yang_keyword_get(y);
+    if (keyword != Y_LIST && keyword != Y_LEAF_LIST)
+        return 1;
+    if (yang_find(y, Y_ORDERED_BY, "user") != NULL)
+        return 0;
+    if (keyword == Y_LEAF_LIST)
+        return xml_body(x1) != NULL;
+    cvk = yang_cvec_get(y);
+    cvi = NULL;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL)
+        if (xml_find_type(x1, NULL, cv_string_get(cvi), CX_ELMNT) == NULL)
+            return 0;
+    return 1;
+}
+
+/*! Log base children that a modification may change, descend where only their children change
+ *
+ * Same matching as text_modify, but copies base nodes before modification instead of
+ * modifying them. Nodes purged by other cases of a choice are also copied.
+ * @param[in]  ul   Undo log
+ * @param[in]  x0   Base node
+ * @param[in]  x1t  Top of modification tree
+ * @param[in]  x1   Modification node matching x0
+ * @param[in]  op   Operation of x1
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see text_modify
+ */
+static int
+xmldb_undo_modify(struct xmldb_undo_log *ul,
+                  cxobj                 *x0,
+                  cxobj                 *x1t,
+                  cxobj                 *x1,
+                  enum operation_type    op)
+{
+    int           retval = -1;
+    cxobj        *x1c;
+    cxobj        *x0c;
+    cxobj        *x0s;
+    yang_stmt    *yc;
+    yang_stmt    *ycase;
+    yang_stmt    *ychoice;
+    yang_stmt    *y0c;
+    yang_stmt    *y0case;
+    yang_stmt    *y0choice;
+    enum rfc_6020 keyword;
+
+    /* If any child cannot be found after modification, copy all */
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL)
+        if (!xmldb_undo_locatable(x1c))
+            break;
+    if (x1c != NULL){
+        if (xmldb_undo_add(ul, x1t, x1, NULL, x0, 1) < 0)
+            goto done;
+        goto ok;
+    }
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        yc = xml_spec(x1c);
+        /* Nodes of other cases may be purged, see choice_other_match */
+        if (yang_choice_case_get(yc, &ycase, &ychoice)){
+            x0s = NULL;
+            while ((x0s = xml_child_each(x0, x0s, CX_ELMNT)) != NULL) {
+                if ((y0c = xml_spec(x0s)) == NULL ||
+                    yang_choice_case_get(y0c, &y0case, &y0choice) == 0)
+                    continue;
+                if (choice_is_other(y0c, y0case, y0choice, yc, ycase, ychoice) == 1)
+                    if (xmldb_undo_add(ul, x1t, x1, NULL, x0s, 0) < 0)
+                        goto done;
+            }
+        }
+        x0c = NULL;
+        if (match_base_child(x0, x1c, yc, &x0c) < 0)
+            goto done;
+        keyword = yang_keyword_get(yc);
+        if (x0c != NULL && xml_spec(x0c) == yc &&
+            (op == OP_MERGE || op == OP_NONE) &&
+            xmldb_undo_plain(x1c) &&
+            (keyword == Y_CONTAINER || keyword == Y_LIST) &&
+            yang_flag_get(yc, YANG_FLAG_MTPOINT_POTENTIAL) == 0 &&
+            xml_flag(x1c, XML_FLAG_ANYDATA) == 0){
+            if (xmldb_undo_modify(ul, x0c, x1t, x1c, op) < 0)
+                goto done;
+        }
+        else if (xmldb_undo_add(ul, x1t, x1, x1c, x0c, 0) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Log base tree nodes that a top-level modification may change
+ *
+ * @param[in]  ul   Undo log
+ * @param[in]  x0t  Base tree
+ * @param[in]  x1t  Modification tree
+ * @param[in]  op   Top-level operation
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see text_modify_top
+ */
+static int
+xmldb_undo_top(struct xmldb_undo_log *ul,
+               cxobj                 *x0t,
+               cxobj                 *x1t,
+               enum operation_type    op)
+{
+    /* Top-level replace or delete of all, copy all */
+    if (!xmldb_undo_plain(x1t) ||
+        op == OP_REPLACE || op == OP_DELETE ||
+        (op == OP_REMOVE && xml_child_nr_type(x1t, CX_ELMNT) == 0))
+        return xmldb_undo_add(ul, x1t, x1t, NULL, x0t, 1);
+    return xmldb_undo_modify(ul, x0t, x1t, x1t, op);
+}
+
+/*! Get base node located by the path of a modification node
+ *
+ * A path node is added if missing, ie it was an empty non-presence container removed
+ * after modification.
+ * @param[in]  x0t  Base tree
+ * @param[in]  x1t  Top of modification tree
+ * @param[in]  x1   Modification node
+ * @param[out] x0p  Base node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_undo_node(cxobj  *x0t,
+                cxobj  *x1t,
+                cxobj  *x1,
+                cxobj **x0p)
+{
+    int        retval = -1;
+    cxobj     *x0par = NULL;
+    cxobj     *x0 = NULL;
+    cxobj     *xnew = NULL;
+    cxobj     *xk;
+    yang_stmt *y;
+    cvec      *cvk;
+    cg_var    *cvi;
+
+    if (x1 == x1t){
+        *x0p = x0t;
+        goto ok;
+    }
+    if (xmldb_undo_node(x0t, x1t, xml_parent(x1), &x0par) < 0)
         goto done;
-    /* Complete defaults
-     */
-    if (xml_global_defaults(h, x0, nsc, "/", yspec, 0) < 0)
+    y = xml_spec(x1);
+    if (match_base_child(x0par, x1, y, &x0) < 0)
         goto done;
-    /* Add default recursive values */
-    if (xml_default_recurse(x0, 0, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+    if (x0 == NULL){
+        if ((xnew = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_spec_set(xnew, y);
+        if (assign_namespace_element(x1, xnew, x0par) < 0)
+            goto done;
+        if (yang_keyword_get(y) == Y_LIST){
+            cvk = yang_cvec_get(y);
+            cvi = NULL;
+            while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+                if ((xk = xml_find_type(x1, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                    continue;
+                if ((xk = xml_dup(xk)) == NULL)
+                    goto done;
+                if (xml_addsub(xnew, xk) < 0){
+                    xml_free(xk);
+                    goto done;
+                }
+            }
+        }
+        if (xml_insert(x0par, xnew, INS_LAST, NULL, NULL) < 0)
+            goto done;
+        x0 = xnew;
+        xnew = NULL;
+    }
+    *x0p = x0;
+ ok:
+    retval = 0;
+ done:
+    if (xnew)
+        xml_free(xnew);
+    return retval;
+}
+
+/*! Restore base tree as it was before a batch modification using its undo log
+ *
+ * Entries are restored in reverse order: each copy is re-inserted in place of the
+ * node matching it, and of the node its modification node may have added.
+ * @param[in]  ul   Undo log. Restored copies are moved to the base tree
+ * @param[in]  x0t  Base tree
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_undo_restore(struct xmldb_undo_log *ul,
+                   cxobj                 *x0t)
+{
+    int                retval = -1;
+    struct xmldb_undo *xu;
+    cxobj             *x0p;
+    cxobj             *x0c;
+    int                i;
+    int                j;
+    int                flags = XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE;
+
+    for (i=ul->ul_len-1; i>=0; i--){
+        xu = &ul->ul_vec[i];
+        if (xmldb_undo_node(x0t, xu->xu_x1t, xu->xu_x1p, &x0p) < 0)
+            goto done;
+        if (xu->xu_all){
+            for (j=xml_child_nr(x0p)-1; j>=0; j--){
+                x0c = xml_child_i(x0p, j);
+                if (xml_type(x0c) == CX_ELMNT && xml_purge(x0c) < 0)
+                    goto done;
+            }
+            while ((x0c = xml_child_i_type(xu->xu_x0c, 0, CX_ELMNT)) != NULL)
+                if (xml_addsub(x0p, x0c) < 0)
+                    goto done;
+        }
+        else {
+            x0c = NULL;
+            if (xu->xu_x1c &&
+                match_base_child(x0p, xu->xu_x1c, xml_spec(xu->xu_x1c), &x0c) < 0)
+                goto done;
+            if (x0c && xml_purge(x0c) < 0)
+                goto done;
+            if (xu->xu_x0c){
+                x0c = NULL;
+                if (match_base_child(x0p, xu->xu_x0c, xml_spec(xu->xu_x0c), &x0c) < 0)
+                    goto done;
+                if (x0c && xml_purge(x0c) < 0)
+                    goto done;
+                if (xml_insert(x0p, xu->xu_x0c, INS_LAST, NULL, NULL) < 0)
+                    goto done;
+                xu->xu_x0c = NULL;
+            }
+        }
+        xml_flag_reset(x0p, flags);
+        if (xml_apply_ancestor(x0p, (xml_applyfn_t*)xml_flag_reset, (void*)(intptr_t)flags) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Modify database given a batch of xml trees and operations, all or nothing
+ *
+ * Same as calling xmldb_put for each modification in order, but pruning, defaults and
+ * writing to file are made once for the whole batch.
+ * If one modification fails, or on error, the datastore cache is restored as it was before
+ * the batch. Before each modification, the base subtrees it may change are copied to an
+ * undo log, so that restoring is proportional to the batch, not to the datastore.
+ * Exceptions are top-level replace or delete, and ordered-by user lists, where all
+ * children of the parent are copied.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       running or candidate
+ * @param[in]  opvec    Vector of top-level operations, one per modification
+ * @param[in]  x1vec    Vector of xml-trees. Top-level symbol of each is dummy <config>
+ * @param[in]  n        Number of modifications
+ * @param[in]  username User name for nacm
+ * @param[out] cbret    Initialized cligen buffer. On exit contains XML if retval == 0
+ * @param[out] failed   Index of failed modification if retval == 0
+ * @retval     1        OK
+ * @retval     0        Failed, cbret contains error xml message, db is unchanged
+ * @retval    -1        Error
+ * @see xmldb_put
+ */
+int
+xmldb_put_batch(clixon_handle        h,
+                const char          *db,
+                enum operation_type *opvec,
+                cxobj              **x1vec,
+                int                  n,
+                char                *username,
+                cbuf                *cbret,
+                int                 *failed)
+{
+    int         retval = -1;
+    yang_stmt  *yspec;
+    cxobj      *x0 = NULL;
+    db_elmnt   *de = NULL;
+    db_elmnt    de0;
+    int         ret;
+    cxobj      *xnacm = NULL;
+    int         permit = 0; /* nacm permit all */
+    int         firsttime = 0;
+    cxobj      *xerr = NULL;
+    int         i;
+    struct xmldb_undo_log ul = {0,};
+
+    clixon_debug(CLIXON_DBG_DATASTORE|CLIXON_DBG_DETAIL, "db %s n:%d", db, n);
+    if (cbret == NULL){
+        clixon_err(OE_XML, EINVAL, "cbret is NULL");
         goto done;
-#ifdef XML_DEFAULT_WHEN_TWICE
-    /* Defaults a second time for when statements that depend on defaults that have not yet been evaluated
-     */
-    if (xml_default_recurse(x0, 0, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
-#endif
-    /* Write back to datastore cache if first time */
-    if (de != NULL)
-        de0 = *de;
-    if (de0.de_xml == NULL)
-        de0.de_xml = x0;
-    de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
-    clicon_db_elmnt_set(h, db, &de0);
-    /* Write cache to file unless volatile (ie stop syncing to store) */
-    if (xmldb_volatile_get(h, db) == 0){
-        if (xmldb_write_cache2file(h, db) < 0)
-            goto done;
-        /* Clear flags from previous steps + dirty */
-        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-                      (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE|XML_FLAG_CACHE_DIRTY)) < 0)
+    }
+    for (i=0; i<n; i++){
+        if (strcmp(xml_name(x1vec[i]), NETCONF_INPUT_CONFIG) != 0){
+            clixon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"%s\"",
+                       xml_name(x1vec[i]), NETCONF_INPUT_CONFIG);
             goto done;
+        }
     }
-    else {
-        /* Clear flags from previous steps */
-        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-                      (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE)) < 0)
+    if ((ret = xmldb_put_cache(h, db, yspec, &de, &x0, &firsttime, &xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    xnacm = clicon_nacm_cache(h);
+    permit = (xnacm==NULL);
+    for (i=0; i<n; i++){
+        clicon_data_del(h, "objectexisted");
+        /* Log what the modification may change for restore if a later one fails */
+        if (!firsttime && xmldb_undo_top(&ul, x0, x1vec[i], opvec[i]) < 0)
             goto done;
+        if ((ret = text_modify_top(h, x0, x1vec[i], yspec, opvec[i], username, xnacm, permit, cbret)) < 0)
+            goto done;
+        if (ret == 0){
+            *failed = i;
+            goto fail;
+        }
     }
+    if (xmldb_put_commit(h, db, de, x0, yspec) < 0)
+        goto done;
+    x0 = NULL; /* In cache */
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    /* Failed or error: restore cache as it was before the batch.
+     * If not in cache before, or if restore fails, remove it to be read from file */
+    if (x0 && (firsttime || xmldb_undo_restore(&ul, x0) < 0)){
+        if (!firsttime)
+            clixon_log(h, LOG_WARNING, "%s: Restore of %s failed, cache removed", __func__, db);
+        if ((de = clicon_db_elmnt_get(h, db)) != NULL && de->de_xml == x0){
+            de0 = *de;
+            de0.de_xml = NULL;
+            clicon_db_elmnt_set(h, db, &de0);
+        }
+        xml_free(x0);
+    }
+    xmldb_undo_free(&ul);
     if (xerr)
         xml_free(xerr);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
@@ -54,6 +54,9 @@
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -76,20 +79,39 @@
  */
 #define EVENT_STRLEN 32
 
+/*! Max number of ready file descriptors returned by one epoll_wait */
+#define EVENT_EPOLL_MAX 64
+
 /*
  * Types
  */
 struct event_data{
     struct event_data          *e_next;                 /* Next in list */
     int                       (*e_fn)(int, void*);      /* Callback function */
-    enum {EVENT_FD, EVENT_TIME} e_type;                 /* Type of event */
+    enum {EVENT_FD, EVENT_TIME, EVENT_DEFER} e_type;    /* Type of event */
     int                         e_fd;                   /* File descriptor */
+    short                       e_events;               /* Requested poll events: POLLIN or POLLOUT */
+    int                         e_prio;                 /* Prioritized, epoll only */
+    int                         e_hidx;                 /* Index in timer heap */
+    uint64_t                    e_seq;                  /* Timer registration order */
+    struct event_data          *e_hnext;                /* Next timer in same hash bucket */
+    struct event_data          *e_inext;                /* Next timer in same id hash bucket */
     struct timeval              e_time;                 /* Timeout */
     void                       *e_arg;                  /* Function argument */
     char                        e_descr[EVENT_STRLEN]; /* String for debugging */
     struct pollfd              *e_pollfd;               /* Pointer to pull struct */
 };
 
+#ifdef HAVE_SYS_EPOLL_H
+/*! Epoll registrations of one file descriptor, indexed by fd in _ep_fds
+ */
+struct event_fd{
+    struct event_data          *ef_list;                /* Callbacks of fd */
+    uint32_t                    ef_events;              /* Events registered in epoll */
+    uint32_t                    ef_gen;                 /* Incremented when fd is removed from epoll */
+};
+#endif
+
 /*
  * Internal variables
  * Consider use handle variables instead of global, but needs API changes
@@ -109,14 +131,39 @@ static int _ee_nr = 0;
 static struct event_data *_ee_prio = NULL;
 static int _ee_prio_nr = 0;
 
-/* Timer event handlers */
-static struct event_data *_ee_timers = NULL;
+/* Timer event handlers: binary min-heap on time, hash on function and argument, and
+ * hash on timer id (registration order) */
+static struct event_data **_et_heap = NULL;
+static int _et_heap_nr = 0;
+static int _et_heap_len = 0;
+static struct event_data **_et_hash = NULL;
+static struct event_data **_et_ihash = NULL;
+static int _et_hash_len = 0;    /* Power of two, of both hashes */
+static uint64_t _et_seq = 1;    /* Next timer registration order and id, 0 is no timer */
+
+/* Deferred callbacks in registration order, called after file events of a loop */
+static struct event_data *_ed = NULL;
 
 /* Set if element in _ee is deleted (clixon_event_unreg_fd). Check in _ee loops
  * XXX: algorithm has flaw: which _ee is unregged?
  */
 static int _ee_unreg = 0;
 
+#ifdef HAVE_SYS_EPOLL_H
+/* Use epoll instead of poll, see CLICON_EVENT_EPOLL */
+static int _event_epoll = 0;
+
+/* Epoll file descriptor */
+static int _ep_fd = -1;
+
+/* Registrations per file descriptor, indexed by fd */
+static struct event_fd *_ep_fds = NULL;
+static int _ep_fds_len = 0;
+
+/* Number of prioritized file registrations */
+static int _ep_prio_nr = 0;
+#endif
+
 /* If set (eg by signal handler) exit select loop on next run and return 0 */
 static int _clicon_exit = 0;
 
@@ -187,6 +234,122 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/*! Update epoll registration of a file descriptor from its callbacks
+ *
+ * @param[in]  fd   File descriptor
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+event_epoll_update(int fd)
+{
+    struct event_fd    *ef = &_ep_fds[fd];
+    struct event_data  *e;
+    struct epoll_event  ev = {0,};
+    uint32_t            events = 0;
+    int                 op;
+
+    for (e = ef->ef_list; e; e = e->e_next){
+        if (e->e_events & POLLIN)
+            events |= EPOLLIN;
+        if (e->e_events & POLLOUT)
+            events |= EPOLLOUT;
+    }
+    if (events == ef->ef_events)
+        return 0;
+    if (events == 0){
+        op = EPOLL_CTL_DEL;
+        ef->ef_gen++; /* Ready events of a later fd with same number are not this fd */
+    }
+    else if (ef->ef_events == 0)
+        op = EPOLL_CTL_ADD;
+    else
+        op = EPOLL_CTL_MOD;
+    ev.events = events;
+    ev.data.u64 = ((uint64_t)ef->ef_gen << 32) | (uint32_t)fd;
+    if (epoll_ctl(_ep_fd, op, fd, &ev) < 0){
+        /* A closed fd is already removed from epoll */
+        if (op != EPOLL_CTL_DEL || (errno != EBADF && errno != ENOENT)){
+            clixon_err(OE_EVENTS, errno, "epoll_ctl");
+            return -1;
+        }
+    }
+    ef->ef_events = events;
+    return 0;
+}
+
+/*! Add file event to epoll registrations
+ *
+ * @param[in]  e    File event, the fd of e is registered
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+event_epoll_add(struct event_data *e)
+{
+    struct event_fd *ef;
+    int              len;
+
+    if (e->e_fd < 0){
+        clixon_err(OE_EVENTS, EINVAL, "Invalid fd: %d", e->e_fd);
+        return -1;
+    }
+    if (e->e_fd >= _ep_fds_len){
+        len = _ep_fds_len ? _ep_fds_len : 64;
+        while (len <= e->e_fd)
+            len *= 2;
+        if ((ef = realloc(_ep_fds, len*sizeof(*ef))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        memset(&ef[_ep_fds_len], 0, (len - _ep_fds_len)*sizeof(*ef));
+        _ep_fds = ef;
+        _ep_fds_len = len;
+    }
+    ef = &_ep_fds[e->e_fd];
+    e->e_next = ef->ef_list;
+    ef->ef_list = e;
+    if (e->e_prio)
+        _ep_prio_nr++;
+    return event_epoll_update(e->e_fd);
+}
+
+/*! Remove file event from epoll registrations
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function of event
+ * @retval     1    Removed
+ * @retval     0    Not found
+ * @retval    -1    Error
+ */
+static int
+event_epoll_del(int   fd,
+                int (*fn)(int, void*))
+{
+    struct event_data  *e;
+    struct event_data **e_prev;
+
+    if (fd < 0 || fd >= _ep_fds_len)
+        return 0;
+    e_prev = &_ep_fds[fd].ef_list;
+    for (e = *e_prev; e; e = e->e_next){
+        if (fn == e->e_fn)
+            break;
+        e_prev = &e->e_next;
+    }
+    if (e == NULL)
+        return 0;
+    *e_prev = e->e_next;
+    if (e->e_prio)
+        _ep_prio_nr--;
+    free(e);
+    if (event_epoll_update(fd) < 0)
+        return -1;
+    return 1;
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * Prio is primitive, non-preemptive as follows:
@@ -228,6 +391,16 @@ clixon_event_reg_fd_prio(int   fd,
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_FD;
+    e->e_events = POLLIN;
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll){
+        e->e_prio = prio;
+        if (event_epoll_add(e) < 0)
+            return -1;
+        clixon_debug(CLIXON_DBG_EVENT, "registering %s", e->e_descr);
+        return 0;
+    }
+#endif
     if (prio){
         e->e_next = _ee_prio;
         _ee_prio = e;
@@ -255,6 +428,59 @@ clixon_event_reg_fd(int   fd,
     return clixon_event_reg_fd_prio(fd, fn, arg, str, 0);
 }
 
+/*! Register a callback function to be called when a file descriptor is writable
+ *
+ * Used for non-blocking output, eg to write the rest of a queued message that could
+ * not be written at once. The callback is called on every event loop as long as the
+ * file descriptor is writable, so unregister it when there is nothing to write.
+ * Write events are not prioritized.
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is writable
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @note Unregister with clixon_event_unreg_fd, fn must differ from an input callback
+ *       of the same fd
+ * @see clixon_event_reg_fd
+ */
+int
+clixon_event_reg_fd_write(int   fd,
+                          int (*fn)(int, void*),
+                          void *arg,
+                          char *str)
+{
+    struct event_data *e;
+
+    if (_event_select){
+        return clixon_event_select_reg_fd_write(fd, fn, arg, str);
+    }
+    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
+        clixon_err(OE_EVENTS, errno, "malloc");
+        return -1;
+    }
+    memset(e, 0, sizeof(struct event_data));
+    strncpy(e->e_descr, str, EVENT_STRLEN-1);
+    e->e_fd = fd;
+    e->e_fn = fn;
+    e->e_arg = arg;
+    e->e_type = EVENT_FD;
+    e->e_events = POLLOUT;
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll){
+        if (event_epoll_add(e) < 0)
+            return -1;
+        clixon_debug(CLIXON_DBG_EVENT, "registering write %s", e->e_descr);
+        return 0;
+    }
+#endif
+    e->e_next = _ee;
+    _ee = e;
+    _ee_nr++;
+    clixon_debug(CLIXON_DBG_EVENT, "registering write %s", e->e_descr);
+    return 0;
+}
+
 /*! Deregister a file descriptor callback
  *
  * @param[in]  s   File descriptor
@@ -277,6 +503,13 @@ clixon_event_unreg_fd(int   s,
     if (_event_select){
         return clixon_event_select_unreg_fd(s, fn);
     }
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll){
+        if ((found = event_epoll_del(s, fn)) < 0)
+            return -1;
+        return found?0:-1;
+    }
+#endif
     /* First try prioritized */
     e_prev = &_ee_prio;
     for (e = _ee_prio; e; e = e->e_next){
@@ -307,43 +540,226 @@ clixon_event_unreg_fd(int   s,
     return found?0:-1;
 }
 
-/*! Call a callback function at an absolute time
+/*! Hash bucket of timer with function and argument
+ */
+static int
+event_timer_hash(int (*fn)(int, void*),
+                 void *arg)
+{
+    uint64_t h;
+
+    h = ((uint64_t)(uintptr_t)fn ^ (uint64_t)(uintptr_t)arg) * 0x9E3779B97F4A7C15ULL;
+    return (int)(h >> 32) & (_et_hash_len - 1);
+}
+
+/*! Timer a expires before timer b, or at same time and registered before b
+ */
+static inline int
+event_timer_before(struct event_data *a,
+                   struct event_data *b)
+{
+    if (timercmp(&a->e_time, &b->e_time, !=))
+        return timercmp(&a->e_time, &b->e_time, <);
+    return a->e_seq < b->e_seq;
+}
+
+/*! Move timer at heap index i up or down to its place in heap
+ */
+static void
+event_timer_sift(int i)
+{
+    struct event_data *e = _et_heap[i];
+    int                j;
+
+    while (i > 0 && event_timer_before(e, _et_heap[(i-1)/2])){
+        j = (i-1)/2;
+        _et_heap[i] = _et_heap[j];
+        _et_heap[i]->e_hidx = i;
+        i = j;
+    }
+    while ((j = 2*i+1) < _et_heap_nr){
+        if (j+1 < _et_heap_nr && event_timer_before(_et_heap[j+1], _et_heap[j]))
+            j++;
+        if (!event_timer_before(_et_heap[j], e))
+            break;
+        _et_heap[i] = _et_heap[j];
+        _et_heap[i]->e_hidx = i;
+        i = j;
+    }
+    _et_heap[i] = e;
+    e->e_hidx = i;
+}
+
+/*! Add timer to heap and hashes, and set its id
+ *
+ * @param[in]  e    Timer event
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+event_timer_add(struct event_data *e)
+{
+    struct event_data **vec;
+    struct event_data  *e1;
+    int                 len;
+    int                 i;
+    int                 h;
+
+    if (_et_heap_nr == _et_heap_len){
+        len = _et_heap_len ? 2*_et_heap_len : 16;
+        if ((vec = realloc(_et_heap, len*sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        _et_heap = vec;
+        _et_heap_len = len;
+    }
+    if (_et_heap_nr >= _et_hash_len){ /* Rehash */
+        len = _et_hash_len ? 2*_et_hash_len : 16;
+        if ((vec = calloc(2*len, sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        if (_et_hash)
+            free(_et_hash);
+        _et_hash = vec;
+        _et_ihash = vec + len;
+        _et_hash_len = len;
+        for (i=0; i<_et_heap_nr; i++){
+            e1 = _et_heap[i];
+            h = event_timer_hash(e1->e_fn, e1->e_arg);
+            e1->e_hnext = _et_hash[h];
+            _et_hash[h] = e1;
+            h = e1->e_seq & (_et_hash_len - 1);
+            e1->e_inext = _et_ihash[h];
+            _et_ihash[h] = e1;
+        }
+    }
+    e->e_seq = _et_seq++;
+    h = event_timer_hash(e->e_fn, e->e_arg);
+    e->e_hnext = _et_hash[h];
+    _et_hash[h] = e;
+    h = e->e_seq & (_et_hash_len - 1);
+    e->e_inext = _et_ihash[h];
+    _et_ihash[h] = e;
+    _et_heap[_et_heap_nr] = e;
+    e->e_hidx = _et_heap_nr++;
+    event_timer_sift(e->e_hidx);
+    return 0;
+}
+
+/*! Remove timer from heap and hashes, does not free it
+ *
+ * @param[in]  e    Timer event
+ */
+static void
+event_timer_remove(struct event_data *e)
+{
+    struct event_data **e_prev;
+    int                 i = e->e_hidx;
+
+    e_prev = &_et_hash[event_timer_hash(e->e_fn, e->e_arg)];
+    while (*e_prev != e)
+        e_prev = &(*e_prev)->e_hnext;
+    *e_prev = e->e_hnext;
+    e->e_hnext = NULL;
+    e_prev = &_et_ihash[e->e_seq & (_et_hash_len - 1)];
+    while (*e_prev != e)
+        e_prev = &(*e_prev)->e_inext;
+    *e_prev = e->e_inext;
+    e->e_inext = NULL;
+    if (i != --_et_heap_nr){
+        _et_heap[i] = _et_heap[_et_heap_nr];
+        _et_heap[i]->e_hidx = i;
+        event_timer_sift(i);
+    }
+}
+
+/*! Poll timeout in ms until first timer expires
+ *
+ * @retval    -1   No timers, wait forever
+ * @retval    ms   Milliseconds to first timer, 0 if expired
+ */
+static int
+event_timer_timeout(void)
+{
+    struct timeval t0;
+    struct timeval t;
+    int64_t        tdiff;
+
+    if (_et_heap_nr == 0)
+        return -1;
+    gettimeofday(&t0, NULL);
+    timersub(&_et_heap[0]->e_time, &t0, &t);
+    tdiff = t.tv_sec * 1000 + t.tv_usec / 1000;
+    if (tdiff < 0)
+        return 0;
+    if (tdiff > INT32_MAX)
+        return INT32_MAX;
+    if (tdiff == 0 && timerisset(&t) && t.tv_sec >= 0) /* Less than one ms: round up */
+        return 1;
+    return (int)tdiff;
+}
+
+/*! Call all expired timers
  *
+ * Called on every event loop, not only on poll timeout, so that busy sockets do not
+ * starve timers.
+ * Timers registered by the callbacks are not called until the next loop, even if they
+ * have already expired.
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+static int
+event_timers_expire(void)
+{
+    struct event_data *e;
+    struct timeval     now;
+    uint64_t           seq = _et_seq;
+
+    gettimeofday(&now, NULL);
+    while (_et_heap_nr > 0){
+        e = _et_heap[0];
+        if (timercmp(&now, &e->e_time, <) || e->e_seq >= seq)
+            break;
+        event_timer_remove(e);
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_descr);
+        if ((*e->e_fn)(0, e->e_arg) < 0) {
+            free(e);
+            return -1;
+        }
+        free(e);
+    }
+    return 0;
+}
+
+/*! Call a callback function at an absolute time, and get an id of the timer
+ *
+ * The id is unique during the lifetime of the process and may be used to cancel the
+ * timer with clixon_event_unreg_timeout_id. This allows several timers with the same
+ * function and argument.
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
  * @param[in]  fn  Function to call at time t
  * @param[in]  arg Argument to function fn
  * @param[in]  str Describing string for logging
+ * @param[out] id  Id of timer, larger than 0 (if not NULL)
  * @retval     0   OK
  * @retval    -1   Error
- * @code
- * int fn(int d, void *arg){
- *   struct timeval t, t1;
- *   gettimeofday(&t, NULL);
- *   t1.tv_sec = 1; t1.tv_usec = 0;
- *   timeradd(&t, &t1, &t);
- *   clixon_event_reg_timeout(t, fn, NULL, "call every second");
- * }
- * @endcode
- *
- * @note  The timestamp is an absolute timestamp, not relative.
- * @note  The callback is not periodic, you need to make a new registration for each period, see example.
- * @note  The first argument to fn is a dummy, just to get the same signature as for file-descriptor callbacks.
- * @see clixon_event_reg_fd
- * @see clixon_event_unreg_timeout
+ * @see clixon_event_reg_timeout
+ * @see clixon_event_unreg_timeout_id
  */
 int
-clixon_event_reg_timeout(struct timeval t,
-                         int          (*fn)(int, void*),
-                         void          *arg,
-                         char          *str)
+clixon_event_reg_timeout_id(struct timeval t,
+                            int          (*fn)(int, void*),
+                            void          *arg,
+                            char          *str,
+                            uint64_t      *id)
 {
     int                 retval = -1;
     struct event_data  *e;
-    struct event_data  *e1;
-    struct event_data **e_prev;
 
     if (_event_select){
-        return clixon_event_select_reg_timeout(t, fn, arg, str);
+        return clixon_event_select_reg_timeout(t, fn, arg, str, id);
     }
     if (str == NULL || fn == NULL){
         clixon_err(OE_CFG, EINVAL, "str or fn is NULL");
@@ -359,21 +775,52 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &_ee_timers;
-    for (e1=_ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
+    if (event_timer_add(e) < 0){
+        free(e);
+        goto done;
     }
-    e->e_next = e1;
-    *e_prev = e;
+    if (id)
+        *id = e->e_seq;
     clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "%s", str);
     retval = 0;
  done:
     return retval;
 }
 
+/*! Call a callback function at an absolute time
+ *
+ * @param[in]  t   Absolute (not relative!) timestamp when callback is called
+ * @param[in]  fn  Function to call at time t
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see clixon_event_reg_timeout_id  to get an id of the timer for cancellation
+ * @code
+ * int fn(int d, void *arg){
+ *   struct timeval t, t1;
+ *   gettimeofday(&t, NULL);
+ *   t1.tv_sec = 1; t1.tv_usec = 0;
+ *   timeradd(&t, &t1, &t);
+ *   clixon_event_reg_timeout(t, fn, NULL, "call every second");
+ * }
+ * @endcode
+ *
+ * @note  The timestamp is an absolute timestamp, not relative.
+ * @note  The callback is not periodic, you need to make a new registration for each period, see example.
+ * @note  The first argument to fn is a dummy, just to get the same signature as for file-descriptor callbacks.
+ * @see clixon_event_reg_fd
+ * @see clixon_event_unreg_timeout
+ */
+int
+clixon_event_reg_timeout(struct timeval t,
+                         int          (*fn)(int, void*),
+                         void          *arg,
+                         char          *str)
+{
+    return clixon_event_reg_timeout_id(t, fn, arg, str, NULL);
+}
+
 /*! Deregister a timeout callback as previosly registered by clixon_event_reg_timeout()
  *
  * Note: deregister when exactly function and function arguments match, not time. So you
@@ -391,23 +838,149 @@ clixon_event_unreg_timeout(int (*fn)(int, void*),
                            void *arg)
 {
     struct event_data  *e;
-    int                 found = 0;
-    struct event_data **e_prev;
 
     if (_event_select){
         return clixon_event_select_unreg_timeout(fn, arg);
     }
-    e_prev = &_ee_timers;
-    for (e = _ee_timers; e; e = e->e_next){
-        if (fn == e->e_fn && arg == e->e_arg) {
-            found++;
-            *e_prev = e->e_next;
-            free(e);
+    if (_et_hash_len == 0)
+        return -1;
+    for (e = _et_hash[event_timer_hash(fn, arg)]; e; e = e->e_hnext)
+        if (fn == e->e_fn && arg == e->e_arg)
+            break;
+    if (e == NULL)
+        return -1;
+    event_timer_remove(e);
+    free(e);
+    return 0;
+}
+
+/*! Cancel a timer with an id as returned by clixon_event_reg_timeout_id()
+ *
+ * It is safe to cancel a timer that has already been called or cancelled
+ * @param[in]  id   Id of timer
+ * @retval     0    OK, timeout unregistered
+ * @retval    -1    OK, but timeout not found
+ * @see clixon_event_reg_timeout_id
+ */
+int
+clixon_event_unreg_timeout_id(uint64_t id)
+{
+    struct event_data  *e;
+
+    if (_event_select){
+        return clixon_event_select_unreg_timeout_id(id);
+    }
+    if (_et_hash_len == 0)
+        return -1;
+    for (e = _et_ihash[id & (_et_hash_len - 1)]; e; e = e->e_inext)
+        if (e->e_seq == id)
             break;
+    if (e == NULL)
+        return -1;
+    event_timer_remove(e);
+    free(e);
+    return 0;
+}
+
+/*! Call a callback function once after the file events of the event loop
+ *
+ * The callback is called after the file descriptor callbacks of the current loop, or
+ * of the next loop if registered outside of them, eg in a timer callback.
+ * The event loop does not block while deferred callbacks are pending.
+ * Use this for work to be made when ready input has been read, instead of a timer.
+ * Callbacks registered by a deferred callback are called in the next loop.
+ * @param[in]  fn  Function to call
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see clixon_event_unreg_defer
+ */
+int
+clixon_event_reg_defer(int  (*fn)(int, void*),
+                       void  *arg,
+                       char  *str)
+{
+    struct event_data  *e;
+    struct event_data **ep;
+
+    if (_event_select){
+        return clixon_event_select_reg_defer(fn, arg, str);
+    }
+    if (str == NULL || fn == NULL){
+        clixon_err(OE_CFG, EINVAL, "str or fn is NULL");
+        return -1;
+    }
+    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
+        clixon_err(OE_EVENTS, errno, "malloc");
+        return -1;
+    }
+    memset(e, 0, sizeof(struct event_data));
+    strncpy(e->e_descr, str, EVENT_STRLEN-1);
+    e->e_fn = fn;
+    e->e_arg = arg;
+    e->e_type = EVENT_DEFER;
+    for (ep = &_ed; *ep; ep = &(*ep)->e_next);
+    *ep = e;
+    clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "%s", str);
+    return 0;
+}
+
+/*! Deregister a deferred callback as previously registered by clixon_event_reg_defer()
+ *
+ * @param[in]  fn   Function
+ * @param[in]  arg  Argument to function fn
+ * @retval     0    OK, callback unregistered
+ * @retval    -1    OK, but callback not found
+ * @see clixon_event_reg_defer
+ */
+int
+clixon_event_unreg_defer(int (*fn)(int, void*),
+                         void *arg)
+{
+    struct event_data  *e;
+    struct event_data **ep;
+
+    if (_event_select){
+        return clixon_event_select_unreg_defer(fn, arg);
+    }
+    for (ep = &_ed; (e = *ep) != NULL; ep = &e->e_next)
+        if (fn == e->e_fn && arg == e->e_arg)
+            break;
+    if (e == NULL)
+        return -1;
+    *ep = e->e_next;
+    free(e);
+    return 0;
+}
+
+/*! Call all deferred callbacks registered before this call
+ *
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+static int
+event_defer_run(void)
+{
+    struct event_data *e;
+    struct event_data *e_next;
+
+    e_next = _ed;
+    _ed = NULL;
+    while ((e = e_next) != NULL){
+        e_next = e->e_next;
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "defer: %s", e->e_descr);
+        if ((*e->e_fn)(0, e->e_arg) < 0){
+            free(e);
+            while ((e = e_next) != NULL){
+                e_next = e->e_next;
+                free(e);
+            }
+            return -1;
         }
-        e_prev = &e->e_next;
+        free(e);
     }
-    return found?0:-1;
+    return 0;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -500,7 +1073,8 @@ event_handle_fds(struct event_data *ee,
         if ((pfd = e->e_pollfd) == NULL) /* Could be added after poll regitsration */
             continue;
         if (pfd->revents != 0) { /* returned events */
-            if (pfd->revents & POLLIN || pfd->revents & POLLHUP) {
+            if (pfd->revents & POLLIN || pfd->revents & POLLHUP ||
+                (e->e_events & POLLOUT && pfd->revents & (POLLOUT|POLLERR))) {
                 clixon_debug(CLIXON_DBG_EVENT, "fd %s", e->e_descr);
                 _ee_unreg = 0;
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0) {
@@ -531,15 +1105,131 @@ event_handle_fds(struct event_data *ee,
     return retval;
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/*! Call callbacks of one ready epoll file descriptor
+ *
+ * The input callback is called on input, hangup or error, the write callback when
+ * the fd is writable, or on hangup or error.
+ * Callbacks may unregister callbacks, or close the fd, so the registrations are
+ * looked up again after each call.
+ * @param[in]  ev    Ready epoll event
+ * @param[in]  prio  Call prioritized (1) or unprioritized (0) callbacks
+ * @retval     1     Callback called
+ * @retval     0     No callback called
+ * @retval    -1     Error
+ */
+static int
+event_epoll_dispatch(struct epoll_event *ev,
+                     int                 prio)
+{
+    int                fd = (int)(ev->data.u64 & 0xffffffff);
+    uint32_t           gen = (uint32_t)(ev->data.u64 >> 32);
+    struct event_data *e;
+    short              events;
+    int                called = 0;
+    int                i;
+
+    for (i=0; i<2; i++){
+        events = i==0 ? POLLIN : POLLOUT;
+        if (i == 0 && (ev->events & (EPOLLIN|EPOLLHUP|EPOLLERR)) == 0)
+            continue;
+        if (i == 1 && (ev->events & (EPOLLOUT|EPOLLHUP|EPOLLERR)) == 0)
+            continue;
+        if (fd >= _ep_fds_len || _ep_fds[fd].ef_gen != gen)
+            break; /* fd removed by earlier callback */
+        for (e = _ep_fds[fd].ef_list; e; e = e->e_next)
+            if (e->e_events & events && e->e_prio == prio)
+                break;
+        if (e == NULL)
+            continue;
+        clixon_debug(CLIXON_DBG_EVENT, "fd %s", e->e_descr);
+        called++;
+        if ((*e->e_fn)(e->e_fd, e->e_arg) < 0) {
+            clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_descr);
+            return -1;
+        }
+    }
+    return called?1:0;
+}
+
+/*! Dispatch events using epoll
+ *
+ * Registrations are kept in the kernel between loops, and only ready file
+ * descriptors are returned. Prioritized callbacks of ready file descriptors are
+ * called first. As with poll, after an unprioritized callback a new loop is made
+ * if there are prioritized registrations.
+ * @param[in] h  Clixon handle
+ * @retval    0  OK
+ * @retval   -1  Error
+ * @see clixon_event_loop
+ */
+static int
+event_epoll_loop(clixon_handle h)
+{
+    int                retval = -1;
+    struct epoll_event evs[EVENT_EPOLL_MAX];
+    int                timeout;
+    int                n;
+    int                i;
+    int                ret;
+
+    while (clixon_exit_get() != 1) {
+        timeout = _ed ? 0 : event_timer_timeout();
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "epoll timeout: %d", timeout);
+        n = epoll_wait(_ep_fd, evs, EVENT_EPOLL_MAX, timeout);
+        if (n == -1) {
+            if (errno == EINTR){
+                if (clixon_exit_get() == 1){
+                    clixon_err(OE_EVENTS, errno, "epoll_wait");
+                    goto ok;
+                }
+                if ((ret = event_handle_eintr(h)) < 0)
+                    goto done;
+                if (ret == 0){ // exit
+                    retval = 0;
+                    goto done;
+                }
+                continue;
+            }
+            clixon_err(OE_EVENTS, errno, "epoll_wait");
+            goto done;
+        }
+        if (event_timers_expire() < 0)
+            goto done;
+        /* Prio files */
+        if (_ep_prio_nr > 0)
+            for (i=0; i<n; i++)
+                if (event_epoll_dispatch(&evs[i], 1) < 0)
+                    goto done;
+        /* Unprio files */
+        for (i=0; i<n; i++){
+            if ((ret = event_epoll_dispatch(&evs[i], 0)) < 0)
+                goto done;
+            if (ret == 1 && _ep_prio_nr > 0) /* Prioritized exists, break unprio fairness */
+                break;
+        }
+        if (event_defer_run() < 0)
+            goto done;
+        clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
+    }
+ ok:
+    if (clixon_exit_get() == 1)
+        retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_EVENT, "retval:%d", retval);
+    return retval;
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
  * @param[in] h  Clixon handle
  * @retval    0  OK
  * @retval   -1  Error: eg select, callback, timer,
- * @note There is an issue with fairness between timeouts and events
- *       Currently a socket that is not read/emptied properly starve timeouts.
- *       One could try to poll the file descriptors after a timeout?
- * TODO: unreg, better prio algorithm
+ * @note All expired timers are called on every loop before file events, so that a
+ *       socket that is not read/emptied properly does not starve timeouts.
+ * @note Deferred callbacks are called on every loop after file events
+ * TODO: better prio algorithm
  */
 int
 clixon_event_loop(clixon_handle h)
@@ -550,9 +1240,6 @@ clixon_event_loop(clixon_handle h)
     struct pollfd     *pfd;
     uint32_t           nfds_max = 0;
     int                nfds = 0;
-    struct timeval     t0;
-    struct timeval     t;
-    int64_t            tdiff;
     int                timeout;
     int                n;
     int                ret;
@@ -560,6 +1247,11 @@ clixon_event_loop(clixon_handle h)
     if (_event_select){
         return clixon_event_select_loop(h);
     }
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll){
+        return event_epoll_loop(h);
+    }
+#endif
     while (clixon_exit_get() != 1) {
         nfds = _ee_prio_nr + _ee_nr;
         if (nfds > nfds_max){
@@ -575,7 +1267,7 @@ clixon_event_loop(clixon_handle h)
             if (e->e_type == EVENT_FD) {
                 pfd = &fds[nfds];
                 pfd->fd = e->e_fd;
-                pfd->events = POLLIN; /* requested event */
+                pfd->events = e->e_events; /* requested event */
                 e->e_pollfd = pfd;
                 clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "register fd prio %s nr:%d",
                              e->e_descr, nfds);
@@ -587,7 +1279,7 @@ clixon_event_loop(clixon_handle h)
             if (e->e_type == EVENT_FD) {
                 pfd = &fds[nfds];
                 pfd->fd = e->e_fd;
-                pfd->events = POLLIN; /* requested event */
+                pfd->events = e->e_events; /* requested event */
                 e->e_pollfd = pfd;
                 clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "register fd %s nr:%d",
                              e->e_descr, nfds);
@@ -598,17 +1290,7 @@ clixon_event_loop(clixon_handle h)
             clixon_err(OE_EVENTS, 0, "File descriptor mismatch");
             goto done;
         }
-        timeout = -1;
-        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout");
-        if (_ee_timers != NULL) {
-            gettimeofday(&t0, NULL);
-            timersub(&_ee_timers->e_time, &t0, &t);
-            tdiff = t.tv_sec * 1000 + t.tv_usec / 1000;
-            if (tdiff < 0)
-                timeout = 0;
-            else
-                timeout = (int)tdiff;
-        }
+        timeout = _ed ? 0 : event_timer_timeout();
         clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "poll timeout: %d", timeout);
         n = poll(fds, nfds, timeout);
         if (n == -1) {
@@ -631,23 +1313,18 @@ clixon_event_loop(clixon_handle h)
                 clixon_err(OE_EVENTS, errno, "poll");
             goto done;
         }
-        if (n == 0) { /* timeout */
-            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "n=0 Timeout");
-            e = _ee_timers;
-            _ee_timers = _ee_timers->e_next;
-            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_descr);
-            if ((*e->e_fn)(0, e->e_arg) < 0) {
-                free(e);
-                goto done;
-            }
-            free(e);
-        }
+        /* All expired timers, also if there are file events */
+        if (event_timers_expire() < 0)
+            goto done;
         /* Prio files */
         if ((ret = event_handle_fds(_ee_prio, 1)) < 0)
             goto done;
         /* Unprio files */
         if ((ret = event_handle_fds(_ee, 0)) < 0)
             goto done;
+        /* Deferred callbacks, after file events */
+        if (event_defer_run() < 0)
+            goto done;
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
   }
  ok:
@@ -665,10 +1342,33 @@ clixon_event_exit(void)
 {
     struct event_data *e;
     struct event_data *e_next;
+#ifdef HAVE_SYS_EPOLL_H
+    int                i;
+#endif
 
     if (_event_select){
         return clixon_event_select_exit();
     }
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll){
+        for (i=0; i<_ep_fds_len; i++){
+            e_next = _ep_fds[i].ef_list;
+            while ((e = e_next) != NULL){
+                e_next = e->e_next;
+                free(e);
+            }
+        }
+        if (_ep_fds)
+            free(_ep_fds);
+        _ep_fds = NULL;
+        _ep_fds_len = 0;
+        _ep_prio_nr = 0;
+        if (_ep_fd != -1)
+            close(_ep_fd);
+        _ep_fd = -1;
+        _event_epoll = 0;
+    }
+#endif
     e_next = _ee_prio;
     while ((e = e_next) != NULL){
         e_next = e->e_next;
@@ -683,22 +1383,70 @@ clixon_event_exit(void)
     }
     _ee = NULL;
 
-    e_next = _ee_timers;
+    while (_et_heap_nr > 0)
+        free(_et_heap[--_et_heap_nr]);
+    if (_et_heap)
+        free(_et_heap);
+    _et_heap = NULL;
+    _et_heap_len = 0;
+    if (_et_hash)
+        free(_et_hash);
+    _et_hash = NULL;
+    _et_ihash = NULL;
+    _et_hash_len = 0;
+    e_next = _ed;
     while ((e = e_next) != NULL){
         e_next = e->e_next;
         free(e);
     }
-    _ee_timers = NULL;
+    _ed = NULL;
     return 0;
 }
 
 /*! Init clixon event handling
  *
- * Set which event handler to use: original select or new poll
+ * Set which event handler to use: original select, poll or epoll
+ * File events registered before init are moved to epoll if epoll is used.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
  */
 int
 clixon_event_init(clixon_handle h)
 {
+#ifdef HAVE_SYS_EPOLL_H
+    struct event_data *e;
+    struct event_data *e_next;
+    int                prio;
+#endif
+
     _event_select = clicon_option_bool(h, "CLICON_EVENT_SELECT");
+    if (!clicon_option_bool(h, "CLICON_EVENT_EPOLL"))
+        return 0;
+#ifdef HAVE_SYS_EPOLL_H
+    if (_event_epoll)
+        return 0;
+    if ((_ep_fd = epoll_create1(EPOLL_CLOEXEC)) < 0){
+        clixon_err(OE_EVENTS, errno, "epoll_create1");
+        return -1;
+    }
+    _event_select = 0;
+    _event_epoll = 1;
+    for (prio=1; prio>=0; prio--){
+        e_next = prio ? _ee_prio : _ee;
+        while ((e = e_next) != NULL){
+            e_next = e->e_next;
+            e->e_prio = prio;
+            if (event_epoll_add(e) < 0)
+                return -1;
+        }
+    }
+    _ee_prio = NULL;
+    _ee_prio_nr = 0;
+    _ee = NULL;
+    _ee_nr = 0;
+#else
+    clixon_log(h, LOG_WARNING, "CLICON_EVENT_EPOLL set but epoll is not supported on this platform");
+#endif
     return 0;
 }
@@ -81,10 +81,12 @@
 struct event_data{
     struct event_data          *e_next;                 /* Next in list */
     int                       (*e_fn)(int, void*);      /* Callback function */
-    enum {EVENT_FD, EVENT_TIME} e_type;                 /* Type of event */
+    enum {EVENT_FD, EVENT_TIME, EVENT_DEFER} e_type;    /* Type of event */
     int                         e_fd;                   /* File descriptor */
     int                         e_prio;                 /* 1: high-prio FD:s only*/
+    int                         e_write;                /* 1: call when writable, not readable */
     struct timeval              e_time;                 /* Timeout */
+    uint64_t                    e_seq;                  /* Timer registration order and id */
     void                       *e_arg;                  /* Function argument */
     char                        e_string[EVENT_STRLEN]; /* String for debugging */
 };
@@ -96,6 +98,12 @@ struct event_data{
 static struct event_data *ee = NULL;
 static struct event_data *ee_timers = NULL;
 
+/* Deferred callbacks in registration order, called after file events of a loop */
+static struct event_data *ee_defer = NULL;
+
+/* Next timer registration order and id, 0 is no timer */
+static uint64_t _ee_seq = 1;
+
 /* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
 static int _ee_unreg = 0;
 
@@ -139,6 +147,26 @@ clixon_event_select_reg_fd_prio(int   fd,
     return 0;
 }
 
+/*! Register a callback function to be called when a file descriptor is writable
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is writable
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @see clixon_event_reg_fd_write
+ */
+int
+clixon_event_select_reg_fd_write(int   fd,
+                                 int (*fn)(int, void*),
+                                 void *arg,
+                                 char *str)
+{
+    if (clixon_event_select_reg_fd_prio(fd, fn, arg, str, 0) < 0)
+        return -1;
+    ee->e_write = 1;
+    return 0;
+}
+
 /*! Deregister a file descriptor callback
  *
  * @param[in]  s   File descriptor
@@ -177,6 +205,7 @@ clixon_event_select_unreg_fd(int   s,
  * @param[in]  fn  Function to call at time t
  * @param[in]  arg Argument to function fn
  * @param[in]  str Describing string for logging
+ * @param[out] id  Id of timer, larger than 0 (if not NULL)
  * @retval     0   OK
  * @retval    -1   Error
  * @code
@@ -199,7 +228,8 @@ int
 clixon_event_select_reg_timeout(struct timeval t, 
                                 int          (*fn)(int, void*),
                                 void          *arg,
-                                char          *str)
+                                char          *str,
+                                uint64_t      *id)
 {
     int                 retval = -1;
     struct event_data  *e;
@@ -220,7 +250,10 @@ clixon_event_select_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
+    e->e_seq = _ee_seq++;
+    if (id)
+        *id = e->e_seq;
+    /* Sort into right place, after timers with same time */
     e_prev = &ee_timers;
     for (e1=ee_timers; e1; e1=e1->e_next){
         if (timercmp(&e->e_time, &e1->e_time, <))
@@ -268,6 +301,146 @@ clixon_event_select_unreg_timeout(int (*fn)(int, void*),
     return found?0:-1;
 }
 
+/*! Cancel a timer with an id as returned by clixon_event_select_reg_timeout()
+ *
+ * @param[in]  id   Id of timer
+ * @retval     0    OK, timeout unregistered
+ * @retval    -1    OK, but timeout not found
+ * @see clixon_event_unreg_timeout_id
+ */
+int
+clixon_event_select_unreg_timeout_id(uint64_t id)
+{
+    struct event_data  *e;
+    struct event_data **e_prev;
+
+    e_prev = &ee_timers;
+    for (e = ee_timers; e; e = e->e_next){
+        if (e->e_seq == id){
+            *e_prev = e->e_next;
+            free(e);
+            return 0;
+        }
+        e_prev = &e->e_next;
+    }
+    return -1;
+}
+
+/*! Call all expired timers
+ *
+ * Timers registered by the callbacks are not called until the next loop, even if they
+ * have already expired.
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+static int
+event_select_timers_expire(void)
+{
+    struct event_data *e;
+    struct timeval     now;
+    uint64_t           seq = _ee_seq;
+
+    gettimeofday(&now, NULL);
+    while ((e = ee_timers) != NULL){
+        if (timercmp(&now, &e->e_time, <) || e->e_seq >= seq)
+            break;
+        ee_timers = e->e_next;
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_string);
+        if ((*e->e_fn)(0, e->e_arg) < 0){
+            free(e);
+            return -1;
+        }
+        free(e);
+    }
+    return 0;
+}
+
+/*! Call a callback function once after the file events of the event loop
+ *
+ * @param[in]  fn  Function to call
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see clixon_event_reg_defer
+ */
+int
+clixon_event_select_reg_defer(int  (*fn)(int, void*),
+                              void  *arg,
+                              char  *str)
+{
+    struct event_data  *e;
+    struct event_data **ep;
+
+    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
+        clixon_err(OE_EVENTS, errno, "malloc");
+        return -1;
+    }
+    memset(e, 0, sizeof(struct event_data));
+    strncpy(e->e_string, str, EVENT_STRLEN-1);
+    e->e_fn = fn;
+    e->e_arg = arg;
+    e->e_type = EVENT_DEFER;
+    for (ep = &ee_defer; *ep; ep = &(*ep)->e_next);
+    *ep = e;
+    clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "%s", str);
+    return 0;
+}
+
+/*! Deregister a deferred callback
+ *
+ * @param[in]  fn   Function
+ * @param[in]  arg  Argument to function fn
+ * @retval     0    OK, callback unregistered
+ * @retval    -1    OK, but callback not found
+ * @see clixon_event_unreg_defer
+ */
+int
+clixon_event_select_unreg_defer(int (*fn)(int, void*),
+                                void *arg)
+{
+    struct event_data  *e;
+    struct event_data **ep;
+
+    for (ep = &ee_defer; (e = *ep) != NULL; ep = &e->e_next)
+        if (fn == e->e_fn && arg == e->e_arg)
+            break;
+    if (e == NULL)
+        return -1;
+    *ep = e->e_next;
+    free(e);
+    return 0;
+}
+
+/*! Call all deferred callbacks registered before this call
+ *
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+static int
+event_select_defer_run(void)
+{
+    struct event_data *e;
+    struct event_data *e_next;
+
+    e_next = ee_defer;
+    ee_defer = NULL;
+    while ((e = e_next) != NULL){
+        e_next = e->e_next;
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "defer: %s", e->e_string);
+        if ((*e->e_fn)(0, e->e_arg) < 0){
+            free(e);
+            while ((e = e_next) != NULL){
+                e_next = e->e_next;
+                free(e);
+            }
+            return -1;
+        }
+        free(e);
+    }
+    return 0;
+}
+
 /*! Poll to see if there is any data available on this file descriptor.
  *
  * @param[in]  fd   File descriptor
@@ -294,9 +467,9 @@ clixon_event_select_poll(int fd)
  * @param[in] h  Clixon handle
  * @retval    0  OK
  * @retval   -1  Error: eg select, callback, timer, 
- * @note There is an issue with fairness between timeouts and events
- *       Currently a socket that is not read/emptied properly starve timeouts.
- *       One could try to poll the file descriptors after a timeout?
+ * @note All expired timers are called on every loop before file events, so that a
+ *       socket that is not read/emptied properly does not starve timeouts.
+ * @note Deferred callbacks are called on every loop after file events
  */
 int
 clixon_event_select_loop(clixon_handle h)
@@ -307,11 +480,13 @@ clixon_event_select_loop(clixon_handle h)
     struct timeval     t0;
     struct timeval     tnull = {0,};
     fd_set             fdset;
+    fd_set             wfdset;
     int                retval = -1;
     struct event_data *e_next;
 
     while (clixon_exit_get() != 1){
         FD_ZERO(&fdset);
+        FD_ZERO(&wfdset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
@@ -320,17 +495,19 @@ clixon_event_select_loop(clixon_handle h)
         }
         for (e=ee; e; e=e->e_next)
             if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+                FD_SET(e->e_fd, e->e_write ? &wfdset : &fdset);
+        if (ee_defer != NULL)
+            n = select(FD_SETSIZE, &fdset, &wfdset, NULL, &tnull);
+        else if (ee_timers != NULL){
             gettimeofday(&t0, NULL);
             timersub(&ee_timers->e_time, &t0, &t);
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull);
+                n = select(FD_SETSIZE, &fdset, &wfdset, NULL, &tnull);
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t);
+                n = select(FD_SETSIZE, &fdset, &wfdset, NULL, &t);
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = select(FD_SETSIZE, &fdset, &wfdset, NULL, NULL);
         if (clixon_exit_get() == 1){
             break;
         }
@@ -369,23 +546,16 @@ clixon_event_select_loop(clixon_handle h)
                 clixon_err(OE_EVENTS, errno, "select");
             goto err;
         }
-        if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
-            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_string);
-            if ((*e->e_fn)(0, e->e_arg) < 0){
-                free(e);
-                goto err;
-            }
-            free(e);
-        }
+        /* All expired timers, also if there are file events */
+        if (event_select_timers_expire() < 0)
+            goto err;
         _ee_unreg = 0;
         if (clicon_option_bool(h, "CLICON_SOCK_PRIO")){
             for (e=ee; e; e=e_next) {
                 if (clixon_exit_get() == 1)
                     break;
                 e_next = e->e_next;
-                if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio){
+                if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_write ? &wfdset : &fdset) && e->e_prio){
                     clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s prio:%d", e->e_string, e->e_prio);
                     if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                         clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
@@ -405,7 +575,7 @@ clixon_event_select_loop(clixon_handle h)
             if (clixon_exit_get() == 1)
                 break;
             e_next = e->e_next;
-            if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio==0){
+            if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_write ? &wfdset : &fdset) && e->e_prio==0){
                 clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s", e->e_string);
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                     clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
@@ -419,6 +589,9 @@ clixon_event_select_loop(clixon_handle h)
                     break;
             }
         }
+        /* Deferred callbacks, after file events */
+        if (event_select_defer_run() < 0)
+            goto err;
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
         continue;
       err:
@@ -449,5 +622,11 @@ clixon_event_select_exit(void)
         free(e);
     }
     ee_timers = NULL;
+    e_next = ee_defer;
+    while ((e = e_next) != NULL){
+        e_next = e->e_next;
+        free(e);
+    }
+    ee_defer = NULL;
     return 0;
 }
@@ -445,3 +445,33 @@ clixon_ptr2ptr_add(map_ptr2ptr **mptabp,
  done:
     return retval;
 }
+
+/*! Remove pointer pair from mptab map
+ *
+ * @param[in]  mptab  Ptr to ptr map
+ * @param[in]  ptr0   Input pointer
+ * @retval     ptr1   Output pointer of removed pair
+ * @retval     NULL   Not found, nothing done
+ * @note The map vector is not shrunk
+ */
+void*
+clixon_ptr2ptr_del(map_ptr2ptr *mptab,
+                   size_t      *lenp,
+                   void        *ptr0)
+{
+    struct map_ptr2ptr *mp;
+    size_t              len;
+    void               *ptr1;
+
+    len = *lenp;
+    if (mptab == NULL || len == 0)
+        return NULL;
+    if (ptr2ptr_search(mptab, ptr0, 0, len, len, 1, &mp) == 0)
+        return NULL;
+    ptr1 = mp->mp_p1;
+    if (mp < &mptab[len-1])
+        memmove(mp, &mp[1], (void*)&mptab[len-1]-(void*)mp);
+    memset(&mptab[len-1], 0, sizeof(*mp));
+    *lenp = len-1;
+    return ptr1;
+}
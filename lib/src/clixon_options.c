@@ -123,6 +123,7 @@ static const map_str2int nacm_credentials_map[] = {
 static const map_str2int yang_regexp_map[] = {
     {"posix",               REGEXP_POSIX},
     {"libxml2",             REGEXP_LIBXML2},
+    {"pcre2",               REGEXP_PCRE2},
     {NULL,                 -1}
 };
 
@@ -221,6 +222,12 @@ clicon_option_dump(clixon_handle h,
             continue;
         clixon_debug(dbglevel, "%s =\t \"%s\"", xml_name(x), xml_body(x));
     }
+    x = NULL;
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "CLICON_BACKEND_SCHED_CLASS") != 0)
+            continue;
+        clixon_debug(dbglevel, "%s =\t \"%s\"", xml_name(x), xml_body(x));
+    }
    retval = 0;
  done:
     if (keys)
@@ -381,7 +388,8 @@ merge_control_xml(clixon_handle h,
         /* List options for configure options that are lists or leaf-lists: append to main */
         if (strcmp(name,"CLICON_FEATURE") == 0 ||
             strcmp(name,"CLICON_YANG_DIR") == 0 ||
-            strcmp(name,"CLICON_SNMP_MIB") == 0){
+            strcmp(name,"CLICON_SNMP_MIB") == 0 ||
+            strcmp(name,"CLICON_BACKEND_SCHED_CLASS") == 0){
             if ((x = xml_dup(xec)) == NULL)
                 goto done;
             if (xml_addsub(xt, x) < 0)
@@ -536,6 +544,8 @@ parse_configfile(clixon_handle  h,
             continue;
         if (strcmp(name,"CLICON_SNMP_MIB")==0)
             continue;
+        if (strcmp(name,"CLICON_BACKEND_SCHED_CLASS")==0)
+            continue;
         if (clicon_hash_add(copt,
                             name,
                             body,
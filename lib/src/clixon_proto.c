@@ -52,6 +52,7 @@
 #include <syslog.h>
 #include <signal.h>
 #include <ctype.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/socket.h>
@@ -710,6 +711,171 @@ clicon_rpc(int                sock,
     return retval;
 }
 
+/*! Send several NETCONF messages without waiting for replies, and receive all replies
+ *
+ * Messages are sent without waiting for replies, so that only one round-trip is made
+ * instead of one per message. The backend processes messages of a session in order and
+ * replies in the same order, so that reply i is the reply of message i.
+ * The socket is non-blocking during the call and replies are read while messages are
+ * still sent. Otherwise both sides may block in write when the socket buffers are full,
+ * or when the backend suspends input from a client that does not read its output.
+ * Input may contain several replies, or a partial reply, per read.
+ * @param[in]  sock   Socket / file descriptor
+ * @param[in]  descr  Description of peer for logging
+ * @param[in]  msgs   Vector of clixon msg data structures
+ * @param[in]  n      Number of messages
+ * @param[out] rets   Vector of n replies as strings. Free each with free()
+ * @param[out] eof    Set if eof encountered, replies may then be missing (NULL)
+ * @retval     0      OK (check eof)
+ * @retval    -1      Error
+ * @see clicon_rpc  for a single message
+ */
+int
+clicon_rpc_pipeline(int                 sock,
+                    const char         *descr,
+                    struct clicon_msg **msgs,
+                    int                 n,
+                    char              **rets,
+                    int                *eof)
+{
+    int            retval = -1;
+    cbuf          *cbsend = NULL;
+    cbuf          *cb = NULL;
+    cbuf          *cbrcv = NULL;
+    unsigned char  buf[BUFSIZ];
+    unsigned char *p;
+    size_t         plen;
+    ssize_t        len;
+    size_t         sent = 0;
+    struct pollfd  pfd;
+    int            flags = -1;
+    int            frame_state = 0;
+    size_t         frame_size = 0;
+    int            eom = 0;
+    int            i;
+
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "n:%d", n);
+    *eof = 0;
+    if ((cbsend = cbuf_new()) == NULL ||
+        (cb = cbuf_new()) == NULL ||
+        (cbrcv = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<n; i++){
+        cbuf_reset(cb);
+        cprintf(cb, "%s", msgs[i]->op_body);
+        if (netconf_output_encap(NETCONF_SSH_CHUNKED, cb) < 0)
+            goto done;
+        if (cbuf_append_buf(cbsend, cbuf_get(cb), cbuf_len(cb)) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    if (clixon_debug_detail())
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send [%s] %s", descr?descr:"", cbuf_get(cbsend));
+    else
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%s] %s", descr?descr:"", cbuf_get(cbsend));
+    if ((flags = fcntl(sock, F_GETFL, 0)) < 0 ||
+        fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0){
+        clixon_err(OE_UNIX, errno, "fcntl");
+        flags = -1;
+        goto done;
+    }
+    i = 0;
+    while (*eof == 0 && i < n){
+        pfd.fd = sock;
+        pfd.events = POLLIN;
+        if (sent < cbuf_len(cbsend))
+            pfd.events |= POLLOUT;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, -1) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        if (pfd.revents & POLLOUT){
+            if ((len = write(sock, cbuf_get(cbsend) + sent, cbuf_len(cbsend) - sent)) < 0){
+                switch (errno){
+                case EINTR:
+                case EAGAIN:
+                    break;
+                case ECONNRESET: /* Connection reset by peer */
+                case EPIPE:      /* Backend shutdown */
+                    *eof = 1;
+                    break;
+                default:
+                    clixon_err(OE_UNIX, errno, "write");
+                    goto done;
+                }
+            }
+            else
+                sent += len;
+        }
+        if ((pfd.revents & (POLLIN|POLLHUP|POLLERR)) == 0)
+            continue;
+        if ((len = read(sock, buf, sizeof(buf))) < 0){
+            switch (errno){
+            case EINTR:
+            case EAGAIN:
+                continue;
+            case ECONNRESET: /* Connection reset by peer */
+                len = 0;
+                break;
+            default:
+                clixon_err(OE_UNIX, errno, "read");
+                goto done;
+            }
+        }
+        if (len == 0){
+            *eof = 1;
+            break;
+        }
+        p = buf;
+        plen = len;
+        while (!(*eof) && plen > 0 && i < n){
+            if (netconf_input_msg2(&p, &plen,
+                                   cbrcv,
+                                   NETCONF_SSH_CHUNKED,
+                                   &frame_state,
+                                   &frame_size,
+                                   &eom) < 0){
+                /* Errors from input are only framing errors, non-fatal, return eof */
+                *eof = 1;
+                break;
+            }
+            if (eom == 0)
+                continue;
+            if (clixon_debug_detail())
+                clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Recv [%s]: %s", descr?descr:"", cbuf_get(cbrcv));
+            else
+                clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Recv [%s]: %s", descr?descr:"", cbuf_get(cbrcv));
+            if ((rets[i++] = strdup(cbuf_get(cbrcv))) == NULL){
+                clixon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            cbuf_reset(cbrcv);
+        }
+    }
+    if (*eof)
+        clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: EOF", descr?descr:"");
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (flags != -1 && fcntl(sock, F_SETFL, flags) < 0){
+        clixon_err(OE_UNIX, errno, "fcntl");
+        retval = -1;
+    }
+    if (cbsend)
+        cbuf_free(cbsend);
+    if (cb)
+        cbuf_free(cb);
+    if (cbrcv)
+        cbuf_free(cbrcv);
+    return retval;
+}
+
 /*! Send a clicon_msg message as reply to a clicon rpc request
  *
  * @param[in]  s       Socket to communicate with client
@@ -262,6 +262,80 @@ clicon_rpc_msg(clixon_handle      h,
     return retval;
 }
 
+/*! Send several internal netconf rpcs to backend without waiting, and collect all replies
+ *
+ * All requests are written to the (cached) backend socket without waiting for replies,
+ * and the n replies are read as they arrive, see clicon_rpc_pipeline. The backend
+ * processes the requests of a session in order, so the reply of request i is returned
+ * in xrets[i].
+ * Use this for bulk operations, eg many small edits, where a round-trip per rpc dominates.
+ * @param[in]   h      Clixon handle
+ * @param[in]   msgs   Vector of n encoded messages. Deallocate each with free
+ * @param[in]   n      Number of messages
+ * @param[out]  xrets  Vector of n return values from backend as xml trees. Free each w xml_free
+ * @retval      0      OK
+ * @retval     -1      Error
+ * @note Unlike clicon_rpc_msg there is no reconnect on close, since some requests may
+ *       already have been processed
+ * @see clicon_rpc_msg  for a single rpc
+ */
+int
+clicon_rpc_msg_pipeline(clixon_handle       h,
+                        struct clicon_msg **msgs,
+                        int                 n,
+                        cxobj             **xrets)
+{
+    int     retval = -1;
+    char  **rets = NULL;
+    int     s = -1;
+    int     eof = 0;
+    int     i;
+
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "n:%d", n);
+    for (i=0; i<n; i++)
+        xrets[i] = NULL;
+    if ((rets = calloc(n, sizeof(char*))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if (clicon_rpc_pipeline(s, clicon_sock_str(h), msgs, n, rets, &eof) < 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        goto done;
+    }
+    if (eof){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    for (i=0; i<n; i++){
+        if (rets[i] &&
+            clixon_xml_parse_string(rets[i], YB_NONE, NULL, &xrets[i], NULL) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (rets){
+        for (i=0; i<n; i++){
+            if (rets[i])
+                free(rets[i]);
+            if (retval < 0 && xrets[i]){
+                xml_free(xrets[i]);
+                xrets[i] = NULL;
+            }
+        }
+        free(rets);
+    }
+    return retval;
+}
+
 /*! Send internal netconf rpc from client to backend and return a persistent socket
  *
  * @param[in]   h      Clixon handle
@@ -1074,8 +1148,9 @@ clicon_rpc_get2(clixon_handle   h,
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
     yspec = clicon_dbspec_yang(h);
-    /* Send xml error back: first check error, then ok */
-    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
+    /* Send xml error back: first check error, then ok
+     * Warnings, eg of timed out state callbacks, are not errors, the data is returned */
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error[error-severity='error']")) != NULL)
         xd = xml_parent(xd); /* point to rpc-reply */
     else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
         if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
@@ -1246,8 +1321,9 @@ clicon_rpc_get_pageable_list(clixon_handle   h,
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
     yspec = clicon_dbspec_yang(h);
-    /* Send xml error back: first check error, then ok */
-    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
+    /* Send xml error back: first check error, then ok
+     * Warnings, eg of timed out state callbacks, are not errors, the data is returned */
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error[error-severity='error']")) != NULL)
         xd = xml_parent(xd); /* point to rpc-reply */
     else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
         if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
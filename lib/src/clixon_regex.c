@@ -37,7 +37,7 @@
   *
   * Clixon regular expression code for Yang type patterns following XML Schema
   * regex. 
-  * Two modes: libxml2 and posix-translation
+  * Three modes: libxml2, posix-translation and pcre2-translation
  * @see http://www.w3.org/TR/2004/REC-xmlschema-2-20041028
  */
 
@@ -53,6 +53,11 @@
 #include <regex.h>
 #include <ctype.h>
 
+#ifdef HAVE_LIBPCRE2_8
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
 #include <cligen/cligen.h>
 
 /* clixon */
@@ -67,6 +72,39 @@
 #include "clixon_options.h"
 #include "clixon_regex.h"
 
+/*
+ * Constants
+ */
+/*! Number of entries in the match memo of a pattern, see regex_exec_memo */
+#define REGEX_MEMO_SIZE   32
+
+/*! Longest string stored in the match memo */
+#define REGEX_MEMO_STRLEN 128
+
+/*
+ * Types
+ */
+/*! One memoized match result */
+struct regex_memo_entry{
+    uint32_t  rme_hash;    /* Hash of rme_str */
+    int       rme_match;   /* Result of regex_exec: 1 match, 0 no match */
+    char     *rme_str;     /* Malloced copy of matched string, NULL if unused */
+};
+
+/*! Direct-mapped memo of recently matched strings of one compiled pattern
+ */
+struct regex_memo{
+    struct regex_memo_entry rm_vec[REGEX_MEMO_SIZE];
+};
+
+#ifdef HAVE_LIBPCRE2_8
+/*! PCRE2 compiled pattern with its match data block */
+struct regex_pcre2{
+    pcre2_code       *rp_code;
+    pcre2_match_data *rp_match;
+};
+#endif
+
 /*-------------------------- POSIX translation -------------------------*/
 
 /* parse 4 digit hexadecimal number */
@@ -368,6 +406,274 @@ regexp_xsd2posix(char  *xsd,
     return retval;
 }
 
+/*-------------------------- PCRE2 translation -------------------------*/
+
+/*! Translate one XSD escape to PCRE2
+ *
+ * PCRE2 supports most XSD escapes (\d, \w, \s, \p{..}, etc) directly, but not
+ * the XML name escapes \i and \c. Unsupported escapes are kept and make
+ * compilation fail.
+ * @param[in]  x      Character following backslash
+ * @param[in]  class  Set if inside a character class
+ * @param[in]  cb     Output buffer
+ */
+static void
+xsd2pcre_escape(char  x,
+                int   class,
+                cbuf *cb)
+{
+    switch (x){
+    case 'i': /* initial */
+        cprintf(cb, class?"_:A-Za-z":"[_:A-Za-z]");
+        break;
+    case 'I':
+        if (class)
+            cprintf(cb, "\\%c", x);
+        else
+            cprintf(cb, "[^_:A-Za-z]");
+        break;
+    case 'c': /* xml namechar */
+        cprintf(cb, class?"._:A-Za-z0-9\\-":"[._:A-Za-z0-9\\-]");
+        break;
+    case 'C':
+        if (class)
+            cprintf(cb, "\\%c", x);
+        else
+            cprintf(cb, "[^._:A-Za-z0-9\\-]");
+        break;
+    default:
+        cprintf(cb, "\\%c", x);
+        break;
+    }
+}
+
+/*! Translate XSD character class to PCRE2
+ *
+ * Character class subtraction, eg [a-z-[aeiou]], is translated to a negative
+ * lookahead followed by the class: (?![aeiou])[a-z]
+ * @param[in]     xsd  Input regex string according XSD
+ * @param[in,out] ip   In: index of '[', out: index of matching ']'
+ * @param[in]     cb   Output buffer
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+static int
+xsd2pcre_class(char  *xsd,
+               int   *ip,
+               cbuf  *cb)
+{
+    int    retval = -1;
+    cbuf  *cls = NULL;
+    cbuf  *sub = NULL;
+    size_t len;
+    int    j;
+    char   x;
+
+    if ((cls = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    len = strlen(xsd);
+    j = *ip + 1;
+    cprintf(cls, "[");
+    if (j < len && xsd[j] == '^'){
+        cprintf(cls, "^");
+        j++;
+    }
+    for (; j<len; j++){
+        x = xsd[j];
+        if (x == '\\' && j+1 < len)
+            xsd2pcre_escape(xsd[++j], 1, cls);
+        else if (x == '-' && j+1 < len && xsd[j+1] == '[' && sub == NULL){
+            if ((sub = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            j++;
+            if (xsd2pcre_class(xsd, &j, sub) < 0)
+                goto done;
+        }
+        else if (x == ']')
+            break;
+        else if (x == '[')
+            cprintf(cls, "\\[");
+        else
+            cprintf(cls, "%c", x);
+    }
+    if (j < len){
+        cprintf(cls, "]");
+        if (sub)
+            cprintf(cb, "(?!%s)", cbuf_get(sub));
+    }
+    /* If not terminated, leave it to compile to fail */
+    cprintf(cb, "%s", cbuf_get(cls));
+    *ip = j;
+    retval = 0;
+ done:
+    if (sub)
+        cbuf_free(sub);
+    if (cls)
+        cbuf_free(cls);
+    return retval;
+}
+
+/*! Transform from XSD regex to PCRE2
+ *
+ * XSD regexps are implicitly anchored at both ends, and ^ and $ are normal
+ * characters. As in the posix translation, a leading ^ and a trailing $ are
+ * accepted as anchors.
+ * @param[in]  xsd    Input regex string according XSD
+ * @param[out] pcre   Output (malloced) string according to PCRE2
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see regexp_xsd2posix
+ */
+int
+regexp_xsd2pcre(char  *xsd,
+                char **pcre)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    size_t len;
+    int    i;
+    char   x;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    len = strlen(xsd);
+    cprintf(cb, "^(?:");
+    for (i=0; i<len; i++){
+        x = xsd[i];
+        if (x == '\\' && i+1 < len)
+            xsd2pcre_escape(xsd[++i], 0, cb);
+        else if (x == '['){
+            if (xsd2pcre_class(xsd, &i, cb) < 0)
+                goto done;
+        }
+        else if ((x == '^' && i == 0) || (x == '$' && i == len-1))
+            ; /* anchors are implicit */
+        else if (x == '^' || x == '$')
+            cprintf(cb, "\\%c", x);
+        else
+            cprintf(cb, "%c", x);
+    }
+    cprintf(cb, ")\\z");
+    if ((*pcre = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Free PCRE2 compiled pattern
+ *
+ * Does not need a handle, the type cache calls this when freeing
+ * @param[in]  recomp  Compiled regular expression
+ * @retval     0       OK
+ */
+int
+regex_pcre2_free(void *recomp)
+{
+#ifdef HAVE_LIBPCRE2_8
+    struct regex_pcre2 *rp = (struct regex_pcre2 *)recomp;
+
+    if (rp == NULL)
+        return 0;
+    if (rp->rp_match)
+        pcre2_match_data_free(rp->rp_match);
+    if (rp->rp_code)
+        pcre2_code_free(rp->rp_code);
+    free(rp);
+#endif
+    return 0;
+}
+
+#ifdef HAVE_LIBPCRE2_8
+/*! Compile XSD regexp with PCRE2, using JIT if available
+ *
+ * @param[in]   regexp  Regular expression string in XSD regex format
+ * @param[out]  recomp  Compiled regular expression, free with regex_pcre2_free
+ * @retval      1       OK
+ * @retval      0       Invalid regular expression
+ * @retval     -1       Error
+ */
+static int
+regex_pcre2_compile(char  *regexp,
+                    void **recomp)
+{
+    int                 retval = -1;
+    char               *pcre = NULL;
+    struct regex_pcre2 *rp = NULL;
+    int                 errcode;
+    PCRE2_SIZE          erroffset;
+
+    if (regexp_xsd2pcre(regexp, &pcre) < 0)
+        goto done;
+    if ((rp = malloc(sizeof(*rp))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(rp, 0, sizeof(*rp));
+    if ((rp->rp_code = pcre2_compile((PCRE2_SPTR)pcre, PCRE2_ZERO_TERMINATED,
+                                     PCRE2_UTF | PCRE2_UCP,
+                                     &errcode, &erroffset, NULL)) == NULL){
+        clixon_debug(CLIXON_DBG_DEFAULT, "pcre2 compile error %d at %zu: %s",
+                     errcode, (size_t)erroffset, pcre);
+        retval = 0;
+        goto done;
+    }
+    /* Interpreter is used if JIT is not supported on this platform */
+    (void)pcre2_jit_compile(rp->rp_code, PCRE2_JIT_COMPLETE);
+    if ((rp->rp_match = pcre2_match_data_create_from_pattern(rp->rp_code, NULL)) == NULL){
+        clixon_err(OE_UNIX, ENOMEM, "pcre2_match_data_create_from_pattern");
+        goto done;
+    }
+    *recomp = rp;
+    rp = NULL;
+    retval = 1;
+ done:
+    if (rp)
+        regex_pcre2_free(rp);
+    if (pcre)
+        free(pcre);
+    return retval;
+}
+
+/*! Execute PCRE2 compiled pattern
+ *
+ * @param[in]  recomp  Compiled regular expression
+ * @param[in]  string  Content string to match
+ * @retval     1       Match
+ * @retval     0       No match, or string is not valid UTF-8
+ * @retval    -1       Error
+ */
+static int
+regex_pcre2_exec(void *recomp,
+                 char *string)
+{
+    struct regex_pcre2 *rp = (struct regex_pcre2 *)recomp;
+    PCRE2_UCHAR         buf[128];
+    int                 ret;
+
+    ret = pcre2_match(rp->rp_code, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED,
+                      0, 0, rp->rp_match, NULL);
+    if (ret >= 0)
+        return 1;
+    if (ret == PCRE2_ERROR_NOMATCH ||
+        (ret <= PCRE2_ERROR_UTF8_ERR1 && ret >= PCRE2_ERROR_UTF8_ERR21))
+        return 0;
+    pcre2_get_error_message(ret, buf, sizeof(buf));
+    clixon_err(OE_YANG, 0, "pcre2_match: %s", (char*)buf);
+    return -1;
+}
+#endif /* HAVE_LIBPCRE2_8 */
+
 /*-------------------------- Generic API functions ------------------------*/
 
 /*! Compilation of regular expression / pattern
@@ -399,6 +705,13 @@ regex_compile(clixon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_compile(regexp, recomp);
         break;
+    case REGEXP_PCRE2:
+#ifdef HAVE_LIBPCRE2_8
+        retval = regex_pcre2_compile(regexp, recomp);
+#else
+        clixon_err(OE_CFG, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set");
+#endif
+        break;
     default:
         clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
         break;
@@ -432,6 +745,13 @@ regex_exec(clixon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_exec(recomp, string);
         break;
+    case REGEXP_PCRE2:
+#ifdef HAVE_LIBPCRE2_8
+        retval = regex_pcre2_exec(recomp, string);
+#else
+        clixon_err(OE_CFG, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set");
+#endif
+        break;
     default:
         clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d",
                    clicon_yang_regexp(h));
@@ -462,6 +782,9 @@ regex_free(clixon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_free(recomp);
         break;
+    case REGEXP_PCRE2:
+        retval = regex_pcre2_free(recomp);
+        break;
     default:
         clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
         goto done;
@@ -470,3 +793,90 @@ regex_free(clixon_handle h,
  done:
     return retval;
 }
+
+/*! Create match memo for one compiled pattern
+ *
+ * @retval     rm      Match memo, free with regex_memo_free
+ * @retval     NULL    Error
+ * @see regex_exec_memo
+ */
+regex_memo *
+regex_memo_new(void)
+{
+    regex_memo *rm;
+
+    if ((rm = malloc(sizeof(*rm))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(rm, 0, sizeof(*rm));
+    return rm;
+}
+
+/*! Free match memo
+ *
+ * @param[in]  rm      Match memo
+ * @retval     0       OK
+ */
+int
+regex_memo_free(regex_memo *rm)
+{
+    int i;
+
+    if (rm == NULL)
+        return 0;
+    for (i=0; i<REGEX_MEMO_SIZE; i++)
+        if (rm->rm_vec[i].rme_str)
+            free(rm->rm_vec[i].rme_str);
+    free(rm);
+    return 0;
+}
+
+/*! Execution of (pre-compiled) regular expression using a match memo
+ *
+ * The memo remembers the result of recently matched strings, so that repeated
+ * values, such as the same interface or VRF names, skip matching.
+ * The memo is direct-mapped, a new string replaces an earlier with same slot.
+ * @param[in]  h       Clixon handle
+ * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  rm      Match memo of recomp, or NULL
+ * @param[in]  string  Content string to match
+ * @retval     1       Match
+ * @retval     0       No match
+ * @retval    -1       Error
+ * @see regex_exec
+ */
+int
+regex_exec_memo(clixon_handle h,
+                void         *recomp,
+                regex_memo   *rm,
+                char         *string)
+{
+    struct regex_memo_entry *rme;
+    uint32_t                 hash = 2166136261U; /* FNV-1a */
+    char                    *p;
+    int                      ret;
+
+    if (rm == NULL)
+        return regex_exec(h, recomp, string);
+    for (p = string; *p != '\0'; p++){
+        if (p - string > REGEX_MEMO_STRLEN)
+            return regex_exec(h, recomp, string);
+        hash ^= (uint8_t)*p;
+        hash *= 16777619U;
+    }
+    rme = &rm->rm_vec[hash % REGEX_MEMO_SIZE];
+    if (rme->rme_str != NULL &&
+        rme->rme_hash == hash &&
+        strcmp(rme->rme_str, string) == 0)
+        return rme->rme_match;
+    if ((ret = regex_exec(h, recomp, string)) < 0)
+        return -1;
+    if (rme->rme_str)
+        free(rme->rme_str);
+    if ((rme->rme_str = strdup(string)) != NULL){ /* Memo is best effort */
+        rme->rme_hash = hash;
+        rme->rme_match = ret;
+    }
+    return ret;
+}
@@ -50,6 +50,7 @@
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -82,8 +83,22 @@
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_validate_minmax.h"
+#include "clixon_validate_deps.h"
 #include "clixon_validate.h"
 
+/*
+ * Constants
+ */
+/* Flags to xml_yang_validate_all1 */
+#define VALIDATE_DIFF      0x01 /* Only revalidate nodes affected by transaction */
+#define VALIDATE_NODESCEND 0x02 /* Do not descend into children and do not check min/max of
+                                 * children, for parallel validation */
+#define VALIDATE_MINMAX    0x04 /* Only check min/max and unique of children, for parallel
+                                 * validation */
+
+/* Minimum number of work units for parallel validation */
+#define VALIDATE_PARALLEL_MIN 64
+
 #ifdef LEAFREF_OPTIMIZE
 
 /* Global cache data only directly used in validate_leafref()
@@ -618,20 +633,14 @@ validate_identityref(cxobj     *xt,
 {
     int         retval = -1;
     char       *node = NULL;
-    char       *idref = NULL;
     yang_stmt  *ybaseref; /* This is the type's base reference */
     yang_stmt  *ybaseid;
     char       *prefix = NULL;
     char       *id = NULL;
     cbuf       *cberr = NULL;
-    cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
     yang_stmt  *ymod;
+    int         ret;
 
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     if ((cberr = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -676,14 +685,12 @@ validate_identityref(cxobj     *xt,
             goto done;
         goto fail;
     }
-    cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-    idref = cbuf_get(cb);
     /* Here check if node is in the derived node list of the base identity
-     * The derived node list is a cvec computed XXX
+     * The derived node list is computed in ys_populate_identity
      */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
-
+    if ((ret = yang_identity_derived(ybaseid, yang_argument_get(ymod), id)) < 0)
+        goto done;
+    if (ret == 0){
         cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang",
                 node,
                 yang_argument_get(ybaseid),
@@ -699,8 +706,6 @@ validate_identityref(cxobj     *xt,
  done:
     if (cberr)
         cbuf_free(cberr);
-    if (cb)
-        cbuf_free(cb);
     if (id)
         free(id);
     if (prefix)
@@ -1603,7 +1608,11 @@ xml_yang_validate_leaf_union(clixon_handle h,
 /*! Validate a single XML node with yang specification for all (not only added) entries
  *
  * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    XML node to be validated
+ * @param[in]  flags VALIDATE_DIFF: only revalidate nodes affected by transaction,
+ *                   VALIDATE_NODESCEND: do not descend into children of xt and do not
+ *                   check min/max of children
  * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
  * @retval     1     Validation OK
  * @retval     0     Validation failed (cbret set)
@@ -1623,6 +1632,7 @@ xml_yang_validate_leaf_union(clixon_handle h,
 static int
 xml_yang_validate_all1(clixon_handle h,
                        cxobj        *xt,
+                       int           flags,
                        cxobj       **xret)
 {
     int        retval = -1;
@@ -1642,6 +1652,11 @@ xml_yang_validate_all1(clixon_handle h,
     validate_level vl = VL_NONE;
     int        saw_node = 0;
     int        inext;
+    int        own = 1;
+    int        descend = 1;
+    int        diff;
+
+    diff = (flags & VALIDATE_DIFF) != 0;
 
     if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
         if ((ret = xml_yang_mount_get(h, xt, &vl, NULL, NULL)) < 0)
@@ -1649,6 +1664,9 @@ xml_yang_validate_all1(clixon_handle h,
         /* Check if validate beyond mountpoints */
         if (ret == 1 && vl == VL_NONE)
             goto ok;
+        /* Mounted spec has no dependency graph: validate all below mountpoint */
+        if (ret == 1)
+            diff = 0;
     }
     /* if not given by argument (overide) use default link
        and !Node has a config sub-statement and it is false */
@@ -1674,7 +1692,9 @@ xml_yang_validate_all1(clixon_handle h,
             goto done;
         goto fail;
     }
-    if (yang_config(yt) != 0){
+    if (diff && xml_deps_check(xt, yt, &own, &descend) < 0)
+        goto done;
+    if (yang_config(yt) != 0 && own){
         ret = yang_check_when_xpath(xt, xml_parent(xt), yt, &hit, &nr, &xpath1);
         clixon_debug(CLIXON_DBG_XPATH|CLIXON_DBG_DETAIL, "nr:%d xpath:%s return:%d", nr, xpath1, ret);
         if (ret < 0)
@@ -1777,17 +1797,20 @@ xml_yang_validate_all1(clixon_handle h,
             }
         }
     }
+    if (flags & VALIDATE_NODESCEND)
+        goto ok;
     x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all1(h, x, xret)) < 0)
+    while (descend && (x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_all1(h, x, diff?VALIDATE_DIFF:0, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
     }
     /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
+    if (yang_config(yt) != 0 &&
+        (!diff || xml_flag(xt, XML_FLAG_ADD|XML_FLAG_CHANGE))){
         /* Checks if next level contains any unique list constraints */
-        if ((ret = xml_yang_validate_minmax(xt, 1, xret)) < 0)
+        if ((ret = xml_yang_validate_minmax(xt, 1, diff, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -1816,40 +1839,539 @@ xml_yang_validate_all(clixon_handle h,
 
 #ifdef LEAFREF_OPTIMIZE
     leafref_opt_init(h);
-    retval = xml_yang_validate_all1(h, xt, xret);
+    retval = xml_yang_validate_all1(h, xt, 0, xret);
+    leafref_opt_exit(h);
+#else
+    retval = xml_yang_validate_all1(h, xt, 0, xret);
+#endif
+    return retval;
+}
+
+/*! Validation function of one work unit in parallel validation
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  x     XML node
+ * @param[in]  flags See xml_yang_validate_all1
+ * @param[out] xret  Error XML tree (if ret == 0)
+ */
+typedef int (validate_unit_fn)(clixon_handle h, cxobj *x, int flags, cxobj **xret);
+
+/*! Validate work unit: all constraints
+ *
+ * A split container is two units: one with VALIDATE_NODESCEND before its children and
+ * one with VALIDATE_MINMAX after them, in the same order as serial validation.
+ */
+static int
+validate_unit_all(clixon_handle h,
+                  cxobj        *x,
+                  int           flags,
+                  cxobj       **xret)
+{
+    int        retval;
+    yang_stmt *y;
+
+    if (flags & VALIDATE_MINMAX){
+        if ((y = xml_spec(x)) == NULL || yang_config(y) == 0)
+            return 1;
+        return xml_yang_validate_minmax(x, 1, 0, xret);
+    }
+#ifdef LEAFREF_OPTIMIZE
+    leafref_opt_init(h);
+    retval = xml_yang_validate_all1(h, x, flags, xret);
     leafref_opt_exit(h);
 #else
-    retval = xml_yang_validate_all1(h, xt, xret);
+    retval = xml_yang_validate_all1(h, x, flags, xret);
 #endif
     return retval;
 }
 
+/*! Validate work unit: added or changed nodes
+ */
+static int
+validate_unit_add(clixon_handle h,
+                  cxobj        *x,
+                  int           flags,
+                  cxobj       **xret)
+{
+    return xml_yang_validate_add(h, x, xret);
+}
+
+/*! Add the error of a worker process in parallel validation to an error tree
+ *
+ * @param[in]     str   Error XML tree of worker as string: <rpc-reply><rpc-error>...
+ * @param[in,out] xret  Error XML tree, created if NULL, otherwise rpc-error is appended
+ * @retval        0     OK
+ * @retval       -1     Error
+ * @see validate_parallel
+ */
+static int
+validate_parallel_err(char   *str,
+                      cxobj **xret)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xr;
+    cxobj *xe;
+
+    if (clixon_xml_parse_string(str, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xr = xml_find_type(xt, NULL, "rpc-reply", CX_ELMNT)) == NULL){
+        clixon_err(OE_XML, 0, "No rpc-reply in error of validation worker");
+        goto done;
+    }
+    if (*xret == NULL){
+        if (xml_rm(xr) < 0)
+            goto done;
+        *xret = xr;
+    }
+    else {
+        if (xml_name_set(*xret, "rpc-reply") < 0)
+            goto done;
+        while ((xe = xml_find_type(xr, NULL, "rpc-error", CX_ELMNT)) != NULL)
+            if (xml_addsub(*xret, xe) < 0)
+                goto done;
+    }
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Validate work units in parallel using worker processes
+ *
+ * The XML tree is shared read-only with the workers by fork copy-on-write. Processes
+ * are used instead of threads since validation code is not thread-safe, eg error state,
+ * xpath and leafref caches.
+ * The units are split into contiguous ranges, one per worker. Each worker reports the
+ * index of the first failing unit in its range followed by its error tree. The error of
+ * the failing unit with the lowest index is returned, so that the error is the same as
+ * in serial validation.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xvec    Work units
+ * @param[in]  fvec    Validation flags of each unit, or NULL
+ * @param[in]  xlen    Number of units
+ * @param[in]  workers Number of worker processes
+ * @param[in]  fn      Validation function
+ * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     2       A worker failed, caller should validate serially
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ */
+static int
+validate_parallel(clixon_handle     h,
+                  cxobj           **xvec,
+                  int              *fvec,
+                  int               xlen,
+                  int               workers,
+                  validate_unit_fn *fn,
+                  cxobj           **xret)
+{
+    int     retval = -1;
+    pid_t  *pids = NULL;
+    int    *fds = NULL;
+    int     fd[2];
+    int     w;
+    int     i;
+    int     res;
+    int     first = -1;  /* Lowest failing unit */
+    int     serial = 0;  /* Worker failed */
+    cbuf   *cb = NULL;   /* Error of worker */
+    cbuf   *cberr = NULL; /* Error of lowest failing unit */
+    cxobj  *xerr = NULL;
+    char    buf[1024];
+    ssize_t len;
+    ssize_t n;
+    int     ret;
+
+    if (workers > xlen)
+        workers = xlen;
+    clixon_debug(CLIXON_DBG_DEFAULT, "units:%d workers:%d", xlen, workers);
+    if ((pids = calloc(workers, sizeof(pid_t))) == NULL ||
+        (fds = calloc(workers, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (w=0; w<workers; w++)
+        fds[w] = -1;
+    for (w=0; w<workers; w++){
+        if (pipe(fd) < 0){
+            clixon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[w] = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            close(fd[0]);
+            close(fd[1]);
+            goto done;
+        }
+        if (pids[w] == 0){ /* Worker */
+            close(fd[0]);
+            res = -1;
+            for (i = (xlen*w)/workers; i < (xlen*(w+1))/workers; i++){
+                if ((ret = fn(h, xvec[i], fvec?fvec[i]:0, &xerr)) < 0){
+                    res = -2;
+                    break;
+                }
+                if (ret == 0){
+                    res = i;
+                    break;
+                }
+            }
+            cbuf_reset(cb);
+            if (cbuf_append_buf(cb, &res, sizeof(res)) < 0)
+                _exit(1);
+            if (res >= 0 && xerr &&
+                clixon_xml2cbuf(cb, xerr, 0, 0, NULL, -1, 0) < 0)
+                _exit(1);
+            for (i = 0; i < cbuf_len(cb); i += n)
+                if ((n = write(fd[1], cbuf_get(cb) + i, cbuf_len(cb) - i)) < 0)
+                    _exit(1);
+            _exit(0);
+        }
+        close(fd[1]);
+        fds[w] = fd[0];
+    }
+    /* Workers are read in order, a worker blocked in write waits only for the caller */
+    for (w=0; w<workers; w++){
+        cbuf_reset(cb);
+        while ((len = read(fds[w], buf, sizeof(buf))) != 0){
+            if (len < 0){
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (cbuf_append_buf(cb, buf, len) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        }
+        if (len < 0 || cbuf_len(cb) < sizeof(res)){
+            serial++;
+            continue;
+        }
+        memcpy(&res, cbuf_get(cb), sizeof(res));
+        if (res == -2 || (res >= 0 && cbuf_len(cb) == sizeof(res)))
+            serial++;
+        else if (res >= 0 && (first == -1 || res < first)){
+            first = res;
+            /* Keep error of lowest failing unit */
+            if (cberr == NULL && (cberr = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cbuf_reset(cberr);
+            cprintf(cberr, "%s", cbuf_get(cb) + sizeof(res));
+        }
+    }
+    if (serial){
+        clixon_log(h, LOG_WARNING, "%s: %d validation workers failed, validating serially",
+                   __func__, serial);
+        retval = 2;
+        goto done;
+    }
+    if (first != -1){
+        if (validate_parallel_err(cbuf_get(cberr), xret) < 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (fds){
+        for (w=0; w<workers; w++)
+            if (fds[w] != -1)
+                close(fds[w]);
+        free(fds);
+    }
+    if (pids){
+        for (w=0; w<workers; w++)
+            if (pids[w] > 0)
+                waitpid(pids[w], NULL, 0);
+        free(pids);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Partition a tree into work units for parallel validation
+ *
+ * Top-level nodes are units. A large top-level container is split into its own
+ * constraints, its children, and the min/max and unique checks of its children, in
+ * the order of serial validation.
+ * @param[in]  xt    Top-level XML tree
+ * @param[out] xvec  Work units. Free with free()
+ * @param[out] fvec  Validation flags of units. Free with free()
+ * @param[out] xlen  Number of units
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+validate_partition(cxobj  *xt,
+                   cxobj ***xvec,
+                   int    **fvec,
+                   int     *xlen)
+{
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xc;
+    yang_stmt *y;
+    int        len;
+    int        i = 0;
+
+    len = xml_child_nr_type(xt, CX_ELMNT);
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        if ((y = xml_spec(x)) != NULL &&
+            yang_keyword_get(y) == Y_CONTAINER &&
+            yang_flag_get(y, YANG_FLAG_MTPOINT_POTENTIAL) == 0x0 &&
+            xml_child_nr_type(x, CX_ELMNT) >= VALIDATE_PARALLEL_MIN)
+            len += xml_child_nr_type(x, CX_ELMNT) + 1;
+    if ((*xvec = calloc(len, sizeof(cxobj*))) == NULL ||
+        (*fvec = calloc(len, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        (*xvec)[i] = x;
+        if ((y = xml_spec(x)) != NULL &&
+            yang_keyword_get(y) == Y_CONTAINER &&
+            yang_flag_get(y, YANG_FLAG_MTPOINT_POTENTIAL) == 0x0 &&
+            xml_child_nr_type(x, CX_ELMNT) >= VALIDATE_PARALLEL_MIN){
+            (*fvec)[i++] = VALIDATE_NODESCEND;
+            xc = NULL;
+            while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+                (*xvec)[i] = xc;
+                (*fvec)[i++] = 0;
+            }
+            (*xvec)[i] = x;
+            (*fvec)[i++] = VALIDATE_MINMAX;
+        }
+        else
+            (*fvec)[i++] = 0;
+    }
+    *xlen = i;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Validate a single XML node with yang specification
  *
+ * If CLICON_VALIDATE_WORKERS is larger than one, validation of top-level nodes and entries
+ * of large top-level containers is made in parallel
  * @param[in]  h     Clixon handle
  * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
  * @retval     1      Validation OK
  * @retval     0      Validation failed (xret set)
  * @retval    -1      Error
+ * @see validate_parallel
  */
 int
 xml_yang_validate_all_top(clixon_handle h,
                           cxobj        *xt,
                           cxobj       **xret)
 {
-    int    ret;
-    cxobj *x;
-
+    int     retval = -1;
+    int     ret;
+    cxobj  *x;
+    cxobj **xvec = NULL;
+    int    *fvec = NULL;
+    int     xlen = 0;
+    int     workers;
+
+    if ((workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS")) > 1){
+        if (validate_partition(xt, &xvec, &fvec, &xlen) < 0)
+            goto done;
+        if (xlen >= VALIDATE_PARALLEL_MIN){
+            if ((ret = validate_parallel(h, xvec, fvec, xlen, workers,
+                                         validate_unit_all, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if (ret == 1)
+                goto minmax;
+        }
+    }
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
+        if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+ minmax:
+    if ((ret = xml_yang_validate_minmax(xt, 0, 0, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (fvec)
+        free(fvec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a vector of added or changed XML nodes
+ *
+ * If CLICON_VALIDATE_WORKERS is larger than one, validation is made in parallel
+ * @param[in]  h     Clixon handle
+ * @param[in]  xvec  Vector of XML nodes
+ * @param[in]  xlen  Length of xvec
+ * @param[out] xret  Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see xml_yang_validate_add
+ */
+int
+xml_yang_validate_add_vec(clixon_handle h,
+                          cxobj       **xvec,
+                          int           xlen,
+                          cxobj       **xret)
+{
+    int ret;
+    int i;
+    int workers;
+
+    if ((workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS")) > 1 &&
+        xlen >= VALIDATE_PARALLEL_MIN){
+        if ((ret = validate_parallel(h, xvec, NULL, xlen, workers,
+                                     validate_unit_add, xret)) < 2)
             return ret;
     }
-    if ((ret = xml_yang_validate_minmax(xt, 0, xret)) < 1)
-        return ret;
+    for (i=0; i<xlen; i++)
+        if ((ret = xml_yang_validate_add(h, xvec[i], xret)) < 1)
+            return ret;
     return 1;
 }
 
+/*! Validate a configuration tree incrementally given the changes of a transaction
+ *
+ * Only must/when/leafref constraints whose dependencies may be affected by the changes are
+ * re-evaluated, using the dependency graph computed by yang_deps_populate.
+ * Assumes XML_FLAG_ADD and XML_FLAG_CHANGE are set in the target tree as by compute_diffs,
+ * including ancestors of deleted nodes.
+ * Referring leafs of deleted or changed leafref targets are checked using a reverse
+ * leafref index instead of revalidating all referring leafs.
+ * Falls back to full validation if no dependency graph exists.
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    Top-level target XML tree
+ * @param[in]  srcgen Datastore generation of source tree, 0 if not known
+ * @param[in]  dvec  Deleted XML nodes (in source tree)
+ * @param[in]  dlen  Length of dvec
+ * @param[in]  avec  Added XML nodes (in target tree)
+ * @param[in]  alen  Length of avec
+ * @param[in]  scvec Changed XML nodes (in source tree)
+ * @param[in]  tcvec Changed XML nodes (in target tree)
+ * @param[in]  clen  Length of scvec and tcvec
+ * @param[out] xret  Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see xml_yang_validate_all_top  Full validation
+ */
+int
+xml_yang_validate_all_diff(clixon_handle h,
+                           cxobj        *xt,
+                           uint64_t      srcgen,
+                           cxobj       **dvec,
+                           int           dlen,
+                           cxobj       **avec,
+                           int           alen,
+                           cxobj       **scvec,
+                           cxobj       **tcvec,
+                           int           clen,
+                           cxobj       **xret)
+{
+    int          retval = -1;
+    int          ret;
+    cxobj       *x;
+    yang_stmt   *yspec;
+    clixon_xvec *xv = NULL;
+    cxobj      **xrefs = NULL;
+    int          xlen = 0;
+    yang_stmt   *yr;
+    yang_stmt   *yc;
+    int          i;
+    int          j;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL || !yang_deps_exists(yspec))
+        return xml_yang_validate_all_top(h, xt, xret);
+    if (xml_deps_mark(yspec, dvec, dlen, avec, alen, tcvec, clen) < 0)
+        goto done;
+#ifdef LEAFREF_OPTIMIZE
+    leafref_opt_init(h);
+#endif
+    /* Referring leafs of removed leafref targets, using reverse leafref index */
+    if (xml_deps_leafref_begin(srcgen, dvec, dlen, avec, alen, scvec, tcvec, clen) < 0)
+        goto done;
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    if (xml_deps_leafref_removed(dvec, dlen, scvec, clen, xv) < 0)
+        goto done;
+    for (i=0; i<clixon_xvec_len(xv); i++){
+        if (xml_deps_leafref_referrers(xt, clixon_xvec_i(xv, i), &xrefs, &xlen) < 0)
+            goto done;
+        for (j=0; j<xlen; j++){
+            x = xrefs[j];
+            yr = xml_spec(x);
+            if (yang_type_get(yr, NULL, &yc, NULL, NULL, NULL, NULL, NULL) < 0)
+                goto done;
+            if ((ret = validate_leafref(x, yr, yc, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        if (xrefs){
+            free(xrefs);
+            xrefs = NULL;
+        }
+        xlen = 0;
+    }
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_all1(h, x, VALIDATE_DIFF, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if ((ret = xml_yang_validate_minmax(xt, 0, 1, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+#ifdef LEAFREF_OPTIMIZE
+    leafref_opt_exit(h);
+#endif
+    xml_deps_reset();
+    if (xrefs)
+        free(xrefs);
+    if (xv)
+        clixon_xvec_free(xv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Exit validation module
  */
 int
@@ -0,0 +1,1696 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Dependency graph of YANG must/when/leafref constraints for incremental validation
+ *
+ * At populate time, each must, when and leafref path XPath is statically analyzed and
+ * attached to the schema node where it is evaluated (its context node).
+ * The analysis classifies the references made by the XPath:
+ * - Relative: the expression only references nodes under an ancestor at most "up" levels
+ *   above the context node. Re-evaluation is only necessary if that ancestor instance is
+ *   changed.
+ * - Absolute: the expression references schema nodes from the root. These are stored as a
+ *   vector of referenced schema nodes. Re-evaluation is necessary if any of these (or their
+ *   descendants) are changed in the transaction.
+ * - Always: the expression could not be analyzed (eg deref(), ancestor:: or preceding::
+ *   axes) and is always re-evaluated.
+ * The information is aggregated upwards in the schema tree so that unchanged XML subtrees
+ * can be skipped entirely during validation.
+ * @see xml_yang_validate_all_diff  where it is used
+ * @see CLICON_VALIDATE_INCREMENTAL in clixon-config.yang
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_map.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_vec.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_yang_module.h"
+#include "clixon_yang_type.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
+#include "clixon_xpath_function.h"
+#include "clixon_validate_deps.h"
+
+/*
+ * Constants
+ */
+#define YD_OWN        0x01 /* Node has own constraints (must/when/leafref/child when) */
+#define YD_ALWAYS     0x02 /* Own constraint could not be analyzed: always evaluate */
+#define YD_GLOBAL     0x04 /* Own constraint has absolute references in yd_vec */
+#define YD_SUB_ALWAYS 0x08 /* Node or descendant has YD_ALWAYS */
+#define YD_SUB_GLOBAL 0x10 /* Node or descendant has YD_GLOBAL */
+#define YD_DIRTY      0x20 /* Transaction: node or descendant is changed */
+#define YD_AFFECTED   0x40 /* Transaction: node or descendant has global constraint with dirty
+                            * reference */
+#define YD_LEAFREF    0x80 /* Own leafref target is checked by reverse index, not by yd_vec */
+
+/*
+ * Types
+ */
+
+/*! Dependency info of a schema node
+ *
+ * Stored in external map, see YANG_FLAG_DEPS. Removed when the YANG node is freed
+ * @see yang_deps_drop
+ */
+struct yang_deps {
+    uint16_t    yd_flags;   /* See YD_* */
+    int16_t     yd_up;      /* Own constraints: levels above node reached, -1 if none */
+    int16_t     yd_reach;   /* Subtree: levels above this node reached by any constraint */
+    yang_stmt **yd_vec;     /* Own absolute references, for Y_SPEC: all YD_GLOBAL nodes */
+    int         yd_len;     /* Length of yd_vec */
+    yang_stmt **yd_refs;    /* Leafref target: referring leafs checked by reverse index */
+    int         yd_rlen;    /* Length of yd_refs */
+};
+typedef struct yang_deps yang_deps;
+
+/*! Reverse leafref index of one referring leaf
+ *
+ * Counts referring instances per leafref value in the source (running) tree. The counts
+ * are kept across transactions: each transaction only computes the change of counts from
+ * its added, deleted and changed subtrees, and a successful commit applies the change.
+ * Counts are rebuilt from the source tree only if the datastore has been modified in
+ * another way, see xmldb_generation_get.
+ */
+struct leafref_index {
+    yang_stmt     *li_yang;    /* Referring leaf or leaf-list */
+    int            li_counted; /* li_count is valid for source generation _leafref_index_gen */
+    clicon_hash_t *li_count;   /* Value -> int: referring instances in source tree */
+    clicon_hash_t *li_delta;   /* Value -> int: change of count in current transaction */
+};
+typedef struct leafref_index leafref_index;
+
+/*! XPath static analysis state
+ *
+ * Either relative (local) where only depth relative to context node is tracked,
+ * or absolute (global) where the schema node is tracked.
+ */
+struct xpdeps_state {
+    int        xd_global;  /* 0: relative, depth is xd_depth. 1: absolute, node is xd_ys */
+    int        xd_depth;   /* Relative depth wrt context node */
+    int        xd_stop;    /* Absolute resolution stopped at xd_ys, skip remaining steps */
+    yang_stmt *xd_ys;      /* Absolute schema node, NULL is root */
+};
+typedef struct xpdeps_state xpdeps_state;
+
+/*! Analysis accumulator for one XPath
+ */
+struct xpdeps_acc {
+    yang_stmt  *xa_ystmt;  /* Statement carrying the XPath, for namespace resolution */
+    yang_stmt  *xa_yspec;  /* Top-level spec */
+    cvec       *xa_nsc;    /* Namespace context of xa_ystmt */
+    int         xa_always; /* Could not analyze */
+    int         xa_up;     /* Max levels above context */
+    yang_stmt **xa_vec;    /* Absolute references */
+    int         xa_len;
+};
+typedef struct xpdeps_acc xpdeps_acc;
+
+/*
+ * Internal variables
+ * Global as the yang when and mymodule maps, see clixon_yang.c
+ */
+static map_ptr2ptr *_yang_deps_map = NULL;
+static size_t       _yang_deps_map_len = 0;
+
+/* Transaction: vector of entries with YD_DIRTY or YD_AFFECTED set, for reset */
+static yang_deps  **_yang_deps_marked = NULL;
+static size_t       _yang_deps_marked_len = 0;
+static size_t       _yang_deps_marked_max = 0;
+
+/* Reverse leafref indexes, one per referring leaf */
+static leafref_index *_leafref_index = NULL;
+static int            _leafref_index_len = 0;
+static uint64_t       _leafref_index_gen = 0; /* Source generation of li_count, 0: invalid */
+static uint64_t       _leafref_delta_gen = 0; /* Source generation of li_delta, 0: none */
+
+/* Forward */
+static int xpdeps_expr(xpath_tree *xs, xpdeps_state *ctx, xpdeps_acc *xa);
+static int leafref_index_clear(void);
+
+/*! Get dependency entry of yang node
+ *
+ * @param[in]  ys  YANG node
+ * @retval     yd  Dependency entry
+ * @retval     NULL No entry
+ */
+static yang_deps *
+yang_deps_get(yang_stmt *ys)
+{
+    if (ys == NULL || yang_flag_get(ys, YANG_FLAG_DEPS) == 0x0)
+        return NULL;
+    return clixon_ptr2ptr(_yang_deps_map, _yang_deps_map_len, ys);
+}
+
+/*! Get or create dependency entry of yang node
+ *
+ * An existing entry, eg from an earlier populate of the same spec, is re-used
+ * @param[in]  ys  YANG node
+ * @retval     yd  Dependency entry
+ * @retval     NULL Error
+ */
+static yang_deps *
+yang_deps_new(yang_stmt *ys)
+{
+    yang_deps *yd;
+
+    if ((yd = clixon_ptr2ptr(_yang_deps_map, _yang_deps_map_len, ys)) != NULL){
+        if (yd->yd_vec)
+            free(yd->yd_vec);
+        if (yd->yd_refs)
+            free(yd->yd_refs);
+    }
+    else {
+        if ((yd = malloc(sizeof(*yd))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            return NULL;
+        }
+        if (clixon_ptr2ptr_add(&_yang_deps_map, &_yang_deps_map_len, ys, yd) < 0){
+            free(yd);
+            return NULL;
+        }
+    }
+    memset(yd, 0, sizeof(*yd));
+    yd->yd_up = -1;
+    yd->yd_reach = -1;
+    yang_flag_set(ys, YANG_FLAG_DEPS);
+    return yd;
+}
+
+/*! Add yang node to vector if not already present
+ */
+static int
+yang_deps_vec_add(yang_stmt ***vec,
+                  int         *len,
+                  yang_stmt   *ys)
+{
+    int i;
+
+    for (i=0; i<*len; i++)
+        if ((*vec)[i] == ys)
+            return 0;
+    if ((*vec = realloc(*vec, (*len+1)*sizeof(yang_stmt*))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    (*vec)[(*len)++] = ys;
+    return 0;
+}
+
+/*! Get closest data node ancestor, skipping choice and case
+ */
+static yang_stmt *
+xpdeps_parent(yang_stmt *ys)
+{
+    yang_stmt *yp = ys;
+
+    while ((yp = yang_parent_get(yp)) != NULL){
+        if (yang_datanode(yp))
+            return yp;
+        if (yang_keyword_get(yp) == Y_MODULE ||
+            yang_keyword_get(yp) == Y_SUBMODULE ||
+            yang_keyword_get(yp) == Y_SPEC)
+            return NULL;
+    }
+    return NULL;
+}
+
+/*! Resolve a child step in absolute mode
+ *
+ * @param[in]  xa       Accumulator
+ * @param[in]  ys       Current schema node, NULL is root
+ * @param[in]  nodetest XPath node test
+ * @retval     yc       Resolved child
+ * @retval     NULL     Not resolved
+ */
+static yang_stmt *
+xpdeps_child(xpdeps_acc *xa,
+             yang_stmt  *ys,
+             xpath_tree *nodetest)
+{
+    char      *prefix;
+    char      *name;
+    char      *ns;
+    yang_stmt *ymod;
+
+    if (nodetest == NULL || nodetest->xs_type != XP_NODE)
+        return NULL;
+    prefix = nodetest->xs_s0;
+    name = nodetest->xs_s1;
+    if (name == NULL || strcmp(name, "*") == 0)
+        return NULL;
+    if (ys == NULL){
+        if ((ns = xml_nsctx_get(xa->xa_nsc, prefix)) == NULL)
+            return NULL;
+        if ((ymod = yang_find_module_by_namespace(xa->xa_yspec, ns)) == NULL)
+            return NULL;
+        ys = ymod;
+    }
+    return yang_find_schemanode(ys, name);
+}
+
+/*! Analyze a location step
+ *
+ * @param[in]     xs  XPath step
+ * @param[in,out] st  State
+ * @param[in]     xa  Accumulator
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+xpdeps_step(xpath_tree   *xs,
+            xpdeps_state *st,
+            xpdeps_acc   *xa)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+
+    if (!st->xd_global){
+        switch (xs->xs_int){
+        case A_CHILD:
+        case A_DESCENDANT:
+        case A_DESCENDANT_OR_SELF:
+            st->xd_depth++;
+            break;
+        case A_PARENT:
+            st->xd_depth--;
+            break;
+        case A_SELF:
+        case A_ATTRIBUTE:
+            break;
+        case A_FOLLOWING_SIBLING:
+        case A_PRECEDING_SIBLING:
+            if (xa->xa_up < 1 - st->xd_depth)
+                xa->xa_up = 1 - st->xd_depth;
+            break;
+        default: /* ancestor, preceding, following, etc */
+            xa->xa_always++;
+            break;
+        }
+        if (xa->xa_up < -st->xd_depth)
+            xa->xa_up = -st->xd_depth;
+    }
+    else if (!st->xd_stop){
+        switch (xs->xs_int){
+        case A_CHILD:
+            if ((yc = xpdeps_child(xa, st->xd_ys, xs->xs_c0)) == NULL){
+                if (st->xd_ys == NULL)
+                    xa->xa_always++;
+                st->xd_stop++;
+            }
+            else
+                st->xd_ys = yc;
+            break;
+        case A_PARENT:
+            if (st->xd_ys)
+                st->xd_ys = xpdeps_parent(st->xd_ys);
+            break;
+        case A_SELF:
+        case A_ATTRIBUTE:
+            break;
+        default: /* Stop here, reference covers all of subtree */
+            if (st->xd_ys == NULL)
+                xa->xa_always++;
+            st->xd_stop++;
+            break;
+        }
+    }
+    /* Predicates have the step node as context */
+    if (xs->xs_c1 && xpdeps_expr(xs->xs_c1, st, xa) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Analyze a location path, thread state through steps
+ *
+ * @param[in]     xs  XPath location path
+ * @param[in,out] st  State
+ * @param[in]     xa  Accumulator
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+xpdeps_path(xpath_tree   *xs,
+            xpdeps_state *st,
+            xpdeps_acc   *xa)
+{
+    int retval = -1;
+
+    if (xs == NULL)
+        goto ok;
+    switch (xs->xs_type){
+    case XP_ABSPATH:
+        st->xd_global = 1;
+        st->xd_stop = 0;
+        st->xd_ys = NULL;
+        if (xs->xs_int == A_DESCENDANT_OR_SELF || xs->xs_c0 == NULL)
+            xa->xa_always++;
+        else if (xpdeps_path(xs->xs_c0, st, xa) < 0)
+            goto done;
+        break;
+    case XP_RELLOCPATH:
+        if (xpdeps_path(xs->xs_c0, st, xa) < 0)
+            goto done;
+        if (xs->xs_int == A_DESCENDANT_OR_SELF){
+            if (st->xd_global)
+                st->xd_stop++;
+            else
+                st->xd_depth++;
+        }
+        if (xpdeps_path(xs->xs_c1, st, xa) < 0)
+            goto done;
+        break;
+    case XP_STEP:
+        if (xpdeps_step(xs, st, xa) < 0)
+            goto done;
+        break;
+    case XP_PRED: /* Chain of predicates, context is current step */
+        if (xpdeps_expr(xs, st, xa) < 0)
+            goto done;
+        break;
+    default:
+        xa->xa_always++;
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! End of location path: register absolute reference
+ */
+static int
+xpdeps_finish(xpdeps_state *st,
+              xpdeps_acc   *xa)
+{
+    if (st->xd_global){
+        if (st->xd_ys == NULL)
+            xa->xa_always++;
+        else if (yang_deps_vec_add(&xa->xa_vec, &xa->xa_len, st->xd_ys) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Analyze an XPath expression given a context
+ *
+ * @param[in]  xs   XPath parse-tree
+ * @param[in]  ctx  Context state, not modified
+ * @param[in]  xa   Accumulator
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xpdeps_expr(xpath_tree   *xs,
+            xpdeps_state *ctx,
+            xpdeps_acc   *xa)
+{
+    int           retval = -1;
+    xpdeps_state  st;
+    xpath_tree   *xf;
+
+    if (xs == NULL)
+        goto ok;
+    switch (xs->xs_type){
+    case XP_LOCPATH:
+        st = *ctx;
+        if (xpdeps_path(xs->xs_c0, &st, xa) < 0)
+            goto done;
+        if (xpdeps_finish(&st, xa) < 0)
+            goto done;
+        break;
+    case XP_PATHEXPR:
+        if (xs->xs_c1 == NULL){
+            if (xpdeps_expr(xs->xs_c0, ctx, xa) < 0)
+                goto done;
+            break;
+        }
+        /* filterexpr / rellocpath: only current() is analyzed */
+        xf = xs->xs_c0;
+        if (xf && xf->xs_type == XP_FILTEREXPR)
+            xf = xf->xs_c0;
+        if (xf && xf->xs_type == XP_PRIME_FN && xf->xs_int == XPATHFN_CURRENT){
+            memset(&st, 0, sizeof(st));
+            if (xs->xs_s0 && strcmp(xs->xs_s0, "//") == 0)
+                st.xd_depth++;
+            if (xpdeps_path(xs->xs_c1, &st, xa) < 0)
+                goto done;
+            if (xpdeps_finish(&st, xa) < 0)
+                goto done;
+        }
+        else
+            xa->xa_always++;
+        break;
+    case XP_PRIME_FN:
+        switch (xs->xs_int){
+        case XPATHFN_DEREF:
+            xa->xa_always++;
+            break;
+        case XPATHFN_CURRENT: /* Context node of constraint, depth 0 */
+            break;
+        default:
+            if (xpdeps_expr(xs->xs_c0, ctx, xa) < 0)
+                goto done;
+            break;
+        }
+        break;
+    case XP_PRIME_STR:
+    case XP_PRIME_NR:
+        break;
+    case XP_ABSPATH:
+    case XP_RELLOCPATH:
+    case XP_STEP: /* Should be covered by XP_LOCPATH */
+        st = *ctx;
+        if (xpdeps_path(xs, &st, xa) < 0)
+            goto done;
+        if (xpdeps_finish(&st, xa) < 0)
+            goto done;
+        break;
+    default: /* XP_EXP, XP_AND, XP_RELEX, XP_ADD, XP_UNION, XP_FILTEREXPR, XP_PRI0, XP_PRED */
+        if (xpdeps_expr(xs->xs_c0, ctx, xa) < 0)
+            goto done;
+        if (xpdeps_expr(xs->xs_c1, ctx, xa) < 0)
+            goto done;
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Analyze one XPath constraint and merge result into dependency entry
+ *
+ * @param[in]  yd      Dependency entry of context node
+ * @param[in]  ystmt   Statement with XPath argument (must/when/path)
+ * @param[in]  xpath   XPath
+ * @param[in]  offset  Levels between the node of yd and the XPath context node
+ *                     (1 if context is parent, -1 if context is child)
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+yang_deps_xpath(yang_deps  *yd,
+                yang_stmt  *ystmt,
+                char       *xpath,
+                int         offset)
+{
+    int           retval = -1;
+    xpath_tree   *xptree = NULL;
+    xpdeps_acc    xa = {0,};
+    xpdeps_state  ctx = {0,};
+    int           up;
+    int           i;
+
+    if (xpath == NULL)
+        goto ok;
+    xa.xa_ystmt = ystmt;
+    xa.xa_yspec = ys_spec(ystmt);
+    if (xml_nsctx_yang(ystmt, &xa.xa_nsc) < 0)
+        goto done;
+    /* A parse error means constraint cannot be analyzed, it will fail at validation */
+    if (xpath_parse(xpath, &xptree) < 0){
+        clixon_err_reset();
+        xa.xa_always++;
+    }
+    else if (xpdeps_expr(xptree, &ctx, &xa) < 0)
+        goto done;
+    yd->yd_flags |= YD_OWN;
+    if (xa.xa_always)
+        yd->yd_flags |= YD_ALWAYS;
+    up = xa.xa_up + offset;
+    if (up < 0)
+        up = 0;
+    if (up > yd->yd_up)
+        yd->yd_up = up;
+    for (i=0; i<xa.xa_len; i++){
+        if (yang_deps_vec_add(&yd->yd_vec, &yd->yd_len, xa.xa_vec[i]) < 0)
+            goto done;
+        yd->yd_flags |= YD_GLOBAL;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xa.xa_vec)
+        free(xa.xa_vec);
+    if (xa.xa_nsc)
+        xml_nsctx_free(xa.xa_nsc);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
+
+/*! Register leafref in reverse index of its target, if possible
+ *
+ * Only simple absolute leafref paths without predicates that resolve to a leaf or
+ * leaf-list are indexed. A deleted or changed target instance then only needs to check
+ * the referring instances with the same value, instead of all referring instances.
+ * @param[in]  yd     Dependency entry of referring leaf
+ * @param[in]  ys     Referring leaf or leaf-list
+ * @param[in]  ypath  Leafref path statement
+ * @retval     1      Registered in reverse index
+ * @retval     0      Not possible, use regular dependency
+ * @retval    -1      Error
+ */
+static int
+yang_deps_leafref_index(yang_deps *yd,
+                        yang_stmt *ys,
+                        yang_stmt *ypath)
+{
+    int           retval = -1;
+    xpath_tree   *xptree = NULL;
+    xpdeps_acc    xa = {0,};
+    xpdeps_state  ctx = {0,};
+    char         *path;
+    yang_stmt    *ytarget;
+    yang_deps    *ydt;
+    enum rfc_6020 keyw;
+
+    path = yang_argument_get(ypath);
+    if (path == NULL || *path != '/' || strchr(path, '[') != NULL)
+        goto nok;
+    xa.xa_ystmt = ypath;
+    xa.xa_yspec = ys_spec(ypath);
+    if (xml_nsctx_yang(ypath, &xa.xa_nsc) < 0)
+        goto done;
+    if (xpath_parse(path, &xptree) < 0){
+        clixon_err_reset();
+        goto nok;
+    }
+    if (xpdeps_expr(xptree, &ctx, &xa) < 0)
+        goto done;
+    if (xa.xa_always || xa.xa_up || xa.xa_len != 1)
+        goto nok;
+    ytarget = xa.xa_vec[0];
+    keyw = yang_keyword_get(ytarget);
+    if (keyw != Y_LEAF && keyw != Y_LEAF_LIST)
+        goto nok;
+    if ((ydt = yang_deps_get(ytarget)) == NULL &&
+        (ydt = yang_deps_new(ytarget)) == NULL)
+        goto done;
+    if (yang_deps_vec_add(&ydt->yd_refs, &ydt->yd_rlen, ys) < 0)
+        goto done;
+    yd->yd_flags |= (YD_OWN|YD_LEAFREF);
+    retval = 1;
+ done:
+    if (xa.xa_vec)
+        free(xa.xa_vec);
+    if (xa.xa_nsc)
+        xml_nsctx_free(xa.xa_nsc);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+ nok:
+    retval = 0;
+    goto done;
+}
+
+/*! Add leafref path dependencies of a type, recursively for unions
+ *
+ * @param[in]  yd     Dependency entry
+ * @param[in]  ys     Leaf or leaf-list
+ * @param[in]  ytype  Resolved type
+ * @param[in]  offset See yang_deps_xpath
+ * @param[in]  union_member  Type is member of union, do not use reverse index
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_deps_type(yang_deps *yd,
+               yang_stmt *ys,
+               yang_stmt *ytype,
+               int        offset,
+               int        union_member)
+{
+    int        retval = -1;
+    int        ret;
+    yang_stmt *ypath;
+    yang_stmt *yreqi;
+    yang_stmt *ytsub;
+    yang_stmt *yrestype;
+    cg_var    *cv;
+    char      *restype;
+    int        inext;
+
+    if (ytype == NULL || (restype = yang_argument_get(ytype)) == NULL)
+        goto ok;
+    if (strcmp(restype, "leafref") == 0){
+        if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL &&
+            (cv = yang_cv_get(yreqi)) != NULL &&
+            cv_bool_get(cv) == 0)
+            goto ok;
+        if ((ypath = yang_find(ytype, Y_PATH, NULL)) == NULL)
+            goto ok;
+        if (!union_member){
+            if ((ret = yang_deps_leafref_index(yd, ys, ypath)) < 0)
+                goto done;
+            if (ret == 1)
+                goto ok;
+        }
+        if (yang_deps_xpath(yd, ypath, yang_argument_get(ypath), offset) < 0)
+            goto done;
+    }
+    else if (strcmp(restype, "union") == 0){
+        inext = 0;
+        while ((ytsub = yn_iter(ytype, &inext)) != NULL){
+            if (yang_keyword_get(ytsub) != Y_TYPE)
+                continue;
+            if (yang_type_resolve(ys, ys, ytsub, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+                goto done;
+            if (yang_deps_type(yd, ys, yrestype, offset, 1) < 0)
+                goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add when dependencies of a node, own when and augment/uses when
+ *
+ * @param[in]  yd     Dependency entry
+ * @param[in]  ys     Node with when
+ * @param[in]  offset Levels between the node of yd and ys
+ */
+static int
+yang_deps_when(yang_deps *yd,
+               yang_stmt *ys,
+               int        offset)
+{
+    int        retval = -1;
+    yang_stmt *yw;
+
+    /* Augment/uses when: context is parent of node */
+    if ((yw = yang_when_get(NULL, ys)) != NULL)
+        if (yang_deps_xpath(yd, yw, yang_argument_get(yw), offset + 1) < 0)
+            goto done;
+    if ((yw = yang_find(ys, Y_WHEN, NULL)) != NULL)
+        if (yang_deps_xpath(yd, yw, yang_argument_get(yw), offset) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add when dependencies of descendants evaluated when checking mandatory nodes
+ *
+ * Mandatory checks of a node evaluates when-statements of children, through choice/case
+ * and non-presence containers
+ * @param[in]  yd     Dependency entry
+ * @param[in]  ys     Parent
+ * @param[in]  offset Levels between the node of yd and children of ys
+ * @see check_mandatory
+ */
+static int
+yang_deps_child_when(yang_deps *yd,
+                     yang_stmt *ys,
+                     int        offset)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+    int        inext;
+
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL){
+        switch (yang_keyword_get(yc)){
+        case Y_CHOICE:
+        case Y_CASE:
+            if (yang_deps_when(yd, yc, offset - 1) < 0)
+                goto done;
+            if (yang_deps_child_when(yd, yc, offset) < 0)
+                goto done;
+            break;
+        case Y_CONTAINER:
+            if (yang_deps_when(yd, yc, offset) < 0)
+                goto done;
+            if (yang_find(yc, Y_PRESENCE, NULL) == NULL)
+                if (yang_deps_child_when(yd, yc, offset - 1) < 0)
+                    goto done;
+            break;
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+        case Y_LIST:
+        case Y_ANYDATA:
+        case Y_ANYXML:
+            if (yang_deps_when(yd, yc, offset) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compute dependency entry of a data node and its subtree, post-order
+ *
+ * @param[in]  ys     YANG data node (or choice/case)
+ * @param[in]  ytop   Entry of Y_SPEC, collects global nodes
+ * @param[out] ydp    Entry of ys, if any
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_deps_node(yang_stmt  *ys,
+               yang_deps  *ytop,
+               yang_deps **ydp)
+{
+    int           retval = -1;
+    yang_deps    *yd = NULL;
+    yang_deps    *ydc;
+    yang_stmt    *yc;
+    yang_stmt    *ytype;
+    enum rfc_6020 keyw;
+    int           inext;
+    int           level;
+    int           reach;
+    int           i;
+
+    *ydp = NULL;
+    keyw = yang_keyword_get(ys);
+    /* Created by yang_deps_clear, references may already be registered */
+    if ((yd = yang_deps_get(ys)) == NULL &&
+        (yd = yang_deps_new(ys)) == NULL)
+        goto done;
+    /* Choice and case are not XML levels */
+    level = (keyw == Y_CHOICE || keyw == Y_CASE) ? 0 : 1;
+    if (keyw != Y_CHOICE && keyw != Y_CASE){
+        /* Own constraints */
+        inext = 0;
+        while ((yc = yn_iter(ys, &inext)) != NULL)
+            if (yang_keyword_get(yc) == Y_MUST)
+                if (yang_deps_xpath(yd, yc, yang_argument_get(yc), 0) < 0)
+                    goto done;
+        if (yang_deps_when(yd, ys, 0) < 0)
+            goto done;
+        if (keyw == Y_LEAF || keyw == Y_LEAF_LIST){
+            if (yang_type_get(ys, NULL, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+                goto done;
+            if (yang_deps_type(yd, ys, ytype, 0, 0) < 0)
+                goto done;
+        }
+        if (yang_deps_child_when(yd, ys, -1) < 0)
+            goto done;
+    }
+    if (yd->yd_flags & YD_ALWAYS)
+        yd->yd_flags |= YD_SUB_ALWAYS;
+    if (yd->yd_flags & YD_GLOBAL){
+        yd->yd_flags |= YD_SUB_GLOBAL;
+        if (yang_deps_vec_add(&ytop->yd_vec, &ytop->yd_len, ys) < 0)
+            goto done;
+    }
+    yd->yd_reach = yd->yd_up;
+    /* Children */
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL){
+        if (!yang_datanode(yc) &&
+            yang_keyword_get(yc) != Y_CHOICE &&
+            yang_keyword_get(yc) != Y_CASE)
+            continue;
+        if (yang_deps_node(yc, ytop, &ydc) < 0)
+            goto done;
+        if (ydc == NULL)
+            continue;
+        yd->yd_flags |= ydc->yd_flags & (YD_SUB_ALWAYS|YD_SUB_GLOBAL);
+        level = (yang_keyword_get(yc) == Y_CHOICE || yang_keyword_get(yc) == Y_CASE) ? 0 : 1;
+        reach = ydc->yd_reach - level;
+        if (reach > yd->yd_reach)
+            yd->yd_reach = reach;
+    }
+    /* Referenced nodes need entries to be marked dirty, see yang_deps_mark_ancestors */
+    for (i=0; i<yd->yd_len; i++){
+        if (yang_deps_get(yd->yd_vec[i]) == NULL &&
+            yang_deps_new(yd->yd_vec[i]) == NULL)
+            goto done;
+    }
+    *ydp = yd;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Create empty dependency entries for a data node and its subtree
+ *
+ * Done before computing so that references to nodes not yet computed are kept
+ * @param[in]  ys     YANG data node (or choice/case)
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_deps_clear(yang_stmt *ys)
+{
+    yang_stmt *yc;
+    int        inext;
+
+    /* Stale flag from copy or earlier computation */
+    yang_flag_reset(ys, YANG_FLAG_DEPS);
+    if (yang_deps_new(ys) == NULL)
+        return -1;
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL){
+        if (!yang_datanode(yc) &&
+            yang_keyword_get(yc) != Y_CHOICE &&
+            yang_keyword_get(yc) != Y_CASE)
+            continue;
+        if (yang_deps_clear(yc) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Compute constraint dependency graph for a YANG spec
+ *
+ * Called after populate/augment, recomputes the whole spec since new modules
+ * may augment existing ones.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Top-level YANG spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see yang_parse_post
+ */
+int
+yang_deps_populate(clixon_handle h,
+                   yang_stmt    *yspec)
+{
+    int        retval = -1;
+    yang_deps *ytop;
+    yang_deps *yd;
+    yang_stmt *ymod;
+    yang_stmt *yc;
+    int        inext;
+    int        inext2;
+    int        pass;
+
+    if (!clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL"))
+        goto ok;
+    clixon_debug(CLIXON_DBG_YANG, "");
+    leafref_index_clear();
+    yang_flag_reset(yspec, YANG_FLAG_DEPS);
+    if ((ytop = yang_deps_new(yspec)) == NULL)
+        goto done;
+    /* Pass 0: create empty entries, pass 1: compute */
+    for (pass=0; pass<2; pass++){
+        inext = 0;
+        while ((ymod = yn_iter(yspec, &inext)) != NULL){
+            if (yang_keyword_get(ymod) != Y_MODULE &&
+                yang_keyword_get(ymod) != Y_SUBMODULE)
+                continue;
+            inext2 = 0;
+            while ((yc = yn_iter(ymod, &inext2)) != NULL){
+                if (!yang_datanode(yc) && yang_keyword_get(yc) != Y_CHOICE)
+                    continue;
+                if (pass == 0){
+                    if (yang_deps_clear(yc) < 0)
+                        goto done;
+                }
+                else if (yang_deps_node(yc, ytop, &yd) < 0)
+                    goto done;
+            }
+        }
+    }
+    clixon_debug(CLIXON_DBG_YANG, "global constraints:%d", ytop->yd_len);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if dependency graph is computed for YANG spec
+ *
+ * @param[in]  yspec  Top-level YANG spec
+ * @retval     1      Yes
+ * @retval     0      No
+ */
+int
+yang_deps_exists(yang_stmt *yspec)
+{
+    return yang_deps_get(yspec) != NULL;
+}
+
+/*! Mark entry as changed in transaction
+ */
+static int
+yang_deps_mark(yang_deps *yd,
+               uint16_t   flag)
+{
+    if (_yang_deps_marked_len >= _yang_deps_marked_max){
+        _yang_deps_marked_max = _yang_deps_marked_max ? 2*_yang_deps_marked_max : 64;
+        if ((_yang_deps_marked = realloc(_yang_deps_marked,
+                                         _yang_deps_marked_max*sizeof(yang_deps*))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    _yang_deps_marked[_yang_deps_marked_len++] = yd;
+    yd->yd_flags |= flag;
+    return 0;
+}
+
+/*! Mark a schema node and its ancestors with flag
+ *
+ * Stops at first ancestor already marked, since then all its ancestors are marked
+ */
+static int
+yang_deps_mark_ancestors(yang_stmt *ys,
+                         uint16_t   flag)
+{
+    yang_deps *yd;
+
+    while (ys != NULL && yang_keyword_get(ys) != Y_SPEC){
+        if ((yd = yang_deps_get(ys)) != NULL){
+            if (yd->yd_flags & flag)
+                break;
+            if (yang_deps_mark(yd, flag) < 0)
+                return -1;
+        }
+        ys = yang_parent_get(ys);
+    }
+    return 0;
+}
+
+/*! xml_apply callback: mark schema of node dirty
+ */
+static int
+xml_deps_dirty_apply(cxobj *x,
+                     void  *arg)
+{
+    return yang_deps_mark_ancestors(xml_spec(x), YD_DIRTY);
+}
+
+/*! Mark schema nodes changed in a transaction and compute affected global constraints
+ *
+ * @param[in]  yspec  Top-level YANG spec
+ * @param[in]  dvec   Deleted XML nodes (recursively)
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added XML nodes (recursively)
+ * @param[in]  alen   Length of avec
+ * @param[in]  cvec   Changed XML nodes
+ * @param[in]  clen   Length of cvec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_deps_reset  Must be called after use
+ */
+int
+xml_deps_mark(yang_stmt *yspec,
+              cxobj    **dvec,
+              int        dlen,
+              cxobj    **avec,
+              int        alen,
+              cxobj    **cvec,
+              int        clen)
+{
+    int        retval = -1;
+    yang_deps *ytop;
+    yang_deps *yd;
+    int        i;
+    int        j;
+
+    if ((ytop = yang_deps_get(yspec)) == NULL)
+        goto ok;
+    for (i=0; i<dlen; i++){
+        if (yang_deps_mark_ancestors(xml_spec(dvec[i]), YD_DIRTY) < 0)
+            goto done;
+        if (xml_apply(dvec[i], CX_ELMNT, xml_deps_dirty_apply, NULL) < 0)
+            goto done;
+    }
+    for (i=0; i<alen; i++){
+        if (yang_deps_mark_ancestors(xml_spec(avec[i]), YD_DIRTY) < 0)
+            goto done;
+        if (xml_apply(avec[i], CX_ELMNT, xml_deps_dirty_apply, NULL) < 0)
+            goto done;
+    }
+    for (i=0; i<clen; i++)
+        if (yang_deps_mark_ancestors(xml_spec(cvec[i]), YD_DIRTY) < 0)
+            goto done;
+    /* Global constraints with dirty references */
+    for (i=0; i<ytop->yd_len; i++){
+        if ((yd = yang_deps_get(ytop->yd_vec[i])) == NULL)
+            continue;
+        for (j=0; j<yd->yd_len; j++)
+            if (yang_deps_dirty(yd->yd_vec[j]))
+                break;
+        if (j < yd->yd_len)
+            if (yang_deps_mark_ancestors(ytop->yd_vec[i], YD_AFFECTED) < 0)
+                goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Reset transaction marks
+ *
+ * The change of reverse leafref counts is kept until xml_deps_leafref_commit
+ * @retval     0      OK
+ */
+int
+xml_deps_reset(void)
+{
+    size_t         i;
+
+    for (i=0; i<_yang_deps_marked_len; i++)
+        _yang_deps_marked[i]->yd_flags &= ~(YD_DIRTY|YD_AFFECTED);
+    _yang_deps_marked_len = 0;
+    return 0;
+}
+
+/*! Check if schema node (or descendant) is changed in transaction
+ *
+ * A node without entry is not referenced and therefore never marked
+ * @param[in]  ys   YANG node
+ * @retval     1    Changed
+ * @retval     0    Not changed
+ */
+int
+yang_deps_dirty(yang_stmt *ys)
+{
+    yang_deps *yd;
+
+    if ((yd = yang_deps_get(ys)) == NULL)
+        return 0;
+    return (yd->yd_flags & YD_DIRTY) != 0;
+}
+
+/*! Get ancestor n levels above, or topmost
+ */
+static cxobj *
+xml_deps_ancestor(cxobj *x,
+                  int    n)
+{
+    cxobj *xp;
+
+    while (n-- > 0 && (xp = xml_parent(x)) != NULL)
+        x = xp;
+    return x;
+}
+
+/*! Check if XML node is changed in transaction, by flags set in compute_diffs
+ */
+static int
+xml_deps_changed(cxobj *x)
+{
+    return xml_flag(x, XML_FLAG_ADD|XML_FLAG_CHANGE) != 0;
+}
+
+/*! Decide how an XML node is revalidated in a transaction
+ *
+ * Assumes XML_FLAG_ADD and XML_FLAG_CHANGE are set on added and changed nodes and their
+ * ancestors in the target tree, also for ancestors of deleted nodes, and xml_deps_mark
+ * has been called.
+ * @param[in]  xt       XML node in target tree
+ * @param[in]  yt       YANG spec of xt
+ * @param[out] own      If set, evaluate constraints of xt itself
+ * @param[out] descend  If set, descend into children of xt
+ * @retval     0        OK
+ */
+int
+xml_deps_check(cxobj     *xt,
+               yang_stmt *yt,
+               int       *own,
+               int       *descend)
+{
+    yang_deps *yd;
+    int        j;
+
+    if (xml_deps_changed(xt)){
+        *own = 1;
+        *descend = 1;
+        return 0;
+    }
+    *own = 0;
+    *descend = 0;
+    if ((yd = yang_deps_get(yt)) == NULL)
+        return 0;
+    if (yd->yd_flags & YD_OWN){
+        if (yd->yd_flags & YD_ALWAYS)
+            *own = 1;
+        else if (yd->yd_up > 0 && xml_deps_changed(xml_deps_ancestor(xt, yd->yd_up)))
+            *own = 1;
+        else if ((yd->yd_flags & YD_GLOBAL) && (yd->yd_flags & YD_AFFECTED)){
+            for (j=0; j<yd->yd_len; j++)
+                if (yang_deps_dirty(yd->yd_vec[j])){
+                    *own = 1;
+                    break;
+                }
+        }
+    }
+    if (yd->yd_flags & (YD_SUB_ALWAYS|YD_AFFECTED))
+        *descend = 1;
+    else if (yd->yd_reach > 0 && xml_deps_changed(xml_deps_ancestor(xt, yd->yd_reach)))
+        *descend = 1;
+    return 0;
+}
+
+/*! Free all reverse leafref indexes
+ */
+static int
+leafref_index_clear(void)
+{
+    int            i;
+    leafref_index *li;
+
+    for (i=0; i<_leafref_index_len; i++){
+        li = &_leafref_index[i];
+        if (li->li_count)
+            clicon_hash_free(li->li_count);
+        if (li->li_delta)
+            clicon_hash_free(li->li_delta);
+    }
+    if (_leafref_index){
+        free(_leafref_index);
+        _leafref_index = NULL;
+    }
+    _leafref_index_len = 0;
+    _leafref_index_gen = 0;
+    _leafref_delta_gen = 0;
+    return 0;
+}
+
+/*! Empty a count hash of a reverse leafref index
+ */
+static int
+leafref_hash_reset(clicon_hash_t **hash)
+{
+    if (*hash)
+        clicon_hash_free(*hash);
+    if ((*hash = clicon_hash_init()) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Get reverse leafref index of a referring leaf, create it if not found
+ *
+ * @param[in]  yr     Referring leaf or leaf-list
+ * @retval     li     Reverse leafref index
+ * @retval     NULL   Error
+ */
+static leafref_index *
+leafref_index_get(yang_stmt *yr)
+{
+    leafref_index *li;
+    int            i;
+
+    for (i=0; i<_leafref_index_len; i++)
+        if (_leafref_index[i].li_yang == yr)
+            return &_leafref_index[i];
+    if ((_leafref_index = realloc(_leafref_index,
+                                  (_leafref_index_len+1)*sizeof(leafref_index))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return NULL;
+    }
+    li = &_leafref_index[_leafref_index_len++];
+    memset(li, 0, sizeof(*li));
+    li->li_yang = yr;
+    if ((li->li_count = clicon_hash_init()) == NULL ||
+        (li->li_delta = clicon_hash_init()) == NULL)
+        return NULL;
+    return li;
+}
+
+/*! Add n to the count of a value, entries that reach zero are removed
+ */
+static int
+leafref_count_add(clicon_hash_t *hash,
+                  char          *body,
+                  int            n)
+{
+    int *ip;
+
+    if ((ip = clicon_hash_value(hash, body, NULL)) != NULL){
+        if ((*ip += n) == 0)
+            clicon_hash_del(hash, body);
+    }
+    else if (clicon_hash_add(hash, body, &n, sizeof(n)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Get count of referring instances of a value in the target tree
+ */
+static int
+leafref_count_get(leafref_index *li,
+                  char          *body)
+{
+    int *ip;
+    int  n = 0;
+
+    if ((ip = clicon_hash_value(li->li_count, body, NULL)) != NULL)
+        n += *ip;
+    if ((ip = clicon_hash_value(li->li_delta, body, NULL)) != NULL)
+        n += *ip;
+    return n;
+}
+
+/*! Find instances of a schema node in an XML tree
+ *
+ * Only descends into children whose schema node is a data ancestor of the node.
+ * If body is set, only instances with that value are collected, otherwise all
+ * instances are counted in li_count.
+ * @param[in]  xt     XML tree
+ * @param[in]  yvec   Data node ancestors of indexed node, top first, last is indexed node
+ * @param[in]  ylen   Length of yvec
+ * @param[in]  li     Reverse leafref index
+ * @param[in]  body   Value to collect, or NULL to count all
+ * @param[out] xvec   Collected XML nodes if body is set
+ * @param[out] xlen   Length of xvec
+ */
+static int
+leafref_index_walk(cxobj          *xt,
+                   yang_stmt     **yvec,
+                   int             ylen,
+                   leafref_index  *li,
+                   char           *body,
+                   cxobj        ***xvec,
+                   int            *xlen)
+{
+    cxobj *x;
+    char  *b;
+
+    if (ylen == 0)
+        return 0;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if (xml_spec(x) != yvec[0])
+            continue;
+        if (ylen > 1){
+            if (leafref_index_walk(x, yvec+1, ylen-1, li, body, xvec, xlen) < 0)
+                return -1;
+        }
+        else if ((b = xml_body(x)) == NULL)
+            continue;
+        else if (body == NULL){
+            if (leafref_count_add(li->li_count, b, 1) < 0)
+                return -1;
+        }
+        else if (strcmp(b, body) == 0){
+            if (cxvec_append(x, xvec, xlen) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Walk all instances of a referring leaf in an XML tree
+ *
+ * @param[in]  xt     Any node in the XML tree, the walk starts at its top
+ * @param[in]  li     Reverse leafref index
+ * @param[in]  body   Value to collect, or NULL to count all
+ * @param[out] xvec   Collected XML nodes if body is set
+ * @param[out] xlen   Length of xvec
+ * @see leafref_index_walk
+ */
+static int
+leafref_index_walk_top(cxobj          *xt,
+                       leafref_index  *li,
+                       char           *body,
+                       cxobj        ***xvec,
+                       int            *xlen)
+{
+    int         retval = -1;
+    yang_stmt **yvec = NULL;
+    yang_stmt  *y;
+    int         ylen = 0;
+    int         i;
+
+    while (xml_parent(xt) != NULL)
+        xt = xml_parent(xt);
+    /* Data node path from top, choice/case are not XML levels */
+    for (y = li->li_yang; y != NULL; y = xpdeps_parent(y))
+        ylen++;
+    if ((yvec = malloc(ylen*sizeof(yang_stmt*))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    i = ylen;
+    for (y = li->li_yang; y != NULL; y = xpdeps_parent(y))
+        yvec[--i] = y;
+    if (leafref_index_walk(xt, yvec, ylen, li, body, xvec, xlen) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (yvec)
+        free(yvec);
+    return retval;
+}
+
+/*! xml_apply callback: add change of a referring leaf instance to reverse index
+ *
+ * @param[in]  x     XML node
+ * @param[in]  arg   Pointer to int: +1 for added and -1 for removed instances
+ */
+static int
+leafref_delta_apply(cxobj *x,
+                    void  *arg)
+{
+    int            n = *(int*)arg;
+    yang_deps     *yd;
+    leafref_index *li;
+    char          *body;
+
+    if ((yd = yang_deps_get(xml_spec(x))) == NULL ||
+        (yd->yd_flags & YD_LEAFREF) == 0 ||
+        (body = xml_body(x)) == NULL)
+        return 0;
+    if ((li = leafref_index_get(xml_spec(x))) == NULL)
+        return -1;
+    return leafref_count_add(li->li_delta, body, n);
+}
+
+/*! Compute change of reverse leafref indexes of a transaction
+ *
+ * Only the deleted, added and changed subtrees are visited. The counts of the
+ * source tree are kept if they are from the same source generation.
+ * @param[in]  gen    Generation of source tree, or 0 if not known
+ * @param[in]  dvec   Deleted XML nodes (in source tree)
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added XML nodes (in target tree)
+ * @param[in]  alen   Length of avec
+ * @param[in]  scvec  Changed XML nodes (in source tree)
+ * @param[in]  tcvec  Changed XML nodes (in target tree)
+ * @param[in]  clen   Length of scvec and tcvec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_deps_leafref_commit
+ */
+int
+xml_deps_leafref_begin(uint64_t gen,
+                       cxobj  **dvec,
+                       int      dlen,
+                       cxobj  **avec,
+                       int      alen,
+                       cxobj  **scvec,
+                       cxobj  **tcvec,
+                       int      clen)
+{
+    leafref_index *li;
+    int            i;
+    int            n;
+
+    for (i=0; i<_leafref_index_len; i++){
+        li = &_leafref_index[i];
+        if (leafref_hash_reset(&li->li_delta) < 0)
+            return -1;
+        if (gen == 0 || gen != _leafref_index_gen){
+            if (li->li_counted && leafref_hash_reset(&li->li_count) < 0)
+                return -1;
+            li->li_counted = 0;
+        }
+    }
+    _leafref_index_gen = gen;
+    _leafref_delta_gen = gen;
+    n = -1;
+    for (i=0; i<dlen; i++){
+        if (leafref_delta_apply(dvec[i], &n) < 0)
+            return -1;
+        if (xml_apply(dvec[i], CX_ELMNT, leafref_delta_apply, &n) < 0)
+            return -1;
+    }
+    for (i=0; i<clen; i++)
+        if (leafref_delta_apply(scvec[i], &n) < 0)
+            return -1;
+    n = 1;
+    for (i=0; i<alen; i++){
+        if (leafref_delta_apply(avec[i], &n) < 0)
+            return -1;
+        if (xml_apply(avec[i], CX_ELMNT, leafref_delta_apply, &n) < 0)
+            return -1;
+    }
+    for (i=0; i<clen; i++)
+        if (leafref_delta_apply(tcvec[i], &n) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Apply the change of reverse leafref indexes after a successful commit
+ *
+ * @param[in]  gen    Generation of the new source tree (running), or 0 if not known
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_deps_leafref_begin
+ */
+int
+xml_deps_leafref_commit(uint64_t gen)
+{
+    leafref_index *li;
+    int            valid;
+    int            i;
+    char         **keys = NULL;
+    size_t         klen;
+    size_t         k;
+    int           *ip;
+
+    valid = gen != 0 && _leafref_delta_gen != 0 && _leafref_delta_gen == _leafref_index_gen;
+    for (i=0; i<_leafref_index_len; i++){
+        li = &_leafref_index[i];
+        if (valid && li->li_counted){
+            if (clicon_hash_keys(li->li_delta, &keys, &klen) < 0)
+                return -1;
+            for (k=0; k<klen; k++)
+                if ((ip = clicon_hash_value(li->li_delta, keys[k], NULL)) != NULL &&
+                    leafref_count_add(li->li_count, keys[k], *ip) < 0)
+                    break;
+            if (keys){
+                free(keys);
+                keys = NULL;
+            }
+            if (k < klen)
+                return -1;
+        }
+        else if (li->li_counted){
+            if (leafref_hash_reset(&li->li_count) < 0)
+                return -1;
+            li->li_counted = 0;
+        }
+        if (leafref_hash_reset(&li->li_delta) < 0)
+            return -1;
+    }
+    _leafref_index_gen = valid ? gen : 0;
+    _leafref_delta_gen = 0;
+    return 0;
+}
+
+/*! Get referring XML nodes of a removed or changed leafref target
+ *
+ * Uses the reverse leafref counts to decide if any referring instance has the value
+ * of the removed target. Only then the target tree is searched for those instances.
+ * The caller checks whether the value still exists elsewhere in the target tree.
+ * @param[in]  xt     Top-level target XML tree
+ * @param[in]  xs     Removed or changed leafref target in source tree
+ * @param[out] xvec   Referring XML nodes in target tree. Free with free()
+ * @param[out] xlen   Length of xvec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_deps_leafref_begin  Must be called before
+ */
+int
+xml_deps_leafref_referrers(cxobj   *xt,
+                           cxobj   *xs,
+                           cxobj ***xvec,
+                           int     *xlen)
+{
+    int            retval = -1;
+    yang_deps     *yd;
+    leafref_index *li;
+    char          *body;
+    int            i;
+
+    *xvec = NULL;
+    *xlen = 0;
+    if ((yd = yang_deps_get(xml_spec(xs))) == NULL ||
+        (body = xml_body(xs)) == NULL)
+        goto ok;
+    for (i=0; i<yd->yd_rlen; i++){
+        if ((li = leafref_index_get(yd->yd_refs[i])) == NULL)
+            goto done;
+        if (!li->li_counted){
+            if (leafref_index_walk_top(xs, li, NULL, NULL, NULL) < 0)
+                goto done;
+            li->li_counted = 1;
+            clixon_debug(CLIXON_DBG_XPATH|CLIXON_DBG_DETAIL, "%s: counted",
+                         yang_argument_get(li->li_yang));
+        }
+        if (leafref_count_get(li, body) <= 0)
+            continue;
+        if (leafref_index_walk_top(xt, li, body, xvec, xlen) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! xml_apply callback: collect removed leafref targets
+ */
+static int
+xml_deps_removed_apply(cxobj *x,
+                       void  *arg)
+{
+    clixon_xvec *xv = (clixon_xvec*)arg;
+    yang_deps   *yd;
+
+    if ((yd = yang_deps_get(xml_spec(x))) != NULL && yd->yd_rlen > 0)
+        if (clixon_xvec_append(xv, x) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Collect leafref targets in source tree that are deleted or changed in a transaction
+ *
+ * @param[in]  dvec   Deleted XML nodes (in source tree)
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  scvec  Changed XML nodes (in source tree)
+ * @param[in]  clen   Length of scvec
+ * @param[out] xv     Vector of removed targets
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_deps_leafref_referrers
+ */
+int
+xml_deps_leafref_removed(cxobj      **dvec,
+                         int          dlen,
+                         cxobj      **scvec,
+                         int          clen,
+                         clixon_xvec *xv)
+{
+    int i;
+
+    for (i=0; i<dlen; i++){
+        if (xml_deps_removed_apply(dvec[i], xv) < 0)
+            return -1;
+        if (xml_apply(dvec[i], CX_ELMNT, xml_deps_removed_apply, xv) < 0)
+            return -1;
+    }
+    for (i=0; i<clen; i++)
+        if (xml_deps_removed_apply(scvec[i], xv) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Free a dependency entry
+ */
+static int
+yang_deps_free(yang_deps *yd)
+{
+    if (yd->yd_vec)
+        free(yd->yd_vec);
+    if (yd->yd_refs)
+        free(yd->yd_refs);
+    free(yd);
+    return 0;
+}
+
+/*! Remove dependency entry of a yang node that is freed
+ *
+ * @param[in]  ys  YANG node
+ * @see ys_free1
+ */
+int
+yang_deps_drop(yang_stmt *ys)
+{
+    yang_deps *yd;
+
+    if (_yang_deps_map != NULL &&
+        (yd = clixon_ptr2ptr_del(_yang_deps_map, &_yang_deps_map_len, ys)) != NULL){
+        /* Reverse leafref indexes refer to referring leafs */
+        if (yd->yd_flags & YD_LEAFREF)
+            leafref_index_clear();
+        yang_deps_free(yd);
+    }
+    return 0;
+}
+
+/*! Free dependency graph
+ *
+ * @param[in]  h  Clixon handle
+ * @see yang_exit
+ */
+int
+yang_deps_exit(clixon_handle h)
+{
+    size_t     i;
+    yang_deps *yd;
+
+    /* Remaining entries of specs not yet freed, YANG nodes are not accessed */
+    for (i=0; i<_yang_deps_map_len; i++){
+        if ((yd = _yang_deps_map[i].mp_p1) != NULL)
+            yang_deps_free(yd);
+    }
+    if (_yang_deps_map){
+        free(_yang_deps_map);
+        _yang_deps_map = NULL;
+    }
+    _yang_deps_map_len = 0;
+    if (_yang_deps_marked){
+        free(_yang_deps_marked);
+        _yang_deps_marked = NULL;
+    }
+    _yang_deps_marked_len = 0;
+    _yang_deps_marked_max = 0;
+    xml_deps_reset();
+    leafref_index_clear();
+    return 0;
+}
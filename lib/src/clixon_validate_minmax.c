@@ -95,29 +95,157 @@ struct vec_order {
     size_t        vo_slen;   /* Length of vo_strvec (is actually global to vector) */
 };
 
-/*! New element last in list, check if already exists if so return -1
+/*! Hash set of value tuples used for unique checks
  *
- * @param[in]  vec   Vector of existing entries (new is last)
- * @param[in]  i1    The new entry is placed at vec[i1]
- * @param[in]  vlen  Length of entry
- * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * Open addressing with linear probing. The set does not store values, only indexes
+ * into a value matrix owned by the caller, where tuple i is vec[i*vlen]..vec[i*vlen+vlen-1]
+ */
+struct unique_set {
+    int    *us_tab;   /* Index into caller value matrix, -1 if empty slot */
+    size_t  us_size;  /* Size of us_tab, power of 2 */
+    size_t  us_nr;    /* Number of entries */
+};
+
+/*! Hash of a value tuple, FNV-1a with separator between values
+ */
+static uint32_t
+unique_tuple_hash(char **tuple,
+                  int    vlen)
+{
+    uint32_t h = 2166136261u;
+    char    *b;
+    int      v;
+
+    for (v=0; v<vlen; v++){
+        for (b = tuple[v]; *b; b++){
+            h ^= (uint8_t)*b;
+            h *= 16777619u;
+        }
+        h ^= 0xff;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*! Initialize unique hash set
+ *
+ * @param[in]  us    Unique set
+ * @param[in]  nr    Expected number of entries
+ * @retval     0     OK
  * @retval    -1     Error
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
  */
 static int
-unique_search_xpath(cxobj  *x,
-                    char   *xpath,
-                    cvec   *nsc,
-                    char ***svec,
-                    size_t *slen)
+unique_set_init(struct unique_set *us,
+                size_t             nr)
+{
+    size_t size = 16;
+
+    while (size < 2*nr)
+        size <<= 1;
+    if ((us->us_tab = malloc(size*sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(us->us_tab, 0xff, size*sizeof(int)); /* -1 */
+    us->us_size = size;
+    us->us_nr = 0;
+    return 0;
+}
+
+static void
+unique_set_free(struct unique_set *us)
+{
+    if (us->us_tab)
+        free(us->us_tab);
+    memset(us, 0, sizeof(*us));
+}
+
+/*! Insert tuple i in unique hash set, return error if an equal tuple exists
+ *
+ * @param[in]  us    Unique set
+ * @param[in]  vec   Value matrix, NULL values not allowed
+ * @param[in]  vlen  Number of values in each tuple
+ * @param[in]  i     Index of new tuple
+ * @param[out] dupl  Index of duplicated tuple (if retval = 1)
+ * @retval     0     OK, entry is unique and inserted
+ * @retval     1     Duplicate detected
+ * @retval    -1     Error
+ */
+static int
+unique_set_insert(struct unique_set *us,
+                  char             **vec,
+                  int                vlen,
+                  int                i,
+                  int               *dupl)
+{
+    int     *tab;
+    size_t   size;
+    size_t   mask;
+    size_t   k;
+    size_t   s;
+    int      j;
+    int      v;
+
+    if (2*(us->us_nr+1) > us->us_size){ /* Grow and rehash */
+        tab = us->us_tab;
+        size = us->us_size;
+        if (unique_set_init(us, us->us_nr+1) < 0)
+            return -1;
+        mask = us->us_size - 1;
+        for (s=0; s<size; s++){
+            if ((j = tab[s]) < 0)
+                continue;
+            k = unique_tuple_hash(&vec[j*vlen], vlen) & mask;
+            while (us->us_tab[k] >= 0)
+                k = (k+1) & mask;
+            us->us_tab[k] = j;
+            us->us_nr++;
+        }
+        free(tab);
+    }
+    mask = us->us_size - 1;
+    k = unique_tuple_hash(&vec[i*vlen], vlen) & mask;
+    while ((j = us->us_tab[k]) >= 0){
+        for (v=0; v<vlen; v++)
+            if (strcmp(vec[j*vlen+v], vec[i*vlen+v]) != 0)
+                break;
+        if (v == vlen){
+            if (dupl)
+                *dupl = j;
+            return 1;
+        }
+        k = (k+1) & mask;
+    }
+    us->us_tab[k] = i;
+    us->us_nr++;
+    return 0;
+}
+
+/*! Collect values of an xpath, check if any value already exists
+ *
+ * @param[in]     x     XML list entry
+ * @param[in]     xpath Canonical xpath of descendant schema node
+ * @param[in]     nsc   Namespace context of xpath
+ * @param[in]     us    Unique hash set of svec
+ * @param[in,out] svec  Vector of values collected so far
+ * @param[in,out] slen  Length of svec
+ * @retval        1     OK, no duplicate
+ * @retval        0     Duplicate found
+ * @retval       -1     Error
+ */
+static int
+unique_search_xpath(cxobj             *x,
+                    char              *xpath,
+                    cvec              *nsc,
+                    struct unique_set *us,
+                    char            ***svec,
+                    size_t            *slen)
 {
     int     retval = -1;
     cxobj **xvec = NULL;
     size_t  xveclen;
     int     i;
-    int     s;
+    int     ret;
     cxobj  *xi;
     char   *bi;
 
@@ -128,20 +256,17 @@ unique_search_xpath(cxobj  *x,
         xi = xvec[i];
         if ((bi = xml_body(xi)) == NULL)
             break;
-        /* Check if bi is duplicate?
-         * XXX: sort svec?
-         */
-        for (s=0; s<(*slen); s++){
-            if (strcmp(bi, (*svec)[s]) == 0){
-                goto fail;
-            }
-        }
         (*slen) ++;
         if (((*svec) = realloc((*svec), (*slen)*sizeof(char*))) == NULL){
             clixon_err(OE_UNIX, errno, "realloc");
             goto done;
         }
         (*svec)[(*slen)-1] = bi;
+        /* Check if bi is duplicate */
+        if ((ret = unique_set_insert(us, *svec, 1, (*slen)-1, NULL)) < 0)
+            goto done;
+        if (ret == 1)
+            goto fail;
     } /* i search results */
     retval = 1;
  done:
@@ -159,17 +284,19 @@ unique_search_xpath(cxobj  *x,
  * @param[in]  i1     The new entry is placed at vec[i1]
  * @param[in]  vlen   Length of vec
  * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @param[out] dupl   Index of duplicated element (if retval = -1)
+ * @param[in]  us     Unique hash set of vec, used if not sorted
+ * @param[out] dupl   Index of duplicated element (if retval = 1)
  * @retval     0      OK, entry is unique
- * @retval    -1      Duplicate detected
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
+ * @retval     1      Duplicate detected
+ * @retval    -1      Error
  */
 static int
-check_insert_duplicate(char **vec,
-                       int    i1,
-                       int    vlen,
-                       int    sorted,
-                       int   *dupl)
+check_insert_duplicate(char             **vec,
+                       int                i1,
+                       int                vlen,
+                       int                sorted,
+                       struct unique_set *us,
+                       int               *dupl)
 {
     int i;
     int v;
@@ -188,26 +315,9 @@ check_insert_duplicate(char **vec,
         /* here we have passed thru all keys of previous element and they are all equal */
         if (dupl)
             *dupl = i;
-        return -1;
-    }
-    else{
-        for (i=0; i<i1; i++){
-            for (v=0; v<vlen; v++){
-                b = vec[i*vlen+v];
-                if (b == NULL || strcmp(b, vec[i1*vlen+v]))
-                    break;
-            }
-            if (v==vlen) /* duplicate */
-                break;
-        }
-        if (i<i1){
-            if (dupl)
-                *dupl = i;
-            return -1;
-        }
-        else
-            return 0;
+        return 1;
     }
+    return unique_set_insert(us, vec, vlen, i1, dupl);
 }
 
 /*! Given a list with unique constraint, detect duplicates
@@ -255,10 +365,11 @@ check_unique_list_direct(cxobj     *x,
     char     *str;
     cvec     *cvk;
     int       dupl;
+    int       ret;
+    struct unique_set us = {0,};
 
     /* If list and is sorted by system, then it is assumed elements are in key-order which is optimized
-     * Other cases are "unique" constraint or list sorted by user which is quadratic in complexity
-     * This second case COULD be optimized if binary insert is made on the vec vector.
+     * Other cases are "unique" constraint or list sorted by user which use a hash set
      */
     sorted = (yang_keyword_get(yu) == Y_LIST &&
               yang_find(y, Y_ORDERED_BY, "user") == NULL);
@@ -280,6 +391,8 @@ check_unique_list_direct(cxobj     *x,
         clixon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
+    if (!sorted && unique_set_init(&us, xml_child_nr(xt)) < 0)
+        goto done;
     /* Loop over children, then over each key, then search "backwards" */
     i = 0; /* x element index */
     do {
@@ -303,7 +416,9 @@ check_unique_list_direct(cxobj     *x,
         }
         if (cvi==NULL){
             /* Last element (i) is newly inserted, see if it is already there */
-            if (check_insert_duplicate(vec, i, clen, sorted, &dupl) < 0){
+            if ((ret = check_insert_duplicate(vec, i, clen, sorted, &us, &dupl)) < 0)
+                goto done;
+            if (ret == 1){
                 if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
                     goto done;
                 goto fail;
@@ -316,6 +431,7 @@ check_unique_list_direct(cxobj     *x,
     /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
+    unique_set_free(&us);
     if (xvec)
         free(xvec);
     if (vec)
@@ -367,6 +483,7 @@ check_unique_list(cxobj     *x,
     cvec   *cvk;
     cvec   *nsc0 = NULL;
     cvec   *nsc1 = NULL;
+    struct unique_set us = {0,};
 
     /* Check if multiple direct children */
     cvk = yang_cvec_get(yu);
@@ -392,9 +509,11 @@ check_unique_list(cxobj     *x,
         goto done;
     if (ret == 0)
         goto fail; // XXX set xret
+    if (unique_set_init(&us, xml_child_nr(xt)) < 0)
+        goto done;
     do {
         /* Collect search results from one */
-        if ((ret = unique_search_xpath(x, xpath1, nsc1, &svec, &slen)) < 0)
+        if ((ret = unique_search_xpath(x, xpath1, nsc1, &us, &svec, &slen)) < 0)
             goto done;
         if (ret == 0){
             if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
@@ -407,6 +526,7 @@ check_unique_list(cxobj     *x,
     /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
+    unique_set_free(&us);
     if (nsc0)
         cvec_free(nsc0);
     if (nsc1)
@@ -561,6 +681,28 @@ xml_unique_detect(cxobj     *x,
     goto done;
 }
 
+/*! Check if any element in a list segment is added or changed in a transaction
+ *
+ * @param[in]  x     First XML element of list
+ * @param[in]  xt    XML parent
+ * @param[in]  y     YANG of x
+ * @retval     1     At least one element is added or changed
+ * @retval     0     No element is added or changed
+ * @see compute_diffs where flags are set
+ */
+static int
+list_segment_changed(cxobj     *x,
+                     cxobj     *xt,
+                     yang_stmt *y)
+{
+    do {
+        if (xml_flag(x, XML_FLAG_ADD|XML_FLAG_CHANGE))
+            return 1;
+        x = xml_child_each(xt, x, CX_ELMNT);
+    } while (x && y == xml_spec(x));
+    return 0;
+}
+
 /*! Perform gap analysis in a child-vector interval [ye,y]
  *
  * Gap analysis here meaning if there is a list x with min-element constraint but there are no
@@ -678,6 +820,8 @@ xml_yang_minmax_gap_analysis(cxobj      *xt,
  * @param[in]  xt      XML parent (may have lists w unique constraints as child)
  * @param[in]  presence Set if called in a recursive loop (the caller will recurse anyway),
  *                     otherwise non-presence containers will be traversed
+ * @param[in]  diff    Only check unique constraints of lists with added or changed elements,
+ *                     assumes transaction flags are set, see xml_yang_validate_all_diff
  * @param[out] xret    Error XML tree. Free with xml_free after use
  * @retval     1       Validation OK
  * @retval     0       Validation failed (xret set)
@@ -690,6 +834,7 @@ xml_yang_minmax_gap_analysis(cxobj      *xt,
 int
 xml_yang_validate_minmax(cxobj  *xt,
                          int     presence,
+                         int     diff,
                          cxobj **xret)
 {
     int           retval = -1;
@@ -727,7 +872,7 @@ xml_yang_validate_minmax(cxobj  *xt,
             }
             nr=1;
             /* new list check */
-            if (ret){
+            if (ret && (!diff || list_segment_changed(x, xt, y))){
                 if (keyw == Y_LIST){
                     if ((ret = check_unique_list_direct(x, xt, y, y, xret)) < 0)
                         goto done;
@@ -767,7 +912,7 @@ xml_yang_validate_minmax(cxobj  *xt,
                 goto fail;
             if (presence && keyw == Y_CONTAINER &&
                 yang_find(y, Y_PRESENCE, NULL) == NULL){
-                if ((ret = xml_yang_validate_minmax(x, presence, xret)) < 0)
+                if ((ret = xml_yang_validate_minmax(x, presence, diff, xret)) < 0)
                     goto done;
                 if (ret == 0)
                     goto fail;
@@ -828,6 +973,29 @@ vec_free(struct vec_order *vec,
     return 0;
 }
 
+/*! Ensure room for one more element in vector, grow exponentially
+ *
+ * @param[in,out] vec   Vector
+ * @param[in]     vlen  Number of elements in use
+ * @param[in,out] vmax  Allocated number of elements
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+vec_order_grow(struct vec_order **vec,
+               size_t             vlen,
+               size_t            *vmax)
+{
+    if (vlen < *vmax)
+        return 0;
+    *vmax = *vmax ? 2*(*vmax) : 16;
+    if ((*vec = realloc(*vec, (*vmax)*sizeof(**vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    return 0;
+}
+
 /*! Leaf-list qsort comparison function
  */
 static int
@@ -1042,6 +1210,7 @@ xml_duplicate_detect1(cxobj  *xt,
     enum rfc_6020     keyw;
     char             *b;
     size_t            vlen = 0;
+    size_t            vmax = 0;
     struct vec_order *vec = NULL;
     cvec             *cvk;
     cg_var           *cvi;
@@ -1068,6 +1237,7 @@ xml_duplicate_detect1(cxobj  *xt,
                 goto done;
             vec = NULL;
             vlen = 0;
+            vmax = 0;
             slen0 = 0;
         }
         keyw = yang_keyword_get(y);
@@ -1078,10 +1248,8 @@ xml_duplicate_detect1(cxobj  *xt,
                 clixon_err(OE_YANG, 0, "Container vector mismatch %lu != 0", slen0);
                 goto done;
             }
-            if ((vec = realloc(vec, (vlen+1)*sizeof(*vec))) == NULL){
-                clixon_err(OE_UNIX, errno, "cvec_new");
+            if (vec_order_grow(&vec, vlen, &vmax) < 0)
                 goto done;
-            }
             vec[vlen].vo_slen = 0;
             vec[vlen].vo_strvec = NULL;
             vec[vlen].vo_xml = x;
@@ -1097,10 +1265,8 @@ xml_duplicate_detect1(cxobj  *xt,
                 clixon_err(OE_YANG, 0, "List key vector mismatch %lu != %lu", slen0, clen);
                 goto done;
             }
-            if ((vec = realloc(vec, (vlen+1)*sizeof(*vec))) == NULL){
-                clixon_err(OE_UNIX, errno, "cvec_new");
+            if (vec_order_grow(&vec, vlen, &vmax) < 0)
                 goto done;
-            }
             vec[vlen].vo_slen = clen;
             vec[vlen].vo_xml = x;
             if ((vec[vlen].vo_strvec = calloc(vec[vlen].vo_slen , sizeof(char*))) == NULL){
@@ -1128,21 +1294,21 @@ xml_duplicate_detect1(cxobj  *xt,
                 slen0 = clen;
                 vlen++;
             }
-            /* Special case of YANG unique statement */
-            if ((ret = xml_unique_detect(x, xt, y, xret)) < 0)
-                goto done;
-            if (ret == 0)
-                goto fail;
+            /* Special case of YANG unique statement, checks whole list from first element */
+            if (y != y0){
+                if ((ret = xml_unique_detect(x, xt, y, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
             break;
         case Y_LEAF_LIST:
             if (vlen > 0 && slen0 != 1){ /* Sanity check */
                 clixon_err(OE_YANG, 0, "Leaf-list key vector mismatch %lu != 1", slen0);
                 goto done;
             }
-            if ((vec = realloc(vec, (vlen+1)*sizeof(struct vec_order))) == NULL){
-                clixon_err(OE_UNIX, errno, "cvec_new");
+            if (vec_order_grow(&vec, vlen, &vmax) < 0)
                 goto done;
-            }
             vec[vlen].vo_xml = x;
             vec[vlen].vo_slen = 1;
             if ((vec[vlen].vo_strvec = calloc(vec[vlen].vo_slen, sizeof(char*))) == NULL){
@@ -1497,9 +1497,10 @@ xml_merge(cxobj     *x0,
  *
  * @param[in]  ytype   YANG type noden
  * @param[in]  valstr  Integer string value
- * @param[out] enumstr Value of enum, dont free
+ * @param[out] enumstr Value of enum, dont free. Not set if not found
  * @retval     0       OK
  * @retval    -1       Error
+ * Handles implicit values
  */
 int
 yang_valstr2enum(yang_stmt *ytype,
@@ -1507,23 +1508,23 @@ yang_valstr2enum(yang_stmt *ytype,
                  char     **enumstr)
 {
     int        retval = -1;
-    yang_stmt *yenum;
-    yang_stmt *yval; 
-    int        inext;
+    yang_stmt *yenum = NULL;
+    int64_t    val;
+    int        ret;
 
     if (enumstr == NULL){
         clixon_err(OE_UNIX, EINVAL, "str is NULL");
         goto done;
     }
-    inext = 0;
-    while ((yenum = yn_iter(ytype, &inext)) != NULL) {
-        if ((yval = yang_find(yenum, Y_VALUE, NULL)) == NULL)
-            goto done;
-        if (strcmp(yang_argument_get(yval), valstr) == 0)
-            break;
-    }
-    if (yenum)
+    if ((ret = parse_int64(valstr, &val, NULL)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    if ((ret = yang_enum_val2name(ytype, val, &yenum)) < 0)
+        goto done;
+    if (ret == 1)
         *enumstr = yang_argument_get(yenum);
+ ok:
     retval = 0;
  done:
     return retval;
@@ -1546,14 +1547,17 @@ yang_enum2valstr(yang_stmt *ytype,
                  char     **valstr)
 {
     int        retval = -1;
-    yang_stmt *yenum;
+    yang_stmt *yenum = NULL;
     yang_stmt *yval;
+    int        ret;
 
     if (valstr == NULL){
         clixon_err(OE_UNIX, EINVAL, "valstr is NULL");
         goto done;
     }
-    if ((yenum = yang_find(ytype, Y_ENUM, enumstr)) == NULL)
+    if ((ret = yang_enum_name2val(ytype, enumstr, &yenum, NULL)) < 0)
+        goto done;
+    if (ret == 0 || yang_keyword_get(yenum) != Y_ENUM)
         goto fail;
     /* Should assign value if yval not found */
     if ((yval = yang_find(yenum, Y_VALUE, NULL)) == NULL)
@@ -1582,22 +1586,21 @@ yang_enum2int(yang_stmt *ytype,
               int32_t   *val)
 {
     int        retval = -1;
-    yang_stmt *yenum;
-    cg_var    *cv;
+    yang_stmt *yenum = NULL;
+    int64_t    v;
+    int        ret;
 
     if (val == NULL){
         clixon_err(OE_UNIX, EINVAL, "val is NULL");
         goto done;
     }
-    if ((yenum = yang_find(ytype, Y_ENUM, enumstr)) == NULL){
-        clixon_err(OE_YANG, 0, "No such enum %s", enumstr);
+    if ((ret = yang_enum_name2val(ytype, enumstr, &yenum, &v)) < 0)
         goto done;
-    }
-    if ((cv = yang_cv_get(yenum)) == NULL){
-        clixon_err(OE_YANG, 0, "Enum lacks cv");
+    if (ret == 0 || yang_keyword_get(yenum) != Y_ENUM){
+        clixon_err(OE_YANG, 0, "No such enum %s", enumstr);
         goto done;
     }
-    *val = cv_int32_get(cv);
+    *val = (int32_t)v;
     retval = 0;
  done:
     return retval;
@@ -1630,39 +1633,19 @@ yang_bits_pos(yang_stmt *ytype,
               char      *bitstr,
               uint32_t  *bitpos)
 {
-    int        retval = 0;
-    int        ret = 0;
-    int        is_first = 1;
-    char      *reason;
-    yang_stmt *yprev;
-    yang_stmt *ypos = NULL;
-    int        inext;
+    int        retval = -1;
+    int        ret;
+    yang_stmt *ybit = NULL;
+    int64_t    pos;
 
-    inext = 0;
-    while ((yprev = yn_iter(ytype, &inext)) != NULL){
-        /* Check for the given bit name (flag) */
-        if (yang_keyword_get(yprev) == Y_BIT){
-            /* Use position from Y_POSITION statement if defined */
-            if ((ypos = yang_find(yprev, Y_POSITION, NULL)) != NULL){
-                if ((ret = parse_uint32(yang_argument_get(ypos), bitpos, &reason)) < 0){
-                    clixon_err(OE_UNIX, EINVAL, "cannot parse bit position val: %s", reason);
-                    goto done;
-                }
-                if (ret == 0)
-                    goto fail;
-            } else {
-                /* Position not defined. Use last known position + 1 (skip first node to start with 0) */
-                if (is_first == 0) (*bitpos)++;
-            }
-            if (strcmp(bitstr, yang_argument_get(yprev)) == 0){
-                retval = 1;
-                goto done;
-            }
-            is_first = 0;
-        }
+    if ((ret = yang_enum_name2val(ytype, bitstr, &ybit, &pos)) < 0)
+        goto done;
+    if (ret == 0 || yang_keyword_get(ybit) != Y_BIT){
+        clixon_debug(CLIXON_DBG_YANG, "flag %s not found", bitstr);
+        goto fail;
     }
-    clixon_debug(CLIXON_DBG_YANG, "flag %s not found", bitstr);
-    goto fail;
+    *bitpos = (uint32_t)pos;
+    retval = 1;
  done:
     return retval;
  fail:
@@ -1826,10 +1809,8 @@ yang_val2bitsstr(clixon_handle  h,
     int        is_first = 1;
     int        ret = 0;
     int        byte = 0;
-    char      *reason = NULL;
     yang_stmt *yprev;
-    yang_stmt *ypos;
-    uint32_t   bitpos = 0;
+    int64_t    bitpos = 0;
     int        inext;
 
     if (cb == NULL){
@@ -1840,20 +1821,13 @@ yang_val2bitsstr(clixon_handle  h,
     inext = 0;
     while ((yprev = yn_iter(ytype, &inext)) != NULL && byte < inlen){
         if (yang_keyword_get(yprev) == Y_BIT) {
-            /* Use position from Y_POSITION statement if defined */
-            if ((ypos = yang_find(yprev, Y_POSITION, NULL)) != NULL){
-                if ((ret = parse_uint32(yang_argument_get(ypos), &bitpos, &reason)) < 0){
-                    clixon_err(OE_UNIX, EINVAL, "cannot parse bit position val: %s", reason);
-                    goto done;
-                }
-                if (ret == 0) 
-                    goto fail;
-            } else {
-                /* Position not defined. Use last known position + 1 (skip first node to start with 0) */
-                if (is_first == 0) bitpos++;
-            }
+            /* Explicit or implicit position */
+            if ((ret = yang_enum_name2val(ytype, yang_argument_get(yprev), NULL, &bitpos)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
             byte = bitpos / 8;
-            if (inval[byte] & (1 << (7 - (bitpos % 8)))){
+            if (byte < inlen && (inval[byte] & (1 << (7 - (bitpos % 8))))){
                 if (is_first == 0) cbuf_append_str(cb, " ");
                 cbuf_append_str(cb, yang_argument_get(yprev));
             }
@@ -1865,8 +1839,6 @@ yang_val2bitsstr(clixon_handle  h,
         cbuf_append_str(cb, " ");
     retval = 1;
  done:
-    if (reason)
-        free(reason);
     return retval;
  fail:
     retval = 0;
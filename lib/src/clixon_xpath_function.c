@@ -353,12 +353,11 @@ derived_from_one(char  *baseidentity,
     yang_stmt *ytype;
     yang_stmt *ybaseid;
     yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
     char      *node = NULL;
     char      *prefix = NULL;
     char      *id = NULL;
-    cbuf      *cb = NULL;
     char      *baseid = NULL;
+    int        ret;
 
     /* Split baseidentity to get its id (w/o prefix) */
     if (nodeid_split(baseidentity, NULL, &baseid) < 0)
@@ -381,8 +380,6 @@ derived_from_one(char  *baseidentity,
     /* Just get the object corresponding to the base identity */
     if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
     /* Get and split the leaf id reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
@@ -403,21 +400,15 @@ derived_from_one(char  *baseidentity,
         ; /* match */
     }
     else {
-        /* Allocate cbuf */
-        if ((cb = cbuf_new()) == NULL){
-            clixon_err(OE_UNIX, errno, "cbuf_new");
+        if ((ret = yang_identity_derived(ybaseid, yang_argument_get(ymod), id)) < 0)
             goto done;
-        }
-        cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
+        if (ret == 0)
             goto nomatch;
     }
     retval = 1;
  done:
     if (baseid)
         free(baseid);
-    if (cb)
-        cbuf_free(cb);
     if (id)
         free(id);
     if (prefix)
@@ -48,6 +48,7 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 #include <arpa/inet.h>
 #include <regex.h>
 #include <dirent.h>
@@ -57,6 +58,7 @@
 #include <assert.h>
 #include <libgen.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <netinet/in.h>
 
@@ -70,6 +72,7 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_file.h"
+#include "clixon_regex.h"
 #include "clixon_yang.h"
 #include "clixon_hash.h"
 #include "clixon_xml.h"
@@ -89,6 +92,7 @@
 #include "clixon_yang_cardinality.h"
 #include "clixon_yang_type.h"
 #include "clixon_yang_schema_mount.h"
+#include "clixon_validate_deps.h"
 #include "clixon_yang_internal.h" /* internal included by this file only, not API */
 
 #ifdef XML_EXPLICIT_INDEX
@@ -182,12 +186,25 @@ static map_ptr2ptr *_yang_when_map = NULL;
 static size_t       _yang_when_map_len = 0;
 static map_ptr2ptr *_yang_mymodule_map = NULL;
 static size_t       _yang_mymodule_map_len = 0;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+static map_ptr2ptr *_yang_index_map = NULL;
+static size_t       _yang_index_map_len = 0;
+#endif
+static map_ptr2ptr *_yang_arena_map = NULL;  /* yspec -> argument arena, see yang_spec_freeze */
+static size_t       _yang_arena_map_len = 0;
+static map_ptr2ptr *_yang_idclosure_map = NULL; /* identity -> derived closure index */
+static size_t       _yang_idclosure_map_len = 0;
 
 /* See option CLICON_YANG_USE_ORIGINAL */
 static int _yang_use_orig = 0;
 
 /* Forward static */
 static int yang_type_cache_free(yang_type_cache *ycache);
+static int yang_identity_closure_drop(yang_stmt *ys);
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+static int yang_index_drop(yang_stmt *yn);
+static int yang_index_changed(yang_stmt *yn);
+#endif
 
 /* Access functions
  */
@@ -256,6 +273,11 @@ yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
     ys->ys_argument = arg; /* not strdup/copied */
+    yang_flag_reset(ys, YANG_FLAG_MAPPED);
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (ys->ys_parent)
+        yang_index_changed(ys->ys_parent);
+#endif
     return 0;
 }
 
@@ -277,6 +299,11 @@ yang_argument_dup(yang_stmt *ys,
         return -1;
     }
     ys->ys_argument = dup; /* not strdup/copied */
+    yang_flag_reset(ys, YANG_FLAG_MAPPED);
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (ys->ys_parent)
+        yang_index_changed(ys->ys_parent);
+#endif
     return 0;
 }
 
@@ -564,6 +591,42 @@ yang_when_set(clixon_handle h,
     return retval;
 }
 
+/*! Get when statement of yang statement from external map, without orig redirect
+ *
+ * @param[in]  ys    Yang statement with YANG_FLAG_WHEN set
+ * @retval     ywhen Yang when statement
+ * @retval     NULL  No yang when
+ * @see yang_when_get
+ * @note Internal, used by yang spec cache
+ */
+yang_stmt *
+yang_when_map_get(yang_stmt *ys)
+{
+    if (yang_flag_get(ys, YANG_FLAG_WHEN) == 0x0 || _yang_when_map == NULL)
+        return NULL;
+    return clixon_ptr2ptr(_yang_when_map, _yang_when_map_len, ys);
+}
+
+/*! Set when statement of yang statement in external map, without orig redirect
+ *
+ * @param[in]  ys    Yang statement
+ * @param[in]  ywhen Yang when statement
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see yang_when_set
+ * @note Internal, used by yang spec cache
+ */
+int
+yang_when_map_set(yang_stmt *ys,
+                  yang_stmt *ywhen)
+{
+    if (clixon_ptr2ptr(_yang_when_map, _yang_when_map_len, ys) == NULL &&
+        clixon_ptr2ptr_add(&_yang_when_map, &_yang_when_map_len, ys, ywhen) < 0)
+        return -1;
+    yang_flag_set(ys, YANG_FLAG_WHEN);
+    return 0;
+}
+
 /*! Get xpath and namespace context for "when"-associated augment
  *
  * Ie, for yang structures like: augment <path> { when <xpath>; ... }
@@ -775,6 +838,127 @@ yang_stats_global(uint64_t *nr)
     return 0;
 }
 
+/*! Argument string arena of a yang spec
+ *
+ * Statements with YANG_FLAG_MAPPED have their argument in an arena of their spec.
+ * An arena is either malloced: interned strings by yang_spec_freeze or the string table of
+ * a spec cache, or a memory-mapped spec cache image shared between processes.
+ * @see yang_spec_arena_add
+ */
+struct yang_arena{
+    struct yang_arena *ya_next;   /* Arena of an earlier freeze or load of the same spec */
+    char              *ya_data;   /* NUL-terminated argument strings */
+    size_t             ya_len;    /* Size of ya_data */
+    int                ya_mapped; /* ya_data is a mapped image and is unmapped on free */
+};
+
+/*! Link a new argument arena to a yang spec
+ *
+ * @param[in]  yspec  Yang spec
+ * @param[in]  ya     Arena, owned by yspec if OK
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_arena_link(yang_stmt         *yspec,
+                struct yang_arena *ya)
+{
+    struct yang_arena *ya0 = NULL;
+
+    if (_yang_arena_map != NULL)
+        ya0 = clixon_ptr2ptr_del(_yang_arena_map, &_yang_arena_map_len, yspec);
+    ya->ya_next = ya0;
+    if (clixon_ptr2ptr_add(&_yang_arena_map, &_yang_arena_map_len, yspec, ya) < 0){
+        ya->ya_next = NULL;
+        if (ya0 != NULL)
+            clixon_ptr2ptr_add(&_yang_arena_map, &_yang_arena_map_len, yspec, ya0);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Get size of argument arenas of a yang spec
+ *
+ * Mapped images are shared between processes and are not counted
+ * @param[in]  yspec  Yang spec
+ * @retval     sz     Size in bytes, 0 if spec has no arena
+ */
+static size_t
+yang_arena_size(yang_stmt *yspec)
+{
+    struct yang_arena *ya;
+    size_t             sz = 0;
+
+    if (_yang_arena_map == NULL)
+        return 0;
+    ya = clixon_ptr2ptr(_yang_arena_map, _yang_arena_map_len, yspec);
+    for (; ya != NULL; ya = ya->ya_next){
+        sz += sizeof(*ya);
+        if (!ya->ya_mapped)
+            sz += ya->ya_len;
+    }
+    return sz;
+}
+
+/*! Free argument arenas of a yang spec, unmap mapped images
+ *
+ * @param[in]  yspec  Yang spec
+ * @note Statements of the spec must not be accessed after this
+ */
+static int
+yang_arena_free(yang_stmt *yspec)
+{
+    struct yang_arena *ya;
+    struct yang_arena *ynext;
+
+    if (_yang_arena_map == NULL)
+        return 0;
+    ya = clixon_ptr2ptr_del(_yang_arena_map, &_yang_arena_map_len, yspec);
+    for (; ya != NULL; ya = ynext){
+        ynext = ya->ya_next;
+        if (ya->ya_mapped)
+            munmap(ya->ya_data, ya->ya_len);
+        else
+            free(ya->ya_data);
+        free(ya);
+    }
+    return 0;
+}
+
+/*! Hand over an argument arena to a yang spec
+ *
+ * Statements with YANG_FLAG_MAPPED may refer to strings in the arena. It is freed, or
+ * unmapped if mapped, when the spec is freed.
+ * @param[in]  yspec  Yang spec
+ * @param[in]  buf    Malloced or mapped arena, owned by yspec if OK
+ * @param[in]  len    Length of arena or mapping
+ * @param[in]  mapped buf is mapped with mmap
+ * @retval     0      OK
+ * @retval    -1      Error, arena is not owned by yspec
+ * @see yang_arena_intern
+ */
+int
+yang_spec_arena_add(yang_stmt *yspec,
+                    char      *buf,
+                    size_t     len,
+                    int        mapped)
+{
+    struct yang_arena *ya;
+
+    if ((ya = malloc(sizeof(*ya))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    ya->ya_data = buf;
+    ya->ya_len = len;
+    ya->ya_mapped = mapped;
+    if (yang_arena_link(yspec, ya) < 0){
+        free(ya);
+        return -1;
+    }
+    return 0;
+}
+
 /*! Return the alloced memory of a single YANG obj
  *
  * @param[in]   y    YANG object
@@ -791,7 +975,7 @@ yang_stats_one(yang_stmt *ys,
 
     sz += sizeof(struct yang_stmt);
     sz += ys->ys_len*sizeof(struct yang_stmt*);
-    if (ys->ys_argument)
+    if (ys->ys_argument && !yang_flag_get(ys, YANG_FLAG_MAPPED))
         sz += strlen(ys->ys_argument) + 1;
     if (ys->ys_cvec)
         sz += cvec_size(ys->ys_cvec);
@@ -812,6 +996,9 @@ yang_stats_one(yang_stmt *ys,
         if (ys->ys_filename)
             sz += strlen(ys->ys_filename) + 1;
         break;
+    case Y_SPEC:
+        sz += yang_arena_size(ys);
+        break;
     default:
         break;
     }
@@ -864,6 +1051,183 @@ yang_stats(yang_stmt    *yt,
 
 /* stats end */
 
+/*! Collect statements below a yang node whose argument strings are owned by the statement
+ *
+ * @param[in]     yn    Yang node, not included itself
+ * @param[in,out] vec   Vector of yang statements
+ * @param[in,out] len   Length of vector
+ * @param[in,out] max   Allocated length of vector
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+yang_freeze_collect(yang_stmt   *yn,
+                    yang_stmt ***vec,
+                    size_t      *len,
+                    size_t      *max)
+{
+    yang_stmt *ys;
+    int        i;
+
+    for (i=0; i<yn->ys_len; i++){
+        if ((ys = yn->ys_stmt[i]) == NULL)
+            continue;
+        if (ys->ys_argument != NULL && !yang_flag_get(ys, YANG_FLAG_MAPPED)){
+            if (*len == *max){
+                *max = *max ? 2 * *max : 1024;
+                if ((*vec = realloc(*vec, *max * sizeof(yang_stmt *))) == NULL){
+                    clixon_err(OE_UNIX, errno, "realloc");
+                    return -1;
+                }
+            }
+            (*vec)[(*len)++] = ys;
+        }
+        if (yang_freeze_collect(ys, vec, len, max) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Intern argument strings of yang statements into one arena of distinct strings
+ *
+ * @param[in]  vec    Yang statements with argument strings
+ * @param[in]  len    Length of vec
+ * @param[out] offs   Offset in arena of the argument of each statement, array of len
+ * @param[out] datap  Arena of NUL-terminated strings, free with free()
+ * @param[out] sizep  Size of arena
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see yang_spec_freeze
+ * @see yang_spec_cache_save  Saves the arena as the string table of the cache
+ */
+int
+yang_arena_intern(yang_stmt **vec,
+                  size_t      len,
+                  size_t     *offs,
+                  char      **datap,
+                  size_t     *sizep)
+{
+    int       retval = -1;
+    size_t   *tab = NULL;
+    size_t    mask;
+    uint32_t  h;
+    size_t    i;
+    size_t    total = 0;
+    char     *data;
+    char     *str;
+
+    for (mask = 1; mask < 2*len; mask <<= 1)
+        ;
+    mask--;
+    if ((tab = malloc((mask+1)*sizeof(*tab))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(tab, 0xff, (mask+1)*sizeof(*tab)); /* SIZE_MAX: empty slot */
+    /* Find first statement with each distinct argument (open addressing) */
+    for (i=0; i<len; i++){
+        str = vec[i]->ys_argument;
+        h = 2166136261U;    /* FNV-1a */
+        while (*str){
+            h ^= (unsigned char)*str++;
+            h *= 16777619U;
+        }
+        for (h &= mask; tab[h] != SIZE_MAX; h = (h+1) & mask)
+            if (strcmp(vec[tab[h]]->ys_argument, vec[i]->ys_argument) == 0)
+                break;
+        if (tab[h] == SIZE_MAX){
+            tab[h] = i;
+            offs[i] = total;
+            total += strlen(vec[i]->ys_argument) + 1;
+        }
+        else
+            offs[i] = offs[tab[h]];
+    }
+    if ((data = malloc(total ? total : 1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (i=0; i<=mask; i++)
+        if (tab[i] != SIZE_MAX)
+            strcpy(data + offs[tab[i]], vec[tab[i]]->ys_argument);
+    *datap = data;
+    *sizep = total;
+    retval = 0;
+ done:
+    if (tab)
+        free(tab);
+    return retval;
+}
+
+/*! Freeze yang spec after parsing: intern argument strings into one arena
+ *
+ * Equal argument strings of all statements in the spec are stored once in a contiguous
+ * arena owned by the spec, instead of one malloced string per statement.
+ * Only argument strings are interned, statements are not moved or compacted.
+ * The statements are marked with YANG_FLAG_MAPPED and their arguments are not freed
+ * individually. The arena is freed with the spec.
+ * May be called again after loading more modules, then only new arguments are interned.
+ * A spec loaded from a spec cache is already interned.
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see CLICON_YANG_SPEC_FREEZE
+ * @note Arguments of frozen statements must not be modified in place, use yang_argument_set
+ */
+int
+yang_spec_freeze(yang_stmt *yspec)
+{
+    int         retval = -1;
+    yang_stmt **vec = NULL;
+    size_t      len = 0;
+    size_t      max = 0;
+    size_t     *offs = NULL;
+    size_t      i;
+    size_t      total = 0;
+    size_t      sz0 = 0;
+    size_t      sz1 = 0;
+    uint64_t    nr = 0;
+    char       *data = NULL;
+
+    if (yang_freeze_collect(yspec, &vec, &len, &max) < 0)
+        goto done;
+    if (len == 0)
+        goto ok;
+    if (clixon_debug_get() & CLIXON_DBG_YANG)
+        yang_stats(yspec, 0, &nr, &sz0);
+    if ((offs = malloc(len*sizeof(*offs))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (yang_arena_intern(vec, len, offs, &data, &total) < 0)
+        goto done;
+    /* Link to earlier arenas of spec */
+    if (yang_spec_arena_add(yspec, data, total, 0) < 0)
+        goto done;
+    for (i=0; i<len; i++){
+        free(vec[i]->ys_argument);
+        vec[i]->ys_argument = data + offs[i];
+        yang_flag_set(vec[i], YANG_FLAG_MAPPED);
+    }
+    data = NULL;
+    if (clixon_debug_get() & CLIXON_DBG_YANG){
+        nr = 0;
+        yang_stats(yspec, 0, &nr, &sz1);
+        clixon_debug(CLIXON_DBG_YANG, "Yang spec %s frozen: nodes:%" PRIu64 " arguments:%zu arena:%zu size before:%zu after:%zu",
+                     yang_argument_get(yspec), nr, len, total, sz0, sz1);
+    }
+ ok:
+    retval = 0;
+ done:
+    if (data)
+        free(data);
+    if (vec)
+        free(vec);
+    if (offs)
+        free(offs);
+    return retval;
+}
+
 /*! Create new yang specification for top domain, add as child to top-level yang_mounts
  *
  * @param[in] h      Clixon handle
@@ -938,6 +1302,9 @@ yspec_new_shared(clixon_handle h,
 
     if (yspec0 != NULL){ /* shared */
         yspec1 = yspec0;
+        /* Mount-point already registered, eg re-bound */
+        if (yang_cvec_get(yspec1) && cvec_find(yang_cvec_get(yspec1), xpath) != NULL)
+            goto done;
     }
     else {
         if ((yspec1 = yspec_new1(h, domain, name)) == NULL)
@@ -1048,11 +1415,17 @@ ys_free1(yang_stmt *ys,
         cvec_free(cvv);
     }
     if (ys->ys_argument){
-        free(ys->ys_argument);
+        if (!yang_flag_get(ys, YANG_FLAG_MAPPED))
+            free(ys->ys_argument);
         ys->ys_argument = NULL;
     }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    yang_index_drop(ys);
+#endif
+    if (yang_flag_get(ys, YANG_FLAG_DEPS))
+        yang_deps_drop(ys);
     switch (ys->ys_keyword) {     /* type-specifi union fields */
     case Y_ACTION:
         while((rc = ys->ys_action_cb) != NULL) {
@@ -1075,18 +1448,22 @@ ys_free1(yang_stmt *ys,
         if (ys->ys_filename)
             free(ys->ys_filename);
         break;
+    case Y_IDENTITY:
+        yang_identity_closure_drop(ys);
+        break;
 #ifdef OPTIMIZE_NO_PRESENCE_CONTAINER
     case Y_CONTAINER:
         if (ys->ys_nopres_cache)
             xml_free(ys->ys_nopres_cache);
         break;
 #endif
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
     case Y_SPEC:
+#ifdef OPTIMIZE_YSPEC_NAMESPACE
         if (ys->ys_nscache)
             free(ys->ys_nscache);
-        break;
 #endif
+        yang_arena_free(ys);
+        break;
     default:
         break;
     }
@@ -1125,6 +1502,9 @@ ys_prune(yang_stmt *yp,
     }
     yp->ys_len--;
     yp->ys_stmt[yp->ys_len] = NULL;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    yang_index_changed(yp);
+#endif
  done:
     return yc;
 }
@@ -1182,6 +1562,9 @@ ys_freechildren(yang_stmt *ys)
         free(ys->ys_stmt);
         ys->ys_stmt = NULL;
     }
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    yang_index_drop(ys);
+#endif
     return 0;
 }
 
@@ -1217,6 +1600,9 @@ yn_realloc(yang_stmt *yn)
         return -1;
     }
     yn->ys_stmt[yn->ys_len - 1] = NULL; /* init field */
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    yang_index_changed(yn);
+#endif
 #ifdef OPTIMIZE_YSPEC_NAMESPACE
     if (yn->ys_keyword == Y_SPEC && yn->ys_nscache){         /* Clear cache */
         yspec_nscache_clear(yn);
@@ -1306,6 +1692,8 @@ ys_cp_one(yang_stmt *ynew,
     sz = sizeof(*yold);
     memcpy(ynew, yold, sz);
     yang_flag_reset(ynew, YANG_FLAG_WHEN); /* Dont inherit WHENs */
+    yang_flag_reset(ynew, YANG_FLAG_FIND_INDEX); /* Index is built on demand */
+    yang_flag_reset(ynew, YANG_FLAG_MAPPED); /* Argument is copied below */
     ynew->ys_parent = NULL;
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
@@ -1525,12 +1913,404 @@ yn_iter(yang_stmt *yparent,
     return yc;
 }
 
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+/*! Hash index of the children of a yang statement
+ *
+ * Children are referenced by their position in the child vector. The index only gives
+ * candidates, lookups always check the actual child.
+ * Hash tables use open addressing and have at least twice as many slots as children.
+ * @see yang_index_get
+ */
+struct yang_index{
+    yang_stmt **yx_stmt;      /* Child vector when index was built, to detect changes */
+    uint32_t    yx_len;       /* Number of children when index was built */
+    uint32_t    yx_mask;      /* Hash table size - 1, size is a power of two */
+    int        *yx_arg;       /* Hash: argument -> first child with that argument, or -1 */
+    int        *yx_argnext;   /* Per child: next child with same argument, or -1 */
+    int        *yx_kwnext;    /* Per child: next child with same keyword, or -1 */
+    int        *yx_ns;        /* Hash: namespace -> first module, or NULL if no modules */
+    int        *yx_prefix;    /* Hash: own prefix -> first module, or NULL if no modules */
+    int         yx_first[Y_SPEC+1]; /* First child with keyword, or -1 */
+};
+
+/*! Key type of a yang index hash table */
+enum yang_index_tab{
+    YX_ARG,     /* Argument of child */
+    YX_NS,      /* Namespace of child module */
+    YX_PREFIX,  /* Own prefix of child module */
+};
+
+/*! FNV-1a string hash
+ */
+static uint32_t
+yang_index_hash(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (unsigned char)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Get the key of a child for a given hash table type
+ *
+ * @param[in]  ys    Child yang statement
+ * @param[in]  tab   Type of hash table
+ * @retval     key   Key string as pointer into yang tree
+ * @retval     NULL  Child has no key
+ */
+static char *
+yang_index_key(yang_stmt           *ys,
+               enum yang_index_tab  tab)
+{
+    yang_stmt *y;
+
+    switch (tab){
+    case YX_ARG:
+        return ys->ys_argument;
+    case YX_NS:
+    case YX_PREFIX:
+        if (ys->ys_keyword != Y_MODULE)
+            return NULL;
+        if ((y = yang_find(ys, tab==YX_NS?Y_NAMESPACE:Y_PREFIX, NULL)) == NULL)
+            return NULL;
+        return y->ys_argument;
+    }
+    return NULL;
+}
+
+/*! Find hash table slot of key, either the slot with the key or the empty slot to use
+ *
+ * @param[in]  yn    Yang statement owning the index
+ * @param[in]  yx    Yang index
+ * @param[in]  tab   Type of hash table
+ * @param[in]  key   Key string
+ * @retval     slot  Pointer to slot containing child position or -1 if empty
+ */
+static int *
+yang_index_slot(yang_stmt           *yn,
+                struct yang_index   *yx,
+                enum yang_index_tab  tab,
+                const char          *key)
+{
+    int      *vec;
+    uint32_t  h;
+    int       i;
+    char     *k;
+
+    switch (tab){
+    case YX_NS:
+        vec = yx->yx_ns;
+        break;
+    case YX_PREFIX:
+        vec = yx->yx_prefix;
+        break;
+    default:
+        vec = yx->yx_arg;
+        break;
+    }
+    h = yang_index_hash(key) & yx->yx_mask;
+    while ((i = vec[h]) != -1){
+        if ((k = yang_index_key(yn->ys_stmt[i], tab)) != NULL &&
+            strcmp(k, key) == 0)
+            break;
+        h = (h + 1) & yx->yx_mask;
+    }
+    return &vec[h];
+}
+
+/*! Free yang index
+ */
+static int
+yang_index_free(struct yang_index *yx)
+{
+    if (yx->yx_arg)
+        free(yx->yx_arg);
+    if (yx->yx_argnext)
+        free(yx->yx_argnext);
+    if (yx->yx_kwnext)
+        free(yx->yx_kwnext);
+    if (yx->yx_ns)
+        free(yx->yx_ns);
+    if (yx->yx_prefix)
+        free(yx->yx_prefix);
+    free(yx);
+    return 0;
+}
+
+/*! Allocate a hash table vector with all slots empty
+ */
+static int *
+yang_index_vec(size_t len)
+{
+    int   *vec;
+    size_t i;
+
+    if ((vec = malloc(len*sizeof(int))) == NULL){
+        clixon_err(OE_YANG, errno, "malloc");
+        return NULL;
+    }
+    for (i=0; i<len; i++)
+        vec[i] = -1;
+    return vec;
+}
+
+/*! Build hash index of the children of a yang statement
+ *
+ * Children are inserted last to first so that each chain and hash slot starts with the
+ * first child in order, as found by a linear search.
+ * @param[in]  yn    Yang statement
+ * @retval     yx    New yang index, free with yang_index_free
+ * @retval     NULL  Error
+ */
+static struct yang_index *
+yang_index_build(yang_stmt *yn)
+{
+    struct yang_index *yx = NULL;
+    yang_stmt         *ys;
+    uint32_t           size;
+    int                nmod = 0;
+    int                i;
+    int               *slot;
+    char              *key;
+
+    if ((yx = calloc(1, sizeof(*yx))) == NULL){
+        clixon_err(OE_YANG, errno, "calloc");
+        goto err;
+    }
+    yx->yx_stmt = yn->ys_stmt;
+    yx->yx_len = yn->ys_len;
+    for (size = 1; size < 2*yn->ys_len; size <<= 1)
+        ;
+    yx->yx_mask = size - 1;
+    if ((yx->yx_arg = yang_index_vec(size)) == NULL ||
+        (yx->yx_argnext = yang_index_vec(yn->ys_len)) == NULL ||
+        (yx->yx_kwnext = yang_index_vec(yn->ys_len)) == NULL)
+        goto err;
+    for (i=0; i<=Y_SPEC; i++)
+        yx->yx_first[i] = -1;
+    for (i=yn->ys_len-1; i>=0; i--){
+        if ((ys = yn->ys_stmt[i]) == NULL)
+            continue;
+        yx->yx_kwnext[i] = yx->yx_first[ys->ys_keyword];
+        yx->yx_first[ys->ys_keyword] = i;
+        if (ys->ys_keyword == Y_MODULE)
+            nmod++;
+        if (ys->ys_argument == NULL)
+            continue;
+        slot = yang_index_slot(yn, yx, YX_ARG, ys->ys_argument);
+        yx->yx_argnext[i] = *slot;
+        *slot = i;
+    }
+    if (nmod){ /* Module lookup by namespace and prefix */
+        if ((yx->yx_ns = yang_index_vec(size)) == NULL ||
+            (yx->yx_prefix = yang_index_vec(size)) == NULL)
+            goto err;
+        for (i=yx->yx_first[Y_MODULE]; i != -1; i = yx->yx_kwnext[i]){
+            ys = yn->ys_stmt[i];
+            if ((key = yang_index_key(ys, YX_NS)) != NULL){
+                slot = yang_index_slot(yn, yx, YX_NS, key);
+                if (*slot == -1)
+                    *slot = i;
+            }
+            if ((key = yang_index_key(ys, YX_PREFIX)) != NULL){
+                slot = yang_index_slot(yn, yx, YX_PREFIX, key);
+                if (*slot == -1)
+                    *slot = i;
+            }
+        }
+    }
+    return yx;
+ err:
+    if (yx)
+        yang_index_free(yx);
+    return NULL;
+}
+
+/*! Remove hash index of yang statement, if any
+ *
+ * @param[in]  yn   Yang statement
+ * @retval     0    OK
+ */
+static int
+yang_index_drop(yang_stmt *yn)
+{
+    struct yang_index *yx;
+
+    if (yang_flag_get(yn, YANG_FLAG_FIND_INDEX) != 0x0){
+        if ((yx = clixon_ptr2ptr_del(_yang_index_map, &_yang_index_map_len, yn)) != NULL)
+            yang_index_free(yx);
+        yang_flag_reset(yn, YANG_FLAG_FIND_INDEX);
+    }
+    return 0;
+}
+
+/*! Children of yang statement have changed, remove index of statement
+ *
+ * Namespace and prefix of a module are indexed in its parent, so remove that too
+ * @param[in]  yn   Yang statement
+ * @retval     0    OK
+ */
+static int
+yang_index_changed(yang_stmt *yn)
+{
+    yang_stmt *yp;
+
+    yang_index_drop(yn);
+    if (yn->ys_keyword == Y_MODULE &&
+        (yp = yn->ys_parent) != NULL)
+        yang_index_drop(yp);
+    return 0;
+}
+
+/*! Get hash index of the children of a yang statement, build it if necessary
+ *
+ * An existing index is rebuilt if the child vector has changed since it was built.
+ * @param[in]  yn   Yang statement
+ * @retval     yx   Yang index
+ * @retval     NULL Too few children, or error: use linear search
+ */
+static struct yang_index *
+yang_index_get(yang_stmt *yn)
+{
+    struct yang_index *yx;
+
+    if (yn->ys_len < OPTIMIZE_YANG_FIND_INDEX)
+        return NULL;
+    if (yang_flag_get(yn, YANG_FLAG_FIND_INDEX) != 0x0){
+        if ((yx = clixon_ptr2ptr(_yang_index_map, _yang_index_map_len, yn)) != NULL &&
+            yx->yx_stmt == yn->ys_stmt &&
+            yx->yx_len == yn->ys_len)
+            return yx;
+        yang_index_drop(yn);
+    }
+    if ((yx = yang_index_build(yn)) == NULL)
+        return NULL;
+    if (clixon_ptr2ptr_add(&_yang_index_map, &_yang_index_map_len, yn, yx) < 0){
+        yang_index_free(yx);
+        return NULL;
+    }
+    yang_flag_set(yn, YANG_FLAG_FIND_INDEX);
+    return yx;
+}
+
+/*! Free all yang indexes, the statements keep their flags but will not find them
+ */
+static int
+yang_index_exit(void)
+{
+    size_t i;
+
+    if (_yang_index_map != NULL) {
+        for (i=0; i<_yang_index_map_len; i++)
+            yang_index_free(_yang_index_map[i].mp_p1);
+        free(_yang_index_map);
+        _yang_index_map = NULL;
+    }
+    _yang_index_map_len = 0;
+    return 0;
+}
+
+/*! Find child using hash index, see yang_find
+ */
+static yang_stmt *
+yang_find_index(yang_stmt         *yn,
+                struct yang_index *yx,
+                int                keyword,
+                const char        *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *ym;
+    yang_stmt *yspec;
+    int        i;
+
+    if (argument != NULL){
+        for (i = *yang_index_slot(yn, yx, YX_ARG, argument); i != -1; i = yx->yx_argnext[i]){
+            ys = yn->ys_stmt[i];
+            if (keyword == 0 || ys->ys_keyword == keyword)
+                return ys;
+        }
+    }
+    else if (keyword != 0){
+        if ((i = yx->yx_first[keyword]) != -1)
+            return yn->ys_stmt[i];
+    }
+    else if (yn->ys_len > 0)
+        return yn->ys_stmt[0];
+    /* Special case: if no match and yang node is module or submodule, extend
+     * search to include submodules
+     */
+    if (keyword != Y_NAMESPACE &&
+        (yn->ys_keyword == Y_MODULE || yn->ys_keyword == Y_SUBMODULE) &&
+        yx->yx_first[Y_INCLUDE] != -1){
+        yspec = ys_spec(yn);
+        for (i = yx->yx_first[Y_INCLUDE]; i != -1; i = yx->yx_kwnext[i]){
+            if ((ym = yang_find_module_by_name(yspec, yn->ys_stmt[i]->ys_argument)) != NULL &&
+                (ys = yang_find(ym, keyword, argument)) != NULL)
+                return ys;
+        }
+    }
+    return NULL;
+}
+
+/*! Find module or submodule in yang spec using hash index
+ *
+ * @param[in]  yspec  Yang spec (or other statement with modules as children)
+ * @param[in]  key    Type of key: module name, namespace or own prefix
+ * @param[in]  str    Key string
+ * @param[out] ymod   Yang module or submodule, or NULL if not found
+ * @retval     1      Index used, ymod is set
+ * @retval     0      No index, use linear search
+ * @see yang_find_module_by_name
+ * @see yang_find_module_by_namespace
+ * @see yang_find_module_by_prefix_yspec
+ */
+int
+yang_find_module_index(yang_stmt              *yspec,
+                       enum yang_module_index  key,
+                       const char             *str,
+                       yang_stmt             **ymod)
+{
+    struct yang_index *yx;
+    yang_stmt         *ys;
+    int                i;
+
+    if (str == NULL || (yx = yang_index_get(yspec)) == NULL)
+        return 0;
+    *ymod = NULL;
+    switch (key){
+    case YANG_MODULE_INDEX_NAME:
+        for (i = *yang_index_slot(yspec, yx, YX_ARG, str); i != -1; i = yx->yx_argnext[i]){
+            ys = yspec->ys_stmt[i];
+            if (ys->ys_keyword == Y_MODULE || ys->ys_keyword == Y_SUBMODULE){
+                *ymod = ys;
+                break;
+            }
+        }
+        break;
+    case YANG_MODULE_INDEX_NAMESPACE:
+        if (yx->yx_ns != NULL &&
+            (i = *yang_index_slot(yspec, yx, YX_NS, str)) != -1)
+            *ymod = yspec->ys_stmt[i];
+        break;
+    case YANG_MODULE_INDEX_PREFIX:
+        if (yx->yx_prefix != NULL &&
+            (i = *yang_index_slot(yspec, yx, YX_PREFIX, str)) != -1)
+            *ymod = yspec->ys_stmt[i];
+        break;
+    }
+    return 1;
+}
+#endif /* OPTIMIZE_YANG_FIND_INDEX */
+
 /*! Find first child yang_stmt with matching keyword and argument
  *
  * Find child given keyword and argument.
  * Special case: look in imported INPUTs as well (for (sub)modules.
- * This could need an optimized lookup, especially the INPUT case.
  * Most common use for the special case, ie in openconfig, is grouping and identity
+ * Statements with many children use a hash index, see OPTIMIZE_YANG_FIND_INDEX
  * @param[in]  yn         Yang node, current context node.
  * @param[in]  keyword    if 0 match any keyword. Actual type: enum rfc_6020
  * @param[in]  argument   String compare w argument. if NULL, match any.
@@ -1550,12 +2330,20 @@ yang_find(yang_stmt  *yn,
     yang_stmt *yspec;
     yang_stmt *ym;
     yang_stmt *yorig;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    struct yang_index *yx;
+#endif
 
     if (_yang_use_orig &&
         (yorig = yang_orig_get(yn)) != NULL &&
         uses_orig_ptr(keyword)){
         return yang_find(yorig, keyword, argument);
     }
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (keyword >= 0 && keyword <= Y_SPEC &&
+        (yx = yang_index_get(yn)) != NULL)
+        return yang_find_index(yn, yx, keyword, argument);
+#endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
         if (keyword == 0 || ys->ys_keyword == keyword){
@@ -1583,6 +2371,76 @@ yang_find(yang_stmt  *yn,
     return yret?yret:yretsub;
 }
 
+/*! Find data node with matching argument among children of choice, including its cases
+ *
+ * @param[in]  ychoice    Yang choice node
+ * @param[in]  argument   Argument that child should match with
+ * @retval     ymatch     Matching child
+ * @retval     NULL       No match
+ */
+static yang_stmt *
+yang_find_datanode_choice(yang_stmt *ychoice,
+                          char      *argument)
+{
+    yang_stmt *yc = NULL;
+    yang_stmt *ysmatch = NULL;
+    int        inext;
+
+    inext = 0;
+    while ((yc = yn_iter(ychoice, &inext)) != NULL){
+        if (yang_keyword_get(yc) == Y_CASE) /* Look for its children */
+            ysmatch = yang_find_datanode(yc, argument);
+        else
+            if (yang_datanode(yc)){
+                if (yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
+                    ysmatch = yc;
+            }
+        if (ysmatch)
+            break;
+    }
+    return ysmatch;
+}
+
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+/*! Find child data node using hash index, see yang_find_datanode
+ */
+static yang_stmt *
+yang_find_datanode_index(yang_stmt         *yn,
+                         struct yang_index *yx,
+                         char              *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *ym;
+    yang_stmt *yspec;
+    int        i;
+
+    for (i = *yang_index_slot(yn, yx, YX_ARG, argument); i != -1; i = yx->yx_argnext[i]){
+        ys = yn->ys_stmt[i];
+        if (yang_datanode(ys))
+            return ys;
+    }
+    for (i = yx->yx_first[Y_CHOICE]; i != -1; i = yx->yx_kwnext[i])
+        if ((ys = yang_find_datanode_choice(yn->ys_stmt[i], argument)) != NULL)
+            return ys;
+    if ((i = yx->yx_first[Y_INPUT]) != -1 &&
+        (ys = yang_find_datanode(yn->ys_stmt[i], argument)) != NULL)
+        return ys;
+    if ((i = yx->yx_first[Y_OUTPUT]) != -1 &&
+        (ys = yang_find_datanode(yn->ys_stmt[i], argument)) != NULL)
+        return ys;
+    /* Special case: if not match and yang node is module or submodule, extend
+     * search to include submodules */
+    if (yn->ys_keyword == Y_MODULE || yn->ys_keyword == Y_SUBMODULE){
+        yspec = ys_spec(yn);
+        for (i = yx->yx_first[Y_INCLUDE]; i != -1; i = yx->yx_kwnext[i])
+            if ((ym = yang_find_module_by_name(yspec, yn->ys_stmt[i]->ys_argument)) != NULL &&
+                (ys = yang_find_datanode(ym, argument)) != NULL)
+                return ys;
+    }
+    return NULL;
+}
+#endif /* OPTIMIZE_YANG_FIND_INDEX */
+
 /*! Find child data node with matching argument (container, leaf, list, leaf-list)
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1604,23 +2462,20 @@ yang_find_datanode(yang_stmt *yn,
     yang_stmt *ysmatch = NULL;
     char      *name;
     int        inext;
-    int        inext2;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    struct yang_index *yx;
 
+    if (argument != NULL &&
+        (yx = yang_index_get(yn)) != NULL){
+        ysmatch = yang_find_datanode_index(yn, yx, argument);
+        goto done;
+    }
+#endif
     inext = 0;
     while ((ys = yn_iter(yn, &inext)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
-            inext2 = 0;
-            while ((yc = yn_iter(ys, &inext2)) != NULL){
-                if (yang_keyword_get(yc) == Y_CASE) /* Look for its children */
-                    ysmatch = yang_find_datanode(yc, argument);
-                else
-                    if (yang_datanode(yc)){
-                        if (yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
-                            ysmatch = yc;
-                    }
-                if (ysmatch)
-                    goto done; // maybe break?
-            }
+            if ((ysmatch = yang_find_datanode_choice(ys, argument)) != NULL)
+                goto done;
         } /* Y_CHOICE */
         else if (yang_keyword_get(ys) == Y_INPUT ||
                  yang_keyword_get(ys) == Y_OUTPUT){ /* Look for its children */
@@ -1657,6 +2512,85 @@ yang_find_datanode(yang_stmt *yn,
     return ysmatch;
 }
 
+/*! Find schema node with matching argument among children of choice, including its cases
+ *
+ * @param[in]  ychoice    Yang choice node
+ * @param[in]  argument   if NULL, match any(first) argument.
+ * @retval     ymatch     Matching child
+ * @retval     NULL       No match
+ */
+static yang_stmt *
+yang_find_schemanode_choice(yang_stmt *ychoice,
+                            char      *argument)
+{
+    yang_stmt *yc = NULL;
+    yang_stmt *ysmatch = NULL;
+    int        j;
+
+    for (j=0; j<ychoice->ys_len; j++){
+        yc = ychoice->ys_stmt[j];
+        if (yang_keyword_get(yc) == Y_CASE) /* Look for its children */
+            ysmatch = yang_find_schemanode(yc, argument);
+        else
+            if (yang_schemanode(yc)){
+                if (argument == NULL)
+                    ysmatch = yc;
+                else
+                    if (yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
+                        ysmatch = yc;
+            }
+        if (ysmatch)
+            break;
+    }
+    return ysmatch;
+}
+
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+/*! Find child schema node using hash index, see yang_find_schemanode
+ */
+static yang_stmt *
+yang_find_schemanode_index(yang_stmt         *yn,
+                           struct yang_index *yx,
+                           char              *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *ym;
+    yang_stmt *yspec;
+    int        i;
+    int        imatch = -1;
+
+    /* Includes choice itself */
+    for (i = *yang_index_slot(yn, yx, YX_ARG, argument); i != -1; i = yx->yx_argnext[i])
+        if (yang_schemanode(yn->ys_stmt[i])){
+            imatch = i;
+            break;
+        }
+    if (strcmp(argument, "input") == 0)
+        i = yx->yx_first[Y_INPUT];
+    else if (strcmp(argument, "output") == 0)
+        i = yx->yx_first[Y_OUTPUT];
+    else
+        i = -1;
+    if (i != -1 && (imatch == -1 || i < imatch))
+        imatch = i;
+    if (imatch != -1)
+        return yn->ys_stmt[imatch];
+    for (i = yx->yx_first[Y_CHOICE]; i != -1; i = yx->yx_kwnext[i])
+        if ((ys = yang_find_schemanode_choice(yn->ys_stmt[i], argument)) != NULL)
+            return ys;
+    /* Special case: if not match and yang node is module or submodule, extend
+     * search to include submodules */
+    if (yn->ys_keyword == Y_MODULE || yn->ys_keyword == Y_SUBMODULE){
+        yspec = ys_spec(yn);
+        for (i = yx->yx_first[Y_INCLUDE]; i != -1; i = yx->yx_kwnext[i])
+            if ((ym = yang_find_module_by_name(yspec, yn->ys_stmt[i]->ys_argument)) != NULL &&
+                (ys = yang_find_schemanode(ym, argument)) != NULL)
+                return ys;
+    }
+    return NULL;
+}
+#endif /* OPTIMIZE_YANG_FIND_INDEX */
+
 /*! Find child schema node with matching argument (container, leaf, etc)
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1674,8 +2608,16 @@ yang_find_schemanode(yang_stmt *yn,
     yang_stmt *yspec;
     yang_stmt *ysmatch = NULL;
     char      *name;
-    int        i, j;
+    int        i;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    struct yang_index *yx;
 
+    if (argument != NULL &&
+        (yx = yang_index_get(yn)) != NULL){
+        ysmatch = yang_find_schemanode_index(yn, yx, argument);
+        goto match;
+    }
+#endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
         if (yang_keyword_get(ys) == Y_CHOICE){
@@ -1685,21 +2627,8 @@ yang_find_schemanode(yang_stmt *yn,
                 goto match;
             }
             /* Then look for its children (case) */
-            for (j=0; j<ys->ys_len; j++){
-                yc = ys->ys_stmt[j];
-                if (yang_keyword_get(yc) == Y_CASE) /* Look for its children */
-                    ysmatch = yang_find_schemanode(yc, argument);
-                else
-                    if (yang_schemanode(yc)){
-                        if (argument == NULL)
-                            ysmatch = yc;
-                        else
-                            if (yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
-                                ysmatch = yc;
-                    }
-                if (ysmatch)
-                    goto match;
-            }
+            if ((ysmatch = yang_find_schemanode_choice(ys, argument)) != NULL)
+                goto match;
         } /* Y_CHOICE */
         else
             if (yang_schemanode(ys)){
@@ -3245,6 +4174,153 @@ ys_populate_identity(clixon_handle h,
     return retval;
 }
 
+/*! Hash index of the derived identities of a base identity
+ *
+ * The derived list of an identity (ys_cvec) is the transitive closure of all identities
+ * derived from it, as <module>:<id> names, see ys_populate_identity.
+ * The index maps a name to its position in the list using open addressing.
+ * It is built on first use and rebuilt if the list has grown, eg when modules are added.
+ * @see yang_identity_derived
+ */
+struct yang_idclosure{
+    int       yi_len;    /* Length of derived list when index was built */
+    uint32_t  yi_mask;   /* Hash table size - 1, size is a power of two */
+    int       yi_tab[];  /* Hash: <module>:<id> -> position in derived list, or -1 */
+};
+
+/*! FNV-1a hash of <module>:<id> given as two strings
+ *
+ * @param[in]  module  Module name, or full <module>:<id> string if id is NULL
+ * @param[in]  id      Identity name, or NULL
+ */
+static uint32_t
+yang_idref_hash(const char *module,
+                const char *id)
+{
+    uint32_t    h = 2166136261U;
+    const char *str;
+
+    for (str = module; *str; str++){
+        h ^= (unsigned char)*str;
+        h *= 16777619U;
+    }
+    if (id != NULL){
+        h ^= (unsigned char)':';
+        h *= 16777619U;
+        for (str = id; *str; str++){
+            h ^= (unsigned char)*str;
+            h *= 16777619U;
+        }
+    }
+    return h;
+}
+
+/*! Remove derived identity index of an identity
+ *
+ * @param[in]  ys   Yang identity statement
+ */
+static int
+yang_identity_closure_drop(yang_stmt *ys)
+{
+    struct yang_idclosure *yi;
+
+    if (_yang_idclosure_map != NULL &&
+        (yi = clixon_ptr2ptr_del(_yang_idclosure_map, &_yang_idclosure_map_len, ys)) != NULL)
+        free(yi);
+    return 0;
+}
+
+/*! Get derived identity index of a base identity, build it if needed
+ *
+ * @param[in]  ybaseid  Base identity
+ * @param[in]  idrefvec Derived identity list of base identity
+ * @retval     yi       Index
+ * @retval     NULL     Error
+ */
+static struct yang_idclosure *
+yang_identity_closure_get(yang_stmt *ybaseid,
+                          cvec      *idrefvec)
+{
+    struct yang_idclosure *yi = NULL;
+    cg_var                *cv = NULL;
+    uint32_t               mask;
+    uint32_t               h;
+    int                    len;
+    int                    i;
+
+    len = cvec_len(idrefvec);
+    if (_yang_idclosure_map != NULL &&
+        (yi = clixon_ptr2ptr(_yang_idclosure_map, _yang_idclosure_map_len, ybaseid)) != NULL){
+        if (yi->yi_len == len)
+            return yi;
+        yang_identity_closure_drop(ybaseid);
+    }
+    for (mask = 1; mask < 2*len; mask <<= 1)
+        ;
+    mask--;
+    if ((yi = malloc(sizeof(*yi) + (mask+1)*sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    yi->yi_len = len;
+    yi->yi_mask = mask;
+    memset(yi->yi_tab, 0xff, (mask+1)*sizeof(int)); /* -1: empty slot */
+    i = 0;
+    while ((cv = cvec_each(idrefvec, cv)) != NULL){
+        for (h = yang_idref_hash(cv_name_get(cv), NULL) & mask;
+             yi->yi_tab[h] != -1;
+             h = (h+1) & mask)
+            ;
+        yi->yi_tab[h] = i++;
+    }
+    if (clixon_ptr2ptr_add(&_yang_idclosure_map, &_yang_idclosure_map_len, ybaseid, yi) < 0){
+        free(yi);
+        return NULL;
+    }
+    return yi;
+}
+
+/*! Check if an identity is derived from a base identity
+ *
+ * Replaces a linear search of <module>:<id> in the derived list of the base identity with
+ * one hash lookup
+ * @param[in]  ybaseid  Base identity
+ * @param[in]  module   Module name of identity
+ * @param[in]  id       Identity name without prefix
+ * @retval     1        Identity is derived from base identity
+ * @retval     0        Not derived
+ * @retval    -1        Error
+ * @see validate_identityref
+ */
+int
+yang_identity_derived(yang_stmt  *ybaseid,
+                      const char *module,
+                      const char *id)
+{
+    struct yang_idclosure *yi;
+    cvec                  *idrefvec;
+    char                  *name;
+    size_t                 mlen;
+    uint32_t               h;
+    int                    i;
+
+    if ((idrefvec = yang_cvec_get(ybaseid)) == NULL || cvec_len(idrefvec) == 0)
+        return 0;
+    if ((yi = yang_identity_closure_get(ybaseid, idrefvec)) == NULL)
+        return -1;
+    mlen = strlen(module);
+    for (h = yang_idref_hash(module, id) & yi->yi_mask;
+         (i = yi->yi_tab[h]) != -1;
+         h = (h+1) & yi->yi_mask){
+        name = cv_name_get(cvec_i(idrefvec, i));
+        if (strncmp(name, module, mlen) == 0 &&
+            name[mlen] == ':' &&
+            strcmp(name+mlen+1, id) == 0)
+            return 1;
+    }
+    return 0;
+}
+
 /*! Return 1 if feature is enabled, 0 if not using the populated yang tree
  *
  * @param[in] yspec   yang specification
@@ -3671,12 +4747,18 @@ yang_features(clixon_handle h,
                         ys_freechildren(ys);
                         ys->ys_len = 0;
                         yang_flag_set(ys, YANG_FLAG_DISABLED);
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+                        yang_index_changed(yt);
+#endif
                         break;
                     }
                     for (j=i+1; j<yt->ys_len; j++)
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
                     yt->ys_stmt[yt->ys_len] = NULL;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+                    yang_index_changed(yt);
+#endif
                     ys_free(ys);
                     continue; /* Don't increment i */
                     break;
@@ -4314,6 +5396,10 @@ yang_type_cache_free(yang_type_cache *ycache)
                     cv_void_set(cv, NULL);
                 }
                 break;
+            case REGEXP_PCRE2:
+                regex_pcre2_free(cv_void_get(cv));
+                cv_void_set(cv, NULL);
+                break;
             default:
                 break;
             }
@@ -4321,10 +5407,92 @@ yang_type_cache_free(yang_type_cache *ycache)
         }
         cvec_free(ycache->yc_regexps);
     }
+    if (ycache->yc_validator)
+        yang_type_validator_free(ycache->yc_validator);
+    if (ycache->yc_enummap)
+        yang_enum_map_free(ycache->yc_enummap);
     free(ycache);
     return 0;
 }
 
+/*! Get compiled validator from yang type cache
+ *
+ * @param[in]  ytype  Yang type statement
+ * @retval     yv     Compiled validator
+ * @retval     NULL   No type cache or no validator compiled
+ * @see ys_cv_validate
+ */
+void *
+yang_type_cache_validator_get(yang_stmt *ytype)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = yang_typecache_get(ytype)) == NULL)
+        return NULL;
+    return ycache->yc_validator;
+}
+
+/*! Set compiled validator in yang type cache
+ *
+ * The validator is freed together with the type cache
+ * @param[in]  ytype  Yang type statement
+ * @param[in]  yv     Compiled validator
+ * @retval     0      OK
+ * @retval    -1      Error, no type cache
+ */
+int
+yang_type_cache_validator_set(yang_stmt *ytype,
+                              void      *yv)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = yang_typecache_get(ytype)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "yang type cache");
+        return -1;
+    }
+    ycache->yc_validator = yv;
+    return 0;
+}
+
+/*! Get enum/bits index from yang type cache
+ *
+ * @param[in]  ytype  Yang type statement
+ * @retval     map    Enum/bits index
+ * @retval     NULL   No type cache or no index built
+ * @see yang_enum_name2val
+ */
+void *
+yang_type_cache_enummap_get(yang_stmt *ytype)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = yang_typecache_get(ytype)) == NULL)
+        return NULL;
+    return ycache->yc_enummap;
+}
+
+/*! Set enum/bits index in yang type cache
+ *
+ * The index is freed together with the type cache
+ * @param[in]  ytype  Yang type statement
+ * @param[in]  map    Enum/bits index
+ * @retval     0      OK
+ * @retval    -1      Error, no type cache
+ */
+int
+yang_type_cache_enummap_set(yang_stmt *ytype,
+                            void      *map)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = yang_typecache_get(ytype)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "yang type cache");
+        return -1;
+    }
+    ycache->yc_enummap = map;
+    return 0;
+}
+
 /*! Add a simple anydata-node 
  *
  * One usecase is CLICON_YANG_UNKNOWN_ANYDATA when unknown data is treated as anydata
@@ -4699,9 +5867,23 @@ yang_exit(clixon_handle h)
         free(_yang_mymodule_map);
         _yang_mymodule_map = NULL;
     }
+    yang_deps_exit(h);
     if ((ymounts = clixon_yang_mounts_get(h)) != NULL){
         ys_free(ymounts);
     }
     clixon_yang_mounts_set(h, NULL);
+    if (_yang_arena_map != NULL) {
+        free(_yang_arena_map);
+        _yang_arena_map = NULL;
+        _yang_arena_map_len = 0;
+    }
+    if (_yang_idclosure_map != NULL) {
+        free(_yang_idclosure_map);
+        _yang_idclosure_map = NULL;
+        _yang_idclosure_map_len = 0;
+    }
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    yang_index_exit();
+#endif
     return 0;
 }
@@ -0,0 +1,1752 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Precompiled YANG spec cache
+ *
+ * Parsing and post-processing (populate, grouping/augment expansion, type resolution) of
+ * large YANG sets is costly and is made by every clixon process at startup.
+ * This module saves the top-level data yang spec after yang_parse_post in a binary file
+ * and loads it instead of parsing when the first module is loaded by the same program.
+ * Subsequent yang_spec_parse_module() etc calls find their modules already loaded.
+ *
+ * The cache file is: <CLICON_YANG_SPEC_CACHE_DIR>/<program>.yspec
+ * It is only used if all of the following are unchanged:
+ * - Program name, all options including features and yang dirs, and the plugins with
+ *   extension callbacks
+ * - The names of all yang files in the yang dirs
+ * - The contents of all loaded module and submodule files
+ * Otherwise the spec is parsed as usual and a new cache file is written.
+ *
+ * File format (native byte order):
+ *   header:  magic, version, byte-order, build flags, context digest, dir digest
+ *   files:   number, then per file: name, size, content digest
+ *   nodes:   number of nodes, number of top-level nodes, then nodes in pre-order
+ * A node refers to other nodes (orig, when, my-module, resolved type, void cv:s) using
+ * their pre-order number, where the yang spec itself is 0.
+ * Strings are null-terminated.
+ *
+ * With CLICON_YANG_SPEC_CACHE_SHARED the file is memory-mapped and yang argument strings,
+ * including all descriptions, refer directly to the mapped image instead of being copied.
+ * All processes of the same program then share one copy of these strings in the page
+ * cache. Nodes, cligen variables, type caches and compiled regexps are still allocated
+ * per process, as are pages of the image that a process writes to.
+ * @see CLICON_YANG_SPEC_CACHE_DIR in clixon-config.yang
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_map.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_file.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_io.h"
+#include "clixon_data.h"
+#include "clixon_plugin.h"
+#include "clixon_yang_type.h"
+#include "clixon_validate_deps.h"
+#include "clixon_yang_cache.h"
+#include "clixon_yang_internal.h" /* internal included by this file only, not API */
+
+/*
+ * Constants
+ */
+#define YANG_CACHE_MAGIC     "CLIXYSPC"
+#define YANG_CACHE_VERSION   3          /* Increment when format changes */
+#define YANG_CACHE_BYTEORDER 0x01020304
+#define YANG_CACHE_NULL      0xffffffff /* Length of NULL string or cvec */
+#define YANG_CACHE_SUFFIX    "yspec"
+#define YANG_CACHE_DATANAME  "yang-spec-cache"  /* clicon_data name of program name */
+#define YANG_CACHE_DIGESTNAME "yang-spec-cache-digest" /* clicon_data name of context digest */
+
+/* Build flags that affect the format */
+#ifdef YANG_SPEC_LINENR
+#define YANG_CACHE_BUILD     0x01
+#else
+#define YANG_CACHE_BUILD     0x00
+#endif
+
+/* Yang flags not saved: dynamic or restored by other means */
+#define YANG_CACHE_FLAGS_SKIP (YANG_FLAG_MARK | YANG_FLAG_TMP | YANG_FLAG_FIND_INDEX | \
+                               YANG_FLAG_MOUNTPOINT | YANG_FLAG_SPEC_MOUNT |        \
+                               YANG_FLAG_WHEN | YANG_FLAG_MYMODULE | YANG_FLAG_DEPS | \
+                               YANG_FLAG_MAPPED)
+
+/*
+ * Types
+ */
+/*! Pointer to pre-order number, sorted on pointer for binary search
+ */
+struct ycache_ptr{
+    void    *yp_ptr;
+    int32_t  yp_id;
+};
+
+/*! Cache writer state
+ */
+struct ycache_wr{
+    cbuf              *yw_cb;     /* Output buffer */
+    yang_stmt        **yw_vec;    /* Nodes in pre-order, index is node number */
+    size_t             yw_len;    /* Number of nodes */
+    size_t             yw_max;    /* Allocated nodes */
+    struct ycache_ptr *yw_sorted; /* Nodes sorted on pointer */
+    uint32_t          *yw_args;   /* Offset of argument in string table per node number */
+    size_t             yw_pos;    /* Number of next node to write */
+};
+
+/*! Reference from a loaded node to another node, resolved when all nodes are read
+ */
+enum ycache_ref_type{
+    YCR_ORIG,
+    YCR_WHEN,
+    YCR_MYMODULE,
+};
+
+struct ycache_ref{
+    yang_stmt            *yr_ys;
+    enum ycache_ref_type  yr_type;
+    int32_t               yr_id;
+};
+
+/*! Type cache of a loaded type node, restored when all nodes are read
+ */
+struct ycache_tc{
+    yang_stmt *yt_ys;
+    int32_t    yt_resolved;
+    uint8_t    yt_options;
+    uint8_t    yt_fraction;
+    cvec      *yt_cvv;
+    cvec      *yt_patterns;
+};
+
+/*! Cache reader state
+ */
+struct ycache_rd{
+    char              *yr_buf;    /* File contents */
+    size_t             yr_len;    /* File length */
+    int                yr_mapped; /* yr_buf is a shared mapping of the file */
+    char              *yr_args;   /* String table of arguments, in yr_buf or yr_arena */
+    uint32_t           yr_argslen;/* Length of string table */
+    char              *yr_arena;  /* Private copy of string table, if frozen and not mapped */
+    size_t             yr_pos;    /* Read position */
+    int                yr_err;    /* Set if read past end or format error */
+    yang_stmt        **yr_vec;    /* Nodes in pre-order, index is node number */
+    uint32_t           yr_nr;     /* Number of nodes read */
+    uint32_t           yr_max;    /* Number of nodes in file */
+    struct ycache_ref *yr_refs;   /* References to resolve */
+    size_t             yr_nrefs;
+    size_t             yr_maxrefs;
+    struct ycache_tc  *yr_tcs;    /* Type caches to restore */
+    size_t             yr_ntcs;
+    size_t             yr_maxtcs;
+};
+
+/*! 64-bit FNV-1a hash of a buffer, continued from an earlier hash
+ */
+static uint64_t
+ycache_hash(uint64_t    h,
+            const void *buf,
+            size_t      len)
+{
+    const unsigned char *p = buf;
+    size_t               i;
+
+    for (i=0; i<len; i++){
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+#define YCACHE_HASH_INIT 14695981039346656037ULL
+
+/*! Hash a string including its terminating null, NULL strings hash as empty
+ */
+static uint64_t
+ycache_hash_str(uint64_t    h,
+                const char *str)
+{
+    if (str == NULL)
+        str = "";
+    return ycache_hash(h, str, strlen(str)+1);
+}
+
+/*! Get file name of yang spec cache
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  yspec Yang spec
+ * @param[out] cb    File name
+ * @retval     1     OK, cache is enabled for this yang spec
+ * @retval     0     Cache not enabled
+ */
+static int
+ycache_filename(clixon_handle h,
+                yang_stmt    *yspec,
+                cbuf         *cb)
+{
+    char *dir;
+    char *name = NULL;
+
+    if ((dir = clicon_option_str(h, "CLICON_YANG_SPEC_CACHE_DIR")) == NULL)
+        return 0;
+    if (clicon_data_get(h, YANG_CACHE_DATANAME, &name) < 0 || name == NULL)
+        return 0;
+    if (yspec != clicon_dbspec_yang(h))
+        return 0;
+    cprintf(cb, "%s/%s.%s", dir, name, YANG_CACHE_SUFFIX);
+    return 1;
+}
+
+static int
+ycache_strcmp(const void *a,
+              const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*! Compute digest of everything except yang files that affects the parsed yang spec
+ *
+ * Program name, all options and configuration, and plugins with extension callbacks
+ * @param[in]  h      Clixon handle
+ * @param[out] digest Digest
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ycache_context_digest(clixon_handle h,
+                      uint64_t     *digest)
+{
+    int              retval = -1;
+    uint64_t         d = YCACHE_HASH_INIT;
+    char            *name = NULL;
+    char           **keys = NULL;
+    size_t           klen = 0;
+    size_t           i;
+    clicon_hash_t   *copt;
+    cbuf            *cb = NULL;
+    cxobj           *xconf;
+    clixon_plugin_t *cp;
+    struct stat      st;
+    int64_t          v;
+
+    clicon_data_get(h, YANG_CACHE_DATANAME, &name);
+    d = ycache_hash_str(d, name);
+    copt = clicon_options(h);
+    if (clicon_hash_keys(copt, &keys, &klen) < 0)
+        goto done;
+    if (klen > 0)
+        qsort(keys, klen, sizeof(char*), ycache_strcmp);
+    for (i=0; i<klen; i++){
+        d = ycache_hash_str(d, keys[i]);
+        d = ycache_hash_str(d, clicon_hash_value(copt, keys[i], NULL));
+    }
+    if ((xconf = clicon_conf_xml(h)) != NULL){
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, xconf, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        d = ycache_hash(d, cbuf_get(cb), cbuf_len(cb));
+    }
+    /* Plugin extension callbacks may modify the yang spec */
+    cp = NULL;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        if (clixon_plugin_api_get(cp)->ca_extension == NULL)
+            continue;
+        d = ycache_hash_str(d, clixon_plugin_name_get(cp));
+        if (stat(clixon_plugin_name_get(cp), &st) == 0){
+            v = st.st_size;
+            d = ycache_hash(d, &v, sizeof(v));
+            v = st.st_mtime;
+            d = ycache_hash(d, &v, sizeof(v));
+        }
+    }
+    *digest = d;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get context digest, computed once when first used
+ *
+ * Options may be changed by the application after the first module is loaded, the
+ * digest is therefore taken when the cache is first read and reused when it is written.
+ * @param[in]  h      Clixon handle
+ * @param[out] digest Digest
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ycache_context_get(clixon_handle h,
+                   uint64_t     *digest)
+{
+    char  *str = NULL;
+    char   buf[32];
+
+    if (clicon_data_get(h, YANG_CACHE_DIGESTNAME, &str) == 0 && str != NULL){
+        *digest = strtoull(str, NULL, 16);
+        return 0;
+    }
+    if (ycache_context_digest(h, digest) < 0)
+        return -1;
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)*digest);
+    return clicon_data_set(h, YANG_CACHE_DIGESTNAME, buf);
+}
+
+/*! Compute digest of names of all yang files in the yang directories
+ *
+ * Detects added or removed files that may change which module revision is loaded.
+ * Recursive entries come in no particular order, so the digest is a sum of the path hashes.
+ * @param[in]  h      Clixon handle
+ * @param[out] digest Digest
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ycache_dir_digest(clixon_handle h,
+                  uint64_t     *digest)
+{
+    int            retval = -1;
+    uint64_t       d = 0;
+    char          *dir;
+    struct dirent *dp = NULL;
+    int            ndp;
+    int            i;
+    cxobj         *xconf;
+    cxobj         *xc;
+    cvec          *cvv = NULL;
+    cg_var        *cv;
+
+    if ((dir = clicon_yang_main_dir(h)) != NULL){
+        if ((ndp = clicon_file_dirent(dir, &dp, "\\.yang$", S_IFREG)) < 0)
+            goto done;
+        for (i=0; i<ndp; i++)
+            d += ycache_hash_str(ycache_hash_str(YCACHE_HASH_INIT, dir), dp[i].d_name);
+    }
+    if ((xconf = clicon_conf_xml(h)) != NULL){
+        xc = NULL;
+        while ((xc = xml_child_each(xconf, xc, CX_ELMNT)) != NULL) {
+            if (strcmp(xml_name(xc), "CLICON_YANG_DIR") != 0 ||
+                (dir = xml_body(xc)) == NULL)
+                continue;
+            if ((cvv = cvec_new(0)) == NULL){
+                clixon_err(OE_UNIX, errno, "cvec_new");
+                goto done;
+            }
+            if (clicon_files_recursive(dir, "\\.yang$", cvv) < 0)
+                goto done;
+            cv = NULL;
+            while ((cv = cvec_each(cvv, cv)) != NULL)
+                d += ycache_hash_str(YCACHE_HASH_INIT, cv_string_get(cv));
+            cvec_free(cvv);
+            cvv = NULL;
+        }
+    }
+    *digest = d;
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    if (cvv)
+        cvec_free(cvv);
+    return retval;
+}
+
+/*! Compute digest of file contents
+ *
+ * @param[in]  filename File name
+ * @param[out] size     File size
+ * @param[out] digest   Digest of contents
+ * @retval     1        OK
+ * @retval     0        File not readable
+ */
+static int
+ycache_file_digest(const char *filename,
+                   uint64_t   *size,
+                   uint64_t   *digest)
+{
+    FILE    *f;
+    char     buf[8192];
+    size_t   n;
+    uint64_t d = YCACHE_HASH_INIT;
+    uint64_t sz = 0;
+
+    if ((f = fopen(filename, "r")) == NULL)
+        return 0;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0){
+        d = ycache_hash(d, buf, n);
+        sz += n;
+    }
+    fclose(f);
+    *size = sz;
+    *digest = d;
+    return 1;
+}
+
+/*
+ * Writer
+ */
+static int
+ycache_wr_buf(struct ycache_wr *yw,
+              const void       *buf,
+              size_t            len)
+{
+    if (cbuf_append_buf(yw->yw_cb, (void*)buf, len) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+ycache_wr_u8(struct ycache_wr *yw,
+             uint8_t           v)
+{
+    return ycache_wr_buf(yw, &v, sizeof(v));
+}
+
+static int
+ycache_wr_u16(struct ycache_wr *yw,
+              uint16_t          v)
+{
+    return ycache_wr_buf(yw, &v, sizeof(v));
+}
+
+static int
+ycache_wr_u32(struct ycache_wr *yw,
+              uint32_t          v)
+{
+    return ycache_wr_buf(yw, &v, sizeof(v));
+}
+
+static int
+ycache_wr_u64(struct ycache_wr *yw,
+              uint64_t          v)
+{
+    return ycache_wr_buf(yw, &v, sizeof(v));
+}
+
+static int
+ycache_wr_str(struct ycache_wr *yw,
+              const char       *str)
+{
+    uint32_t len;
+
+    if (str == NULL)
+        return ycache_wr_u32(yw, YANG_CACHE_NULL);
+    len = strlen(str);
+    if (ycache_wr_u32(yw, len) < 0)
+        return -1;
+    /* Include null so that strings can be used directly in a mapped image */
+    return ycache_wr_buf(yw, str, len+1);
+}
+
+static int
+ycache_ptr_cmp(const void *a,
+               const void *b)
+{
+    const struct ycache_ptr *pa = a;
+    const struct ycache_ptr *pb = b;
+
+    if (pa->yp_ptr < pb->yp_ptr)
+        return -1;
+    if (pa->yp_ptr > pb->yp_ptr)
+        return 1;
+    return 0;
+}
+
+/*! Number yang statement and its descendants in pre-order
+ */
+static int
+ycache_number(struct ycache_wr *yw,
+              yang_stmt        *ys)
+{
+    yang_stmt **vec;
+    int         i;
+
+    if (yw->yw_len >= yw->yw_max){
+        yw->yw_max = yw->yw_max ? 2*yw->yw_max : 1024;
+        if ((vec = realloc(yw->yw_vec, yw->yw_max*sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        yw->yw_vec = vec;
+    }
+    yw->yw_vec[yw->yw_len++] = ys;
+    for (i=0; i<ys->ys_len; i++)
+        if (ycache_number(yw, ys->ys_stmt[i]) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Get pre-order number of a node
+ *
+ * @param[in]  yw   Writer state
+ * @param[in]  ptr  Pointer to yang statement, or NULL
+ * @param[out] id   Node number, -1 if ptr is NULL
+ * @retval     1    OK
+ * @retval     0    Pointer is not a node in the yang spec
+ */
+static int
+ycache_id(struct ycache_wr *yw,
+          void             *ptr,
+          int32_t          *id)
+{
+    struct ycache_ptr  key;
+    struct ycache_ptr *yp;
+
+    if (ptr == NULL){
+        *id = -1;
+        return 1;
+    }
+    key.yp_ptr = ptr;
+    if ((yp = bsearch(&key, yw->yw_sorted, yw->yw_len, sizeof(key), ycache_ptr_cmp)) == NULL)
+        return 0;
+    *id = yp->yp_id;
+    return 1;
+}
+
+/*! Write a cligen variable
+ *
+ * @retval   1    OK
+ * @retval   0    Variable cannot be saved
+ * @retval  -1    Error
+ */
+static int
+ycache_write_cv(struct ycache_wr *yw,
+                cg_var           *cv)
+{
+    int          retval = -1;
+    enum cv_type type;
+    int32_t      id;
+    char        *str = NULL;
+
+    type = cv_type_get(cv);
+    if (ycache_wr_u8(yw, type) < 0 ||
+        ycache_wr_u8(yw, cv_flag(cv, 0xff)) < 0 ||
+        ycache_wr_str(yw, cv_name_get(cv)) < 0)
+        goto done;
+    switch (type){
+    case CGV_ERR:
+    case CGV_EMPTY:
+        break;
+    case CGV_VOID: /* Only references to yang statements can be saved */
+        if (ycache_id(yw, cv_void_get(cv), &id) == 0)
+            goto fail;
+        if (ycache_wr_u32(yw, (uint32_t)id) < 0)
+            goto done;
+        break;
+    case CGV_STRING:
+    case CGV_REST:
+    case CGV_INTERFACE:
+    case CGV_URL:
+        if (ycache_wr_str(yw, cv_string_get(cv)) < 0)
+            goto done;
+        break;
+    case CGV_DEC64:
+        if (ycache_wr_u8(yw, cv_dec64_n_get(cv)) < 0)
+            goto done;
+        /* fall through */
+    default:
+        if ((str = cv2str_dup(cv)) == NULL){
+            clixon_err(OE_UNIX, errno, "cv2str_dup");
+            goto done;
+        }
+        if (ycache_wr_str(yw, str) < 0)
+            goto done;
+        break;
+    }
+    retval = 1;
+ done:
+    if (str)
+        free(str);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Write a cligen variable vector, which may be NULL
+ *
+ * @retval   1    OK
+ * @retval   0    Vector cannot be saved
+ * @retval  -1    Error
+ */
+static int
+ycache_write_cvec(struct ycache_wr *yw,
+                  cvec             *cvv)
+{
+    cg_var *cv;
+    int     ret;
+
+    if (cvv == NULL)
+        return ycache_wr_u32(yw, YANG_CACHE_NULL);
+    if (ycache_wr_u32(yw, cvec_len(cvv)) < 0)
+        return -1;
+    cv = NULL;
+    while ((cv = cvec_each(cvv, cv)) != NULL)
+        if ((ret = ycache_write_cv(yw, cv)) < 1)
+            return ret;
+    return 1;
+}
+
+/*! Write a reference to another node
+ *
+ * @retval   1    OK
+ * @retval   0    Reference outside yang spec
+ * @retval  -1    Error
+ */
+static int
+ycache_write_ref(struct ycache_wr *yw,
+                 yang_stmt        *yref)
+{
+    int32_t id;
+
+    if (ycache_id(yw, yref, &id) == 0)
+        return 0;
+    if (ycache_wr_u32(yw, (uint32_t)id) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Write string table of interned arguments of all nodes
+ *
+ * Equal arguments are stored once, nodes refer to arguments by offset in the table.
+ * The table is the argument arena of a loaded spec, see yang_spec_arena_add
+ * @param[in]  yw   Writer state, nodes numbered
+ * @retval     1    OK
+ * @retval     0    Table too large
+ * @retval    -1    Error
+ */
+static int
+ycache_write_args(struct ycache_wr *yw)
+{
+    int         retval = -1;
+    yang_stmt **vec = NULL;
+    uint32_t   *ids = NULL;
+    size_t     *offs = NULL;
+    char       *data = NULL;
+    size_t      size = 0;
+    size_t      len = 0;
+    size_t      i;
+
+    if ((yw->yw_args = malloc(yw->yw_len*sizeof(*yw->yw_args))) == NULL ||
+        (vec = malloc(yw->yw_len*sizeof(*vec))) == NULL ||
+        (ids = malloc(yw->yw_len*sizeof(*ids))) == NULL ||
+        (offs = malloc(yw->yw_len*sizeof(*offs))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (i=0; i<yw->yw_len; i++){
+        yw->yw_args[i] = YANG_CACHE_NULL;
+        if (yw->yw_vec[i]->ys_argument != NULL){
+            vec[len] = yw->yw_vec[i];
+            ids[len++] = i;
+        }
+    }
+    if (yang_arena_intern(vec, len, offs, &data, &size) < 0)
+        goto done;
+    if (size >= YANG_CACHE_NULL){
+        retval = 0;
+        goto done;
+    }
+    for (i=0; i<len; i++)
+        yw->yw_args[ids[i]] = offs[i];
+    if (ycache_wr_u32(yw, size) < 0 ||
+        ycache_wr_buf(yw, data, size) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    if (ids)
+        free(ids);
+    if (offs)
+        free(offs);
+    if (data)
+        free(data);
+    return retval;
+}
+
+/*! Write yang statement and its descendants in pre-order
+ *
+ * @param[in]  yw   Writer state
+ * @param[in]  ys   Yang statement
+ * @retval     1    OK
+ * @retval     0    Statement cannot be saved, eg references outside the yang spec
+ * @retval    -1    Error
+ */
+static int
+ycache_write_node(struct ycache_wr *yw,
+                  yang_stmt        *ys)
+{
+    yang_type_cache *ycache;
+    int              ret;
+    int              i;
+
+    if (ycache_wr_u8(yw, ys->ys_keyword) < 0 ||
+        ycache_wr_u16(yw, ys->ys_flags & ~YANG_CACHE_FLAGS_SKIP) < 0 ||
+        ycache_wr_u32(yw, ys->ys_len) < 0)
+        return -1;
+#ifdef YANG_SPEC_LINENR
+    if (ycache_wr_u32(yw, ys->ys_linenum) < 0)
+        return -1;
+#endif
+    if (ycache_wr_u32(yw, yw->yw_args[yw->yw_pos++]) < 0)
+        return -1;
+    if (ys->ys_cv == NULL){
+        if (ycache_wr_u8(yw, 0) < 0)
+            return -1;
+    }
+    else {
+        if (ycache_wr_u8(yw, 1) < 0)
+            return -1;
+        if ((ret = ycache_write_cv(yw, ys->ys_cv)) < 1)
+            return ret;
+    }
+    if ((ret = ycache_write_cvec(yw, ys->ys_cvec)) < 1)
+        return ret;
+    if ((ret = ycache_write_ref(yw, ys->ys_orig)) < 1)
+        return ret;
+    if ((ret = ycache_write_ref(yw, yang_when_map_get(ys))) < 1)
+        return ret;
+    if ((ret = ycache_write_ref(yw, yang_mymodule_get(ys))) < 1)
+        return ret;
+    switch (ys->ys_keyword){
+    case Y_MODULE:
+    case Y_SUBMODULE:
+        if (ycache_wr_str(yw, ys->ys_filename) < 0)
+            return -1;
+        break;
+    case Y_TYPE:
+        if ((ycache = ys->ys_typecache) == NULL){
+            if (ycache_wr_u8(yw, 0) < 0)
+                return -1;
+            break;
+        }
+        if (ycache_wr_u8(yw, 1) < 0 ||
+            ycache_wr_u8(yw, ycache->yc_options) < 0 ||
+            ycache_wr_u8(yw, ycache->yc_fraction) < 0)
+            return -1;
+        if ((ret = ycache_write_ref(yw, ycache->yc_resolved)) < 1)
+            return ret;
+        if ((ret = ycache_write_cvec(yw, ycache->yc_cvv)) < 1)
+            return ret;
+        if ((ret = ycache_write_cvec(yw, ycache->yc_patterns)) < 1)
+            return ret;
+        break;
+    default:
+        break;
+    }
+    for (i=0; i<ys->ys_len; i++)
+        if ((ret = ycache_write_node(yw, ys->ys_stmt[i])) < 1)
+            return ret;
+    return 1;
+}
+
+/*! Write cache file atomically
+ *
+ * Write to a temporary file and rename, since several processes may start concurrently
+ */
+static int
+ycache_write_file(const char *filename,
+                  cbuf       *cb)
+{
+    int    retval = -1;
+    cbuf  *tb = NULL;
+    FILE  *f = NULL;
+    char  *tmpfile;
+
+    if ((tb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(tb, "%s.%d", filename, (int)getpid());
+    tmpfile = cbuf_get(tb);
+    if ((f = fopen(tmpfile, "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen(%s)", tmpfile);
+        goto done;
+    }
+    if (fwrite(cbuf_get(cb), 1, cbuf_len(cb), f) != cbuf_len(cb)){
+        clixon_err(OE_UNIX, errno, "fwrite(%s)", tmpfile);
+        fclose(f);
+        f = NULL;
+        unlink(tmpfile);
+        goto done;
+    }
+    if (fclose(f) < 0){
+        f = NULL;
+        clixon_err(OE_UNIX, errno, "fclose(%s)", tmpfile);
+        unlink(tmpfile);
+        goto done;
+    }
+    f = NULL;
+    if (rename(tmpfile, filename) < 0){
+        clixon_err(OE_UNIX, errno, "rename(%s)", filename);
+        unlink(tmpfile);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (tb)
+        cbuf_free(tb);
+    return retval;
+}
+
+/*! Save yang spec to cache file
+ *
+ * Called after yang_parse_post when modules are added to the top-level data yang spec.
+ * If the spec cannot be saved, eg a module is not loaded from a file, no file is written.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK, also if cache is not enabled
+ * @retval    -1      Error
+ * @see yang_spec_cache_load
+ */
+int
+yang_spec_cache_save(clixon_handle h,
+                     yang_stmt    *yspec)
+{
+    int              retval = -1;
+    cbuf            *fb = NULL;
+    struct ycache_wr yw = {0,};
+    uint64_t         digest;
+    uint64_t         size;
+    yang_stmt       *ym;
+    char            *dir;
+    struct stat      st;
+    size_t           i;
+    int              ret;
+
+    if ((fb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (ycache_filename(h, yspec, fb) == 0)
+        goto ok;
+    /* Number nodes and sort for pointer lookup */
+    if (ycache_number(&yw, yspec) < 0)
+        goto done;
+    if ((yw.yw_sorted = malloc(yw.yw_len*sizeof(*yw.yw_sorted))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (i=0; i<yw.yw_len; i++){
+        yw.yw_sorted[i].yp_ptr = yw.yw_vec[i];
+        yw.yw_sorted[i].yp_id = i;
+    }
+    qsort(yw.yw_sorted, yw.yw_len, sizeof(*yw.yw_sorted), ycache_ptr_cmp);
+    if ((yw.yw_cb = cbuf_new_alloc(1024*1024)) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Header */
+    if (ycache_wr_buf(&yw, YANG_CACHE_MAGIC, strlen(YANG_CACHE_MAGIC)) < 0 ||
+        ycache_wr_u32(&yw, YANG_CACHE_VERSION) < 0 ||
+        ycache_wr_u32(&yw, YANG_CACHE_BYTEORDER) < 0 ||
+        ycache_wr_u32(&yw, YANG_CACHE_BUILD) < 0)
+        goto done;
+    if (ycache_context_get(h, &digest) < 0)
+        goto done;
+    if (ycache_wr_u64(&yw, digest) < 0)
+        goto done;
+    if (ycache_dir_digest(h, &digest) < 0)
+        goto done;
+    if (ycache_wr_u64(&yw, digest) < 0)
+        goto done;
+    /* Source files */
+    if (ycache_wr_u32(&yw, yspec->ys_len) < 0)
+        goto done;
+    for (i=0; i<yspec->ys_len; i++){
+        ym = yspec->ys_stmt[i];
+        if ((ym->ys_keyword != Y_MODULE && ym->ys_keyword != Y_SUBMODULE) ||
+            ym->ys_filename == NULL ||
+            ycache_file_digest(ym->ys_filename, &size, &digest) == 0){
+            clixon_debug(CLIXON_DBG_YANG, "Yang spec cache not saved: %s has no source file",
+                         yang_argument_get(ym));
+            goto ok;
+        }
+        if (ycache_wr_str(&yw, ym->ys_filename) < 0 ||
+            ycache_wr_u64(&yw, size) < 0 ||
+            ycache_wr_u64(&yw, digest) < 0)
+            goto done;
+    }
+    /* Nodes */
+    if (ycache_wr_u32(&yw, yw.yw_len) < 0 ||
+        ycache_wr_u32(&yw, yspec->ys_len) < 0)
+        goto done;
+    if ((ret = ycache_write_args(&yw)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_debug(CLIXON_DBG_YANG, "Yang spec cache not saved: too large");
+        goto ok;
+    }
+    yw.yw_pos = 1; /* yspec itself is not written */
+    for (i=0; i<yspec->ys_len; i++){
+        if ((ret = ycache_write_node(&yw, yspec->ys_stmt[i])) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_debug(CLIXON_DBG_YANG, "Yang spec cache not saved: %s has external references",
+                         yang_argument_get(yspec->ys_stmt[i]));
+            goto ok;
+        }
+    }
+    dir = clicon_option_str(h, "CLICON_YANG_SPEC_CACHE_DIR");
+    if (stat(dir, &st) < 0){
+        if (mkdir(dir, S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH) < 0){
+            clixon_err(OE_UNIX, errno, "mkdir(%s)", dir);
+            goto done;
+        }
+    }
+    else if (!S_ISDIR(st.st_mode)){
+        clixon_err(OE_UNIX, 0, "%s exists but is not a directory as expected", dir);
+        goto done;
+    }
+    if (ycache_write_file(cbuf_get(fb), yw.yw_cb) < 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_YANG, "Yang spec cache saved: %s nodes:%zu size:%zu",
+                 cbuf_get(fb), yw.yw_len, cbuf_len(yw.yw_cb));
+ ok:
+    retval = 0;
+ done:
+    if (fb)
+        cbuf_free(fb);
+    if (yw.yw_cb)
+        cbuf_free(yw.yw_cb);
+    if (yw.yw_vec)
+        free(yw.yw_vec);
+    if (yw.yw_sorted)
+        free(yw.yw_sorted);
+    if (yw.yw_args)
+        free(yw.yw_args);
+    return retval;
+}
+
+/*
+ * Reader
+ * Read functions set yr_err on read past end, the caller checks it when convenient.
+ */
+static void *
+ycache_rd_buf(struct ycache_rd *yr,
+              size_t            len)
+{
+    void *p;
+
+    if (yr->yr_err || len > yr->yr_len - yr->yr_pos){
+        yr->yr_err = 1;
+        return NULL;
+    }
+    p = yr->yr_buf + yr->yr_pos;
+    yr->yr_pos += len;
+    return p;
+}
+
+static uint8_t
+ycache_rd_u8(struct ycache_rd *yr)
+{
+    uint8_t *p;
+
+    if ((p = ycache_rd_buf(yr, sizeof(*p))) == NULL)
+        return 0;
+    return *p;
+}
+
+static uint16_t
+ycache_rd_u16(struct ycache_rd *yr)
+{
+    uint16_t v = 0;
+    void    *p;
+
+    if ((p = ycache_rd_buf(yr, sizeof(v))) != NULL)
+        memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t
+ycache_rd_u32(struct ycache_rd *yr)
+{
+    uint32_t v = 0;
+    void    *p;
+
+    if ((p = ycache_rd_buf(yr, sizeof(v))) != NULL)
+        memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t
+ycache_rd_u64(struct ycache_rd *yr)
+{
+    uint64_t v = 0;
+    void    *p;
+
+    if ((p = ycache_rd_buf(yr, sizeof(v))) != NULL)
+        memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*! Read string and return a malloced copy
+ *
+ * @param[in]  yr   Reader state
+ * @param[out] str  Malloced string, or NULL if NULL string or read error
+ * @retval     0    OK, check yr_err
+ * @retval    -1    Error
+ */
+static int
+ycache_rd_str(struct ycache_rd *yr,
+              char            **str)
+{
+    uint32_t len;
+    char    *p;
+
+    *str = NULL;
+    len = ycache_rd_u32(yr);
+    if (yr->yr_err || len == YANG_CACHE_NULL)
+        return 0;
+    if ((p = ycache_rd_buf(yr, len+1)) == NULL)
+        return 0;
+    if (p[len] != '\0'){
+        yr->yr_err = 1;
+        return 0;
+    }
+    if ((*str = malloc(len+1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memcpy(*str, p, len);
+    (*str)[len] = '\0';
+    return 0;
+}
+
+/*! Read argument of node as offset in string table
+ *
+ * @param[in]  yr   Reader state
+ * @param[out] str  String in table, or NULL
+ * @retval     0    OK, check yr_err
+ */
+static int
+ycache_rd_arg(struct ycache_rd *yr,
+              char            **str)
+{
+    uint32_t off;
+
+    *str = NULL;
+    off = ycache_rd_u32(yr);
+    if (yr->yr_err || off == YANG_CACHE_NULL)
+        return 0;
+    if (off >= yr->yr_argslen){
+        yr->yr_err = 1;
+        return 0;
+    }
+    *str = yr->yr_args + off;
+    return 0;
+}
+
+/*! Read value of cligen variable, type and name already set
+ *
+ * Void references are stored as node number + 1 and resolved later
+ * @retval   1    OK
+ * @retval   0    Format error
+ * @retval  -1    Error
+ */
+static int
+ycache_read_cv(struct ycache_rd *yr,
+               cg_var           *cv)
+{
+    int      retval = -1;
+    char    *str = NULL;
+    char    *reason = NULL;
+    uint8_t  flags;
+    int32_t  id;
+    int      ret;
+
+    flags = ycache_rd_u8(yr);
+    if (flags)
+        cv_flag_set(cv, flags);
+    if (ycache_rd_str(yr, &str) < 0)
+        goto done;
+    if (str != NULL){
+        if (cv_name_set(cv, str) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_name_set");
+            goto done;
+        }
+        free(str);
+        str = NULL;
+    }
+    switch (cv_type_get(cv)){
+    case CGV_ERR:
+    case CGV_EMPTY:
+        break;
+    case CGV_VOID:
+        id = (int32_t)ycache_rd_u32(yr);
+        if (id < -1 || id >= (int32_t)yr->yr_max)
+            goto fail;
+        cv_void_set(cv, (void*)(intptr_t)(id+1));
+        break;
+    case CGV_STRING:
+    case CGV_REST:
+    case CGV_INTERFACE:
+    case CGV_URL:
+        if (ycache_rd_str(yr, &str) < 0)
+            goto done;
+        if (str != NULL && cv_string_set(cv, str) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_string_set");
+            goto done;
+        }
+        break;
+    case CGV_DEC64:
+        cv_dec64_n_set(cv, ycache_rd_u8(yr));
+        /* fall through */
+    default:
+        if (ycache_rd_str(yr, &str) < 0)
+            goto done;
+        if (str == NULL)
+            goto fail;
+        if ((ret = cv_parse1(str, cv, &reason)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        break;
+    }
+    if (yr->yr_err)
+        goto fail;
+    retval = 1;
+ done:
+    if (str)
+        free(str);
+    if (reason)
+        free(reason);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Read cligen variable vector
+ *
+ * @param[in]  yr   Reader state
+ * @param[out] cvvp Vector, or NULL
+ * @retval     1    OK
+ * @retval     0    Format error
+ * @retval    -1    Error
+ */
+static int
+ycache_read_cvec(struct ycache_rd *yr,
+                 cvec            **cvvp)
+{
+    cvec    *cvv;
+    cg_var  *cv;
+    uint32_t len;
+    uint32_t i;
+    int      ret;
+
+    *cvvp = NULL;
+    len = ycache_rd_u32(yr);
+    if (yr->yr_err)
+        return 0;
+    if (len == YANG_CACHE_NULL)
+        return 1;
+    if ((cvv = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        return -1;
+    }
+    *cvvp = cvv;
+    for (i=0; i<len; i++){
+        if ((cv = cvec_add(cvv, ycache_rd_u8(yr))) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_add");
+            return -1;
+        }
+        if ((ret = ycache_read_cv(yr, cv)) < 1)
+            return ret;
+    }
+    return 1;
+}
+
+/*! Read a node reference and add it to resolve list
+ *
+ * @retval   1    OK
+ * @retval   0    Format error
+ * @retval  -1    Error
+ */
+static int
+ycache_read_ref(struct ycache_rd    *yr,
+                yang_stmt           *ys,
+                enum ycache_ref_type type)
+{
+    struct ycache_ref *refs;
+    int32_t            id;
+
+    id = (int32_t)ycache_rd_u32(yr);
+    if (yr->yr_err || id < -1 || id >= (int32_t)yr->yr_max)
+        return 0;
+    if (id == -1)
+        return 1;
+    if (yr->yr_nrefs >= yr->yr_maxrefs){
+        yr->yr_maxrefs = yr->yr_maxrefs ? 2*yr->yr_maxrefs : 1024;
+        if ((refs = realloc(yr->yr_refs, yr->yr_maxrefs*sizeof(*refs))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        yr->yr_refs = refs;
+    }
+    yr->yr_refs[yr->yr_nrefs].yr_ys = ys;
+    yr->yr_refs[yr->yr_nrefs].yr_type = type;
+    yr->yr_refs[yr->yr_nrefs].yr_id = id;
+    yr->yr_nrefs++;
+    return 1;
+}
+
+/*! Read type cache of type node and add it to restore list
+ *
+ * @retval   1    OK
+ * @retval   0    Format error
+ * @retval  -1    Error
+ */
+static int
+ycache_read_typecache(struct ycache_rd *yr,
+                      yang_stmt        *ys)
+{
+    struct ycache_tc *tcs;
+    struct ycache_tc *tc;
+    int               ret;
+
+    if (ycache_rd_u8(yr) == 0)
+        return yr->yr_err?0:1;
+    if (yr->yr_ntcs >= yr->yr_maxtcs){
+        yr->yr_maxtcs = yr->yr_maxtcs ? 2*yr->yr_maxtcs : 256;
+        if ((tcs = realloc(yr->yr_tcs, yr->yr_maxtcs*sizeof(*tcs))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        yr->yr_tcs = tcs;
+    }
+    tc = &yr->yr_tcs[yr->yr_ntcs++];
+    memset(tc, 0, sizeof(*tc));
+    tc->yt_ys = ys;
+    tc->yt_options = ycache_rd_u8(yr);
+    tc->yt_fraction = ycache_rd_u8(yr);
+    tc->yt_resolved = (int32_t)ycache_rd_u32(yr);
+    if (yr->yr_err || tc->yt_resolved < -1 || tc->yt_resolved >= (int32_t)yr->yr_max)
+        return 0;
+    if ((ret = ycache_read_cvec(yr, &tc->yt_cvv)) < 1)
+        return ret;
+    return ycache_read_cvec(yr, &tc->yt_patterns);
+}
+
+/*! Read yang statement and its descendants in pre-order
+ *
+ * @param[in]  yr   Reader state
+ * @param[out] ysp  New yang statement, also set on format error, free with ys_free
+ * @retval     1    OK
+ * @retval     0    Format error
+ * @retval    -1    Error
+ */
+static int
+ycache_read_node(struct ycache_rd *yr,
+                 yang_stmt       **ysp)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    uint8_t    keyword;
+    uint32_t   len;
+    uint32_t   i;
+    int        ret;
+    char      *str;
+
+    *ysp = NULL;
+    keyword = ycache_rd_u8(yr);
+    if (yr->yr_err || keyword == 0 || keyword > Y_SPEC || yr->yr_nr >= yr->yr_max)
+        return 0;
+    if ((ys = ys_new(keyword)) == NULL)
+        return -1;
+    *ysp = ys;
+    yr->yr_vec[yr->yr_nr++] = ys;
+    ys->ys_flags = ycache_rd_u16(yr);
+    len = ycache_rd_u32(yr);
+#ifdef YANG_SPEC_LINENR
+    ys->ys_linenum = ycache_rd_u32(yr);
+#endif
+    ycache_rd_arg(yr, &str);
+    if (str != NULL){
+        if (yr->yr_mapped || yr->yr_arena){
+            /* Argument refers to argument arena of spec, see YANG_FLAG_MAPPED */
+            ys->ys_argument = str;
+            ys->ys_flags |= YANG_FLAG_MAPPED;
+        }
+        else if ((ys->ys_argument = strdup(str)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            return -1;
+        }
+    }
+    if (ycache_rd_u8(yr) != 0){
+        if ((ys->ys_cv = cv_new(ycache_rd_u8(yr))) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_new");
+            return -1;
+        }
+        if ((ret = ycache_read_cv(yr, ys->ys_cv)) < 1)
+            return ret;
+    }
+    if ((ret = ycache_read_cvec(yr, &ys->ys_cvec)) < 1)
+        return ret;
+    if ((ret = ycache_read_ref(yr, ys, YCR_ORIG)) < 1 ||
+        (ret = ycache_read_ref(yr, ys, YCR_WHEN)) < 1 ||
+        (ret = ycache_read_ref(yr, ys, YCR_MYMODULE)) < 1)
+        return ret;
+    switch (keyword){
+    case Y_MODULE:
+    case Y_SUBMODULE:
+        if (ycache_rd_str(yr, &ys->ys_filename) < 0)
+            return -1;
+        break;
+    case Y_TYPE:
+        if ((ret = ycache_read_typecache(yr, ys)) < 1)
+            return ret;
+        break;
+    default:
+        break;
+    }
+    if (yr->yr_err || len > yr->yr_max - yr->yr_nr)
+        return 0;
+    if (len > 0 &&
+        (ys->ys_stmt = calloc(len, sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i=0; i<len; i++){
+        ret = ycache_read_node(yr, &yc);
+        if (yc != NULL){
+            ys->ys_stmt[i] = yc;
+            ys->ys_len = i+1;
+            yc->ys_parent = ys;
+        }
+        if (ret < 1)
+            return ret;
+    }
+    return 1;
+}
+
+/*! Resolve void cv references in a vector from node number + 1 to node pointer
+ */
+static int
+ycache_resolve_cv(struct ycache_rd *yr,
+                  cg_var           *cv)
+{
+    intptr_t id1;
+
+    if (cv == NULL || cv_type_get(cv) != CGV_VOID)
+        return 0;
+    id1 = (intptr_t)cv_void_get(cv);
+    cv_void_set(cv, id1 ? yr->yr_vec[id1-1] : NULL);
+    return 0;
+}
+
+/*! Read whole file into memory
+ *
+ * If shared, the file is mapped instead of read. The mapping is private copy-on-write:
+ * pages are shared with all other processes mapping the same file until written.
+ * A new cache file is written to a new inode and renamed, so an existing mapping
+ * remains valid.
+ * @param[in]  filename  Cache file
+ * @param[in]  shared    Map file instead of reading it
+ * @param[out] bufp      File contents, free or munmap
+ * @param[out] lenp      File length
+ * @retval     1         OK
+ * @retval     0         No such file
+ * @retval    -1         Error
+ */
+static int
+ycache_read_file(const char *filename,
+                 int         shared,
+                 char      **bufp,
+                 size_t     *lenp)
+{
+    int         retval = -1;
+    FILE       *f = NULL;
+    struct stat st;
+    char       *buf = NULL;
+    void       *addr;
+
+    if ((f = fopen(filename, "r")) == NULL){
+        retval = 0;
+        goto done;
+    }
+    if (fstat(fileno(f), &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat(%s)", filename);
+        goto done;
+    }
+    if (st.st_size == 0){
+        retval = 0;
+        goto done;
+    }
+    if (shared){
+        if ((addr = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE,
+                         fileno(f), 0)) == MAP_FAILED){
+            clixon_err(OE_UNIX, errno, "mmap(%s)", filename);
+            goto done;
+        }
+        *bufp = addr;
+        *lenp = st.st_size;
+        retval = 1;
+        goto done;
+    }
+    if ((buf = malloc(st.st_size+1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (fread(buf, 1, st.st_size, f) != (size_t)st.st_size){
+        clixon_err(OE_UNIX, errno, "fread(%s)", filename);
+        goto done;
+    }
+    *bufp = buf;
+    buf = NULL;
+    *lenp = st.st_size;
+    retval = 1;
+ done:
+    if (buf)
+        free(buf);
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Check cache header and source files
+ *
+ * @retval   1    OK, cache is valid
+ * @retval   0    Cache is stale or has wrong format
+ * @retval  -1    Error
+ */
+static int
+ycache_read_header(clixon_handle     h,
+                   struct ycache_rd *yr)
+{
+    int       retval = -1;
+    char     *magic;
+    uint64_t  digest;
+    uint64_t  size;
+    uint64_t  fsize;
+    uint64_t  fdigest;
+    uint32_t  nfiles;
+    uint32_t  i;
+    char     *filename = NULL;
+    char     *reason = NULL;
+
+    if ((magic = ycache_rd_buf(yr, strlen(YANG_CACHE_MAGIC))) == NULL ||
+        memcmp(magic, YANG_CACHE_MAGIC, strlen(YANG_CACHE_MAGIC)) != 0 ||
+        ycache_rd_u32(yr) != YANG_CACHE_VERSION ||
+        ycache_rd_u32(yr) != YANG_CACHE_BYTEORDER ||
+        ycache_rd_u32(yr) != YANG_CACHE_BUILD){
+        reason = "format";
+        goto fail;
+    }
+    if (ycache_context_get(h, &digest) < 0)
+        goto done;
+    if (ycache_rd_u64(yr) != digest){
+        reason = "options or plugins changed";
+        goto fail;
+    }
+    if (ycache_dir_digest(h, &digest) < 0)
+        goto done;
+    if (ycache_rd_u64(yr) != digest){
+        reason = "yang files added or removed";
+        goto fail;
+    }
+    nfiles = ycache_rd_u32(yr);
+    for (i=0; i<nfiles && !yr->yr_err; i++){
+        if (ycache_rd_str(yr, &filename) < 0)
+            goto done;
+        size = ycache_rd_u64(yr);
+        digest = ycache_rd_u64(yr);
+        if (filename == NULL ||
+            ycache_file_digest(filename, &fsize, &fdigest) == 0 ||
+            fsize != size ||
+            fdigest != digest){
+            reason = "yang file changed";
+            goto fail;
+        }
+        free(filename);
+        filename = NULL;
+    }
+    if (yr->yr_err){
+        reason = "format";
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+ fail:
+    clixon_debug(CLIXON_DBG_YANG, "Yang spec cache stale: %s%s%s", reason,
+                 filename?" ":"", filename?filename:"");
+    retval = 0;
+    goto done;
+}
+
+/*! Load top-level data yang spec from cache file
+ *
+ * Only done if the yang spec is empty, ie before the first module is loaded.
+ * Subsequent yang_spec_parse_module etc calls find their modules already loaded.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @retval     1      Loaded from cache
+ * @retval     0      Not loaded: cache not enabled, stale or not present, parse as usual
+ * @retval    -1      Error
+ * @see yang_spec_cache_save
+ */
+int
+yang_spec_cache_load(clixon_handle h,
+                     yang_stmt    *yspec)
+{
+    int                retval = -1;
+    cbuf              *fb = NULL;
+    struct ycache_rd   yr = {0,};
+    struct ycache_ref *ref;
+    struct ycache_tc  *tc;
+    yang_stmt         *ys;
+    yang_stmt         *yref;
+    uint32_t           ntop;
+    uint32_t           i;
+    int                ret;
+    int                attached = 0;
+
+    if (yspec->ys_len != 0)
+        goto fail;
+    if ((fb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (ycache_filename(h, yspec, fb) == 0)
+        goto fail;
+    yr.yr_mapped = clicon_option_bool(h, "CLICON_YANG_SPEC_CACHE_SHARED");
+    if ((ret = ycache_read_file(cbuf_get(fb), yr.yr_mapped, &yr.yr_buf, &yr.yr_len)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = ycache_read_header(h, &yr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    yr.yr_max = ycache_rd_u32(&yr);
+    ntop = ycache_rd_u32(&yr);
+    if (yr.yr_err || yr.yr_max == 0 || ntop >= yr.yr_max ||
+        yr.yr_max > yr.yr_len){
+        clixon_debug(CLIXON_DBG_YANG, "Yang spec cache: format");
+        goto fail;
+    }
+    /* String table of arguments, strings are NUL-terminated */
+    yr.yr_argslen = ycache_rd_u32(&yr);
+    if (yr.yr_err || yr.yr_argslen == YANG_CACHE_NULL ||
+        (yr.yr_args = ycache_rd_buf(&yr, yr.yr_argslen)) == NULL ||
+        (yr.yr_argslen > 0 && yr.yr_args[yr.yr_argslen-1] != '\0')){
+        clixon_debug(CLIXON_DBG_YANG, "Yang spec cache: format");
+        goto fail;
+    }
+    /* Frozen: string table is already interned, use a copy as argument arena */
+    if (!yr.yr_mapped && yr.yr_argslen > 0 &&
+        clicon_option_bool(h, "CLICON_YANG_SPEC_FREEZE")){
+        if ((yr.yr_arena = malloc(yr.yr_argslen)) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memcpy(yr.yr_arena, yr.yr_args, yr.yr_argslen);
+        yr.yr_args = yr.yr_arena;
+    }
+    if ((yr.yr_vec = calloc(yr.yr_max, sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    yr.yr_vec[yr.yr_nr++] = yspec;
+    /* Read all nodes and attach them to yspec */
+    for (i=0; i<ntop; i++){
+        ret = ycache_read_node(&yr, &ys);
+        if (ys != NULL){
+            if (yn_insert(yspec, ys) < 0){
+                ys_free(ys);
+                goto done;
+            }
+            attached = 1;
+        }
+        if (ret < 0)
+            goto done;
+        if (ret == 0){
+            clixon_debug(CLIXON_DBG_YANG, "Yang spec cache: format");
+            goto fail;
+        }
+    }
+    if (yr.yr_nr != yr.yr_max){
+        clixon_debug(CLIXON_DBG_YANG, "Yang spec cache: format");
+        goto fail;
+    }
+    /* Resolve references */
+    for (i=0; i<yr.yr_nr; i++){
+        ys = yr.yr_vec[i];
+        ycache_resolve_cv(&yr, ys->ys_cv);
+        if (ys->ys_cvec){
+            cg_var *cv = NULL;
+            while ((cv = cvec_each(ys->ys_cvec, cv)) != NULL)
+                ycache_resolve_cv(&yr, cv);
+        }
+    }
+    for (i=0; i<yr.yr_nrefs; i++){
+        ref = &yr.yr_refs[i];
+        yref = yr.yr_vec[ref->yr_id];
+        switch (ref->yr_type){
+        case YCR_ORIG:
+            ref->yr_ys->ys_orig = yref;
+            break;
+        case YCR_WHEN:
+            if (yang_when_map_set(ref->yr_ys, yref) < 0)
+                goto done;
+            break;
+        case YCR_MYMODULE:
+            if (yang_mymodule_set(ref->yr_ys, yref) < 0)
+                goto done;
+            break;
+        }
+    }
+    /* Restore type caches, compiles regexps */
+    for (i=0; i<yr.yr_ntcs; i++){
+        tc = &yr.yr_tcs[i];
+        if (ys_resolve_type_restore(h, tc->yt_ys,
+                                    tc->yt_resolved==-1?NULL:yr.yr_vec[tc->yt_resolved],
+                                    tc->yt_options, tc->yt_cvv, tc->yt_patterns,
+                                    tc->yt_fraction) < 0)
+            goto done;
+    }
+    /* Not saved: computed from the restored spec */
+    if (yang_deps_populate(h, yspec) < 0)
+        goto done;
+    /* Arguments of loaded spec refer to image or arena: freed with the spec */
+    if (yr.yr_mapped){
+        if (yang_spec_arena_add(yspec, yr.yr_buf, yr.yr_len, 1) < 0)
+            goto done;
+        yr.yr_buf = NULL;
+    }
+    else if (yr.yr_arena){
+        if (yang_spec_arena_add(yspec, yr.yr_arena, yr.yr_argslen, 0) < 0)
+            goto done;
+        yr.yr_arena = NULL;
+    }
+    clixon_debug(CLIXON_DBG_YANG, "Yang spec cache loaded: %s nodes:%u shared:%d",
+                 cbuf_get(fb), yr.yr_nr, yr.yr_mapped);
+    retval = 1;
+ done:
+    if (retval < 0 && attached){ /* Remove partially loaded spec */
+        while ((ys = ys_prune(yspec, 0)) != NULL)
+            ys_free(ys);
+    }
+    if (fb)
+        cbuf_free(fb);
+    if (yr.yr_buf){
+        if (!yr.yr_mapped)
+            free(yr.yr_buf);
+        else
+            munmap(yr.yr_buf, yr.yr_len);
+    }
+    if (yr.yr_arena)
+        free(yr.yr_arena);
+    if (yr.yr_vec)
+        free(yr.yr_vec);
+    if (yr.yr_refs)
+        free(yr.yr_refs);
+    if (yr.yr_tcs){
+        for (i=0; i<yr.yr_ntcs; i++){
+            if (yr.yr_tcs[i].yt_cvv)
+                cvec_free(yr.yr_tcs[i].yt_cvv);
+            if (yr.yr_tcs[i].yt_patterns)
+                cvec_free(yr.yr_tcs[i].yt_patterns);
+        }
+        free(yr.yr_tcs);
+    }
+    return retval;
+ fail:
+    if (attached){
+        while ((ys = ys_prune(yspec, 0)) != NULL)
+            ys_free(ys);
+        attached = 0;
+    }
+    retval = 0;
+    goto done;
+}
+
+/*! Enable yang spec cache for this program
+ *
+ * The name separates cache files of programs loading different sets of modules.
+ * The cache is only used if also CLICON_YANG_SPEC_CACHE_DIR is set
+ * @param[in]  h     Clixon handle
+ * @param[in]  name  Program name, eg "backend"
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+yang_spec_cache_init(clixon_handle h,
+                     const char   *name)
+{
+    return clicon_data_set(h, YANG_CACHE_DATANAME, (char*)name);
+}
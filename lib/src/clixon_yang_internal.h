@@ -57,6 +57,8 @@ struct yang_type_cache{
     cvec      *yc_patterns; /* List of regexp, if cvec_len() > 0 */
     cvec      *yc_regexps;  /* List of _compiled_ regexp, if cvec_len() > 0 */
     yang_stmt *yc_resolved; /* Resolved type object, can be NULL - note direct ptr */
+    void      *yc_validator; /* Compiled leaf validator, see ys_cv_validate */
+    void      *yc_enummap;  /* Enum/bits name and value index, see yang_enum_name2val */
 };
 typedef struct yang_type_cache yang_type_cache;
 
@@ -133,4 +135,11 @@ struct yang_stmt {
 #define ys_nopres_cache   u.ysu_nopres_cache
 #endif
 
+/*
+ * Prototypes
+ */
+yang_stmt *yang_when_map_get(yang_stmt *ys);
+int        yang_when_map_set(yang_stmt *ys, yang_stmt *ywhen);
+int        yang_arena_intern(yang_stmt **vec, size_t len, size_t *offs, char **datap, size_t *sizep);
+
 #endif  /* _CLIXON_YANG_INTERNAL_H_ */
@@ -586,6 +586,10 @@ yang_find_module_by_prefix_yspec(yang_stmt *yspec,
     yang_stmt *yprefix;
     int        inext;
 
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (yang_find_module_index(yspec, YANG_MODULE_INDEX_PREFIX, prefix, &ymod) == 1)
+        return ymod;
+#endif
     inext = 0;
     while ((ymod = yn_iter(yspec, &inext)) != NULL)
         if (yang_keyword_get(ymod) == Y_MODULE &&
@@ -617,6 +621,10 @@ yang_find_module_by_namespace(yang_stmt *yspec,
 
     if (ns == NULL)
         goto done;
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (yang_find_module_index(yspec, YANG_MODULE_INDEX_NAMESPACE, ns, &ymod) == 1)
+        goto done;
+#endif
     inext = 0;
     while ((ymod = yn_iter(yspec, &inext)) != NULL) {
         if (yang_find(ymod, Y_NAMESPACE, ns) != NULL)
@@ -724,6 +732,10 @@ yang_find_module_by_name(yang_stmt *yspec,
     yang_stmt *ymod;
     int        inext;
 
+#ifdef OPTIMIZE_YANG_FIND_INDEX
+    if (yang_find_module_index(yspec, YANG_MODULE_INDEX_NAME, name, &ymod) == 1)
+        return ymod;
+#endif
     inext = 0;
     while ((ymod = yn_iter(yspec, &inext)) != NULL)
         if ((yang_keyword_get(ymod) == Y_MODULE || yang_keyword_get(ymod) == Y_SUBMODULE) &&
@@ -64,6 +64,7 @@
 #include <regex.h>
 #include <dirent.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include <syslog.h>
 #include <sys/stat.h>
@@ -101,10 +102,26 @@
 #include "clixon_yang_internal.h"
 #include "clixon_yang_sub_parse.h"
 #include "clixon_yang_parse_lib.h"
+#include "clixon_validate_deps.h"
+#include "clixon_yang_cache.h"
 
 /* Size of json read buffer when reading from file*/
 #define BUFLEN 1024
 
+/* Least number of files in a directory to parse them in parallel, see CLICON_YANG_PARSE_WORKERS */
+#define YANG_PARSE_PARALLEL_MIN 8
+
+/* Null string in parse tree buffer */
+#define YANG_PARSE_NULL 0xffffffff
+
+/*! Reader state of parse tree buffer of a parse worker
+ */
+struct yparse_rd {
+    char  *yr_buf;  /* Buffer */
+    size_t yr_len;  /* Length of buffer */
+    size_t yr_pos;  /* Read position */
+};
+
 /* Forward */
 static int yang_expand_grouping(clixon_handle h, yang_stmt *yn);
 
@@ -1646,6 +1663,18 @@ yang_parse_post(clixon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+    /* 12. Compute must/when/leafref dependency graph for incremental validation
+     *     Done for whole spec since new modules may augment already loaded ones
+     */
+    if (yang_deps_populate(h, yspec) < 0)
+        goto done;
+    /* 13. Save spec for next startup if enabled */
+    if (yang_spec_cache_save(h, yspec) < 0)
+        goto done;
+    /* 14. Intern argument strings of new statements if enabled */
+    if (clicon_option_bool(h, "CLICON_YANG_SPEC_FREEZE") &&
+        yang_spec_freeze(yspec) < 0)
+        goto done;
     retval = 0;
  done:
     if (ylist)
@@ -1681,6 +1710,9 @@ yang_spec_parse_module(clixon_handle h,
         clixon_err(OE_YANG, EINVAL, "yang module not set");
         goto done;
     }
+    /* Load whole spec from cache on first module if enabled */
+    if (yang_spec_cache_load(h, yspec) < 0)
+        goto done;
     /* Apply steps 2.. on new modules, ie ones after modmin. */
     modmin = yang_len_get(yspec);
     /* Do not load module if it already exists */
@@ -1719,6 +1751,9 @@ yang_spec_parse_file(clixon_handle h,
     int         modmin;       /* Existing number of modules */
     char       *base = NULL;;
 
+    /* Load whole spec from cache on first module if enabled */
+    if (yang_spec_cache_load(h, yspec) < 0)
+        goto done;
     /* Apply steps 2.. on new modules, ie ones after modmin. */
     modmin = yang_len_get(yspec);
     /* Find module, and do not load file if module already exists */
@@ -1746,6 +1781,356 @@ yang_spec_parse_file(clixon_handle h,
     return retval;
 }
 
+/*! Write string to parse tree buffer, NULL is written as YANG_PARSE_NULL
+ */
+static int
+yparse_wr_str(cbuf       *cb,
+              const char *str)
+{
+    uint32_t len;
+
+    len = str ? strlen(str) : YANG_PARSE_NULL;
+    if (cbuf_append_buf(cb, &len, sizeof(len)) < 0)
+        return -1;
+    if (str && cbuf_append_buf(cb, (void*)str, len) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Write parsed yang statement and its descendants in pre-order to buffer
+ *
+ * Only what the parser sets is written: keyword, argument, line number and the cv of
+ * statements such as revision or unknown. Native byte order, the buffer is only read
+ * by the parent process.
+ * @param[in]  cb   Buffer
+ * @param[in]  ys   Yang statement
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see yparse_rd_tree
+ */
+static int
+yparse_wr_tree(cbuf      *cb,
+               yang_stmt *ys)
+{
+    int      retval = -1;
+    cg_var  *cv;
+    char    *str = NULL;
+    uint32_t u;
+    int      i;
+
+    u = yang_keyword_get(ys);
+    if (cbuf_append_buf(cb, &u, sizeof(u)) < 0)
+        goto done;
+    u = yang_linenum_get(ys);
+    if (cbuf_append_buf(cb, &u, sizeof(u)) < 0)
+        goto done;
+    if (yparse_wr_str(cb, yang_argument_get(ys)) < 0)
+        goto done;
+    cv = yang_cv_get(ys);
+    u = cv ? cv_type_get(cv) : CGV_ERR;
+    if (cbuf_append_buf(cb, &u, sizeof(u)) < 0)
+        goto done;
+    if (cv){
+        if ((str = cv2str_dup(cv)) == NULL)
+            goto done;
+        if (yparse_wr_str(cb, str) < 0)
+            goto done;
+    }
+    u = ys->ys_len;
+    if (cbuf_append_buf(cb, &u, sizeof(u)) < 0)
+        goto done;
+    for (i=0; i<ys->ys_len; i++)
+        if (yparse_wr_tree(cb, ys->ys_stmt[i]) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    return retval;
+}
+
+/*! Read uint32 from parse tree buffer
+ *
+ * @retval  1  OK
+ * @retval  0  End of buffer
+ */
+static int
+yparse_rd_u32(struct yparse_rd *yr,
+              uint32_t         *u)
+{
+    if (yr->yr_pos + sizeof(*u) > yr->yr_len)
+        return 0;
+    memcpy(u, yr->yr_buf + yr->yr_pos, sizeof(*u));
+    yr->yr_pos += sizeof(*u);
+    return 1;
+}
+
+/*! Read string from parse tree buffer
+ *
+ * @param[in]  yr    Reader state
+ * @param[out] strp  Malloced string or NULL
+ * @retval     1     OK
+ * @retval     0     End of buffer
+ * @retval    -1     Error
+ */
+static int
+yparse_rd_str(struct yparse_rd *yr,
+              char            **strp)
+{
+    uint32_t len;
+
+    *strp = NULL;
+    if (yparse_rd_u32(yr, &len) == 0)
+        return 0;
+    if (len == YANG_PARSE_NULL)
+        return 1;
+    if (yr->yr_pos + len > yr->yr_len)
+        return 0;
+    if ((*strp = malloc(len + 1)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memcpy(*strp, yr->yr_buf + yr->yr_pos, len);
+    (*strp)[len] = '\0';
+    yr->yr_pos += len;
+    return 1;
+}
+
+/*! Read yang statement and its descendants in pre-order from parse tree buffer
+ *
+ * @param[in]  yr    Reader state
+ * @param[out] ysp   Yang statement, not attached to any parent. Free with ys_free
+ * @retval     1     OK
+ * @retval     0     Format error
+ * @retval    -1     Error
+ * @see yparse_wr_tree
+ */
+static int
+yparse_rd_tree(struct yparse_rd *yr,
+               yang_stmt       **ysp)
+{
+    int        retval = -1;
+    yang_stmt *ys = NULL;
+    yang_stmt *yc;
+    cg_var    *cv;
+    char      *str = NULL;
+    char      *reason = NULL;
+    uint32_t   keyword;
+    uint32_t   linenum;
+    uint32_t   cvtype;
+    uint32_t   len;
+    uint32_t   i;
+    int        ret;
+
+    if (yparse_rd_u32(yr, &keyword) == 0 ||
+        yparse_rd_u32(yr, &linenum) == 0)
+        goto fail;
+    if ((ys = ys_new(keyword)) == NULL)
+        goto done;
+    yang_linenum_set(ys, linenum);
+    if ((ret = yparse_rd_str(yr, &str)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    yang_argument_set(ys, str); /* consumed */
+    str = NULL;
+    if (yparse_rd_u32(yr, &cvtype) == 0)
+        goto fail;
+    if (cvtype != CGV_ERR){
+        if ((ret = yparse_rd_str(yr, &str)) < 0)
+            goto done;
+        if (ret == 0 || str == NULL)
+            goto fail;
+        if ((cv = cv_new(cvtype)) == NULL){
+            clixon_err(OE_YANG, errno, "cv_new");
+            goto done;
+        }
+        yang_cv_set(ys, cv);
+        if ((ret = cv_parse1(str, cv, &reason)) < 0){
+            clixon_err(OE_YANG, errno, "parsing cv");
+            goto done;
+        }
+        if (ret == 0)
+            goto fail;
+    }
+    if (yparse_rd_u32(yr, &len) == 0)
+        goto fail;
+    for (i=0; i<len; i++){
+        if ((ret = yparse_rd_tree(yr, &yc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (yn_insert(ys, yc) < 0){
+            ys_free(yc);
+            goto done;
+        }
+    }
+    *ysp = ys;
+    ys = NULL;
+    retval = 1;
+ done:
+    if (ys)
+        ys_free(ys);
+    if (str)
+        free(str);
+    if (reason)
+        free(reason);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Parse yang files in parallel using worker processes
+ *
+ * The files are split into contiguous ranges, one per worker. Each worker lexes and
+ * parses its files and writes the parse trees to a pipe. The parent reads the trees
+ * back in file order.
+ * Processes are used instead of threads since the flex/bison parsers and error state
+ * are global. Statement checks, the yang patch hook and the post steps, including
+ * ys_populate, are made by the caller, since they resolve across modules.
+ * If a file does not parse, the caller parses serially to report the error as usual.
+ * @param[in]  h        Clixon handle
+ * @param[in]  files    Vector of filenames
+ * @param[in]  nfiles   Number of files
+ * @param[in]  workers  Number of worker processes
+ * @param[out] ymods    Parsed (sub)modules, one per file, not in any yang spec
+ * @retval     1        OK, all files parsed
+ * @retval     0        A worker failed, caller should parse serially
+ * @retval    -1        Error
+ * @see validate_parallel  Similar for validation
+ */
+static int
+yang_parse_parallel(clixon_handle h,
+                    char        **files,
+                    int           nfiles,
+                    int           workers,
+                    yang_stmt   **ymods)
+{
+    int              retval = -1;
+    pid_t           *pids = NULL;
+    int             *fds = NULL;
+    int              fd[2];
+    int              w;
+    int              i;
+    cbuf            *cb = NULL;
+    yang_stmt       *yspec;
+    yang_stmt       *ymod;
+    FILE            *fp;
+    struct yparse_rd yr;
+    char             buf[4096];
+    ssize_t          len;
+    ssize_t          n;
+    int              serial = 0;  /* Failed workers */
+    int              ret;
+
+    if (workers > nfiles)
+        workers = nfiles;
+    clixon_debug(CLIXON_DBG_YANG, "files:%d workers:%d", nfiles, workers);
+    if ((pids = calloc(workers, sizeof(pid_t))) == NULL ||
+        (fds = calloc(workers, sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (w=0; w<workers; w++)
+        fds[w] = -1;
+    for (w=0; w<workers; w++){
+        if (pipe(fd) < 0){
+            clixon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[w] = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            close(fd[0]);
+            close(fd[1]);
+            goto done;
+        }
+        if (pids[w] == 0){ /* Worker */
+            close(fd[0]);
+            if ((yspec = ys_new(Y_SPEC)) == NULL)
+                _exit(1);
+            for (i = (nfiles*w)/workers; i < (nfiles*(w+1))/workers; i++){
+                if ((fp = fopen(files[i], "r")) == NULL)
+                    _exit(1);
+                if ((ymod = yang_parse_file(fp, files[i], yspec)) == NULL)
+                    _exit(1);
+                fclose(fp);
+                if (yparse_wr_tree(cb, ymod) < 0)
+                    _exit(1);
+            }
+            for (i = 0; i < cbuf_len(cb); i += n)
+                if ((n = write(fd[1], cbuf_get(cb) + i, cbuf_len(cb) - i)) < 0)
+                    _exit(1);
+            _exit(0);
+        }
+        close(fd[1]);
+        fds[w] = fd[0];
+    }
+    /* Workers are read in order, a worker blocked in write waits only for the caller */
+    for (w=0; w<workers; w++){
+        cbuf_reset(cb);
+        while ((len = read(fds[w], buf, sizeof(buf))) != 0){
+            if (len < 0){
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (cbuf_append_buf(cb, buf, len) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        }
+        if (len < 0){
+            serial++;
+            continue;
+        }
+        yr.yr_buf = cbuf_get(cb);
+        yr.yr_len = cbuf_len(cb);
+        yr.yr_pos = 0;
+        for (i = (nfiles*w)/workers; i < (nfiles*(w+1))/workers; i++){
+            if ((ret = yparse_rd_tree(&yr, &ymods[i])) < 0)
+                goto done;
+            if (ret == 0){
+                serial++;
+                break;
+            }
+        }
+    }
+    if (serial){
+        clixon_debug(CLIXON_DBG_YANG, "%d parse workers failed, parsing serially", serial);
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (fds){
+        for (w=0; w<workers; w++)
+            if (fds[w] != -1)
+                close(fds[w]);
+        free(fds);
+    }
+    if (pids){
+        for (w=0; w<workers; w++)
+            if (pids[w] > 0)
+                waitpid(pids[w], NULL, 0);
+        free(pids);
+    }
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    for (i=0; i<nfiles; i++)
+        if (ymods[i]){
+            ys_free(ymods[i]);
+            ymods[i] = NULL;
+        }
+    retval = 0;
+    goto done;
+}
+
 /*! Load all yang modules in directory
  *
  * @param[in]  h     Clicon handle
@@ -1759,8 +2144,8 @@ yang_spec_parse_file(clixon_handle h,
  * 1) If x is already loaded (eg via direct file loading) skip it
  * 2) Prefer x.yang over x@rev.yang (no revision)
  * 3) If only x@rev.yang's found, prefer newest (newest revision)
- * There is also an extra failsafe which may not be necessary, which removes
- * the oldest module if 1-3 for some reason fails.
+ * If CLICON_YANG_PARSE_WORKERS is larger than one, the files are parsed in parallel
+ * @see yang_parse_parallel
  */
 int
 yang_spec_load_dir(clixon_handle h,
@@ -1771,18 +2156,22 @@ yang_spec_load_dir(clixon_handle h,
     int            ndp;
     struct dirent *dp = NULL;
     int            i;
-    int            j;
     char           filename[MAXPATHLEN];
     char          *base = NULL; /* filename without dir */
     int            modmin;
     yang_stmt     *ym;   /* yang module */
-    yang_stmt     *ym0;  /* (existing) yang module */
     yang_stmt     *yrev; /* yang revision */
     uint32_t       revf = 0; /* revision in filename */
     uint32_t       revm = 0; /* revision in parsed new module (should be same as revf) */
-    uint32_t       rev0; /* revision in existing module */
     char          *oldbase = NULL;
     int            taken = 0;
+    char         **files = NULL; /* Files to load */
+    char         **bases = NULL; /* Module names of files */
+    uint32_t      *revs = NULL;  /* Revisions in filenames */
+    yang_stmt    **ymods = NULL; /* Parsed modules if parsed in parallel */
+    int            nfiles = 0;
+    int            workers;
+    int            ret;
 
     /* Get yang files names from yang module directory. Note that these
      * are sorted alphatetically:
@@ -1794,9 +2183,18 @@ yang_spec_load_dir(clixon_handle h,
         goto done;
     if (ndp == 0)
         goto ok;
+    /* Load whole spec from cache on first module if enabled */
+    if (yang_spec_cache_load(h, yspec) < 0)
+        goto done;
     /* Apply post steps on new modules, ie ones after modmin. */
     modmin = yang_len_get(yspec);
-    /* Load all yang files in dir */
+    if ((files = calloc(ndp, sizeof(char*))) == NULL ||
+        (bases = calloc(ndp, sizeof(char*))) == NULL ||
+        (revs = calloc(ndp, sizeof(uint32_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Select one yang file per module in dir */
     for (i = 0; i < ndp; i++) {
         /* base = module name [+ @rev ] + .yang */
        if (oldbase)
@@ -1829,38 +2227,65 @@ yang_spec_load_dir(clixon_handle h,
             taken = 1; /* last in line and not taken */
         }
         /* Here only a single file is reached(taken)
-         * Check if module already exists -> ym0/rev0 */
-        rev0 = 0;
-        if ((ym0 = yang_find(yspec, Y_MODULE, base)) != NULL ||
-            (ym0 = yang_find(yspec, Y_SUBMODULE, base)) != NULL){
-            yrev = yang_find(ym0, Y_REVISION, NULL);
-            rev0 = cv_uint32_get(yang_cv_get(yrev));
-            continue; /* skip if already added by specific file or module */
-        }
+         * Skip if module already added by specific file or module */
+        if (yang_find(yspec, Y_MODULE, base) != NULL ||
+            yang_find(yspec, Y_SUBMODULE, base) != NULL)
+            continue;
         /* Create full filename */
         snprintf(filename, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
-        if ((ym = yang_parse_filename(h, filename, yspec)) == NULL)
+        if ((files[nfiles] = strdup(filename)) == NULL ||
+            (bases[nfiles] = strdup(base)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        revs[nfiles++] = revf;
+    }
+    /* Parse files in parallel, or serially below */
+    workers = clicon_option_int(h, "CLICON_YANG_PARSE_WORKERS");
+    if (workers > 1 && nfiles >= YANG_PARSE_PARALLEL_MIN){
+        if ((ymods = calloc(nfiles, sizeof(yang_stmt*))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((ret = yang_parse_parallel(h, files, nfiles, workers, ymods)) < 0)
+            goto done;
+        if (ret == 0){
+            free(ymods);
+            ymods = NULL;
+        }
+    }
+    /* Load all yang files in order */
+    for (i = 0; i < nfiles; i++) {
+        /* Skip if module is contained in a file loaded before */
+        if (yang_find(yspec, Y_MODULE, bases[i]) != NULL ||
+            yang_find(yspec, Y_SUBMODULE, bases[i]) != NULL)
+            continue;
+        if (ymods){
+            ym = ymods[i];
+            ymods[i] = NULL;
+            if (yn_insert(yspec, ym) < 0){
+                ys_free(ym);
+                goto done;
+            }
+            if (yang_filename_set(ym, files[i]) < 0)
+                goto done;
+#ifdef OPTIMIZE_YSPEC_NAMESPACE
+            yspec_nscache_clear(yspec);
+#endif
+            /* YANG patch hook, see yang_parse_filename */
+            if (clixon_plugin_yang_patch_all(h, ym) < 0)
+                goto done;
+        }
+        else if ((ym = yang_parse_filename(h, files[i], yspec)) == NULL)
             goto done;
         revm = 0;
         if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL)
             revm = cv_uint32_get(yang_cv_get(yrev));
         /* Sanity check that file revision does not match internal rev stmt */
-        if (revf && revm && revm != revf){ /* XXX */
-            clixon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", filename, revf, revm);
+        if (revs[i] && revm && revm != revs[i]){ /* XXX */
+            clixon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", files[i], revs[i], revm);
             goto done;
         }
-        /* If ym0 and ym exists, delete the yang with oldest revision 
-         * This is a failsafe in case anything else fails
-         */
-        if (revm && rev0){
-            if (revm > rev0) /* Loaded module is older or eq -> remove ym */
-                ym = ym0;
-            for (j=0; j<yang_len_get(yspec); j++)
-                if (yspec->ys_stmt[j] == ym)
-                    break;
-            ys_prune(yspec, j);
-            ys_free(ym);
-        }
     }
     if (yang_parse_post(h, yspec, modmin) < 0)
         goto done;
@@ -1873,6 +2298,26 @@ yang_spec_load_dir(clixon_handle h,
         free(base);
     if (oldbase)
         free(oldbase);
+    if (ymods){
+        for (i = 0; i < nfiles; i++)
+            if (ymods[i])
+                ys_free(ymods[i]);
+        free(ymods);
+    }
+    if (files){
+        for (i = 0; i < ndp; i++)
+            if (files[i])
+                free(files[i]);
+        free(files);
+    }
+    if (bases){
+        for (i = 0; i < ndp; i++)
+            if (bases[i])
+                free(bases[i]);
+        free(bases);
+    }
+    if (revs)
+        free(revs);
     return retval;
 }
 
@@ -77,6 +77,12 @@
  * - yang_mount_xtop2xmnt(): top-level xml -> xmnt vector
  * - yang_mount_yspec2ymnt(): top-level yspec -> ymnt vector NOTUSED
  * - yang_schema_mount_statistics(): Given xtop -> find all xmnt -> stats
+ * - yang_schema_mount_refs(): yspec -> number of mount-points using it
+ * - yang_schema_mount_gc(): free yspecs not used by any mount-point
+ *
+ * Mounted yspecs are shared between mount-points with equal yang-library content, found by a
+ * canonical digest of the yang-library, see yang_schema_yanglib_mount_parse().
+ * A yspec is parsed when its first mount-point is bound.
 
  *
  * Note: the xpath used as key in yang unknown cvec is "canonical" in the sense:
@@ -122,6 +128,7 @@
 #include "clixon_plugin.h"
 #include "clixon_xml_bind.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_datastore.h"
 #include "clixon_yang_schema_mount.h"
 
 /*! Check if YANG node is a RFC 8528 YANG schema mount
@@ -705,70 +712,118 @@ yang_schema_mount_statedata(clixon_handle h,
     goto done;
 }
 
-/*! Given xml mount-point and yanglib, find existing yspec
+static int
+yang_schema_strcmp(const void *a,
+                   const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*! Compute canonical digest of yang-library content
  *
- * Get and loop through all XML from xt mount-points.
- * Get xyanglib and if equal to xt, find and return yspec
- * @param[in]   h        Clixon handle
- * @param[in]   xt       XML tree node
- * @param[in]   xyanglib yanglib in XML
- * @param[out]  yspecp   Yang spec
- * @retval      0        OK
- * @retval     -1        Error
+ * Only the fields that determine the parsed yspec are included: module name, revision and
+ * namespace. Modules are sorted, so that order and other content do not matter.
+ * @param[in]  xyanglib XML yang-lib on the form <any><module-set><module>*
+ * @param[out] cb       Digest as hex string
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see yang_schema_find_digest
  */
 static int
-yang_schema_find_share(clixon_handle h,
-                       cxobj        *xt,
-                       cxobj        *xyanglib,
-                       yang_stmt   **yspecp)
+yang_schema_yanglib_digest(cxobj *xyanglib,
+                           cbuf  *cb)
 {
-    int     retval = -1;
-    cvec   *cvv = NULL;
-    cg_var *cv;
-    cxobj  *xroot;
-    cxobj  *xmnt;
-    cxobj  *xylib = NULL;
-    int     config = 1;
-    int     ret;
+    int       retval = -1;
+    cxobj   **vec = NULL;
+    size_t    veclen;
+    char    **keys = NULL;
+    size_t    nkeys = 0;
+    cbuf     *cbk = NULL;
+    char     *name;
+    char     *str;
+    uint64_t  d = 14695981039346656037ULL; /* FNV-1a */
+    size_t    i;
 
-    xroot = xml_root(xt);
-    /* Get all XML mtpoints */
-    if (yang_mount_xtop2xmnt(xroot, &cvv) < 0)
+    if (xpath_vec(xyanglib, NULL, "module-set/module", &vec, &veclen) < 0)
         goto done;
-    /* Loop through XML mount-points */
-    cv = NULL;
-    while ((cv = cvec_each(cvv, cv)) != NULL) {
-        xmnt = cv_void_get(cv);
-        if (xmnt == xt)
-            continue;
-        if (xylib){
-            xml_free(xylib);
-            xylib = NULL;
-        }
-        /* Get xyanglib */
-        if (clixon_plugin_yang_mount_all(h, xmnt, &config, NULL, &xylib) < 0)
-            goto done;
-        if (xylib == NULL)
-            continue;
-        /* Check if equal */
-        if (xml_tree_equal(xyanglib, xylib) == 1)
+    if ((cbk = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (veclen && (keys = calloc(veclen, sizeof(char *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<veclen; i++){
+        if ((name = xml_find_body(vec[i], "name")) == NULL)
             continue;
-        /* Find and return yspec */
-        *yspecp = NULL;
-        if ((ret = xml_yang_mount_get(h, xmnt, NULL, NULL, yspecp)) < 0)
+        cbuf_reset(cbk);
+        cprintf(cbk, "%s@", name);
+        if ((str = xml_find_body(vec[i], "revision")) != NULL)
+            cprintf(cbk, "%s", str);
+        if ((str = xml_find_body(vec[i], "namespace")) != NULL)
+            cprintf(cbk, " %s", str);
+        if ((keys[nkeys++] = strdup(cbuf_get(cbk))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
             goto done;
-        if (ret == 1 && *yspecp != NULL)
-            break;
+        }
     }
+    if (nkeys)
+        qsort(keys, nkeys, sizeof(char *), yang_schema_strcmp);
+    for (i=0; i<nkeys; i++){
+        for (str = keys[i]; ; str++){ /* Including null as separator */
+            d ^= (unsigned char)*str;
+            d *= 1099511628211ULL;
+            if (*str == '\0')
+                break;
+        }
+    }
+    cprintf(cb, "%016" PRIx64, d);
     retval = 0;
  done:
-    if (xylib)
-        xml_free(xylib);
-    if (cvv)
-        cvec_free(cvv);
+    if (keys){
+        for (i=0; i<nkeys; i++)
+            if (keys[i])
+                free(keys[i]);
+        free(keys);
+    }
+    if (cbk)
+        cbuf_free(cbk);
+    if (vec)
+        free(vec);
     return retval;
 }
 
+/*! Given yang-library digest, find existing yspec in domain
+ *
+ * Mounted yspecs are content-addressed by the digest of their yang-library, stored as the
+ * cv of the yspec. Mount-points with equal yang-library content share the same yspec.
+ * @param[in]   ydomain  YANG domain
+ * @param[in]   digest   Canonical yang-library digest
+ * @retval      yspec    Shared yang spec
+ * @retval      NULL     Not found
+ * @see yang_schema_yanglib_digest
+ */
+static yang_stmt *
+yang_schema_find_digest(yang_stmt *ydomain,
+                        char      *digest)
+{
+    yang_stmt *yspec;
+    cg_var    *cv;
+    int        inext;
+
+    inext = 0;
+    while ((yspec = yn_iter(ydomain, &inext)) != NULL) {
+        if (yang_keyword_get(yspec) != Y_SPEC ||
+            yang_flag_get(yspec, YANG_FLAG_SPEC_MOUNT) == 0 ||
+            (cv = yang_cv_get(yspec)) == NULL)
+            continue;
+        if (strcmp(cv_string_get(cv), digest) == 0)
+            return yspec;
+    }
+    return NULL;
+}
+
 /*! Given yanglib, mount it, potentially create a new yspec, and parse all its yangs
  *
  * Optionally check for shared yspec
@@ -795,6 +850,8 @@ yang_schema_yanglib_mount_parse(clixon_handle h,
     yang_stmt *yspec1 = NULL;
     char      *xpath = NULL;
     cbuf      *cb = NULL;
+    cbuf      *cbd = NULL;
+    cg_var    *cv;
     int        ret;
     static unsigned int nr = 0;
 
@@ -819,9 +876,14 @@ yang_schema_yanglib_mount_parse(clixon_handle h,
         if ((ydomain = ydomain_new(h, domain)) == NULL)
             goto done;
     }
-    /* Optimization: find equal yspec from other mount-point */
-    if (yang_schema_find_share(h, xt, xyanglib, &yspec0) < 0)
+    /* Optimization: find yspec with equal yang-library content from other mount-point */
+    if ((cbd = cbuf_new()) == NULL){
+        clixon_err(OE_YANG, errno, "cbuf_new");
         goto done;
+    }
+    if (yang_schema_yanglib_digest(xyanglib, cbd) < 0)
+        goto done;
+    yspec0 = yang_schema_find_digest(ydomain, cbuf_get(cbd));
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_YANG, errno, "cbuf_new");
         goto done;
@@ -837,6 +899,20 @@ yang_schema_yanglib_mount_parse(clixon_handle h,
             ys_prune_self(yspec1); /* remove from tree, free in done code */
             goto anydata;
         }
+        /* Register digest only when parsed ok */
+        if ((cv = cv_new(CGV_STRING)) == NULL){
+            clixon_err(OE_YANG, errno, "cv_new");
+            goto done;
+        }
+        if (cv_name_set(cv, "digest") == NULL ||
+            cv_string_set(cv, cbuf_get(cbd)) == NULL){
+            clixon_err(OE_YANG, errno, "cv_string_set");
+            cv_free(cv);
+            goto done;
+        }
+        yang_cv_set(yspec1, cv);
+        clixon_debug(CLIXON_DBG_YANG, "new mount yspec %s/%s digest:%s",
+                     domain, cbuf_get(cb), cbuf_get(cbd));
     }
     if (xml_yang_mount_set(h, xt, yspec1) < 0)
         goto done;
@@ -849,6 +925,8 @@ yang_schema_yanglib_mount_parse(clixon_handle h,
         ys_free(yspec1);
     if (cb)
         cbuf_free(cb);
+    if (cbd)
+        cbuf_free(cbd);
     if (xpath)
         free(xpath);
     return retval;
@@ -957,24 +1035,140 @@ yang_schema_yspec_rm(clixon_handle h,
     if ((ret = xml_yang_mount_get(h, xmnt, NULL, &xpath, &yspec)) < 0)
         goto done;
     if (ret == 1 && xpath != NULL && yspec != NULL){
+        /* The yspec is not freed here even if unused since it may still be in use by caches,
+         * see https://github.com/clicon/clixon-controller/issues/169
+         * Unused yspecs are instead freed by yang_schema_mount_gc()
+         */
         if (yang_cvec_rm(yspec, xpath) < 0)
             goto done;
-#if 0
-        cvec      *cvv;
-        /* see https://github.com/clicon/clixon-controller/issues/169
-         * cannot remove yspec since it may still be in use by caches
-         */
-        cvv = yang_cvec_get(yspec);
-        if (cvv && cvec_len(cvv) == 0){
+    }
+    retval = 0;
+ done:
+    if (xpath)
+        free(xpath);
+    return retval;
+}
+
+/*! Get number of mount-points referring to a mounted yspec
+ *
+ * Each mount-point using a yspec is registered by its xpath in the yspec cvec
+ * @param[in]  yspec  Mounted yang spec
+ * @retval     refs   Number of mount-points
+ */
+int
+yang_schema_mount_refs(yang_stmt *yspec)
+{
+    cvec *cvv;
+
+    if ((cvv = yang_cvec_get(yspec)) == NULL)
+        return 0;
+    return cvec_len(cvv);
+}
+
+/*! Mark mounted yspecs in use by an XML tree - callback function for xml_apply
+ *
+ * @param[in]  x    XML node
+ * @param[in]  arg  Not used
+ * @retval     2    Locally abort this subtree, continue with others
+ * @retval     0    OK, continue
+ */
+static int
+mark_xml_schema_mounts(cxobj *x,
+                       void  *arg)
+{
+    yang_stmt *y;
+    yang_stmt *yspec;
+    cxobj     *xc;
+
+    if ((y = xml_spec(x)) == NULL)
+        return 2;
+    if (yang_schema_mount_point(y) == 0)
+        return 0;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+        if ((y = xml_spec(xc)) != NULL &&
+            (yspec = ys_spec(y)) != NULL &&
+            yang_flag_get(yspec, YANG_FLAG_SPEC_MOUNT))
+            yang_flag_set(yspec, YANG_FLAG_MARK);
+    }
+    return 0;
+}
+
+/*! Free mounted yspecs that are not used by any mount-point
+ *
+ * A mounted yspec is unused if no mount-point refers to it, see yang_schema_yspec_rm, and if
+ * no datastore cache is bound to it.
+ * Call when no other XML trees, such as transaction trees, may be bound to removed mount-points
+ * @param[in]  h       Clixon handle
+ * @param[out] nfreed  Number of freed yspecs (if given)
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+yang_schema_mount_gc(clixon_handle h,
+                     int          *nfreed)
+{
+    int        retval = -1;
+    yang_stmt *ymounts;
+    yang_stmt *ydomain;
+    yang_stmt *yspec;
+    cxobj     *xt;
+    char     **keys = NULL;
+    size_t     klen = 0;
+    size_t     i;
+    int        inext;
+    int        inext2;
+    int        unused = 0;
+    int        n = 0;
+
+    if ((ymounts = clixon_yang_mounts_get(h)) == NULL)
+        goto ok;
+    inext = 0;
+    while ((ydomain = yn_iter(ymounts, &inext)) != NULL) {
+        inext2 = 0;
+        while ((yspec = yn_iter(ydomain, &inext2)) != NULL) {
+            if (yang_flag_get(yspec, YANG_FLAG_SPEC_MOUNT) &&
+                yang_schema_mount_refs(yspec) == 0)
+                unused++;
+        }
+    }
+    if (unused == 0)
+        goto ok;
+    /* Mark yspecs still bound to mount-points in datastore caches */
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<klen; i++){
+        if ((xt = xmldb_cache_get(h, keys[i])) == NULL)
+            continue;
+        if (xml_apply(xt, CX_ELMNT, mark_xml_schema_mounts, NULL) < 0)
+            goto done;
+    }
+    inext = 0;
+    while ((ydomain = yn_iter(ymounts, &inext)) != NULL) {
+        inext2 = 0;
+        while ((yspec = yn_iter(ydomain, &inext2)) != NULL) {
+            if (yang_flag_get(yspec, YANG_FLAG_SPEC_MOUNT) == 0)
+                continue;
+            if (yang_flag_get(yspec, YANG_FLAG_MARK)){
+                yang_flag_reset(yspec, YANG_FLAG_MARK);
+                continue;
+            }
+            if (yang_schema_mount_refs(yspec) != 0)
+                continue;
+            clixon_debug(CLIXON_DBG_YANG, "free unused mount yspec %s/%s",
+                         yang_argument_get(ydomain), yang_argument_get(yspec));
             ys_prune_self(yspec);
             ys_free(yspec);
-            yspec = NULL;
+            inext2--; /* Removed from iteration */
+            n++;
         }
-#endif
     }
+ ok:
+    if (nfreed)
+        *nfreed = n;
     retval = 0;
  done:
-    if (xpath)
-        free(xpath);
+    if (keys)
+        free(keys);
     return retval;
 }
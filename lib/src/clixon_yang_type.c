@@ -59,6 +59,8 @@
  * 3) We know I think when cache is set and when it is not set in the calls
  *    to yang_type_resolve. maybe we should make code easier by a separate
  *    yang_type_resolve_cache() call?
+ * 4) ys_cv_validate compiles the type of a leaf into a yang_type_validator on
+ *    first use and stores it in the type cache, see ys_type_validator
  */
 
 #ifdef HAVE_CONFIG_H
@@ -106,6 +108,103 @@
  * Local types and variables
  */
 
+/*! Kind of compiled validator, see struct yang_type_validator
+ */
+enum yv_kind{
+    YV_BUILTIN,   /* Built-in type: range, length, enum, bits and patterns */
+    YV_UNION,     /* Union: validate members */
+    YV_LEAFREF,   /* Leafref: validate using referred node */
+};
+
+/*! Cheap lexical check of a value before it is parsed as a union member
+ *
+ * Conservative: a value rejected by the check is also rejected by cv_parse1
+ */
+enum yv_lex{
+    YV_LEX_ANY,   /* No check */
+    YV_LEX_INT,   /* Integer: sign or digit first */
+    YV_LEX_DEC64, /* Decimal64: sign, digit or decimal point first */
+};
+
+/*! How a value is compared with range or length restrictions
+ */
+enum yv_bound{
+    YV_BOUND_NONE,
+    YV_BOUND_INT,     /* Signed integers and decimal64 */
+    YV_BOUND_UINT,    /* Unsigned integers */
+    YV_BOUND_LENGTH,  /* String length */
+};
+
+/*! One interval of a merged range or length restriction
+ */
+struct yv_range{
+    int64_t  yr_imin;
+    int64_t  yr_imax;
+    uint64_t yr_umin;
+    uint64_t yr_umax;
+};
+
+/*! Number of entries in the value memo of a union, see yv_union_memo */
+#define YV_UNION_MEMO_SIZE   32
+
+/*! Longest value stored in the value memo of a union */
+#define YV_UNION_MEMO_STRLEN 128
+
+/*! One memoized union value and its matching member
+ */
+struct yv_union_memo{
+    uint32_t  um_hash;    /* Hash of um_str */
+    int       um_member;  /* Index of a matching member */
+    int       um_first;   /* um_member is first matching member in declaration order */
+    char     *um_str;     /* Malloced copy of value, NULL if unused */
+};
+
+/*! Compiled validator of a leaf type or union member type
+ *
+ * Flattened result of yang_type_get/yang_type_resolve so that ys_cv_validate does not
+ * resolve the type chain and parse range cvecs on every call.
+ * Stored in the type cache of the Y_TYPE statement it is compiled from.
+ */
+typedef struct yang_type_validator{
+    enum yv_kind     yv_kind;
+    yang_stmt       *yv_ytype;    /* Type statement compiled from */
+    yang_stmt       *yv_restype;  /* Resolved type statement */
+    enum cv_type     yv_cvtype;   /* Resolved cligen type */
+    uint8_t          yv_fraction; /* Fraction digits for decimal64 */
+    uint8_t          yv_enum;     /* Resolved type is enumeration */
+    uint8_t          yv_bits;     /* Resolved type is bits */
+    enum yv_bound    yv_bound;    /* How values are compared with yv_ranges */
+    int              yv_rlen;     /* Number of intervals, 0 means no restriction */
+    struct yv_range *yv_ranges;   /* Sorted and merged intervals */
+    cvec            *yv_cvv;      /* Original range/length cvec, for error messages */
+    cvec            *yv_regexps;  /* Compiled patterns, or NULL */
+    regex_memo     **yv_memos;    /* Match memo per compiled pattern */
+    int              yv_mlen;     /* Number of union members */
+    struct yang_type_validator **yv_members; /* Union members in declaration order */
+    uint32_t        *yv_hits;     /* Successful validations per member */
+    int             *yv_order;    /* Member indexes, most successful first */
+    enum yv_lex      yv_lex;      /* Lexical check as union member */
+    int              yv_pure;     /* Result depends on value only, ie no leafref */
+    struct yv_union_memo *yv_umemo; /* Direct-mapped memo of matched values, if pure union */
+} yang_type_validator;
+
+/*! Name and value index of the enums or bits of an enumeration or bits type
+ *
+ * Enum values and bit positions are computed once, including implicit ones.
+ * Stored in the type cache of the resolved enumeration or bits type statement.
+ * @see yang_enum_map_get
+ */
+typedef struct yang_enum_map{
+    int          ye_nchild;  /* Number of children of type when built, to detect changes */
+    int          ye_len;     /* Number of enum or bit statements */
+    uint32_t     ye_mask;    /* Hash table size - 1, size is a power of two */
+    yang_stmt  **ye_stmt;    /* Enum or bit statements in declaration order */
+    int64_t     *ye_val;     /* Value of enum or position of bit */
+    int         *ye_name;    /* Hash: name -> index, or -1 */
+    int         *ye_value;   /* Hash: value -> index of first with value, or -1 */
+} yang_enum_map;
+
+
 /* Mapping between yang types <--> cligen types
    Note, first match used wne translating from cv to yang --> order is significant */
 static const map_str2int ytmap[] = {
@@ -303,6 +402,51 @@ ys_resolve_type(yang_stmt *ytype,
     return retval;
 }
 
+/*! Restore type cache of a type statement from an earlier resolve, see ys_resolve_type
+ *
+ * Used when a yang spec is loaded from cache. The patterns are compiled here since the
+ * compiled regexps depend on the regexp engine.
+ * @param[in]  h         Clixon handle
+ * @param[in]  ytype     Yang type statement
+ * @param[in]  resolved  Resolved type object
+ * @param[in]  options   Pattern/range/length options, see YANG_OPTIONS_*
+ * @param[in]  cvv       Range or length restrictions, or NULL
+ * @param[in]  patterns  Pattern strings, or NULL
+ * @param[in]  fraction  Fraction digits for decimal64
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see yang_spec_cache_load
+ */
+int
+ys_resolve_type_restore(clixon_handle h,
+                        yang_stmt    *ytype,
+                        yang_stmt    *resolved,
+                        int           options,
+                        cvec         *cvv,
+                        cvec         *patterns,
+                        uint8_t       fraction)
+{
+    int   retval = -1;
+    cvec *regexps = NULL;
+
+    if (patterns != NULL && cvec_len(patterns) > 0) {
+        if ((regexps = cvec_new(0)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if (compile_pattern2regexp(h, ytype, patterns, regexps) < 1)
+            goto done;
+    }
+    if (yang_type_cache_set2(ytype, resolved, options, cvv,
+                             patterns, fraction, clicon_yang_regexp(h), regexps) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (regexps)
+        cvec_free(regexps);
+    return retval;
+}
+
 /*! Translate from a yang type to a cligen variable type
  *
  * Currently many built-in types from RFC6020 and some RFC6991 types.
@@ -418,6 +562,7 @@ clicon_type2cv(char         *origtype,
  *
  * @param[in]  h       Clixon handle
  * @param[in]  regexps Vector of compiled regexps
+ * @param[in]  memos   Vector of match memos, one per regexp, or NULL
  * @param[out] reason  If given, and return value is 0, contains malloced string
  * @retval     1       Validation OK
  * @retval     0       Validation not OK, malloced reason is returned. Free reason with free()
@@ -426,6 +571,7 @@ clicon_type2cv(char         *origtype,
 static int
 cv_validate_pattern(clixon_handle h,
                     cvec         *regexps,
+                    regex_memo  **memos,
                     yang_stmt    *yrestype,
                     char         *str,
                     char        **reason)
@@ -434,12 +580,14 @@ cv_validate_pattern(clixon_handle h,
     cg_var *cvr;
     void   *re = NULL;
     int     ret;
+    int     i = 0;
 
     cvr = NULL; /* Loop over compiled regexps */
     while ((cvr = cvec_each(regexps, cvr)) != NULL){
         re = cv_void_get(cvr);
-        if ((ret = regex_exec(h, re, str?str:"")) < 0)
+        if ((ret = regex_exec_memo(h, re, memos?memos[i]:NULL, str?str:"")) < 0)
             goto done;
+        i++;
         if (cv_flag(cvr, V_INVERT))
             ret = !ret; /* swap 0 and 1 */
         if (ret == 0){
@@ -565,13 +713,594 @@ outoflength(uint64_t    u64,
     return retval;
 }
 
-/*! Validate CLIgen variable
+/*! Free enum/bits index
+ *
+ * @param[in]  arg  Enum/bits index
+ * @retval     0    OK
+ * @see yang_type_cache_enummap_set
+ */
+int
+yang_enum_map_free(void *arg)
+{
+    yang_enum_map *ye = (yang_enum_map *)arg;
+
+    if (ye == NULL)
+        return 0;
+    if (ye->ye_stmt)
+        free(ye->ye_stmt);
+    if (ye->ye_val)
+        free(ye->ye_val);
+    if (ye->ye_name)
+        free(ye->ye_name);
+    if (ye->ye_value)
+        free(ye->ye_value);
+    free(ye);
+    return 0;
+}
+
+/*! FNV-1a string hash
+ */
+static uint32_t
+yang_enum_hash_name(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (unsigned char)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Multiplicative hash of enum value or bit position
+ */
+static uint32_t
+yang_enum_hash_val(int64_t val)
+{
+    return (uint32_t)(((uint64_t)val * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*! Build name and value index of an enumeration or bits type
+ *
+ * Bit positions are assigned as in yang_bits_pos: explicit position, otherwise previous
+ * position + 1 starting with 0
+ * @param[in]  ytype  Resolved enumeration or bits type statement
+ * @retval     ye     Enum/bits index, free with yang_enum_map_free
+ * @retval     NULL   Error
+ */
+static yang_enum_map *
+yang_enum_map_new(yang_stmt *ytype)
+{
+    yang_enum_map *ye = NULL;
+    yang_stmt     *yc;
+    yang_stmt     *ypos;
+    cg_var        *cv;
+    uint32_t       pos = 0;
+    uint32_t       h;
+    char          *reason = NULL;
+    int            inext;
+    int            n;
+    int            i;
+    int            ret;
+
+    if ((ye = malloc(sizeof(*ye))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto err;
+    }
+    memset(ye, 0, sizeof(*ye));
+    ye->ye_nchild = yang_len_get(ytype);
+    n = ye->ye_nchild ? ye->ye_nchild : 1;
+    for (ye->ye_mask = 1; ye->ye_mask < 2*n; ye->ye_mask <<= 1)
+        ;
+    ye->ye_mask--;
+    if ((ye->ye_stmt = malloc(n*sizeof(*ye->ye_stmt))) == NULL ||
+        (ye->ye_val = malloc(n*sizeof(*ye->ye_val))) == NULL ||
+        (ye->ye_name = malloc((ye->ye_mask+1)*sizeof(int))) == NULL ||
+        (ye->ye_value = malloc((ye->ye_mask+1)*sizeof(int))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto err;
+    }
+    memset(ye->ye_name, 0xff, (ye->ye_mask+1)*sizeof(int));  /* -1: empty slot */
+    memset(ye->ye_value, 0xff, (ye->ye_mask+1)*sizeof(int));
+    inext = 0;
+    while ((yc = yn_iter(ytype, &inext)) != NULL){
+        switch (yang_keyword_get(yc)){
+        case Y_ENUM:
+            /* Explicit and implicit values are assigned in ys_populate_type_enum */
+            if ((cv = yang_cv_get(yc)) == NULL){
+                clixon_err(OE_YANG, 0, "Enum %s lacks value", yang_argument_get(yc));
+                goto err;
+            }
+            ye->ye_val[ye->ye_len] = cv_int32_get(cv);
+            break;
+        case Y_BIT:
+            if ((ypos = yang_find(yc, Y_POSITION, NULL)) != NULL){
+                if ((ret = parse_uint32(yang_argument_get(ypos), &pos, &reason)) < 0){
+                    clixon_err(OE_UNIX, EINVAL, "cannot parse bit position val: %s", reason);
+                    goto err;
+                }
+                if (ret == 0){
+                    clixon_err(OE_YANG, EINVAL, "Invalid bit position of %s: %s",
+                               yang_argument_get(yc), reason);
+                    goto err;
+                }
+            }
+            else if (ye->ye_len > 0)
+                pos++;
+            ye->ye_val[ye->ye_len] = pos;
+            break;
+        default:
+            continue;
+        }
+        ye->ye_stmt[ye->ye_len] = yc;
+        for (h = yang_enum_hash_name(yang_argument_get(yc)) & ye->ye_mask;
+             ye->ye_name[h] != -1;
+             h = (h+1) & ye->ye_mask)
+            ;
+        ye->ye_name[h] = ye->ye_len;
+        for (h = yang_enum_hash_val(ye->ye_val[ye->ye_len]) & ye->ye_mask;
+             (i = ye->ye_value[h]) != -1;
+             h = (h+1) & ye->ye_mask)
+            if (ye->ye_val[i] == ye->ye_val[ye->ye_len])
+                break;
+        if (i == -1)
+            ye->ye_value[h] = ye->ye_len;
+        ye->ye_len++;
+    }
+    if (reason)
+        free(reason);
+    return ye;
+ err:
+    if (reason)
+        free(reason);
+    yang_enum_map_free(ye);
+    return NULL;
+}
+
+/*! Get name and value index of an enumeration or bits type, build it on first use
+ *
+ * @param[in]  ytype  Resolved enumeration or bits type statement
+ * @param[out] yep    Enum/bits index, or NULL if type has no type cache
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_enum_map_get(yang_stmt      *ytype,
+                  yang_enum_map **yep)
+{
+    yang_enum_map *ye;
+
+    *yep = NULL;
+    if (yang_typecache_get(ytype) == NULL)
+        return 0;
+    if ((ye = yang_type_cache_enummap_get(ytype)) != NULL){
+        if (ye->ye_nchild == yang_len_get(ytype)){
+            *yep = ye;
+            return 0;
+        }
+        yang_enum_map_free(ye);
+        yang_type_cache_enummap_set(ytype, NULL);
+    }
+    if ((ye = yang_enum_map_new(ytype)) == NULL)
+        return -1;
+    if (yang_type_cache_enummap_set(ytype, ye) < 0){
+        yang_enum_map_free(ye);
+        return -1;
+    }
+    *yep = ye;
+    return 0;
+}
+
+/*! Look up name in enum/bits index
+ *
+ * @see yang_enum_name2val
+ */
+static int
+yang_enum_name2val1(yang_enum_map *ye,
+                    const char    *name,
+                    yang_stmt    **ys,
+                    int64_t       *val)
+{
+    uint32_t h;
+    int      i;
+
+    for (h = yang_enum_hash_name(name) & ye->ye_mask;
+         (i = ye->ye_name[h]) != -1;
+         h = (h+1) & ye->ye_mask){
+        if (strcmp(yang_argument_get(ye->ye_stmt[i]), name) == 0){
+            if (ys)
+                *ys = ye->ye_stmt[i];
+            if (val)
+                *val = ye->ye_val[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*! Look up value in enum/bits index
+ *
+ * @see yang_enum_val2name
+ */
+static int
+yang_enum_val2name1(yang_enum_map *ye,
+                    int64_t        val,
+                    yang_stmt    **ys)
+{
+    uint32_t h;
+    int      i;
+
+    for (h = yang_enum_hash_val(val) & ye->ye_mask;
+         (i = ye->ye_value[h]) != -1;
+         h = (h+1) & ye->ye_mask){
+        if (ye->ye_val[i] == val){
+            if (ys)
+                *ys = ye->ye_stmt[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*! Given an enumeration or bits type and a name, return enum value or bit position
+ *
+ * @param[in]  ytype  Resolved enumeration or bits type statement
+ * @param[in]  name   Name of enum or bit
+ * @param[out] ys     Enum or bit statement (if given)
+ * @param[out] val    Enum value or bit position, also implicit (if given)
+ * @retval     1      Found
+ * @retval     0      Not found
+ * @retval    -1      Error
+ */
+int
+yang_enum_name2val(yang_stmt  *ytype,
+                   const char *name,
+                   yang_stmt **ys,
+                   int64_t    *val)
+{
+    yang_enum_map *ye;
+    int            i;
+
+    if (yang_enum_map_get(ytype, &ye) < 0)
+        return -1;
+    if (ye == NULL){ /* No type cache, build temporary index */
+        if ((ye = yang_enum_map_new(ytype)) == NULL)
+            return -1;
+        i = yang_enum_name2val1(ye, name, ys, val);
+        yang_enum_map_free(ye);
+        return i;
+    }
+    return yang_enum_name2val1(ye, name, ys, val);
+}
+
+/*! Given an enumeration or bits type and an enum value or bit position, return statement
+ *
+ * If several enums have the same value, the first is returned
+ * @param[in]  ytype  Resolved enumeration or bits type statement
+ * @param[in]  val    Enum value or bit position, also implicit
+ * @param[out] ys     Enum or bit statement
+ * @retval     1      Found
+ * @retval     0      Not found
+ * @retval    -1      Error
+ */
+int
+yang_enum_val2name(yang_stmt  *ytype,
+                   int64_t     val,
+                   yang_stmt **ys)
+{
+    yang_enum_map *ye;
+    int            i;
+
+    if (yang_enum_map_get(ytype, &ye) < 0)
+        return -1;
+    if (ye == NULL){ /* No type cache, build temporary index */
+        if ((ye = yang_enum_map_new(ytype)) == NULL)
+            return -1;
+        i = yang_enum_val2name1(ye, val, ys);
+        yang_enum_map_free(ye);
+        return i;
+    }
+    return yang_enum_val2name1(ye, val, ys);
+}
+
+/*! Validate string against enumeration
+ *
+ * @param[in]  yrestype Resolved type (enumeration)
+ * @param[in]  str      String value, may be NULL
+ * @param[out] reason   If given, and return value is 0, contains malloced string
+ * @retval     1        Validation OK
+ * @retval     0        Validation not OK
+ * @retval    -1        Error
+ */
+static int
+cv_validate_enum(yang_stmt *yrestype,
+                 char      *str,
+                 char     **reason)
+{
+    yang_stmt *yi = NULL;
+    int        ret;
+
+    if (str != NULL) {
+        if ((ret = yang_enum_name2val(yrestype, str, &yi, NULL)) < 0)
+            return -1;
+        if (ret == 1 && yang_keyword_get(yi) == Y_ENUM)
+            return 1;
+    }
+    if (reason)
+        *reason = cligen_reason("'%s' does not match enumeration", str);
+    return 0;
+}
+
+/*! Validate string against bits
+ *
+ * The lexical representation of the bits type is a space-separated list
+ * of the names of the bits that are set.  A zero-length string thus
+ * represents a value where no bits are set.
+ * @param[in]  yrestype Resolved type (bits)
+ * @param[in]  str      String value
+ * @param[out] reason   If given, and return value is 0, contains malloced string
+ * @retval     1        Validation OK
+ * @retval     0        Validation not OK
+ * @retval    -1        Error
+ */
+static int
+cv_validate_bits(yang_stmt *yrestype,
+                 char      *str,
+                 char     **reason)
+{
+    int        retval = -1;
+    yang_stmt *yi;
+    char     **vec = NULL;
+    int        nvec;
+    char      *v;
+    int        ret;
+    int        i;
+
+    str = clixon_trim2(str, " \t\n"); /* May be misplaced, strip earlier? */
+    nvec = 0;
+    if ((vec = clicon_strsep(str, " \t", &nvec)) == NULL)
+        goto done;
+    for (i=0; i<nvec; i++){
+        if ((v = vec[i]) == NULL || !strlen(v))
+            continue;
+        if ((ret = yang_enum_name2val(yrestype, v, &yi, NULL)) < 0)
+            goto done;
+        if (ret == 0 || yang_keyword_get(yi) != Y_BIT){
+            if (reason)
+                *reason = cligen_reason("'%s' does not match enumeration", v);
+            goto fail;
+        }
+    }
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get signed value of an integer or decimal64 cligen variable
+ *
+ * @param[in]  cv      Cligen variable
+ * @param[in]  cvtype  Type used to access cv
+ * @see range_check  in earlier versions, same access per type
+ */
+static int64_t
+yv_int_get(cg_var      *cv,
+           enum cv_type cvtype)
+{
+    switch (cvtype){
+    case CGV_INT8:
+        return cv_int8_get(cv);
+    case CGV_INT16:
+        return cv_int16_get(cv);
+    case CGV_INT32:
+        return cv_int32_get(cv);
+    default: /* CGV_INT64, CGV_DEC64 */
+        return cv_int64_get(cv);
+    }
+}
+
+/*! Get unsigned value of an unsigned integer cligen variable
+ *
+ * @param[in]  cv      Cligen variable
+ * @param[in]  cvtype  Type used to access cv
+ */
+static uint64_t
+yv_uint_get(cg_var      *cv,
+            enum cv_type cvtype)
+{
+    switch (cvtype){
+    case CGV_UINT8:
+        return cv_uint8_get(cv);
+    case CGV_UINT16:
+        return cv_uint16_get(cv);
+    case CGV_UINT32:
+        return cv_uint32_get(cv);
+    default: /* CGV_UINT64, lengths */
+        return cv_uint64_get(cv);
+    }
+}
+
+/*! Sort intervals on lower bound
+ */
+static int
+yv_range_cmp(const void *a,
+             const void *b)
+{
+    const struct yv_range *ra = a;
+    const struct yv_range *rb = b;
+
+    if (ra->yr_imin != rb->yr_imin)
+        return ra->yr_imin < rb->yr_imin ? -1 : 1;
+    if (ra->yr_umin != rb->yr_umin)
+        return ra->yr_umin < rb->yr_umin ? -1 : 1;
+    return 0;
+}
+
+/*! Compile range or length restriction cvec into sorted, merged intervals
+ *
+ * The cvec is a sequence of range_min with optional range_max entries.
+ * A value is valid if it is within any of the intervals.
+ * @param[in]  yv   Validator with yv_cvv and yv_cvtype set
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yv_ranges_compile(yang_type_validator *yv)
+{
+    int              retval = -1;
+    cvec            *cvv = yv->yv_cvv;
+    cg_var          *cv1;
+    cg_var          *cv2;
+    struct yv_range *yr;
+    struct yv_range *yrlast;
+    int              i;
+    int              j;
+
+    switch (yv->yv_cvtype){
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+    case CGV_DEC64:
+        yv->yv_bound = YV_BOUND_INT;
+        break;
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+        yv->yv_bound = YV_BOUND_UINT;
+        break;
+    case CGV_STRING:
+    case CGV_REST:
+        yv->yv_bound = YV_BOUND_LENGTH;
+        break;
+    default:
+        yv->yv_bound = YV_BOUND_NONE;
+        break;
+    }
+    if (yv->yv_bound == YV_BOUND_NONE || cvec_len(cvv) == 0)
+        goto ok;
+    if ((yv->yv_ranges = calloc(cvec_len(cvv), sizeof(struct yv_range))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = 0;
+    while (i<cvec_len(cvv)){
+        cv1 = cvec_i(cvv, i++); /* Increment to check for max pair */
+        if (strcmp(cv_name_get(cv1),"range_min") != 0){
+            clixon_err(OE_YANG, EINVAL, "Internal error, expected range_min");
+            goto done;
+        }
+        if (i<cvec_len(cvv) &&
+            (cv2 = cvec_i(cvv, i)) != NULL &&
+            strcmp(cv_name_get(cv2),"range_max") == 0){
+            i++;
+        }
+        else
+            cv2 = cv1;
+        yr = &yv->yv_ranges[yv->yv_rlen++];
+        if (yv->yv_bound == YV_BOUND_INT){
+            yr->yr_imin = yv_int_get(cv1, yv->yv_cvtype);
+            yr->yr_imax = yv_int_get(cv2, yv->yv_cvtype);
+        }
+        else if (yv->yv_bound == YV_BOUND_UINT){
+            yr->yr_umin = yv_uint_get(cv1, yv->yv_cvtype);
+            yr->yr_umax = yv_uint_get(cv2, yv->yv_cvtype);
+        }
+        else {
+            yr->yr_umin = cv_uint64_get(cv1);
+            yr->yr_umax = cv_uint64_get(cv2);
+        }
+    }
+    /* Sort and merge overlapping intervals */
+    qsort(yv->yv_ranges, yv->yv_rlen, sizeof(struct yv_range), yv_range_cmp);
+    j = 0;
+    for (i=1; i<yv->yv_rlen; i++){
+        yrlast = &yv->yv_ranges[j];
+        yr = &yv->yv_ranges[i];
+        if (yv->yv_bound == YV_BOUND_INT && yr->yr_imin <= yrlast->yr_imax){
+            if (yr->yr_imax > yrlast->yr_imax)
+                yrlast->yr_imax = yr->yr_imax;
+        }
+        else if (yv->yv_bound != YV_BOUND_INT && yr->yr_umin <= yrlast->yr_umax){
+            if (yr->yr_umax > yrlast->yr_umax)
+                yrlast->yr_umax = yr->yr_umax;
+        }
+        else
+            yv->yv_ranges[++j] = *yr;
+    }
+    yv->yv_rlen = j + 1;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check value against merged range or length intervals
+ *
+ * Binary search for the last interval whose lower bound is not above the value
+ * @param[in]  yv      Compiled validator
+ * @param[in]  cv      Value
+ * @param[out] reason  If given, and return value is 0, contains malloced string
+ * @retval     1       Within range
+ * @retval     0       Out of range
+ * @retval    -1       Error
+ */
+static int
+yv_range_check(yang_type_validator *yv,
+               cg_var              *cv,
+               char               **reason)
+{
+    struct yv_range *yr;
+    int64_t          ii = 0;
+    uint64_t         uu = 0;
+    char            *str;
+    int              low = 0;
+    int              high = yv->yv_rlen - 1;
+    int              mid;
+    int              found = -1;
+
+    if (yv->yv_bound == YV_BOUND_INT)
+        ii = yv_int_get(cv, yv->yv_cvtype);
+    else if (yv->yv_bound == YV_BOUND_UINT)
+        uu = yv_uint_get(cv, yv->yv_cvtype);
+    else if ((str = cv_string_get(cv)) != NULL)
+        uu = strlen(str); /* equal no string with empty string for range check */
+    while (low <= high){
+        mid = (low + high) / 2;
+        yr = &yv->yv_ranges[mid];
+        if (yv->yv_bound == YV_BOUND_INT ? yr->yr_imin <= ii : yr->yr_umin <= uu){
+            found = mid;
+            low = mid + 1;
+        }
+        else
+            high = mid - 1;
+    }
+    if (found != -1){
+        yr = &yv->yv_ranges[found];
+        if (yv->yv_bound == YV_BOUND_INT ? ii <= yr->yr_imax : uu <= yr->yr_umax)
+            return 1;
+    }
+    if (reason){
+        if (yv->yv_bound == YV_BOUND_LENGTH){
+            if (outoflength(uu, yv->yv_cvv, reason) < 0)
+                return -1;
+        }
+        else if (outofrange(cv, yv->yv_cvv, reason) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Validate CLIgen variable using a compiled built-in type validator
  *
  * @param[in]  h       Clixon handle
+ * @param[in]  yv      Compiled validator of kind YV_BUILTIN
  * @param[in]  cv      A cligen variable to validate. This is a correctly parsed cv.
- * @param[in]  cvtype  Resolved type of cv
- *                     string describing reason why validation failed. 
- * @param[in]  regexps Vector of compiled regexps
  * @param[out] reason  If given, and return value is 0, contains malloced str 
  * @retval     1       Validation OK
  * @retval     0       Validation not OK, malloced reason is returned. Free reason with free()
@@ -580,183 +1309,47 @@ outoflength(uint64_t    u64,
  * @see cv_validate Corresponding type check in cligen
  */
 static int
-cv_validate1(clixon_handle h,
-             cg_var      *cv,
-             enum cv_type cvtype,
-             int          options,
-             cvec        *cvv,
-             cvec        *regexps,
-             yang_stmt   *yrestype,
-             char        *restype,
-             char       **reason)
+yv_validate_builtin(clixon_handle        h,
+                    yang_type_validator *yv,
+                    cg_var              *cv,
+                    char               **reason)
 {
-    int             retval = 1; /* OK */
-    cg_var         *cv1;
-    cg_var         *cv2;
-    int             ret;
-    yang_stmt      *yi = NULL;
-    char           *str = NULL;
-    int             found;
-    char          **vec = NULL;
-    int             nvec;
-    char           *v;
-    uint64_t        uu = 0;
-    int64_t         ii = 0;
-    int             i;
-    int             reti; /* must keep signed, unsigned and string retval */
-    int             retu; /* separated due to different error handling */
-    int             rets;
-    int             inext;
+    int   retval = -1;
+    char *str;
+    int   ret;
 
     if (reason && *reason){
         free(*reason);
         *reason = NULL;
     }
-    /* check options first for length and range */
-    if ((options & YANG_OPTIONS_RANGE) != 0 ||
-        (options & YANG_OPTIONS_LENGTH) != 0){
-        i = 0;
-        while (i<cvec_len(cvv)){
-            cv1 = cvec_i(cvv, i++); /* Increment to check for max pair */
-            if (strcmp(cv_name_get(cv1),"range_min") != 0){
-                clixon_err(OE_YANG, EINVAL, "Internal error, expected range_min");
-                goto done;
-            }
-            if (i<cvec_len(cvv) &&
-                (cv2 = cvec_i(cvv, i)) != NULL &&
-                strcmp(cv_name_get(cv2),"range_max") == 0){
-                i++;
-            }
-            else
-                cv2 = cv1;
-            reti = 0; retu = 0; rets = 0;
-            switch (cvtype){
-            case CGV_INT8:
-                ii =  cv_int8_get(cv);
-                reti = range_check(ii, cv1, cv2, int8);
-                break;
-            case CGV_INT16:
-                ii =  cv_int16_get(cv);
-                reti = range_check(ii, cv1, cv2, int16);
-                break;
-            case CGV_INT32:
-                ii =  cv_int32_get(cv);
-                reti = range_check(ii, cv1, cv2, int32);
-                break;
-            case CGV_DEC64: /* XXX look at fraction-digit? */
-            case CGV_INT64:
-                ii =  cv_int64_get(cv);
-                reti = range_check(ii, cv1, cv2, int64);
-                break;
-            case CGV_UINT8:
-                uu =  cv_uint8_get(cv);
-                retu = range_check(uu, cv1, cv2, uint8);
-                break;
-            case CGV_UINT16:
-                uu =  cv_uint16_get(cv);
-                retu = range_check(uu, cv1, cv2, uint16);
-                break;
-            case CGV_UINT32:
-                uu =  cv_uint32_get(cv);
-                retu = range_check(uu, cv1, cv2, uint32);
-                break;
-            case CGV_UINT64:
-                uu =  cv_uint32_get(cv);
-                retu = range_check(uu, cv1, cv2, uint64);
-                break;
-            case CGV_STRING:
-            case CGV_REST:
-                if ((str = cv_string_get(cv)) == NULL)
-                    uu = 0; /* equal no string with empty string for range check */
-                else
-                    uu = strlen(str);
-                rets = range_check(uu, cv1, cv2, uint64);
-                break;
-            default:
-                break;
-            }
-            /* Error handling for signed and unsigned, strings in switch 
-             * OK: if check OK
-             * Failure: check fails and it is the last
-             */
-            if ((reti==0 && retu==0 && rets == 0))
-                goto step1ok;
-            /* Check fails */
-            if (i==cvec_len(cvv)){ /* And it is last */
-                if (reason){
-                    if (reti || retu){
-                        if (outofrange(cv, cvv, reason) < 0)
-                            goto done;
-                    }
-                    else if (outoflength(uu, cvv, reason) < 0)
-                        goto done;
-                }
-                goto fail;
-            }
-        } /* while i<cvec_len(cvv) */
+    /* check length and range first */
+    if (yv->yv_rlen){
+        if ((ret = yv_range_check(yv, cv, reason)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
     }
- step1ok:
-    /* then check options for others */
-    switch (cvtype){
+    switch (yv->yv_cvtype){
     case CGV_STRING:
     case CGV_REST:
-        str = cv_string_get(cv);
         /* Note, if there is no value, eg <s/>, str is NULL.
          */
-        if (restype){
-            if (strcmp(restype, "enumeration") == 0){
-                found = 0;
-                if (str != NULL) {
-                    //              str = clixon_trim2(str, " \t\n"); /* May be misplaced, strip earlier? */
-                    inext = 0;
-                    while ((yi = yn_iter(yrestype, &inext)) != NULL){
-                        if (yang_keyword_get(yi) != Y_ENUM)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), str) == 0){
-                            found++;
-                            break;
-                        }
-                    }
-                }
-                if (!found){
-                    if (reason)
-                        *reason = cligen_reason("'%s' does not match enumeration", str);
-                    goto fail;
-                }
-            }
-            if (strcmp(restype, "bits") == 0 && str != NULL){
-                /* The lexical representation of the bits type is a space-separated list
-                 * of the names of the bits that are set.  A zero-length string thus
-                 * represents a value where no bits are set.
-                 */
-                str = clixon_trim2(str, " \t\n"); /* May be misplaced, strip earlier? */
-                nvec = 0;
-                if ((vec = clicon_strsep(str, " \t", &nvec)) == NULL)
-                    goto done;
-                for (i=0; i<nvec; i++){
-                    if ((v = vec[i]) == NULL || !strlen(v))
-                        continue;
-                    found = 0;
-                    inext = 0;
-                    while ((yi = yn_iter(yrestype, &inext)) != NULL){
-                        if (yang_keyword_get(yi) != Y_BIT)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), v) == 0){
-                            found++;
-                            break;
-                        }
-                    }
-                    if (!found){
-                        if (reason)
-                            *reason = cligen_reason("'%s' does not match enumeration", v);
-                        goto fail;
-                        break;
-                    }
-                }
-            }
+        str = cv_string_get(cv);
+        if (yv->yv_enum){
+            if ((ret = cv_validate_enum(yv->yv_restype, str, reason)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        if (yv->yv_bits && str != NULL){
+            if ((ret = cv_validate_bits(yv->yv_restype, str, reason)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
         }
-        if (regexps && cvec_len(regexps)) {
-            if ((ret = cv_validate_pattern(h, regexps, yrestype, str, reason)) < 0)
+        if (yv->yv_regexps) {
+            if ((ret = cv_validate_pattern(h, yv->yv_regexps, yv->yv_memos,
+                                           yv->yv_restype, str, reason)) < 0)
                 goto done;
             if (ret == 0)
                 goto fail;
@@ -765,7 +1358,6 @@ cv_validate1(clixon_handle h,
     case CGV_VOID:
         break; /* empty type OK */
     case CGV_ERR:
-        retval = 0;
         if (reason)
             *reason = cligen_reason("Invalid cv");
         goto fail;
@@ -775,8 +1367,6 @@ cv_validate1(clixon_handle h,
     }
     retval = 1; /* validation OK */
  done:
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0; /* validation failed */
@@ -784,8 +1374,8 @@ cv_validate1(clixon_handle h,
 }
 
 /* Forward */
-static int ys_cv_validate_union(clixon_handle h,yang_stmt *ys, char **reason,
-                                yang_stmt *yrestype, char *type, char *val, yang_stmt **ysubp);
+static int yv_validate_union(clixon_handle h, yang_type_validator *yv, yang_stmt *ys,
+                             char *val, yang_stmt **ysubp, char **reason);
 
 static int
 ys_cv_validate_leafref(clixon_handle h,
@@ -838,146 +1428,224 @@ ys_cv_validate_leafref(clixon_handle h,
     goto done;
 }
 
-/*! Validate union
+/*! Validate value as one member type of a union
  *
  * @param[in]  h      Clixon handle
- * @param[in]  ys     Yang statement (union)
- * @param[out] reason If given, and return value is 0, contains malloced string
- * param[in]   yt     One of the types in the union
- * param[in]   type   Original type
+ * @param[in]  ym     Compiled validator of union member
+ * @param[in]  ys     Yang statement (leaf or leaf-list)
  * @param[in]  val    Value to match
+ * @param[out] reason If given, and return value is 0, contains malloced string
  * @retval     1      Validation OK
  * @retval     0      Validation not OK, malloced reason is returned. Free reason with free()
  * @retval    -1      Error (fatal), with errno set to indicate error
  */
 static int
-ys_cv_validate_union_one(clixon_handle h,
-                         yang_stmt    *ys,
-                         char        **reason,
-                         yang_stmt    *yt,
-                         char         *type,  /* orig type */
-                         char         *val)
+yv_validate_member(clixon_handle        h,
+                   yang_type_validator *ym,
+                   yang_stmt           *ys,
+                   char                *val,
+                   char               **reason)
 {
-    int          retval = -1;
-    yang_stmt   *yrestype;      /* union subtype */
-    int          options = 0;
-    cvec        *cvv = NULL;
-    cvec        *regexps = NULL;
-    cvec        *patterns = NULL;
-    uint8_t      fraction = 0;
-    char        *restype;
-    enum cv_type cvtype;
-    cg_var      *cvt=NULL;
-    yang_stmt   *ysubt = NULL;
+    int     retval = -1;
+    cg_var *cvt = NULL;
 
-    if ((regexps = cvec_new(0)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    if ((patterns = cvec_new(0)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    if (yang_type_resolve(ys, ys, yt, &yrestype, &options, &cvv, patterns, regexps,
-                          &fraction) < 0)
-        goto done;
-    if (yrestype == NULL){
-        clixon_err(OE_YANG, 0, "result-type should not be NULL");
-        goto done;
-    }
-    restype = yrestype?yang_argument_get(yrestype):NULL;
-    if (restype && strcmp(restype, "union") == 0){      /* recursive union */
-        if ((retval = ys_cv_validate_union(h, ys, reason, yrestype, type, val, &ysubt)) < 0)
-            goto done;
-    }
-        /* Leafref needs to resolve referred node for type information */
-    else if (restype && strcmp(restype,"leafref") == 0){
-        if ((retval = ys_cv_validate_leafref(h, val, ys, yrestype, NULL, reason)) < 0)  /* XXX: ysub? */
-            goto done;
-    }
-    else {
-        if (clicon_type2cv(type, restype, ys, &cvtype) < 0)
-            goto done;
-        /* reparse value with the new type */
-        if ((cvt = cv_new(cvtype)) == NULL){
-            clixon_err(OE_UNIX, errno, "cv_new");
-            goto done;
-        }
-        if (cvtype == CGV_DEC64)
-            cv_dec64_n_set(cvt, fraction);
+    switch (ym->yv_kind){
+    case YV_UNION: /* recursive union */
+        retval = yv_validate_union(h, ym, ys, val, NULL, reason);
+        break;
+    case YV_LEAFREF: /* Leafref needs to resolve referred node for type information */
+        retval = ys_cv_validate_leafref(h, val, ys, ym->yv_restype, NULL, reason);
+        break;
+    case YV_BUILTIN:
         if (val == NULL){ /* Fail validation on NULL */
             retval = 0;
             goto done;
         }
+        /* reparse value with the member type */
+        if ((cvt = cv_new(ym->yv_cvtype)) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_new");
+            goto done;
+        }
+        if (ym->yv_cvtype == CGV_DEC64)
+            cv_dec64_n_set(cvt, ym->yv_fraction);
         if ((retval = cv_parse1(val, cvt, reason)) < 0){
             clixon_err(OE_UNIX, errno, "cv_parse");
             goto done;
         }
         if (retval == 0)
             goto done;
-        if ((retval = cv_validate1(h, cvt, cvtype, options, cvv,
-                                   regexps, yrestype, restype, reason)) < 0)
-            goto done;
+        retval = yv_validate_builtin(h, ym, cvt, reason);
+        break;
     }
  done:
-    if (patterns)
-        cvec_free(patterns);
-    if (regexps)
-        cvec_free(regexps);
     if (cvt)
         cv_free(cvt);
     return retval;
 }
 
-/*! Validate union
+/*! Cheap lexical check of a value as a built-in union member
  *
- * @param[in]  h        Clixon handle
- * @param[in]  ys       Yang statement (union)
- * @param[out] reason   If given, and return value is 0, contains malloced string
- * param[in]   yrestype Resolved Yang type 
- * param[in]   type     Original type
- * @param[in]  val      Value to match
- * @param[out] ysubp    Sub-type of ys that matches val
- * @retval     1        Validation OK
- * @retval     0        Validation not OK, malloced reason is returned. Free reason with free()
- * @retval    -1        Error (fatal), with errno set to indicate error
+ * Rejects values that cannot be parsed as the member type without creating and
+ * parsing a cv, eg "192.0.2.1" or "eth0" as an integer member.
+ * @param[in]  ym     Compiled validator of union member
+ * @param[in]  val    Value to match
+ * @retval     1      Rejected, the member does not match
+ * @retval     0      Not rejected, parse and validate the member
  */
 static int
-ys_cv_validate_union(clixon_handle h,
-                     yang_stmt    *ys,
-                     char        **reason,
-                     yang_stmt    *yrestype,
-                     char         *type,
-                     char         *val,
-                     yang_stmt   **ysubp)
+yv_lex_reject(yang_type_validator *ym,
+              char                *val)
 {
-    int        retval = 1; /* valid */
-    yang_stmt *yt;
-    char      *reason1 = NULL;  /* saved reason */
-    int        inext;
+    char *p;
 
-    inext = 0;
-    while ((yt = yn_iter(yrestype, &inext)) != NULL){
-        if (yang_keyword_get(yt) != Y_TYPE)
-            continue;
-        if ((retval = ys_cv_validate_union_one(h, ys, reason, yt, type, val)) < 0)
+    if (ym->yv_lex == YV_LEX_ANY || val == NULL)
+        return 0;
+    for (p = val; isspace((unsigned char)*p); p++);
+    if (isdigit((unsigned char)*p) || *p == '-' || *p == '+')
+        return 0;
+    if (ym->yv_lex == YV_LEX_DEC64 && *p == '.')
+        return 0;
+    return 1;
+}
+
+/*! Find slot of value in value memo of union
+ *
+ * @param[in]  yv     Compiled validator of union
+ * @param[in]  val    Value to match
+ * @param[out] hash   Hash of val
+ * @retval     um     Memo slot of val, check um_str if it is val
+ * @retval     NULL   No memo, or val too long to be memoized
+ */
+static struct yv_union_memo *
+yv_union_memo(yang_type_validator *yv,
+              char                *val,
+              uint32_t            *hash)
+{
+    uint32_t h = 2166136261U; /* FNV-1a */
+    char    *p;
+
+    if (yv->yv_umemo == NULL || val == NULL)
+        return NULL;
+    for (p = val; *p != '\0'; p++){
+        if (p - val > YV_UNION_MEMO_STRLEN)
+            return NULL;
+        h ^= (uint8_t)*p;
+        h *= 16777619U;
+    }
+    *hash = h;
+    return &yv->yv_umemo[h % YV_UNION_MEMO_SIZE];
+}
+
+/*! Validate union
+ *
+ * Members are tried in order of how often they succeeded, unless the matching
+ * member is requested, in which case declaration order is used since the first
+ * matching member in declaration order determines the type.
+ * Built-in members are first checked lexically, see yv_lex_reject.
+ * If the union does not contain leafrefs, matched values are memoized so that
+ * revalidation of the same value skips the member search.
+ * If no member matches, the reason is the one of the last member in declaration
+ * order, same as when trying members in declaration order.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yv     Compiled validator of union
+ * @param[in]  ys     Yang statement (leaf or leaf-list)
+ * @param[in]  val    Value to match
+ * @param[out] ysubp  Sub-type of ys that matches val
+ * @param[out] reason If given, and return value is 0, contains malloced string
+ * @retval     1      Validation OK
+ * @retval     0      Validation not OK, malloced reason is returned. Free reason with free()
+ * @retval    -1      Error (fatal), with errno set to indicate error
+ */
+static int
+yv_validate_union(clixon_handle        h,
+                  yang_type_validator *yv,
+                  yang_stmt           *ys,
+                  char                *val,
+                  yang_stmt          **ysubp,
+                  char               **reason)
+{
+    int                   retval = 1; /* valid */
+    char                 *reason1 = NULL;  /* saved reason */
+    int                   r1 = -1;         /* member index of saved reason */
+    int                   rlex = -1;       /* highest member index rejected lexically */
+    struct yv_union_memo *um;
+    uint32_t              hash = 0;
+    int                   i;
+    int                   k;
+    int                   tmp;
+
+    if ((um = yv_union_memo(yv, val, &hash)) != NULL &&
+        um->um_str != NULL &&
+        um->um_hash == hash &&
+        strcmp(um->um_str, val) == 0){
+        if (ysubp == NULL)
+            goto done;
+        if (um->um_first){
+            *ysubp = yv->yv_members[um->um_member]->yv_ytype;
             goto done;
-        /* If validation failed, save reason, reset error and continue,
-         * save latest reason if noithing validates.
-         */
-        if (retval == 0 && reason && *reason != NULL){
-            if (reason1)
-                free(reason1);
-            reason1 = *reason;
-            *reason = NULL;
         }
+    }
+    for (k=0; k<yv->yv_mlen; k++){
+        i = ysubp ? k : yv->yv_order[k];
+        if (yv->yv_members[i]->yv_kind == YV_BUILTIN &&
+            yv_lex_reject(yv->yv_members[i], val)){
+            if (i > rlex)
+                rlex = i;
+            retval = 0;
+            continue;
+        }
+        if ((retval = yv_validate_member(h, yv->yv_members[i], ys, val, reason)) < 0)
+            goto done;
         /* Enough that one type validates value, return that value
          */
         if (retval == 1) {
+            if (um != NULL){
+                if (um->um_str)
+                    free(um->um_str);
+                if ((um->um_str = strdup(val)) != NULL){ /* Memo is best effort */
+                    um->um_hash = hash;
+                    um->um_member = i;
+                    um->um_first = ysubp != NULL || i == 0;
+                }
+            }
             if (ysubp)
-                *ysubp = yt;
+                *ysubp = yv->yv_members[i]->yv_ytype;
+            else {
+                if (yv->yv_hits[i] < UINT32_MAX)
+                    yv->yv_hits[i]++;
+                /* Move member towards front while more successful than predecessor */
+                while (k > 0 && yv->yv_hits[yv->yv_order[k-1]] < yv->yv_hits[i]){
+                    tmp = yv->yv_order[k-1];
+                    yv->yv_order[k-1] = i;
+                    yv->yv_order[k] = tmp;
+                    k--;
+                }
+            }
             break;
         }
+        /* If validation failed, save reason of latest member in declaration order */
+        if (reason && *reason != NULL){
+            if (i > r1){
+                if (reason1)
+                    free(reason1);
+                reason1 = *reason;
+                r1 = i;
+            }
+            else
+                free(*reason);
+            *reason = NULL;
+        }
+    }
+    /* Latest member in declaration order was rejected lexically: get its reason */
+    if (retval == 0 && reason && rlex > r1){
+        if ((retval = yv_validate_member(h, yv->yv_members[rlex], ys, val, reason)) < 0)
+            goto done;
+        if (*reason != NULL){
+            if (reason1)
+                free(reason1);
+            reason1 = *reason;
+            *reason = NULL;
+        }
     }
  done:
     if (retval == 0 && reason1){
@@ -989,8 +1657,235 @@ ys_cv_validate_union(clixon_handle h,
     return retval;
 }
 
+/*! Free compiled validator
+ *
+ * @param[in]  arg  Compiled validator
+ * @retval     0    OK
+ * @see yang_type_cache_validator_set
+ */
+int
+yang_type_validator_free(void *arg)
+{
+    yang_type_validator *yv = (yang_type_validator *)arg;
+    int                  i;
+
+    if (yv == NULL)
+        return 0;
+    if (yv->yv_ranges)
+        free(yv->yv_ranges);
+    if (yv->yv_memos){
+        for (i=0; i<cvec_len(yv->yv_regexps); i++)
+            regex_memo_free(yv->yv_memos[i]);
+        free(yv->yv_memos);
+    }
+    if (yv->yv_regexps)
+        cvec_free(yv->yv_regexps); /* compiled regexps are owned by type cache */
+    if (yv->yv_members){
+        for (i=0; i<yv->yv_mlen; i++)
+            if (yv->yv_members[i])
+                yang_type_validator_free(yv->yv_members[i]);
+        free(yv->yv_members);
+    }
+    if (yv->yv_hits)
+        free(yv->yv_hits);
+    if (yv->yv_order)
+        free(yv->yv_order);
+    if (yv->yv_umemo){
+        for (i=0; i<YV_UNION_MEMO_SIZE; i++)
+            if (yv->yv_umemo[i].um_str)
+                free(yv->yv_umemo[i].um_str);
+        free(yv->yv_umemo);
+    }
+    free(yv);
+    return 0;
+}
+
+/*! Compile type statement into validator
+ *
+ * Resolve type chain once and flatten restrictions. Union members are compiled
+ * recursively.
+ * @param[in]  ys     Yang statement (leaf or leaf-list) used for resolving
+ * @param[in]  ytype  Type statement
+ * @param[out] yvp    Compiled validator, free with yang_type_validator_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_type_validator_compile(yang_stmt            *ys,
+                            yang_stmt            *ytype,
+                            yang_type_validator **yvp)
+{
+    int                  retval = -1;
+    yang_type_validator *yv = NULL;
+    yang_type_validator *ym = NULL;
+    yang_stmt           *yrestype = NULL;
+    yang_stmt           *yt;
+    int                  options = 0;
+    cvec                *cvv = NULL;
+    cvec                *regexps = NULL;
+    uint8_t              fraction = 0;
+    char                *restype;
+    int                  inext;
+    int                  i;
+
+    if ((yv = malloc(sizeof(*yv))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(yv, 0, sizeof(*yv));
+    yv->yv_ytype = ytype;
+    if ((regexps = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (yang_type_resolve(ys, ys, ytype, &yrestype, &options, &cvv, NULL, regexps,
+                          &fraction) < 0)
+        goto done;
+    if (yrestype == NULL){
+        clixon_err(OE_YANG, 0, "result-type should not be NULL");
+        goto done;
+    }
+    yv->yv_restype = yrestype;
+    restype = yang_argument_get(yrestype);
+    if (clicon_type2cv(yang_argument_get(ytype), restype, ys, &yv->yv_cvtype) < 0)
+        goto done;
+    if (strcmp(restype, "union") == 0){
+        yv->yv_kind = YV_UNION;
+        yv->yv_pure = 1;
+        inext = 0;
+        while ((yt = yn_iter(yrestype, &inext)) != NULL){
+            if (yang_keyword_get(yt) != Y_TYPE)
+                continue;
+            if (yang_type_validator_compile(ys, yt, &ym) < 0)
+                goto done;
+            if ((yv->yv_members = realloc(yv->yv_members,
+                                          (yv->yv_mlen+1)*sizeof(ym))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            if (ym->yv_pure == 0)
+                yv->yv_pure = 0;
+            yv->yv_members[yv->yv_mlen++] = ym;
+            ym = NULL;
+        }
+        if (yv->yv_mlen){
+            if ((yv->yv_hits = calloc(yv->yv_mlen, sizeof(uint32_t))) == NULL ||
+                (yv->yv_order = calloc(yv->yv_mlen, sizeof(int))) == NULL){
+                clixon_err(OE_UNIX, errno, "calloc");
+                goto done;
+            }
+            for (i=0; i<yv->yv_mlen; i++)
+                yv->yv_order[i] = i;
+        }
+        if (yv->yv_pure && yv->yv_mlen &&
+            (yv->yv_umemo = calloc(YV_UNION_MEMO_SIZE, sizeof(struct yv_union_memo))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    else if (strcmp(restype, "leafref") == 0)
+        yv->yv_kind = YV_LEAFREF;
+    else {
+        yv->yv_kind = YV_BUILTIN;
+        yv->yv_pure = 1;
+        switch (yv->yv_cvtype){
+        case CGV_INT8: case CGV_INT16: case CGV_INT32: case CGV_INT64:
+        case CGV_UINT8: case CGV_UINT16: case CGV_UINT32: case CGV_UINT64:
+            yv->yv_lex = YV_LEX_INT;
+            break;
+        case CGV_DEC64:
+            yv->yv_lex = YV_LEX_DEC64;
+            break;
+        default:
+            yv->yv_lex = YV_LEX_ANY;
+            break;
+        }
+        yv->yv_fraction = fraction;
+        yv->yv_enum = strcmp(restype, "enumeration") == 0;
+        yv->yv_bits = strcmp(restype, "bits") == 0;
+        if ((options & (YANG_OPTIONS_RANGE|YANG_OPTIONS_LENGTH)) != 0){
+            yv->yv_cvv = cvv;
+            if (yv_ranges_compile(yv) < 0)
+                goto done;
+        }
+        if (cvec_len(regexps)){
+            yv->yv_regexps = regexps;
+            regexps = NULL;
+            if ((yv->yv_memos = calloc(cvec_len(yv->yv_regexps), sizeof(regex_memo *))) == NULL){
+                clixon_err(OE_UNIX, errno, "calloc");
+                goto done;
+            }
+            for (i=0; i<cvec_len(yv->yv_regexps); i++)
+                if ((yv->yv_memos[i] = regex_memo_new()) == NULL)
+                    goto done;
+        }
+    }
+    *yvp = yv;
+    yv = NULL;
+    retval = 0;
+ done:
+    if (ym)
+        yang_type_validator_free(ym);
+    if (yv)
+        yang_type_validator_free(yv);
+    if (regexps)
+        cvec_free(regexps);
+    return retval;
+}
+
+/*! Get compiled validator of a leaf or leaf-list, compile it on first use
+ *
+ * Same type statement as yang_type_get() uses. The validator is stored in the type
+ * cache of the type statement. If there is no type cache, the validator is returned
+ * to the caller who must free it.
+ * @param[in]  ys     Yang statement, leaf or leaf-list
+ * @param[out] yvp    Compiled validator
+ * @param[out] freeit Set if caller must free validator with yang_type_validator_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ys_type_validator(yang_stmt            *ys,
+                  yang_type_validator **yvp,
+                  int                  *freeit)
+{
+    int                  retval = -1;
+    yang_stmt           *ytype;
+    yang_stmt           *yorig;
+    yang_type_validator *yv;
+
+    *freeit = 0;
+    if ((ytype = yang_find(ys, Y_TYPE, NULL)) == NULL){
+        clixon_err(OE_DB, ENOENT, "mandatory type object is not found");
+        goto done;
+    }
+    /* Use original tree to resolve types */
+    if ((yorig = yang_orig_get(ys)) != NULL && yang_flag_get(ytype, YANG_FLAG_REFINE) == 0){
+        ys = yorig;
+        if ((ytype = yang_find(ys, Y_TYPE, NULL)) == NULL){
+            clixon_err(OE_DB, ENOENT, "mandatory type object is not found");
+            goto done;
+        }
+    }
+    if ((yv = yang_type_cache_validator_get(ytype)) == NULL){
+        if (yang_type_validator_compile(ys, ytype, &yv) < 0)
+            goto done;
+        if (yang_typecache_get(ytype) == NULL)
+            *freeit = 1;
+        else if (yang_type_cache_validator_set(ytype, yv) < 0){
+            yang_type_validator_free(yv);
+            goto done;
+        }
+    }
+    *yvp = yv;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Validate cligen variable cv using yang statement as spec
  *
+ * The type of ys is compiled into a validator on first use, see ys_type_validator
  * @param[in]  h       Clixon handle     
  * @param[in]  cv      A cligen variable to validate. This is a correctly parsed cv.
  * @param[in]  ys      A yang statement, must be leaf or leaf-list.
@@ -1010,20 +1905,12 @@ ys_cv_validate(clixon_handle h,
                yang_stmt   **ysub,
                char        **reason)
 {
-    int             retval = -1;
-    cg_var         *ycv;        /* cv of yang-statement */
-    int             options = 0;
-    cvec           *cvv = NULL;
-    cvec           *patterns = NULL;
-    cvec           *regexps = NULL;
-    enum cv_type    cvtype;
-    char           *origtype = NULL;  /* orig type */
-    yang_stmt      *yrestype = NULL; /* resolved type */
-    char           *restype;
-    uint8_t         fraction = 0;
-    int             retval2;
-    char           *val;
-    cg_var         *cvt = NULL;
+    int                  retval = -1;
+    cg_var              *ycv;        /* cv of yang-statement */
+    yang_type_validator *yv = NULL;
+    int                  freeit = 0;
+    enum cv_type         cvtype;
+    char                *val;
 
     if (reason)
         *reason=NULL;
@@ -1032,23 +1919,9 @@ ys_cv_validate(clixon_handle h,
         goto done;
     }
     ycv = yang_cv_get(ys);
-    if ((patterns = cvec_new(0)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    if ((regexps = cvec_new(0)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    if (yang_type_get(ys, &origtype, &yrestype,
-                      &options, &cvv,
-                      patterns,
-                      regexps,
-                      &fraction) < 0)
-        goto done;
-    restype = yrestype?yang_argument_get(yrestype):NULL;
-    if (clicon_type2cv(origtype, restype, ys, &cvtype) < 0)
+    if (ys_type_validator(ys, &yv, &freeit) < 0)
         goto done;
+    cvtype = yv->yv_cvtype;
     if (cv_type_get(ycv) != cvtype){
         /* special case: dbkey has rest syntax-> cv but yang cant have that */
         if (cvtype == CGV_STRING && cv_type_get(ycv) == CGV_REST)
@@ -1059,8 +1932,8 @@ ys_cv_validate(clixon_handle h,
             goto done;
         }
     }
-    /* Note restype can be NULL here for example with unresolved hardcoded uuid */
-    if (restype && strcmp(restype, "union") == 0){
+    switch (yv->yv_kind){
+    case YV_UNION:
         if (cvtype != CGV_REST){
             clixon_err(OE_YANG, 0, "union must be rest cv type but is %d", cvtype);
             goto done;
@@ -1070,11 +1943,10 @@ ys_cv_validate(clixon_handle h,
          */
         if ((val = cv_string_get(cv)) == NULL)
             val = "";
-        if ((retval2 = ys_cv_validate_union(h, ys, reason, yrestype, origtype, val, ysub)) < 0)
-            goto done;
-        retval = retval2; /* invalid (0) with latest reason or valid 1 */
-    }
-    else{
+        /* invalid (0) with latest reason or valid 1 */
+        retval = yv_validate_union(h, yv, ys, val, ysub, reason);
+        break;
+    case YV_LEAFREF:
         /* Leafref needs to resolve referred node for type information 
          * From rfc7950 Sec 9.9:
          * The leafref built-in type is restricted to the value space of some
@@ -1084,37 +1956,26 @@ ys_cv_validate(clixon_handle h,
          * leaf or leaf-list node in the schema tree.  The value space of the
          * referring node is the value space of the referred node.
          */
-        if (restype && strcmp(restype,"leafref") == 0){
-            if (cvtype != CGV_REST){
-                clixon_err(OE_YANG, 0, "leafref must be rest cv type but is %d", cvtype);
-                goto done;
-            }
-            /* Instead of NULL, give an empty string to validate, this is to avoid cv_parse
-             * errors and may actually be the wrong thing to do.
-             */
-            if ((val = cv_string_get(cv)) == NULL)
-                val = "";
-            retval = ys_cv_validate_leafref(h, val, ys, yrestype, ysub, reason);
+        if (cvtype != CGV_REST){
+            clixon_err(OE_YANG, 0, "leafref must be rest cv type but is %d", cvtype);
             goto done;
         }
-        if ((retval = cv_validate1(h, cv, cvtype, options, cvv,
-                                   regexps, yrestype, restype, reason)) < 0)
+        if ((val = cv_string_get(cv)) == NULL)
+            val = "";
+        retval = ys_cv_validate_leafref(h, val, ys, yv->yv_restype, ysub, reason);
+        break;
+    case YV_BUILTIN:
+        if ((retval = yv_validate_builtin(h, yv, cv, reason)) < 0)
             goto done;
         if (ysub)
             *ysub = ys;
+        break;
     }
   done:
-    if (origtype)
-        free(origtype);
-    if (regexps)
-        cvec_free(regexps);
-    if (patterns)
-        cvec_free(patterns);
-    if (cvt)
-        cv_free(cvt);
+    if (freeit && yv)
+        yang_type_validator_free(yv);
     return retval;
 }
-
 /*
  * a typedef can be under module, submodule, container, list, grouping, rpc, 
  * input, output, notification
@@ -0,0 +1,173 @@
+#!/usr/bin/env bash
+# Read-only RPCs executed by backend worker processes, see CLICON_BACKEND_RPC_WORKERS
+# Check get-config, get, get-schema and stats replies from workers
+# Check that replies are in request order when several requests are sent in one session
+# Then write pipelined requests directly to the backend socket, the first with a slow
+# (large) reply, and check that all replies are in request order
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fin=$dir/in.xml
+fout=$dir/out.xml
+sock=/usr/local/var/run/$APPNAME.sock
+
+# Number of list entries in slow reply
+: ${perfnr:=5000}
+
+# Number of pipelined requests
+: ${perfreq:=20}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_BACKEND_RPC_WORKERS>4</CLICON_BACKEND_RPC_WORKERS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  revision 2025-05-01;
+  container table {
+    list parameter {
+      key name;
+      leaf name {
+        type string;
+      }
+      leaf value {
+        type uint32;
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add parameter"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></data></rpc-reply>"
+
+new "get"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:table\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></data></rpc-reply>"
+
+new "get-config error from worker"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><notexist/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>" ""
+
+new "get-schema"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-schema xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><identifier>example</identifier><version>2025-05-01</version><format>yang</format></get-schema></rpc>" "<rpc-reply $DEFAULTNS><data xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\">module example{" ""
+
+new "stats"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats xmlns=\"http://clicon.org/lib\"></stats></rpc>" "<rpc-reply $DEFAULTNS><global xmlns=\"http://clicon.org/lib\"><xmlnr>[0-9]*</xmlnr>" ""
+
+# Several requests in one session: edit between two reads by workers
+rpc1=$(chunked_framing "<rpc $DEFAULTNS message-id=\"1\"><get-config><source><candidate/></source></get-config></rpc>")
+rpc2=$(chunked_framing "<rpc $DEFAULTNS message-id=\"2\"><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>2</value></parameter></table></config></edit-config></rpc>")
+rpc3=$(chunked_framing "<rpc $DEFAULTNS message-id=\"3\"><get-config><source><candidate/></source></get-config></rpc>")
+
+new "replies in request order"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO$rpc1$rpc2$rpc3" "" "<rpc-reply $DEFAULTNS message-id=\"1\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></data></rpc-reply>" ""
+
+new "last get-config sees edit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ -z "$netcat" ]; then
+    echo "...skipped: pipelined requests, netcat not available"
+else
+    new "add $perfnr parameters"
+    conf="<table xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$perfnr; i++ )); do
+        conf+="<parameter><name>x$i</name><value>$i</value></parameter>"
+    done
+    conf+="</table>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$conf</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "generate $perfreq pipelined rpcs, first is slow"
+    # Slow get-config of all, then edits in backend and small get-configs in workers
+    echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"1\"><get-config><source><candidate/></source></get-config></rpc>")" > $fin
+    for (( i=2; i<=$perfreq; i++ )); do
+        if [ $((i%2)) -eq 0 ]; then
+            echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"$i\"><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>y$i</name><value>$i</value></parameter></table></config></edit-config></rpc>")" >> $fin
+        else
+            echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"$i\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='y$((i-1))']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")" >> $fin
+        fi
+    done
+
+    new "send $perfreq pipelined rpcs at once"
+    sudo $netcat -U $sock < $fin > $fout
+
+    new "check $perfreq replies in request order"
+    ids=$(grep -o "<rpc-reply [^>]*message-id=\"[0-9]*\"" $fout | grep -o "message-id=\"[0-9]*\"" | grep -o "[0-9]*" | tr '\n' ' ')
+    expect=$(seq -s ' ' 1 $perfreq)
+    if [ "$ids" != "$expect " ]; then
+        err "$expect" "$ids"
+    fi
+
+    new "check slow reply is complete"
+    if ! grep -q "<parameter><name>x$((perfnr-1))</name><value>$((perfnr-1))</value></parameter>" $fout; then
+        err "<name>x$((perfnr-1))</name>" "$(head -c 200 $fout)"
+    fi
+
+    new "check get-configs by workers see preceding edits"
+    for (( i=3; i<=$perfreq; i+=2 )); do
+        if ! grep -q "message-id=\"$i\"[^>]*><data><table xmlns=\"urn:example:clixon\"><parameter><name>y$((i-1))</name>" $fout; then
+            err "reply $i with y$((i-1))" "$(grep -o "message-id=\"$i\".\{0,120\}" $fout)"
+        fi
+    done
+
+    new "netconf discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,164 @@
+#!/usr/bin/env bash
+# Weighted fair scheduling of RPCs of backend clients, see CLICON_BACKEND_SCHED_QUANTUM
+# Check that RPCs are replied to in order, and scheduling state in netconf-monitoring
+# Also with CLICON_BACKEND_SCHED_QUEUE_MAX 0, ie the queue of a client is not limited
+# Then check admission control by sending many RPCs at once directly to the backend socket
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fin=$dir/in.xml
+fout=$dir/out.xml
+sock=/usr/local/var/run/$APPNAME.sock
+
+# Number of RPCs sent at once
+: ${perfreq:=50}
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table {
+    list parameter {
+      key name;
+      leaf name {
+        type string;
+      }
+      leaf value {
+        type uint32;
+      }
+    }
+  }
+}
+EOF
+
+# Args:
+# 1: admit max
+# 2: queue max
+function testrun()
+{
+    admit=$1
+    qmax=$2
+
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>true</CLICON_NETCONF_MONITORING>
+  <CLICON_BACKEND_SCHED_QUANTUM>1</CLICON_BACKEND_SCHED_QUANTUM>
+  <CLICON_BACKEND_SCHED_CLASS>cli:4</CLICON_BACKEND_SCHED_CLASS>
+  <CLICON_BACKEND_SCHED_CLASS>netconf:2</CLICON_BACKEND_SCHED_CLASS>
+  <CLICON_BACKEND_SCHED_QUEUE_MAX>$qmax</CLICON_BACKEND_SCHED_QUEUE_MAX>
+  <CLICON_BACKEND_SCHED_ADMIT_MAX>$admit</CLICON_BACKEND_SCHED_ADMIT_MAX>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+rpcs=""
+for (( i=1; i<=10; i++ )); do
+    rpcs+=$(chunked_framing "<rpc $DEFAULTNS message-id=\"$i\"><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>x$i</name><value>$i</value></parameter></table></config></edit-config></rpc>")
+done
+rpcs+=$(chunked_framing "<rpc $DEFAULTNS message-id=\"11\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='x10']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")
+
+testrun 0 0
+
+new "unlimited queue: several rpcs in one session, replies in order"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO$rpcs" "" "<rpc-reply $DEFAULTNS message-id=\"11\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>x10</name><value>10</value></parameter></table></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+fi
+testrun 0 4
+
+new "several rpcs in one session, replies in order"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO$rpcs" "" "<rpc-reply $DEFAULTNS message-id=\"11\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>x10</name><value>10</value></parameter></table></data></rpc-reply>"
+
+new "netconf-monitoring session scheduling class"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ncm:netconf-state/ncm:sessions\" xmlns:ncm=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"/></get></rpc>" "<sched-class xmlns=\"http://clicon.org/lib\">netconf</sched-class><rpc-queue-depth xmlns=\"http://clicon.org/lib\">0</rpc-queue-depth>" ""
+
+new "netconf-monitoring scheduler classes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ncm:netconf-state/cl:scheduler\" xmlns:ncm=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<scheduler xmlns=\"http://clicon.org/lib\"><class><name>cli</name><weight>4</weight><queue-depth>0</queue-depth><rpcs>0</rpcs><denied>0</denied>.*</class><class><name>default</name><weight>1</weight>.*</class><class><name>netconf</name><weight>2</weight><queue-depth>0</queue-depth><rpcs>[1-9][0-9]*</rpcs><denied>0</denied>" ""
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ -z "$netcat" ]; then
+    echo "...skipped: admission control, netcat not available"
+else
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        stop_backend -f $cfg
+    fi
+    testrun 2 4
+
+    new "generate $perfreq rpcs"
+    echo -n "" > $fin
+    for (( i=0; i<$perfreq; i++ )); do
+        echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"$i\"><get-config><source><candidate/></source></get-config></rpc>")" >> $fin
+    done
+
+    new "send $perfreq rpcs at once"
+    sudo $netcat -U $sock < $fin > $fout
+
+    new "check $perfreq replies"
+    nr=$(grep -o "<rpc-reply" $fout | wc -l)
+    if [ $nr -ne $perfreq ]; then
+        err1 "$perfreq replies" "$nr"
+    fi
+
+    new "check resource-denied"
+    nr=$(grep -o "<error-tag>resource-denied</error-tag>" $fout | wc -l)
+    if [ $nr -eq 0 ]; then
+        err1 "resource-denied" "$nr"
+    fi
+
+    new "netconf-monitoring denied"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ncm:netconf-state/cl:scheduler\" xmlns:ncm=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<class><name>default</name><weight>1</weight><queue-depth>0</queue-depth><rpcs>[1-9][0-9]*</rpcs><denied>[1-9][0-9]*</denied>" ""
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,168 @@
+#!/usr/bin/env bash
+# Backend client that does not read its output, see CLICON_BACKEND_OUTPUT_HIGHWATER
+# A client subscribes to a notification stream, sends many RPCs with large replies
+# directly to the backend socket and then stops reading.
+# Check that other clients are still served, that notifications to the slow client
+# are dropped, and with CLICON_BACKEND_OUTPUT_SUSPEND that input from the slow
+# client is suspended, ie not all of its RPCs are received by the backend.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fin=$dir/in.xml
+sock=/usr/local/var/run/$APPNAME.sock
+
+# Number of list entries, makes each get-config reply large
+: ${perfnr:=2000}
+
+# Number of RPCs sent by the slow client
+: ${perfreq:=20}
+
+# Seconds the slow client is connected without reading
+: ${slowwait:=6}
+
+# High-water mark of output queue in bytes, less than one reply
+highwater=8192
+
+if [ -z "$netcat" ]; then
+    echo "...skipped: netcat not available"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# netcat without idle timeout, the slow client is idle when not reading
+nc=${netcat%% *}
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table {
+    list parameter {
+      key name;
+      leaf name {
+        type string;
+      }
+      leaf value {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Args:
+# 1: suspend input
+function testrun()
+{
+    suspend=$1
+
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_STREAM_DISCOVERY_RFC5277>true</CLICON_STREAM_DISCOVERY_RFC5277>
+  <CLICON_NETCONF_MONITORING>true</CLICON_NETCONF_MONITORING>
+  <CLICON_BACKEND_OUTPUT_HIGHWATER>$highwater</CLICON_BACKEND_OUTPUT_HIGHWATER>
+  <CLICON_BACKEND_OUTPUT_SUSPEND>$suspend</CLICON_BACKEND_OUTPUT_SUSPEND>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -- -n 1"
+        start_backend -s init -f $cfg -- -n 1 # notification every second
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "add $perfnr entries"
+    conf="<table xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$perfnr; i++ )); do
+        conf+="<parameter><name>x$i</name><value>value of parameter x$i</value></parameter>"
+    done
+    conf+="</table>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$conf</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "generate subscription and $perfreq rpcs"
+    echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"0\"><create-subscription xmlns=\"urn:ietf:params:xml:ns:netconf:notification:1.0\"><stream>EXAMPLE</stream></create-subscription></rpc>")" > $fin
+    for (( i=1; i<=$perfreq; i++ )); do
+        echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"$i\"><get-config><source><candidate/></source></get-config></rpc>")" >> $fin
+    done
+
+    new "start slow client, not reading"
+    # The output pipe is never read, when it is full netcat stops reading the socket
+    (cat $fin; sleep $slowwait) | sudo $nc -U $sock | sleep $slowwait &
+    sleep 3 # Wait for notifications to the slow client
+
+    new "other client is served"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='x1']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>x1</name><value>value of parameter x1</value></parameter></table></data></rpc-reply>"
+
+    new "notifications to slow client are dropped"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"subtree\"><netconf-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><statistics><out-notifications/></statistics></netconf-state></filter></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><netconf-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><statistics><out-notifications>0</out-notifications></statistics></netconf-state></data></rpc-reply>"
+
+    new "get rpcs received per session"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"subtree\"><netconf-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><sessions/></netconf-state></filter></get></rpc>" "<in-rpcs>" ""
+    # The slow client has the largest number of received rpcs
+    nr=$(echo "$ret" | grep -o "<in-rpcs>[0-9]*</in-rpcs>" | grep -o "[0-9]*" | sort -n | tail -1)
+    if $suspend; then
+        new "input from slow client suspended"
+        if [ $nr -ge $perfreq ]; then
+            err1 "less than $perfreq rpcs received" "$nr"
+        fi
+    else
+        new "all rpcs from slow client received"
+        if [ $nr -ne $((perfreq+1)) ]; then
+            err1 "$((perfreq+1)) rpcs received" "$nr"
+        fi
+    fi
+
+    new "wait for slow client"
+    wait
+
+    new "netconf discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "drop notifications"
+testrun false
+
+new "drop notifications and suspend input"
+testrun true
+
+rm -rf $dir
+
+new "endtest"
+endtest
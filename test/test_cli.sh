@@ -153,6 +153,7 @@ load("Load configuration from XML file") <filename:string>("Filename (local file
 }
 
 rpc("example rpc") <a:string>("routing instance"), example_client_rpc("");
+pipeline("example rpcs pipelined") <nr:uint32>("number of rpcs") <a:string>("routing instance prefix"), example_client_pipeline("");
 
 # Special cli bug with choice+dbexpand, part1 set db symbol
 choicebug {
@@ -260,6 +261,15 @@ new "cli rpc"
 # We dont know which message-id the cli app uses
 expectpart "$($clixon_cli -1 -f $cfg -l o rpc ipv4)" 0 "<rpc-reply $DEFAULTONLY message-id=" "><x xmlns=\"urn:example:clixon\">ipv4</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>"
 
+new "cli pipelined rpcs"
+expectpart "$($clixon_cli -1 -f $cfg -l o pipeline 3 ip)" 0 "<rpc-reply $DEFAULTONLY message-id=\"0\"><x xmlns=\"urn:example:clixon\">ip0</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>" "<rpc-reply $DEFAULTONLY message-id=\"1\"><x xmlns=\"urn:example:clixon\">ip1</x>" "<rpc-reply $DEFAULTONLY message-id=\"2\"><x xmlns=\"urn:example:clixon\">ip2</x>"
+
+new "cli pipelined rpcs, replies in request order"
+ids=$(echo "$ret" | grep -o "message-id=\"[0-9]*\"" | grep -o "[0-9]*" | tr '\n' ' ')
+if [ "$ids" != "0 1 2 " ]; then
+    err "0 1 2 " "$ids"
+fi
+
 new "cli bug with choice+dbexpand, part1 set db symbol"
 expectpart "$($clixon_cli -1 -f $cfg set table parameter foobar)" 0 "^$"
 
@@ -270,6 +280,37 @@ expectpart "$($clixon_cli -1 -f $cfg choicebug foobar)" 0 "^$"
 new "cli discard"
 expectpart "$($clixon_cli -1 -f $cfg discard)" 0 "^$"
 
+# Pipelined rpcs where requests and replies are larger than the socket buffers
+pipenr=2000
+prefix=$(printf "a%.0s" $(seq 500))
+function pipelinetest()
+{
+    new "cli $pipenr pipelined rpcs $1"
+    expectpart "$($clixon_cli -1 -f $cfg -l o pipeline $pipenr $prefix)" 0 "<rpc-reply $DEFAULTONLY message-id=\"$((pipenr-1))\"><x xmlns=\"urn:example:clixon\">$prefix$((pipenr-1))</x>"
+
+    new "cli $pipenr pipelined rpcs $1, replies in request order"
+    ids=$(echo "$ret" | grep -o "message-id=\"[0-9]*\"" | grep -o "[0-9]*" | tr '\n' ' ')
+    expect=$(seq -s ' ' 0 $((pipenr-1)))
+    if [ "$ids" != "$expect " ]; then
+        err "$expect" "$ids"
+    fi
+}
+
+pipelinetest "larger than socket buffers"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+    # Backend stops reading a client whose output is not written
+    new "start backend -s running -f $cfg -o CLICON_BACKEND_OUTPUT_HIGHWATER=8192 -o CLICON_BACKEND_OUTPUT_SUSPEND=true"
+    start_backend -s running -f $cfg -o CLICON_BACKEND_OUTPUT_HIGHWATER=8192 -o CLICON_BACKEND_OUTPUT_SUSPEND=true
+
+    new "wait backend"
+    wait_backend
+
+    pipelinetest "with suspended input"
+fi
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
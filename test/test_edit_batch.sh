@@ -0,0 +1,267 @@
+#!/usr/bin/env bash
+# Batched edits with the clixon-lib edit-batch rpc
+# Check that edits are applied in order, and that a failed edit leaves candidate unchanged,
+# also after choice, ordered-by user and top-level replace edits
+# Check default-operation, test-option and autocommit
+# Apply edits with the clixon_client_edit_batch() client api
+# Last, apply many small edits in one batch
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fbatch=$dir/batch.xml
+cfile=$dir/edit-batch.c
+app=$dir/edit-batch
+
+# Number of edits in large batch
+: ${perfreq:=1000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table {
+    list parameter {
+      key name;
+      leaf name {
+        type string;
+      }
+      leaf value {
+        type uint32;
+      }
+    }
+    choice mode {
+      leaf fast {
+        type empty;
+      }
+      leaf slow {
+        type uint32;
+      }
+    }
+    leaf-list tag {
+      type string;
+      ordered-by user;
+    }
+  }
+}
+EOF
+
+# Edit of other table nodes than parameter
+# Args:
+# 1: edit-id
+# 2: operation
+# 3: table children
+function edittable()
+{
+    echo -n "<edit><edit-id>$1</edit-id><operation>$2</operation><config><table xmlns=\"urn:example:clixon\">$3</table></config></edit>"
+}
+
+# Args:
+# 1: edit-id
+# 2: operation
+# 3: name
+# 4: value (optional)
+function edit()
+{
+    echo -n "<edit><edit-id>$1</edit-id><operation>$2</operation><config><table xmlns=\"urn:example:clixon\"><parameter><name>$3</name>"
+    if [ -n "$4" ]; then
+        echo -n "<value>$4</value>"
+    fi
+    echo -n "</parameter></table></config></edit>"
+}
+
+cat<<EOF > $cfile
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <clixon/clixon_queue.h>
+#include <clixon/clixon_hash.h>
+#include <clixon/clixon_handle.h>
+#include <clixon/clixon_client.h>
+
+int
+main(int    argc,
+     char **argv)
+{
+    int                  retval = -1;
+    clixon_handle        h = NULL; /* clixon handle */
+    clixon_client_handle ch = NULL; /* clixon client handle */
+    int                  s;
+    const char          *ops[] = {NULL, "delete"};
+    const char          *configs[] = {
+        "<table xmlns=\"urn:example:clixon\"><parameter><name>e</name><value>5</value></parameter></table>",
+        "<table xmlns=\"urn:example:clixon\"><parameter><name>b</name></parameter></table>"};
+
+    if ((h = clixon_client_init("$cfg")) == NULL)
+       return -1;
+    if ((ch = clixon_client_connect(h, CLIXON_CLIENT_NETCONF, NULL)) == NULL)
+       return -1;
+    s = clixon_client_socket_get(ch);
+    if (clixon_client_hello(s, NULL, 0) < 0)
+      return -1;
+    if (clixon_client_edit_batch(ch, 2, ops, configs) < 0)
+      goto done;
+    printf("ok\n"); /* for test output */
+    /* b is already deleted: the batch fails and nothing is applied */
+    if (clixon_client_edit_batch(ch, 2, ops, configs) == 0)
+      goto done;
+    printf("failed\n"); /* for test output */
+    retval = 0;
+  done:
+    clixon_client_disconnect(ch);
+    clixon_client_terminate(h);
+    return retval;
+}
+EOF
+
+new "compile $cfile -> $app"
+if [ "$LINKAGE" = static ]; then
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app /usr/local/lib/libclixon${LIBSTATIC_SUFFIX} ${LIBS}"
+else
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app -L /usr/local/lib -lclixon"
+fi
+expectpart "$($COMPILE)" 0 ""
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-batch: create, merge and delete"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edit 1 create a 1)$(edit 2 create b 2)$(edit 3 merge a 3)$(edit 4 create c 4)$(edit 5 delete c)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "edit-batch: last edit fails"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edit 1 merge a 5)$(edit 2 create d 6)$(edit 3 create b 7)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-exists</error-tag>"
+
+new "get-config: unchanged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "edit-batch: choice and ordered-by user"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edittable 1 merge "<slow>1</slow><tag>p</tag><tag>q</tag>")</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config: choice and ordered-by user"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter><slow>1</slow><tag>p</tag><tag>q</tag></table></data></rpc-reply>"
+
+new "edit-batch: merge, delete, other case and insert, last edit fails"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edit 1 merge a 5)$(edit 2 delete b)$(edittable 3 merge "<fast/><tag>r</tag>")$(edit 4 create d 6)$(edit 5 create a 7)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-exists</error-tag>"
+
+new "get-config: unchanged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter><slow>1</slow><tag>p</tag><tag>q</tag></table></data></rpc-reply>"
+
+new "edit-batch: top-level replace, last edit fails"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edit 1 replace c 8)$(edit 2 create c 9)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-exists</error-tag>"
+
+new "get-config: unchanged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter><slow>1</slow><tag>p</tag><tag>q</tag></table></data></rpc-reply>"
+
+new "edit-batch: remove choice and ordered-by user"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edittable 1 remove "<slow/>")$(edittable 2 remove "<tag>p</tag><tag>q</tag>")</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config: removed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "edit-batch: unknown element"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">$(edit 1 merge a 5)<edit><edit-id>2</edit-id><config><table xmlns=\"urn:example:clixon\"><xxx/></table></config></edit></edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>unknown-element</error-tag>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>3</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "edit-batch: default-operation replace, then merge"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\"><default-operation>replace</default-operation><edit><edit-id>1</edit-id><config><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><value>8</value></parameter></table></config></edit>$(edit 2 merge d 9)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config: replaced"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><value>8</value></parameter><parameter><name>d</name><value>9</value></parameter></table></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "edit-batch: test-option test-only not supported"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\"><test-option>test-only</test-option>$(edit 1 merge a 5)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>operation-not-supported</error-tag>"
+
+new "edit-batch: test-option set"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\"><test-option>set</test-option>$(edit 1 merge a 5)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "edit-batch: autocommit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\" cl:autocommit=\"true\" xmlns:cl=\"http://clicon.org/lib\">$(edit 1 merge a 6)</edit-batch></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running: committed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>6</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "client api edit-batch: ok, then failed"
+expectpart "$(sudo $app)" 0 "^ok$" "^failed$"
+
+new "get-config: client edits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>6</value></parameter><parameter><name>e</name><value>5</value></parameter></table></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "generate batch of $perfreq edits"
+rpc="<rpc $DEFAULTNS><edit-batch xmlns=\"http://clicon.org/lib\">"
+for (( i=0; i<$perfreq; i++ )); do
+    rpc+="$(edit $i merge x$i $i)"
+done
+rpc+="</edit-batch></rpc>"
+echo -n "$DEFAULTHELLO$(chunked_framing "$rpc")" > $fbatch
+
+new "edit-batch: $perfreq edits"
+expecteof_file "time -p $clixon_netconf -qef $cfg" 0 "$fbatch" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$" 2>&1 | awk '/real/ {print $2}'
+
+new "get-config: last edit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='x$(( $perfreq - 1 ))']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>x$(( $perfreq - 1 ))</name><value>$(( $perfreq - 1 ))</value></parameter></table></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
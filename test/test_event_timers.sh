@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+# Event timers of the poll, select and epoll event handlers
+# The example backend registers many timers with deadlines in shuffled order, and
+# cancels every third by its id, see -- -T in example_backend.c
+# Check in the backend log that the other timers are called in deadline order, and
+# that cancelled timers are not called
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+flog=$dir/backend.log
+
+# Number of timers
+: ${perfnr:=200}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  leaf x {
+    type string;
+  }
+}
+EOF
+
+# Every third timer is cancelled, starting with the first
+cancelled=$(( (perfnr+2)/3 ))
+called=$(( perfnr-cancelled ))
+
+# Args:
+# 1: Event handler option, or empty for poll
+function testrun()
+{
+    opt=$1
+
+    rm -f $flog
+    new "test params: -f $cfg $opt"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -l f$flog $opt -- -T $perfnr"
+        start_backend -s init -f $cfg -l f$flog $opt -- -T $perfnr
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "wait for timers"
+    sleep 3
+
+    new "timers called in deadline order, cancelled timers not called"
+    expectpart "$(sudo cat $flog)" 0 "example timers: $called called, $cancelled cancelled, 0 errors" --not-- "example timer [0-9]*:"
+
+    new "backend is served after timers"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "poll event handler"
+testrun ""
+
+new "select event handler"
+testrun "-o CLICON_EVENT_SELECT=true"
+
+new "epoll event handler"
+testrun "-o CLICON_EVENT_EPOLL=true"
+
+rm -rf $dir
+
+new "endtest"
+endtest
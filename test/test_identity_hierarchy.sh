@@ -0,0 +1,208 @@
+#!/usr/bin/env bash
+# Multi-level identity hierarchy across modules
+# Identities derived in four levels over three modules, and an identity with two bases
+# Check identityref validation and XPath derived-from() and derived-from-or-self()
+# See yang_identity_derived
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/id-top.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+# Level 0 and 1
+cat <<EOF > $dir/id-base.yang
+module id-base {
+   yang-version 1.1;
+   namespace "urn:example:id-base";
+   prefix b;
+   identity root;
+   identity l1 {
+      base root;
+   }
+}
+EOF
+
+# Level 2, and an identity with two bases
+cat <<EOF > $dir/id-mid.yang
+module id-mid {
+   yang-version 1.1;
+   namespace "urn:example:id-mid";
+   prefix m;
+   import id-base {
+      prefix b;
+   }
+   identity l2 {
+      base b:l1;
+   }
+   identity other;
+   identity multi {
+      base b:root;
+      base other;
+   }
+}
+EOF
+
+# Level 3 and 4, and data
+cat <<EOF > $fyang
+module id-top {
+   yang-version 1.1;
+   namespace "urn:example:id-top";
+   prefix t;
+   import id-base {
+      prefix b;
+   }
+   import id-mid {
+      prefix m;
+   }
+   identity l3 {
+      base m:l2;
+   }
+   identity l4 {
+      base l3;
+   }
+   list entry {
+      key name;
+      leaf name {
+         type string;
+      }
+      leaf type {
+         type identityref {
+            base b:root;
+         }
+      }
+      leaf other {
+         type identityref {
+            base m:other;
+         }
+      }
+      leaf below {
+         type string;
+         must "derived-from(../type, 'b:l1')" {
+            error-message "type not derived from l1";
+         }
+      }
+      leaf self {
+         type string;
+         must "derived-from-or-self(../type, 'b:l1')" {
+            error-message "type not l1 or derived from l1";
+         }
+      }
+   }
+}
+EOF
+
+NS="xmlns=\"urn:example:id-top\" xmlns:b=\"urn:example:id-base\" xmlns:m=\"urn:example:id-mid\" xmlns:t=\"urn:example:id-top\""
+
+# Edit entry in candidate, validate, discard
+# Args:
+# 1: entry contents
+# 2: error-message of validate, or empty for ok
+function idtest()
+{
+    entry=$1
+    errmsg=$2
+
+    new "edit $entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><entry $NS><name>x</name>$entry</entry></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ -z "$errmsg" ]; then
+        new "validate ok"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    else
+        new "validate fail: $errmsg"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>$errmsg" ""
+    fi
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# identityref
+new "identityref: four levels over three modules"
+idtest "<type>t:l4</type>"
+
+new "identityref: each level"
+for id in b:l1 m:l2 t:l3; do
+    idtest "<type>$id</type>"
+done
+
+new "identityref: base identity itself is not derived"
+idtest "<type>b:root</type>" "Identityref validation failed, b:root not derived from root in id-base.yang"
+
+new "identityref: two bases, both valid"
+idtest "<type>m:multi</type><other>m:multi</other>"
+
+new "identityref: other hierarchy"
+idtest "<other>t:l4</other>" "Identityref validation failed, t:l4 not derived from other in id-mid.yang"
+
+# derived-from()
+new "derived-from: four levels"
+idtest "<type>t:l4</type><below>x</below>"
+
+new "derived-from: level 2 in other module"
+idtest "<type>m:l2</type><below>x</below>"
+
+new "derived-from: not self"
+idtest "<type>b:l1</type><below>x</below>" "type not derived from l1"
+
+new "derived-from: two bases, not below l1"
+idtest "<type>m:multi</type><below>x</below>" "type not derived from l1"
+
+# derived-from-or-self()
+new "derived-from-or-self: self"
+idtest "<type>b:l1</type><self>x</self>"
+
+new "derived-from-or-self: four levels"
+idtest "<type>t:l4</type><self>x</self>"
+
+new "derived-from-or-self: two bases, not below l1"
+idtest "<type>m:multi</type><self>x</self>" "type not l1 or derived from l1"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,131 @@
+#!/usr/bin/env bash
+# Throughput of bulk small edits: one round-trip per rpc vs pipelined rpcs
+# First, send $perfreq edit-config rpcs via one netconf client, which waits for each reply
+# Then, send the same number of rpcs directly to the backend socket without waiting
+# for replies, and check that each reply is ok, has the message-id of its request and
+# is received in request order
+# See clicon_rpc_msg_pipeline(), and the example cli pipeline command in test_cli.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of edit requests
+: ${perfreq:=1000}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/scaling.yang
+fserial=$dir/serial.xml
+fpipeline=$dir/pipeline.xml
+foutput=$dir/output.xml
+sock=/usr/local/var/run/$APPNAME.sock
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate $perfreq serial edits"
+echo -n "$DEFAULTHELLO" > $fserial
+for (( i=0; i<$perfreq; i++ )); do
+    echo -n "$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$i</a><b>$i</b></y></x></config></edit-config></rpc>")" >> $fserial
+done
+
+new "netconf $perfreq serial edits"
+{ $TIMEFN $clixon_netconf -qef $cfg < $fserial > $foutput; } 2>&1 | awk '/real/ {print $2}'
+
+new "check $perfreq serial replies"
+nr=$(grep -o "<ok/>" $foutput | wc -l)
+if [ $nr -ne $perfreq ]; then
+    err1 "$perfreq replies" "$nr"
+fi
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ -z "$netcat" ]; then
+    echo "...skipped: pipelined edits, netcat not available"
+else
+    new "generate $perfreq pipelined edits"
+    echo -n "" > $fpipeline
+    for (( i=0; i<$perfreq; i++ )); do
+        echo -n "$(chunked_framing "<rpc $DEFAULTNS username=\"$USER\" message-id=\"$i\"><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$i</a><b>$i</b></y></x></config></edit-config></rpc>")" >> $fpipeline
+    done
+
+    # Note: netcat waits 1s for more input after the last reply
+    new "backend $perfreq pipelined edits"
+    { $TIMEFN sudo $netcat -U $sock < $fpipeline > $foutput; } 2>&1 | awk '/real/ {print $2}'
+
+    new "check $perfreq pipelined replies ok in request order"
+    # message-id of each ok reply, in the order received
+    ids=$(grep -o "<rpc-reply [^>]*message-id=\"[0-9]*\"[^>]*><ok/></rpc-reply>" $foutput | grep -o "message-id=\"[0-9]*\"" | grep -o "[0-9]*" | tr '\n' ' ')
+    expect=$(seq -s ' ' 0 $(( $perfreq - 1 )))
+    if [ "$ids" != "$expect " ]; then
+        err "$expect" "$ids"
+    fi
+
+    new "check pipelined edits"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$(( $perfreq - 1 ))]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>$(( $perfreq - 1 ))</a><b>$(( $perfreq - 1 ))</b></y></x></data></rpc-reply>"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
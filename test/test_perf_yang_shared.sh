@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# Memory of many NETCONF sessions using a shared memory-mapped YANG spec cache
+# See CLICON_YANG_SPEC_CACHE_SHARED
+# Start $nrsessions concurrent netconf sessions on a YANG with many long descriptions,
+# first with a private and then with a shared spec cache.
+# Compare the sum of private anonymous resident memory (RssAnon) of the sessions: argument
+# strings of the shared cache are in file pages and not in the heap of each session.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+cachedir=$dir/yspec
+
+# Number of leafs in YANG
+: ${perfnr:=2000}
+
+# Number of concurrent netconf sessions
+: ${nrsessions:=10}
+
+# Seconds to wait for sessions to load YANG
+: ${sessionwait:=3}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_SPEC_CACHE_DIR>$cachedir</CLICON_YANG_SPEC_CACHE_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+desc="Long description of a leaf used to make argument strings dominate the memory of the YANG spec"
+desc="$desc, $desc, $desc"
+
+echo "module example{" > $fyang
+echo "  yang-version 1.1;" >> $fyang
+echo "  namespace \"urn:example:clixon\";" >> $fyang
+echo "  prefix ex;" >> $fyang
+echo "  container c {" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "    leaf x$i { type string; description \"$i: $desc\"; }" >> $fyang
+done
+echo "  }" >> $fyang
+echo "}" >> $fyang
+
+# Start $nrsessions netconf sessions, sum RssAnon of them in kB in variable rss
+# Sessions are kept open by a sleeping writer
+function sessionrun()
+{
+    pids=""
+    for (( i=0; i<$nrsessions; i++ )); do
+        (echo "$DEFAULTHELLO"; sleep $((sessionwait+2))) | $clixon_netconf -qf $cfg > /dev/null &
+        pids="$pids $!"
+    done
+    sleep $sessionwait
+    rss=0
+    for pid in $pids; do
+        kb=$(awk '/^RssAnon:/ {print $2}' /proc/$pid/status 2> /dev/null)
+        if [ -z "$kb" ]; then
+            err1 "RssAnon of session $pid"
+        fi
+        rss=$((rss+kb))
+    done
+    wait
+}
+
+new "test params: -f $cfg"
+
+if [ ! -f /proc/self/status ] || ! grep -q ^RssAnon: /proc/self/status; then
+    echo "...skipped: RssAnon in /proc is required"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Cache is written by the sessions
+rm -rf $cachedir
+mkdir $cachedir
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "write netconf spec cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+if [ ! -f $cachedir/clixon_netconf.yspec ]; then
+    err1 "Expected $cachedir/clixon_netconf.yspec"
+fi
+
+new "$nrsessions sessions with private spec cache"
+sessionrun
+rss0=$rss
+
+sed -i "s|</clixon-config>|  <CLICON_YANG_SPEC_CACHE_SHARED>true</CLICON_YANG_SPEC_CACHE_SHARED>\n</clixon-config>|" $cfg
+
+new "rewrite netconf spec cache, options changed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "$nrsessions sessions with shared spec cache"
+sessionrun
+rss1=$rss
+
+echo "RssAnon of $nrsessions sessions: private:${rss0}kB shared:${rss1}kB"
+
+new "shared spec cache uses less private memory"
+if [ $rss1 -ge $rss0 ]; then
+    err1 "RssAnon less than ${rss0}kB" "${rss1}kB"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
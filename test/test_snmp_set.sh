@@ -247,6 +247,13 @@ testrun clixonExampleString STRING foobar foobar foobar ${MIB}.1.3.0 ${MIB}.1.3.
 testrun ifPromiscuousMode INTEGER 1 1 true ${MIB}.1.10.0  ${MIB}.1.10.0 # boolean
 testrun ifIpAddr IPADDRESS 1.2.3.4 1.2.3.4 1.2.3.4 ${MIB}.1.13.0  ${MIB}.1.13.0 # InetAddress
 testrun bitTest "Hex-STRING" "00 20 00 00 00" "00 20 00 00 00" "bit10" ${MIB}.1.14.0  ${MIB}.1.14.0 # bitTest
+
+# Bitstring shorter than the highest bit position: only bits within the input are set
+new "Set bitTest via SNMP with short bitstring"
+expectpart "$($snmpset ${MIB}.1.14.0 x "80 20")" 0 "Hex-STRING:"
+
+new "Check bitTest via CLI"
+expectpart "$($clixon_cli -1 -f $cfg show config)" 0 "<bitTest>bit00 bit10</bitTest>"
 # XXX It was supposed to test writing hardware address type, but it is also read-only
 #testrun ifPhysAddress STRING ff:ee:dd:cc:bb:aa ff:ee:dd:cc:bb:aa ff:ee:dd:cc:bb:aa ${IFMIB}.2.2.1.6.1
 
@@ -83,6 +83,16 @@ EOF
         if [ -z "$pid" ]; then
             err "backend pid" "backend dead"
         fi
+
+        new "Unix socket partial message does not block other clients"
+        (printf "\n#100\n<hello" ; sleep 10) | netcat -U $sock &
+        ncpid=$!
+        sleep 1
+
+        new "cli show version while partial message pending"
+        expectpart "$($clixon_cli -1f $cfg show version)" 0 "${CLIXON_VERSION}"
+
+        kill $ncpid 2> /dev/null
     fi
     if [ $BE -ne 0 ]; then
         new "Kill backend"
@@ -0,0 +1,136 @@
+#!/usr/bin/env bash
+# State data cache of backend plugins, see CLICON_BACKEND_STATEDATA_CACHE_TTL
+# Use main example -- -s option for state
+# Check cache hits and misses with the stats RPC, cache flush on commit, and expiry
+# Then without CLICON_BACKEND_STATEDATA_CACHE_TTL, with a time to live of the state
+# subtree registered by the example plugin: -- -s -L <ms>
+# Check that a request within the subtree uses the cached state of the subtree
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_BACKEND_STATEDATA_CACHE_TTL>3000</CLICON_BACKEND_STATEDATA_CACHE_TTL>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  /* State data (not config) for the example application*/
+  container state {
+     config false;
+     leaf-list op {
+        type string;
+     }
+  }
+}
+EOF
+
+new "test params: -f $cfg -- -s"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -s"
+    start_backend -s init -f $cfg -- -s
+fi
+
+new "wait backend"
+wait_backend
+
+STATE="<rpc-reply $DEFAULTNS><data><state xmlns=\"urn:example:clixon\"><op>41</op><op>42</op><op>43</op></state></data></rpc-reply>"
+GET="<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"ex:state\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>"
+STATS="<rpc $DEFAULTNS><stats xmlns=\"http://clicon.org/lib\"></stats></rpc>"
+
+new "get state: miss"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$GET" "" "$STATE"
+
+new "stats: no hits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$STATS" "<statedata-cache xmlns=\"http://clicon.org/lib\"><entries>[1-9][0-9]*</entries><hits>0</hits><misses>[1-9][0-9]*</misses><expired>0</expired></statedata-cache>" ""
+
+new "get state: hit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$GET" "" "$STATE"
+
+new "stats: hits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$STATS" "<statedata-cache xmlns=\"http://clicon.org/lib\"><entries>[1-9][0-9]*</entries><hits>[1-9][0-9]*</hits>" ""
+
+new "get all state: miss, other xpath"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get/></rpc>" "<state xmlns=\"urn:example:clixon\"><op>41</op><op>42</op><op>43</op></state>" ""
+
+new "commit flushes cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "stats: no entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$STATS" "<statedata-cache xmlns=\"http://clicon.org/lib\"><entries>0</entries>" ""
+
+new "get state: miss"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$GET" "" "$STATE"
+
+sleep 4
+
+new "get state after ttl: expired"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$GET" "" "$STATE"
+
+new "stats: expired"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$STATS" "<expired>[1-9][0-9]*</expired></statedata-cache>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+    new "start backend -s init -f $cfg -o CLICON_BACKEND_STATEDATA_CACHE_TTL=0 -- -s -L 3000"
+    start_backend -s init -f $cfg -o CLICON_BACKEND_STATEDATA_CACHE_TTL=0 -- -s -L 3000
+fi
+
+new "wait backend"
+wait_backend
+
+new "subtree ttl: get state: miss"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$GET" "" "$STATE"
+
+new "subtree ttl: get within state: hit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:state/ex:op\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>" "" "$STATE"
+
+new "subtree ttl: get all state: not cached, default ttl is 0"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get/></rpc>" "<state xmlns=\"urn:example:clixon\"><op>41</op><op>42</op><op>43</op></state>" ""
+
+new "subtree ttl: stats: hits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$STATS" "<statedata-cache xmlns=\"http://clicon.org/lib\"><entries>[1-9][0-9]*</entries><hits>[1-9][0-9]*</hits>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+# State data callbacks called in parallel by worker processes
+# See CLICON_BACKEND_STATEDATA_PARALLEL and CLICON_BACKEND_STATEDATA_DEADLINE
+# Use main example -- -s -w <ms> option to delay the state callback
+# Check state data without deadline, within deadline, and when deadline is exceeded
+# When exceeded, the reply has a warning with the name of the plugin
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  /* State data (not config) for the example application*/
+  container state {
+     config false;
+     leaf-list op {
+        type string;
+     }
+  }
+}
+EOF
+
+# Args:
+# 1: deadline in ms
+# 2: delay of state callback in ms
+# 3: expected state
+function testrun()
+{
+    deadline=$1
+    delay=$2
+    expect=$3
+
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_BACKEND_STATEDATA_PARALLEL>true</CLICON_BACKEND_STATEDATA_PARALLEL>
+  <CLICON_BACKEND_STATEDATA_DEADLINE>$deadline</CLICON_BACKEND_STATEDATA_DEADLINE>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg -- -s -w $delay"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -- -s -w $delay"
+        start_backend -s init -f $cfg -- -s -w $delay
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "get state deadline:$deadline delay:$delay"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"ex:state\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS>$expect</rpc-reply>"
+
+    new "get config is not affected"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+STATE="<data><state xmlns=\"urn:example:clixon\"><op>41</op><op>42</op><op>43</op></state></data>"
+
+new "Parallel state, no deadline"
+testrun 0 0 "$STATE"
+
+new "Parallel state, within deadline"
+testrun 5000 100 "$STATE"
+
+new "Parallel state, deadline exceeded: no state, warning with plugin name"
+testrun 200 3000 "<rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>warning</error-severity><error-message>State data callback of plugin example_backend not done after 200 ms, state data of plugin ignored</error-message></rpc-error><data/>"
+
+rm -rf $dir
+
+new "endtest"
+endtest
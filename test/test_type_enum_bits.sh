@@ -0,0 +1,195 @@
+#!/usr/bin/env bash
+# Enumerations and bits with implicit values and positions
+# Enums without value statements, and mixed explicit and implicit values
+# Bits without position statements, and mixed explicit and implicit positions
+# Valid names are accepted and invalid names rejected via the enum/bits index
+# of the resolved type, also when the type is used via a typedef
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/type.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  typedef implicit-enum {
+     type enumeration {
+        enum zero;
+        enum one;
+        enum two;
+     }
+  }
+  typedef implicit-bits {
+     type bits {
+        bit b0;
+        bit b1;
+        bit b2;
+     }
+  }
+  container c {
+     leaf e1 {
+        description "Enum without value statements";
+        type enumeration {
+           enum red;
+           enum green;
+           enum blue;
+        }
+     }
+     leaf e2 {
+        description "Enum with mixed explicit and implicit values";
+        type enumeration {
+           enum a {
+              value 10;
+           }
+           enum b;
+           enum c {
+              value -3;
+           }
+           enum d;
+        }
+     }
+     leaf e3 {
+        type implicit-enum;
+     }
+     leaf b1 {
+        description "Bits without position statements";
+        type bits {
+           bit x;
+           bit y;
+           bit z;
+        }
+     }
+     leaf b2 {
+        description "Bits with mixed explicit and implicit positions";
+        type bits {
+           bit p {
+              position 5;
+           }
+           bit q;
+           bit r {
+              position 40;
+           }
+           bit s;
+        }
+     }
+     leaf b3 {
+        type implicit-bits;
+     }
+  }
+}
+EOF
+
+# Edit leaf in candidate, validate, discard
+# Args:
+# 1: leaf name
+# 2: value
+# 3: expect ok (true) or fail (false)
+function typetest()
+{
+    leaf=$1
+    val=$2
+    ok=$3
+
+    new "edit $leaf $val"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><$leaf>$val</$leaf></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if $ok; then
+        new "validate $leaf $val ok"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+        new "get-config $leaf $val"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:clixon\"><$leaf>$val</$leaf></c></data></rpc-reply>"
+    else
+        new "validate $leaf $val fail"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>$leaf</bad-element></error-info><error-severity>error</error-severity><error-message>" ""
+    fi
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "enum without values"
+for v in red green blue; do
+    typetest e1 $v true
+done
+typetest e1 yellow false
+typetest e1 0 false
+
+new "enum with mixed values"
+for v in a b c d; do
+    typetest e2 $v true
+done
+typetest e2 10 false
+typetest e2 e false
+
+new "enum without values via typedef"
+for v in zero one two; do
+    typetest e3 $v true
+done
+typetest e3 three false
+
+new "bits without positions"
+typetest b1 "x" true
+typetest b1 "z" true
+typetest b1 "x y z" true
+typetest b1 "x w" false
+
+new "bits with mixed positions"
+typetest b2 "q" true
+typetest b2 "p q r s" true
+typetest b2 "t" false
+
+new "bits without positions via typedef"
+typetest b3 "b0 b2" true
+typetest b3 "b3" false
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
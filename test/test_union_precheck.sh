@@ -0,0 +1,187 @@
+#!/usr/bin/env bash
+# Union validation: lexical check of numeric members and memo of matched values
+# - string with pattern and integer members
+# - identityref and integer members
+# - leafref members: result depends on other data and is not memoized
+# - memo is per union type: a value matched by one union is not valid in another
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/union.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  identity crypto;
+  identity des {
+     base crypto;
+  }
+  container c {
+     leaf x {
+        type string;
+     }
+     leaf a {
+        description "Integer and string with pattern";
+        type union {
+           type int32;
+           type string {
+              pattern '[a-z]+';
+           }
+        }
+     }
+     leaf b {
+        description "Other union type with some of the same values as a";
+        type union {
+           type int8;
+           type enumeration {
+              enum foo;
+           }
+        }
+     }
+     leaf i {
+        description "Integer and identityref";
+        type union {
+           type uint8;
+           type identityref {
+              base crypto;
+           }
+        }
+     }
+     leaf r {
+        description "Leafref and enumeration";
+        type union {
+           type leafref {
+              path "../x";
+              require-instance true;
+           }
+           type enumeration {
+              enum none;
+           }
+        }
+     }
+  }
+}
+EOF
+
+# Edit config in candidate, validate twice, discard
+# Second validation uses memoized values of the first
+# Args:
+# 1: contents of container c
+# 2: start of rpc-error of validate, or empty for ok
+function uniontest()
+{
+    conf=$1
+    expect=$2
+
+    new "edit $conf"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$conf</c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    for v in 1 2; do
+        if [ -z "$expect" ]; then
+            new "validate $v ok"
+            expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+        else
+            new "validate $v fail"
+            expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type>$expect" ""
+        fi
+    done
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "string with pattern and int"
+uniontest "<a>42</a>"
+uniontest "<a>-42</a>"
+uniontest "<a>abc</a>"
+uniontest "<a>4a</a>" "<error-tag>bad-element</error-tag><error-info><bad-element>a</bad-element></error-info>"
+uniontest "<a>-</a>" "<error-tag>bad-element</error-tag><error-info><bad-element>a</bad-element></error-info>"
+uniontest "<a>a4</a>" "<error-tag>bad-element</error-tag><error-info><bad-element>a</bad-element></error-info>"
+uniontest "<a>192.0.2.1</a>" "<error-tag>bad-element</error-tag><error-info><bad-element>a</bad-element></error-info>"
+
+new "identityref and int"
+uniontest "<i>42</i>"
+uniontest "<i>ex:des</i>"
+uniontest "<i>ex:crypto</i>" "<error-tag>"
+uniontest "<i>ex:zzz</i>" "<error-tag>"
+uniontest "<i>300</i>" "<error-tag>"
+
+new "leafref and enumeration"
+uniontest "<x>abc</x><r>abc</r>"
+uniontest "<r>none</r>"
+uniontest "<x>abc</x><r>def</r>" "<error-tag>data-missing</error-tag><error-app-tag>instance-required</error-app-tag>"
+
+new "leafref: same value valid, then invalid when referred node changes"
+new "netconf set x and r"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x>abc</x><r>abc</r></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate leafref ok"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf change x"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x>def</x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate leafref fail, r is unchanged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag><error-app-tag>instance-required</error-app-tag>" ""
+
+new "discard"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "memo is per union type"
+# a is validated before b: its matched values are memoized
+uniontest "<a>200</a><b>100</b>"
+uniontest "<a>200</a><b>200</b>" "<error-tag>bad-element</error-tag><error-info><bad-element>b</bad-element></error-info>"
+uniontest "<a>foo</a><b>foo</b>"
+uniontest "<a>abc</a><b>abc</b>" "<error-tag>bad-element</error-tag><error-info><bad-element>b</bad-element></error-info>"
+uniontest "<b>200</b>" "<error-tag>bad-element</error-tag><error-info><bad-element>b</bad-element></error-info>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
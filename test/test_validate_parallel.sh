@@ -0,0 +1,170 @@
+#!/usr/bin/env bash
+# Parallel validation using worker processes, see CLICON_VALIDATE_WORKERS
+# Validate the same invalid configurations serially and in parallel and check that
+# the rpc-error replies are the same.
+# A large top-level container is split into work units, check that errors of its
+# children are reported before its own max-elements error, as in serial validation.
+# Check in the backend log that errors are reported by the workers, without falling
+# back to serial validation.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/test.yang
+flog=$dir/backend.log
+
+# Number of list entries, larger than VALIDATE_PARALLEL_MIN
+: ${perfnr:=200}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module $APPNAME{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container c {
+     list e {
+        key name;
+        max-elements 100;
+        leaf name {
+           type uint32;
+        }
+        leaf val {
+           type uint32;
+           must ". < 1000" {
+              error-message "val too large";
+           }
+        }
+     }
+  }
+  leaf t {
+     type uint32;
+     must ". < 1000" {
+        error-message "t too large";
+     }
+  }
+}
+EOF
+
+# Generate config with $perfnr entries where entry $1 (if any) has an invalid value
+# Also top-level leaf t with value $2
+function genconfig()
+{
+    bad=$1
+    t=$2
+    conf="<c xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$perfnr; i++ )); do
+        if [ $i -eq $bad ]; then
+            conf+="<e><name>$i</name><val>5000</val></e>"
+        else
+            conf+="<e><name>$i</name><val>$i</val></e>"
+        fi
+    done
+    conf+="</c><t xmlns=\"urn:example:clixon\">$t</t>"
+}
+
+# Validate configurations with given number of workers, save replies in reply$1_*
+function testrun()
+{
+    workers=$1
+
+    rm -f $flog
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -l f$flog -o CLICON_VALIDATE_WORKERS=$workers"
+        start_backend -s init -f $cfg -l f$flog -o CLICON_VALIDATE_WORKERS=$workers
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    # Invalid entry and too many entries: entry error is first
+    genconfig 150 1
+    new "workers $workers: add config with invalid entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$conf</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "workers $workers: validate invalid entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>val too large</error-message></rpc-error></rpc-reply>"
+    echo "$ret" > $dir/reply${workers}_entry
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    # Only too many entries
+    genconfig -1 1
+    new "workers $workers: add config with too many entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$conf</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "workers $workers: validate too many entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-app-tag>too-many-elements</error-app-tag>" ""
+    echo "$ret" > $dir/reply${workers}_max
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    # Invalid entry and invalid top-level leaf after the container: entry error is first
+    genconfig 10 5000
+    new "workers $workers: add config with invalid entry and leaf"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$conf</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "workers $workers: validate invalid entry and leaf"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>val too large</error-message></rpc-error></rpc-reply>"
+    echo "$ret" > $dir/reply${workers}_leaf
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "workers $workers: errors from workers, no serial validation"
+        expectpart "$(sudo cat $flog)" 0 "" --not-- "validating serially" "xret is NULL"
+    fi
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "serial validation"
+testrun 0
+
+new "parallel validation"
+testrun 4
+
+for t in entry max leaf; do
+    new "compare serial and parallel replies: $t"
+    if ! cmp -s $dir/reply0_$t $dir/reply4_$t; then
+        err "$(cat $dir/reply0_$t)" "$(cat $dir/reply4_$t)"
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+# Parallel parsing of YANG files of a directory, see CLICON_YANG_PARSE_WORKERS
+# Load many modules from CLICON_YANG_MAIN_DIR serially and in parallel and check that
+# types, revisions, extensions, imports and augments are the same.
+# Then add a module with a syntax error and check that the error is reported as in
+# serial parsing.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+ydir=$dir/yang
+
+# Number of modules, larger than YANG_PARSE_PARALLEL_MIN
+: ${perfnr:=16}
+
+test -d $ydir || mkdir -p $ydir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+# Base module with typedef and extension, imported by the others
+cat <<EOF > $ydir/base.yang
+module base{
+  yang-version 1.1;
+  namespace "urn:example:base";
+  prefix b;
+  revision 2025-01-01;
+  extension ext {
+    argument name;
+  }
+  typedef small {
+    type int32 {
+      range "1..10";
+    }
+  }
+  container top;
+}
+EOF
+
+for (( i=0; i<$perfnr; i++ )); do
+    cat <<EOF > $ydir/m$i@2025-02-01.yang
+module m$i{
+  yang-version 1.1;
+  namespace "urn:example:m$i";
+  prefix m$i;
+  import base {
+    prefix b;
+  }
+  revision 2025-02-01;
+  augment "/b:top" {
+    container c$i {
+      b:ext "c$i";
+      leaf s {
+        type b:small;
+      }
+      leaf d {
+        type decimal64 {
+          fraction-digits 2;
+        }
+      }
+      leaf-list l {
+        type string {
+          pattern '[a-z]+';
+        }
+        max-elements 2;
+      }
+    }
+  }
+}
+EOF
+done
+
+# Start backend, run tests, stop backend
+# Args:
+# 1: number of parse workers
+function testrun()
+{
+    workers=$1
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -o CLICON_YANG_PARSE_WORKERS=$workers"
+        start_backend -s init -f $cfg -o CLICON_YANG_PARSE_WORKERS=$workers
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "add invalid range"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:base\"><c3 xmlns=\"urn:example:m3\"><s>11</s></c3></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate invalid range"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>s</bad-element></error-info>" ""
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "add too many leaf-list entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:base\"><c9 xmlns=\"urn:example:m9\"><l>a</l><l>b</l><l>c</l></c9></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate max-elements"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>operation-failed</error-tag><error-app-tag>too-many-elements</error-app-tag>" ""
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "add valid config"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:base\"><c0 xmlns=\"urn:example:m0\"><s>5</s><d>1.25</d><l>abc</l></c0></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get config"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><top xmlns=\"urn:example:base\"><c0 xmlns=\"urn:example:m0\"><s>5</s><d>1.25</d><l>abc</l></c0></top></data></rpc-reply>"
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_YANG_PARSE_WORKERS=$workers" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "test params: -f $cfg"
+
+new "Parse serially"
+testrun 0
+
+new "Parse in parallel"
+testrun 4
+
+new "Files are parsed by workers"
+expectpart "$(sudo $clixon_backend -F1s init -f $cfg -l o -D yang -o CLICON_YANG_PARSE_WORKERS=4 2>&1)" 0 "files:$((perfnr+1)) workers:4" --not-- "parsing serially"
+
+# Syntax error in one module
+cat <<EOF > $ydir/bad.yang
+module bad{
+  yang-version 1.1;
+  namespace "urn:example:bad";
+  prefix bad;
+  container x {
+    leaf y
+  }
+}
+EOF
+
+new "Syntax error serially"
+expectpart "$(sudo $clixon_backend -F1s init -f $cfg -l o -o CLICON_YANG_PARSE_WORKERS=0 2>&1)" 255 "$ydir/bad.yang on line"
+
+new "Syntax error in parallel"
+expectpart "$(sudo $clixon_backend -F1s init -f $cfg -l o -D yang -o CLICON_YANG_PARSE_WORKERS=4 2>&1)" 255 "$ydir/bad.yang on line" "parsing serially"
+
+rm -rf $dir
+
+new "endtest"
+endtest
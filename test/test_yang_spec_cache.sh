@@ -0,0 +1,189 @@
+#!/usr/bin/env bash
+# Precompiled YANG spec cache, see CLICON_YANG_SPEC_CACHE_DIR
+# Start backend twice: first parse and write cache, then read cache
+# Check that types, patterns, groupings and augments work when loaded from cache
+# Then change the YANG and check that the cache is rewritten
+# Last, use a shared memory-mapped cache and frozen specs
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fyang2=$dir/example-augment.yang
+cachedir=$dir/yspec
+cachefile=$cachedir/clixon_backend.yspec
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_SPEC_CACHE_DIR>$cachedir</CLICON_YANG_SPEC_CACHE_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  typedef small {
+    type int32 {
+      range "1..10";
+    }
+  }
+  grouping gr {
+    leaf name {
+      type string {
+        pattern '[a-z]+';
+      }
+    }
+    leaf value {
+      type small;
+    }
+  }
+  container table {
+    list parameter {
+      key name;
+      uses gr;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang2
+module example-augment{
+  yang-version 1.1;
+  namespace "urn:example:augment";
+  prefix aug;
+  import example {
+    prefix ex;
+  }
+  augment "/ex:table/ex:parameter" {
+    leaf extra {
+      type enumeration {
+        enum one;
+        enum two;
+      }
+    }
+  }
+}
+EOF
+
+# Start backend, run tests, stop backend
+function testrun()
+{
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "add invalid pattern"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>ABC</name></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate invalid pattern"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>name</bad-element></error-info>" ""
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "add invalid range"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>def</name><value>11</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate invalid range"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>value</bad-element></error-info>" ""
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "add parameter"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>abc</name><value>5</value><extra xmlns=\"urn:example:augment\">one</extra></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>abc</name><value>5</value><extra xmlns=\"urn:example:augment\">one</extra></parameter></table></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "test params: -f $cfg"
+
+rm -rf $cachedir
+
+new "Parse and write cache"
+testrun
+
+if [ $BE -ne 0 ]; then
+    new "Check cache file"
+    if [ ! -f $cachefile ]; then
+        err1 "Expected $cachefile"
+    fi
+fi
+
+new "Read cache"
+testrun
+
+if [ $BE -ne 0 ]; then
+    new "Change yang, cache is rewritten"
+    sum0=$(sudo cksum $cachefile)
+    sed -i 's/enum two;/enum two;\n        enum three;/' $fyang2
+    testrun
+    sum1=$(sudo cksum $cachefile)
+    if [ "$sum0" = "$sum1" ]; then
+        err1 "Expected $cachefile to change"
+    fi
+fi
+
+new "Shared cache: options changed, cache is rewritten"
+sed -i "s|</clixon-config>|  <CLICON_YANG_SPEC_CACHE_SHARED>true</CLICON_YANG_SPEC_CACHE_SHARED>\n</clixon-config>|" $cfg
+testrun
+
+new "Shared cache: read mapped cache"
+testrun
+
+new "Frozen spec: options changed, cache is rewritten"
+sed -i "s|<CLICON_YANG_SPEC_CACHE_SHARED>true</CLICON_YANG_SPEC_CACHE_SHARED>|<CLICON_YANG_SPEC_CACHE_SHARED>false</CLICON_YANG_SPEC_CACHE_SHARED>\n  <CLICON_YANG_SPEC_FREEZE>true</CLICON_YANG_SPEC_FREEZE>|" $cfg
+testrun
+
+new "Frozen spec: string table of cache is argument arena"
+testrun
+
+new "Frozen and shared"
+sed -i "s|<CLICON_YANG_SPEC_CACHE_SHARED>false</CLICON_YANG_SPEC_CACHE_SHARED>|<CLICON_YANG_SPEC_CACHE_SHARED>true</CLICON_YANG_SPEC_CACHE_SHARED>|" $cfg
+testrun
+testrun
+
+rm -rf $dir
+
+new "endtest"
+endtest